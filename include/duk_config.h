@@ -2213,6 +2213,9 @@ typedef struct duk_hthread duk_context;
 #if !defined(DUK_MEMCMP)
 #define DUK_MEMCMP       memcmp
 #endif
+#if !defined(DUK_MEMCHR)
+#define DUK_MEMCHR       memchr
+#endif
 #if !defined(DUK_MEMSET)
 #define DUK_MEMSET       memset
 #endif
@@ -2913,6 +2916,7 @@ typedef struct duk_hthread duk_context;
 #define DUK_USE_AVOID_PLATFORM_FUNCPTRS
 #define DUK_USE_BASE64_FASTPATH
 #define DUK_USE_BASE64_SUPPORT
+#undef DUK_USE_BASE64_DECODE_TABLES
 #define DUK_USE_BOOLEAN_BUILTIN
 #define DUK_USE_BUFFEROBJECT_SUPPORT
 #undef DUK_USE_BUFLEN16
@@ -2923,8 +2927,13 @@ typedef struct duk_hthread duk_context;
 #define DUK_USE_CBOR_BUILTIN
 #define DUK_USE_CBOR_DEC_RECLIMIT 1000
 #define DUK_USE_CBOR_ENC_RECLIMIT 1000
+#undef DUK_USE_CBOR_STREAMING
 #define DUK_USE_CBOR_SUPPORT
+#undef DUK_USE_CODEC_DECODE_INTO
+#undef DUK_USE_COMPILER_LAZY
+#undef DUK_USE_COMPILER_LOWMEM
 #define DUK_USE_COMPILER_RECLIMIT 2500
+#undef DUK_USE_COMPILER_STATS
 #define DUK_USE_COROUTINE_SUPPORT
 #undef DUK_USE_CPP_EXCEPTIONS
 #undef DUK_USE_DATAPTR16
@@ -2949,6 +2958,7 @@ typedef struct duk_hthread duk_context;
 #define DUK_USE_DOUBLE_LINKED_HEAP
 #define DUK_USE_DUKTAPE_BUILTIN
 #define DUK_USE_ENCODING_BUILTINS
+#undef DUK_USE_ENCODING_FASTPATH
 #define DUK_USE_ERRCREATE
 #define DUK_USE_ERRTHROW
 #define DUK_USE_ES6
@@ -2984,6 +2994,7 @@ typedef struct duk_hthread duk_context;
 #define DUK_USE_FUNC_FILENAME_PROPERTY
 #define DUK_USE_FUNC_NAME_PROPERTY
 #undef DUK_USE_GC_TORTURE
+#undef DUK_USE_GET_FREE_HEAP_SIZE
 #undef DUK_USE_GET_MONOTONIC_TIME
 #undef DUK_USE_GET_RANDOM_DOUBLE
 #define DUK_USE_GLOBAL_BINDING
@@ -3002,6 +3013,7 @@ typedef struct duk_hthread duk_context;
 #define DUK_USE_HOBJECT_ENTRY_MINGROW_DIVISOR 8
 #define DUK_USE_HOBJECT_HASH_PART
 #define DUK_USE_HOBJECT_HASH_PROP_LIMIT 8
+#undef DUK_USE_HOBJECT_SHAPES
 #define DUK_USE_HSTRING_ARRIDX
 #define DUK_USE_HSTRING_CLEN
 #undef DUK_USE_HSTRING_EXTDATA
@@ -3015,17 +3027,23 @@ typedef struct duk_hthread duk_context;
 #define DUK_USE_JSON_BUILTIN
 #define DUK_USE_JSON_DECNUMBER_FASTPATH
 #define DUK_USE_JSON_DECSTRING_FASTPATH
+#define DUK_USE_JSON_DEC_KEYCACHE_SIZE 32
 #define DUK_USE_JSON_DEC_RECLIMIT 1000
 #define DUK_USE_JSON_EATWHITE_FASTPATH
 #define DUK_USE_JSON_ENC_RECLIMIT 1000
+#undef DUK_USE_JSON_INCREMENTAL_PARSER
 #define DUK_USE_JSON_QUOTESTRING_FASTPATH
 #undef DUK_USE_JSON_STRINGIFY_FASTPATH
+#undef DUK_USE_JSON_STRINGIFY_SINK
 #define DUK_USE_JSON_SUPPORT
 #define DUK_USE_JX
 #define DUK_USE_LEXER_SLIDING_WINDOW
 #undef DUK_USE_LIGHTFUNC_BUILTINS
 #define DUK_USE_LITCACHE_SIZE 256
+#undef DUK_USE_MARK_AND_SWEEP_INCREMENTAL
+#undef DUK_USE_MARK_AND_SWEEP_PAUSE_STATS
 #define DUK_USE_MARK_AND_SWEEP_RECLIMIT 256
+#define DUK_USE_MARK_AND_SWEEP_STEP_BUDGET 2
 #define DUK_USE_MATH_BUILTIN
 #define DUK_USE_NATIVE_CALL_RECLIMIT 1000
 #undef DUK_USE_NATIVE_STACK_CHECK
@@ -3038,22 +3056,34 @@ typedef struct duk_hthread duk_context;
 #define DUK_USE_NONSTD_SETTER_KEY_ARGUMENT
 #define DUK_USE_NONSTD_STRING_FROMCHARCODE_32BIT
 #define DUK_USE_NUMBER_BUILTIN
+#undef DUK_USE_NUMCONV_PARSE_FASTPATH
+#undef DUK_USE_NUMCONV_STRINGIFY_FASTPATH
 #define DUK_USE_OBJECT_BUILTIN
 #undef DUK_USE_OBJSIZES16
 #undef DUK_USE_PARANOID_ERRORS
 #define DUK_USE_PC2LINE
 #define DUK_USE_PERFORMANCE_BUILTIN
 #undef DUK_USE_PREFER_SIZE
+#define DUK_USE_PROFILER_BUFSIZE 4096
+#undef DUK_USE_PROFILER_INSTRUMENT
+#define DUK_USE_PROFILER_INTERVAL 1000
+#define DUK_USE_PROFILER_MAXDEPTH 16
+#undef DUK_USE_PROFILER_SAMPLING
 #undef DUK_USE_PROMISE_BUILTIN
+#undef DUK_USE_PROPERTY_IC
+#define DUK_USE_PROPERTY_IC_SIZE 128
 #define DUK_USE_PROVIDE_DEFAULT_ALLOC_FUNCTIONS
 #undef DUK_USE_REFCOUNT16
 #define DUK_USE_REFCOUNT32
 #define DUK_USE_REFERENCE_COUNTING
 #define DUK_USE_REFLECT_BUILTIN
+#undef DUK_USE_REGEXP_CACHE
+#define DUK_USE_REGEXP_CACHE_SIZE 8
 #define DUK_USE_REGEXP_CANON_BITMAP
 #undef DUK_USE_REGEXP_CANON_WORKAROUND
 #define DUK_USE_REGEXP_COMPILER_RECLIMIT 10000
 #define DUK_USE_REGEXP_EXECUTOR_RECLIMIT 10000
+#undef DUK_USE_REGEXP_PREFILTER
 #define DUK_USE_REGEXP_SUPPORT
 #undef DUK_USE_ROM_GLOBAL_CLONE
 #undef DUK_USE_ROM_GLOBAL_INHERIT
@@ -3065,16 +3095,22 @@ typedef struct duk_hthread duk_context;
 #define DUK_USE_SHEBANG_COMMENTS
 #undef DUK_USE_SHUFFLE_TORTURE
 #define DUK_USE_SOURCE_NONBMP
+#undef DUK_USE_STRCACHE_INDEX
+#define DUK_USE_STRCACHE_INDEX_LIMIT 8192
 #undef DUK_USE_STRHASH16
 #undef DUK_USE_STRHASH_DENSE
+#undef DUK_USE_STRHASH_FULL
 #define DUK_USE_STRHASH_SKIP_SHIFT 5
 #define DUK_USE_STRICT_DECL
 #undef DUK_USE_STRICT_UTF8_SOURCE
+#undef DUK_USE_STRING_APPEND_INPLACE
 #define DUK_USE_STRING_BUILTIN
+#undef DUK_USE_STRING_SEARCH_FASTPATH
 #undef DUK_USE_STRLEN16
 #define DUK_USE_STRTAB_GROW_LIMIT 17
 #define DUK_USE_STRTAB_MAXSIZE 268435456L
 #define DUK_USE_STRTAB_MINSIZE 1024
+#undef DUK_USE_STRTAB_PROBE
 #undef DUK_USE_STRTAB_PTRCOMP
 #define DUK_USE_STRTAB_RESIZE_CHECK_MASK 255
 #define DUK_USE_STRTAB_SHRINK_LIMIT 6
@@ -3082,8 +3118,10 @@ typedef struct duk_hthread duk_context;
 #define DUK_USE_SYMBOL_BUILTIN
 #define DUK_USE_TAILCALL
 #define DUK_USE_TARGET_INFO "unknown"
+#undef DUK_USE_TEXTENCODER_ENCODE_INTO
 #define DUK_USE_TRACEBACKS
 #define DUK_USE_TRACEBACK_DEPTH 10
+#undef DUK_USE_TYPEDARRAY_KERNELS
 #define DUK_USE_VALSTACK_GROW_SHIFT 2
 #define DUK_USE_VALSTACK_LIMIT 1000000L
 #define DUK_USE_VALSTACK_SHRINK_CHECK_SHIFT 2
@@ -3102,6 +3140,170 @@ typedef struct duk_hthread duk_context;
 
 /* __OVERRIDE_DEFINES__ */
 
+/*
+ *  Mongoose OS build options, set through mos.yml cdefs.
+ */
+
+#if defined(MOS_DUK_ENABLE_PROFILER) && (MOS_DUK_ENABLE_PROFILER != 0)
+/* The sampling profiler is driven by the executor interrupt. */
+#define DUK_USE_INTERRUPT_COUNTER
+#define DUK_USE_PROFILER_SAMPLING
+#endif
+
+#if defined(MOS_DUK_ENABLE_INSTRUMENTATION) && (MOS_DUK_ENABLE_INSTRUMENTATION != 0)
+/* Per-function call counts and inclusive time, updated on every call. */
+#define DUK_USE_PROFILER_INSTRUMENT
+#endif
+
+#if defined(MOS_DUK_ENABLE_INCREMENTAL_GC) && (MOS_DUK_ENABLE_INCREMENTAL_GC != 0)
+/* Voluntary GC runs as time-bounded incremental marking steps. */
+#define DUK_USE_MARK_AND_SWEEP_INCREMENTAL
+#endif
+
+#if defined(MOS_DUK_ENABLE_GC_STATS) && (MOS_DUK_ENABLE_GC_STATS != 0)
+/* GC pause time histogram (MOS.System.gcStats). */
+#define DUK_USE_MARK_AND_SWEEP_PAUSE_STATS
+#endif
+
+#if defined(MOS_DUK_ENABLE_STRHASH_FULL) && (MOS_DUK_ENABLE_STRHASH_FULL != 0)
+/* Hash every byte of a string instead of sampling long strings. */
+#define DUK_USE_STRHASH_FULL
+#endif
+
+#if defined(MOS_DUK_ENABLE_STRTAB_PROBE) && (MOS_DUK_ENABLE_STRTAB_PROBE != 0)
+/* Open addressing string table with cached hashes instead of chaining. */
+#define DUK_USE_STRTAB_PROBE
+#endif
+
+#if defined(MOS_DUK_ENABLE_STRCACHE_INDEX) && (MOS_DUK_ENABLE_STRCACHE_INDEX != 0)
+/* O(1) random character access into long non-ASCII strings. */
+#define DUK_USE_STRCACHE_INDEX
+#endif
+
+#if defined(MOS_DUK_ENABLE_PROPERTY_IC) && (MOS_DUK_ENABLE_PROPERTY_IC != 0)
+/* Per-instruction inline caches for property reads and writes. */
+#define DUK_USE_PROPERTY_IC
+#endif
+
+#if defined(MOS_DUK_ENABLE_SHAPES) && (MOS_DUK_ENABLE_SHAPES != 0)
+/* Shared key/flags/hash parts for plain objects with the same layout. */
+#define DUK_USE_HOBJECT_SHAPES
+#endif
+
+#if defined(MOS_DUK_ENABLE_TYPEDARRAY_KERNELS) && (MOS_DUK_ENABLE_TYPEDARRAY_KERNELS != 0)
+/* Per element type loops for TypedArray set(), fill(), indexOf() etc. */
+#define DUK_USE_TYPEDARRAY_KERNELS
+#endif
+
+#if defined(MOS_DUK_ENABLE_JSON_FASTPATH) && (MOS_DUK_ENABLE_JSON_FASTPATH != 0)
+/* Serialize plain data directly from property tables, slow path on side effects. */
+#define DUK_USE_JSON_STRINGIFY_FASTPATH
+#endif
+
+#if defined(MOS_DUK_ENABLE_JSON_STRINGIFY_SINK) && (MOS_DUK_ENABLE_JSON_STRINGIFY_SINK != 0)
+/* JSON.stringifyTo() and duk_json_encode_sink(): output in chunks to a sink. */
+#define DUK_USE_JSON_STRINGIFY_SINK
+#endif
+
+#if defined(MOS_DUK_ENABLE_JSON_PARSER) && (MOS_DUK_ENABLE_JSON_PARSER != 0)
+/* JSON.Parser: parse input fed in chunks, building a value or emitting events. */
+#define DUK_USE_JSON_INCREMENTAL_PARSER
+#endif
+
+#if defined(MOS_DUK_ENABLE_CBOR_STREAMING) && (MOS_DUK_ENABLE_CBOR_STREAMING != 0)
+/* CBOR.encodeInto(), CBOR.decode() on buffer views and CBOR.Decoder for item sequences. */
+#define DUK_USE_CBOR_STREAMING
+#endif
+
+#if defined(MOS_DUK_ENABLE_BASE64_DECODE_TABLES) && (MOS_DUK_ENABLE_BASE64_DECODE_TABLES != 0)
+/* Pre-shifted base64 decode tables (about 2.5 kB) for a faster decode fast path. */
+#define DUK_USE_BASE64_DECODE_TABLES
+#endif
+
+#if defined(MOS_DUK_ENABLE_CODEC_DECODE_INTO) && (MOS_DUK_ENABLE_CODEC_DECODE_INTO != 0)
+/* duk_base64_decode_into(), duk_hex_decode_into() and Duktape.decInto(). */
+#define DUK_USE_CODEC_DECODE_INTO
+#endif
+
+#if defined(MOS_DUK_ENABLE_ENCODING_FASTPATH) && (MOS_DUK_ENABLE_ENCODING_FASTPATH != 0)
+/* TextDecoder/TextEncoder copy well-formed UTF-8 runs instead of going codepoint by codepoint. */
+#define DUK_USE_ENCODING_FASTPATH
+#endif
+
+#if defined(MOS_DUK_ENABLE_TEXTENCODER_ENCODE_INTO) && (MOS_DUK_ENABLE_TEXTENCODER_ENCODE_INTO != 0)
+/* TextEncoder.prototype.encodeInto(): encode into a caller supplied buffer. */
+#define DUK_USE_TEXTENCODER_ENCODE_INTO
+#endif
+
+#if defined(MOS_DUK_ENABLE_NUMCONV_STRINGIFY_FASTPATH) && (MOS_DUK_ENABLE_NUMCONV_STRINGIFY_FASTPATH != 0)
+/* Grisu3 for shortest number-to-string conversion, Dragon4 only as a fallback (~1 kB). */
+#define DUK_USE_NUMCONV_STRINGIFY_FASTPATH
+#endif
+
+#if defined(MOS_DUK_ENABLE_NUMCONV_PARSE_FASTPATH) && (MOS_DUK_ENABLE_NUMCONV_PARSE_FASTPATH != 0)
+/* Eisel-Lemire for decimal string-to-number conversion of up to 19 digits (~2 kB table). */
+#define DUK_USE_NUMCONV_PARSE_FASTPATH
+#endif
+
+#if defined(MOS_DUK_ENABLE_REGEXP_CACHE) && (MOS_DUK_ENABLE_REGEXP_CACHE != 0)
+/* Reuse compiled bytecode for repeated new RegExp(pattern, flags). */
+#define DUK_USE_REGEXP_CACHE
+#endif
+
+#if defined(MOS_DUK_ENABLE_REGEXP_PREFILTER) && (MOS_DUK_ENABLE_REGEXP_PREFILTER != 0)
+/* Skip input positions which can't start a match (first chars, literal prefix, '^'). */
+#define DUK_USE_REGEXP_PREFILTER
+#endif
+
+#if defined(MOS_DUK_ENABLE_STRING_SEARCH_FASTPATH) && (MOS_DUK_ENABLE_STRING_SEARCH_FASTPATH != 0)
+/* memchr()/Horspool substring search for indexOf(), includes(), split(), replace(). */
+#define DUK_USE_STRING_SEARCH_FASTPATH
+#endif
+
+#if defined(MOS_DUK_ENABLE_STRING_APPEND_INPLACE) && (MOS_DUK_ENABLE_STRING_APPEND_INPLACE != 0)
+/* 's += x' grows a uniquely referenced string in place. */
+#define DUK_USE_STRING_APPEND_INPLACE
+#endif
+
+#if defined(MOS_DUK_ENABLE_COMPILER_LOWMEM) && (MOS_DUK_ENABLE_COMPILER_LOWMEM != 0)
+/* Compiler state off the native stack, small initial bytecode buffers. */
+#define DUK_USE_COMPILER_LOWMEM
+#endif
+
+#if defined(MOS_DUK_ENABLE_COMPILER_STATS) && (MOS_DUK_ENABLE_COMPILER_STATS != 0)
+/* Peak heap and native stack per compilation (MOS.System.compileStats). */
+#define DUK_USE_COMPILER_STATS
+#endif
+
+#if defined(MOS_DUK_ENABLE_COMPILER_LAZY) && (MOS_DUK_ENABLE_COMPILER_LAZY != 0)
+/* Inner functions are pre-parsed at load, compiled on their first call. */
+#define DUK_USE_COMPILER_LAZY
+#endif
+
+#if (defined(DUK_USE_PROFILER_SAMPLING) || defined(DUK_USE_PROFILER_INSTRUMENT) || \
+     defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL) || defined(DUK_USE_MARK_AND_SWEEP_PAUSE_STATS) || \
+     defined(DUK_USE_COMPILER_STATS)) && \
+    defined(DUK_USE_DATE_NOW_TIME)
+/* Embedded targets fall back to time() which only has second resolution;
+ * profiler, GC and compile timings need mgos_uptime() instead (see
+ * mos_duk_utils.c).
+ */
+#if defined(DUK_COMPILING_DUKTAPE)
+extern double mos_duk_get_monotonic_time(void);
+#endif
+#define DUK_USE_GET_MONOTONIC_TIME(ctx)  mos_duk_get_monotonic_time()
+#endif
+
+#if defined(DUK_USE_COMPILER_STATS) && defined(MOS_DUK_ENABLE_COMPILER_STATS)
+/* Compile statistics track peak heap use through the platform's free
+ * heap counter.
+ */
+#if defined(DUK_COMPILING_DUKTAPE)
+extern size_t mgos_get_free_heap_size(void);
+#endif
+#define DUK_USE_GET_FREE_HEAP_SIZE(ctx)  mgos_get_free_heap_size()
+#endif
+
 /*
  *  Conditional includes
  */
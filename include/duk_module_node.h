@@ -7,7 +7,10 @@
 extern "C" {
 #endif
 
+/* [ ... source ] -> [ ... source module/error ] */
 extern duk_ret_t duk_module_node_peval_main(duk_context *ctx, const char *path);
+/* [ ... source ] -> [ ... module/error ], source can be freed once compiled */
+extern duk_ret_t duk_module_node_peval_main_consume(duk_context *ctx, const char *path);
 extern void duk_module_node_init(duk_context *ctx);
 
 #if defined(__cplusplus)
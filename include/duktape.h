@@ -252,6 +252,7 @@ typedef void (*duk_debug_read_flush_function) (void *udata);
 typedef void (*duk_debug_write_flush_function) (void *udata);
 typedef duk_idx_t (*duk_debug_request_function) (duk_context *ctx, void *udata, duk_idx_t nvalues);
 typedef void (*duk_debug_detached_function) (duk_context *ctx, void *udata);
+typedef void (*duk_json_sink_function) (void *udata, const char *buffer, duk_size_t length);
 
 struct duk_thread_state {
 	/* XXX: Enough space to hold internal suspend/resume structure.
@@ -525,6 +526,11 @@ DUK_EXTERNAL_DECL void duk_free(duk_context *ctx, void *ptr);
 DUK_EXTERNAL_DECL void *duk_realloc(duk_context *ctx, void *ptr, duk_size_t size);
 DUK_EXTERNAL_DECL void duk_get_memory_functions(duk_context *ctx, duk_memory_functions *out_funcs);
 DUK_EXTERNAL_DECL void duk_gc(duk_context *ctx, duk_uint_t flags);
+DUK_EXTERNAL_DECL duk_bool_t duk_gc_step(duk_context *ctx, duk_double_t budget_ms);
+DUK_EXTERNAL_DECL duk_bool_t duk_gc_idle(duk_context *ctx, duk_double_t budget_ms, duk_uint_t flags);
+DUK_EXTERNAL_DECL void duk_gc_inspect(duk_context *ctx);
+DUK_EXTERNAL_DECL void duk_ic_inspect(duk_context *ctx);
+DUK_EXTERNAL_DECL void duk_compile_inspect(duk_context *ctx);
 
 /*
  *  Error handling
@@ -1035,9 +1041,12 @@ DUK_EXTERNAL_DECL void duk_set_length(duk_context *ctx, duk_idx_t idx, duk_size_
 
 DUK_EXTERNAL_DECL const char *duk_base64_encode(duk_context *ctx, duk_idx_t idx);
 DUK_EXTERNAL_DECL void duk_base64_decode(duk_context *ctx, duk_idx_t idx);
+DUK_EXTERNAL_DECL duk_size_t duk_base64_decode_into(duk_context *ctx, duk_idx_t idx, void *buf, duk_size_t len);
 DUK_EXTERNAL_DECL const char *duk_hex_encode(duk_context *ctx, duk_idx_t idx);
 DUK_EXTERNAL_DECL void duk_hex_decode(duk_context *ctx, duk_idx_t idx);
+DUK_EXTERNAL_DECL duk_size_t duk_hex_decode_into(duk_context *ctx, duk_idx_t idx, void *buf, duk_size_t len);
 DUK_EXTERNAL_DECL const char *duk_json_encode(duk_context *ctx, duk_idx_t idx);
+DUK_EXTERNAL_DECL duk_size_t duk_json_encode_sink(duk_context *ctx, duk_idx_t idx, duk_json_sink_function sink, void *udata, duk_size_t chunk_size);
 DUK_EXTERNAL_DECL void duk_json_decode(duk_context *ctx, duk_idx_t idx);
 DUK_EXTERNAL_DECL void duk_cbor_encode(duk_context *ctx, duk_idx_t idx, duk_uint_t encode_flags);
 DUK_EXTERNAL_DECL void duk_cbor_decode(duk_context *ctx, duk_idx_t idx, duk_uint_t decode_flags);
@@ -1337,6 +1346,19 @@ DUK_EXTERNAL_DECL void duk_debugger_cooperate(duk_context *ctx);
 DUK_EXTERNAL_DECL duk_bool_t duk_debugger_notify(duk_context *ctx, duk_idx_t nvalues);
 DUK_EXTERNAL_DECL void duk_debugger_pause(duk_context *ctx);
 
+/*
+ *  Profiler (requires DUK_USE_PROFILER_SAMPLING and/or
+ *  DUK_USE_PROFILER_INSTRUMENT)
+ */
+
+DUK_EXTERNAL_DECL void duk_profiler_start(duk_context *ctx, duk_uint_t interval);
+DUK_EXTERNAL_DECL void duk_profiler_stop(duk_context *ctx);
+DUK_EXTERNAL_DECL void duk_profiler_reset(duk_context *ctx);
+DUK_EXTERNAL_DECL void duk_profiler_push_folded(duk_context *ctx);
+DUK_EXTERNAL_DECL void duk_profiler_inspect(duk_context *ctx);
+DUK_EXTERNAL_DECL void duk_profiler_instrument(duk_context *ctx, duk_bool_t enable);
+DUK_EXTERNAL_DECL void duk_profiler_push_report(duk_context *ctx);
+
 /*
  *  Time handling
  */
@@ -9,11 +9,21 @@
 extern "C" {
 #endif /* __cplusplus */
 
+#include <stdbool.h>
+
 #include "duktape.h"
 
 /* Return global duktape instance. */
 duk_context* mgos_duk_get_global(void);
 
+/*
+ * Run garbage collection from the main loop while no JS callbacks are
+ * pending, spending at most `budget_ms` per poll (a full collection when
+ * `compact` is set or without incremental GC). Allocation triggered
+ * collections are postponed as long as idle ones keep up. 0 disables.
+ */
+void mgos_duk_gc_on_idle(double budget_ms, bool compact);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -227,11 +227,18 @@ static duk_int_t duk__eval_module_source(duk_context *ctx) {
 
 	/* [ ... module source func_src ] */
 
-	(void) duk_get_prop_string(ctx, -3, "filename");
+	/* Drop the unwrapped source so only one copy of the module text is
+	 * alive while compiling.
+	 */
+	duk_remove(ctx, -2);
+
+	/* [ ... module func_src ] */
+
+	(void) duk_get_prop_string(ctx, -2, "filename");
 	duk_compile(ctx, DUK_COMPILE_EVAL);
 	duk_call(ctx, 0);
 
-	/* [ ... module source func ] */
+	/* [ ... module func ] */
 
 	/* Set name for the wrapper function. */
 	duk_push_string(ctx, "name");
@@ -239,22 +246,22 @@ static duk_int_t duk__eval_module_source(duk_context *ctx) {
 	duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_FORCE);
 
 	/* call the function wrapper */
-	(void) duk_get_prop_string(ctx, -3, "exports");   /* exports */
-	(void) duk_get_prop_string(ctx, -4, "require");   /* require */
-	duk_dup(ctx, -5);                                 /* module */
-	(void) duk_get_prop_string(ctx, -6, "filename");  /* __filename */
+	(void) duk_get_prop_string(ctx, -2, "exports");   /* exports */
+	(void) duk_get_prop_string(ctx, -3, "require");   /* require */
+	duk_dup(ctx, -4);                                 /* module */
+	(void) duk_get_prop_string(ctx, -5, "filename");  /* __filename */
 	duk_push_undefined(ctx);                          /* __dirname */
 	duk_call(ctx, 5);
 
-	/* [ ... module source result(ignore) ] */
+	/* [ ... module result(ignore) ] */
 
 	/* module.loaded = true */
 	duk_push_true(ctx);
-	duk_put_prop_string(ctx, -4, "loaded");
+	duk_put_prop_string(ctx, -3, "loaded");
 
-	/* [ ... module source retval ] */
+	/* [ ... module retval ] */
 
-	duk_pop_2(ctx);
+	duk_pop(ctx);
 
 	/* [ ... module ] */
 
@@ -264,13 +271,13 @@ static duk_int_t duk__eval_module_source(duk_context *ctx) {
 /* Load a module as the 'main' module. */
 duk_ret_t duk_module_node_peval_main(duk_context *ctx, const char *path) {
 	/*
-	 *  Stack: [ ... source ]
+	 *  Stack: [ ... source ] -> [ ... source module/error ]
 	 */
 
 	duk__push_module_object(ctx, path, 1 /*main*/);
 	/* [ ... source module ] */
 
-	duk_dup(ctx, 0);
+	duk_dup(ctx, -2);
 	/* [ ... source module source ] */
 
 #if DUK_VERSION >= 19999
@@ -280,6 +287,27 @@ duk_ret_t duk_module_node_peval_main(duk_context *ctx, const char *path) {
 #endif
 }
 
+/* Same as duk_module_node_peval_main() but the source is consumed so that
+ * it can be freed as soon as it has been compiled.
+ */
+duk_ret_t duk_module_node_peval_main_consume(duk_context *ctx, const char *path) {
+	/*
+	 *  Stack: [ ... source ] -> [ ... module/error ]
+	 */
+
+	duk__push_module_object(ctx, path, 1 /*main*/);
+	/* [ ... source module ] */
+
+	duk_insert(ctx, -2);
+	/* [ ... module source ] */
+
+#if DUK_VERSION >= 19999
+	return duk_safe_call(ctx, duk__eval_module_source, NULL, 2, 1);
+#else
+	return duk_safe_call(ctx, duk__eval_module_source, 2, 1);
+#endif
+}
+
 void duk_module_node_init(duk_context *ctx) {
 	/*
 	 *  Stack: [ ... options ] => [ ... ]
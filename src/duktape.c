@@ -789,6 +789,7 @@ struct duk_hbuffer_external;
 struct duk_propaccessor;
 union duk_propvalue;
 struct duk_propdesc;
+struct duk_propshape;
 
 struct duk_heap;
 struct duk_breakpoint;
@@ -797,8 +798,12 @@ struct duk_activation;
 struct duk_catcher;
 struct duk_ljstate;
 struct duk_strcache_entry;
+struct duk_strcache_index;
 struct duk_litcache_entry;
+struct duk_propic_entry;
+struct duk_re_cache_entry;
 struct duk_strtab_entry;
+struct duk_prof_entry;
 
 #if defined(DUK_USE_DEBUG)
 struct duk_fixedbuffer;
@@ -850,6 +855,7 @@ typedef struct duk_hbuffer_external duk_hbuffer_external;
 typedef struct duk_propaccessor duk_propaccessor;
 typedef union duk_propvalue duk_propvalue;
 typedef struct duk_propdesc duk_propdesc;
+typedef struct duk_propshape duk_propshape;
 
 typedef struct duk_heap duk_heap;
 typedef struct duk_breakpoint duk_breakpoint;
@@ -858,8 +864,13 @@ typedef struct duk_activation duk_activation;
 typedef struct duk_catcher duk_catcher;
 typedef struct duk_ljstate duk_ljstate;
 typedef struct duk_strcache_entry duk_strcache_entry;
+typedef struct duk_strcache_index duk_strcache_index;
 typedef struct duk_litcache_entry duk_litcache_entry;
+typedef struct duk_propic_entry duk_propic_entry;
+typedef struct duk_re_cache_entry duk_re_cache_entry;
 typedef struct duk_strtab_entry duk_strtab_entry;
+typedef struct duk_prof_entry duk_prof_entry;
+typedef struct duk_strhash_state duk_strhash_state;
 
 #if defined(DUK_USE_DEBUG)
 typedef struct duk_fixedbuffer duk_fixedbuffer;
@@ -2197,6 +2208,10 @@ DUK_INTERNAL_DECL duk_ret_t duk_bi_duktape_object_gc(duk_context *ctx);
 DUK_INTERNAL_DECL duk_ret_t duk_bi_duktape_object_fin(duk_context *ctx);
 DUK_INTERNAL_DECL duk_ret_t duk_bi_duktape_object_enc(duk_context *ctx);
 DUK_INTERNAL_DECL duk_ret_t duk_bi_duktape_object_dec(duk_context *ctx);
+#if defined(DUK_USE_CODEC_DECODE_INTO)
+/* Duktape.decInto(), added by duk_hthread_create_builtin_objects(). */
+DUK_INTERNAL_DECL duk_ret_t duk_bi_duktape_object_dec_into(duk_context *ctx);
+#endif
 DUK_INTERNAL_DECL duk_ret_t duk_bi_duktape_object_compact(duk_context *ctx);
 DUK_INTERNAL_DECL duk_ret_t duk_bi_thread_yield(duk_context *ctx);
 DUK_INTERNAL_DECL duk_ret_t duk_bi_thread_resume(duk_context *ctx);
@@ -2235,6 +2250,10 @@ DUK_INTERNAL_DECL duk_ret_t duk_bi_cbor_encode(duk_context *ctx);
 DUK_INTERNAL_DECL duk_ret_t duk_bi_cbor_decode(duk_context *ctx);
 DUK_INTERNAL_DECL duk_ret_t duk_bi_textencoder_prototype_encoding_getter(duk_context *ctx);
 DUK_INTERNAL_DECL duk_ret_t duk_bi_textencoder_prototype_encode(duk_context *ctx);
+#if defined(DUK_USE_TEXTENCODER_ENCODE_INTO)
+/* TextEncoder.prototype.encodeInto(), added by duk_hthread_create_builtin_objects(). */
+DUK_INTERNAL_DECL duk_ret_t duk_bi_textencoder_prototype_encode_into(duk_context *ctx);
+#endif
 DUK_INTERNAL_DECL duk_ret_t duk_bi_textdecoder_prototype_shared_getter(duk_context *ctx);
 DUK_INTERNAL_DECL duk_ret_t duk_bi_textdecoder_prototype_decode(duk_context *ctx);
 DUK_INTERNAL_DECL duk_ret_t duk_bi_performance_now(duk_context *ctx);
@@ -4331,6 +4350,10 @@ struct duk_compiler_func {
 	duk_uint8_t needs_shuffle;           /* function needs shuffle registers */
 	duk_uint8_t reject_regexp_in_adv;    /* reject RegExp literal on next advance() call; needed for handling IdentifierName productions */
 	duk_uint8_t allow_regexp_in_adv;     /* allow RegExp literal on next advance() call */
+#if defined(DUK_USE_COMPILER_LAZY)
+	duk_uint8_t is_lazy;                 /* pre-parsed only, bytecode is generated on first call */
+	duk_uint8_t in_lazy;                 /* outer function is pre-parsed too, no template is needed */
+#endif
 };
 
 struct duk_compiler_ctx {
@@ -4359,6 +4382,27 @@ struct duk_compiler_ctx {
 
 	/* current function being compiled (embedded instead of pointer for more compact access) */
 	duk_compiler_func curr_func;
+
+#if defined(DUK_USE_COMPILER_LAZY)
+	/* Source string that deferred inner functions are compiled from
+	 * later, NULL if the source is not a heap string (nothing deferred).
+	 */
+	duk_hstring *h_source;              /* borrowed reference */
+	duk_bool_t lazy_eager_next;         /* next function is a parenthesized expression, compile it now */
+#endif
+
+#if defined(DUK_USE_COMPILER_STATS)
+	/* Native stack and heap high water marks of this compilation, see
+	 * duk__comp_stats_sample().
+	 */
+	duk_uintptr_t stats_stack_base;     /* address of a local in duk_js_compile() */
+	duk_size_t stats_stack_max;
+#if defined(DUK_USE_GET_FREE_HEAP_SIZE)
+	duk_size_t stats_heap_base;         /* free heap on entry */
+	duk_size_t stats_heap_min;          /* lowest free heap seen */
+#endif
+	duk_uint32_t stats_funcs;           /* function templates created */
+#endif
 };
 
 /*
@@ -4366,6 +4410,9 @@ struct duk_compiler_ctx {
  */
 
 DUK_INTERNAL_DECL void duk_js_compile(duk_hthread *thr, const duk_uint8_t *src_buffer, duk_size_t src_length, duk_small_uint_t flags);
+#if defined(DUK_USE_COMPILER_LAZY)
+DUK_INTERNAL_DECL void duk_js_compile_lazy(duk_hthread *thr, duk_hcompfunc *func);
+#endif
 
 #endif  /* DUK_JS_COMPILER_H_INCLUDED */
 /* #include duk_regexp.h */
@@ -4410,6 +4457,15 @@ DUK_INTERNAL_DECL void duk_js_compile(duk_hthread *thr, const duk_uint8_t *src_b
 #define DUK_RE_FLAG_GLOBAL                 (1U << 0)
 #define DUK_RE_FLAG_IGNORE_CASE            (1U << 1)
 #define DUK_RE_FLAG_MULTILINE              (1U << 2)
+#define DUK_RE_FLAG_PREFILTER              (1U << 3)  /* internal: bytecode header has prefilter info */
+
+/* prefilter info flags (DUK_USE_REGEXP_PREFILTER) */
+#define DUK_RE_PF_FIRST                    (1U << 0)  /* ASCII first character set present */
+#define DUK_RE_PF_FIRST_NONASCII           (1U << 1)  /* match may also start with a non-ASCII char */
+#define DUK_RE_PF_ANCHORED                 (1U << 2)  /* match only possible at input start */
+
+/* maximum literal prefix length recorded for the prefilter */
+#define DUK_RE_PF_MAX_PREFIX               16
 
 struct duk_re_matcher_ctx {
 	duk_hthread *thr;
@@ -4569,6 +4625,7 @@ struct duk_heaphdr_string {
 
 #define DUK_HEAPHDR_FLAGS_TYPE_MASK      0x00000003UL
 #define DUK_HEAPHDR_FLAGS_FLAG_MASK      (~DUK_HEAPHDR_FLAGS_TYPE_MASK)
+#define DUK_HEAPHDR_FLAGS_HEAP_MASK      (((1UL << DUK_HEAPHDR_FLAGS_USER_START) - 1UL) & DUK_HEAPHDR_FLAGS_FLAG_MASK)
 
                                              /* 2 bits for heap type */
 #define DUK_HEAPHDR_FLAGS_HEAP_START     2   /* 5 heap flags */
@@ -4762,6 +4819,28 @@ DUK_INTERNAL_DECL void duk_heaphdr_assert_valid(duk_heaphdr *h);
 #if !defined(DUK_REFCOUNT_H_INCLUDED)
 #define DUK_REFCOUNT_H_INCLUDED
 
+/* Write barrier for incremental mark-and-sweep: a DECREF which leaves the
+ * target alive shades it so that everything reachable when the marking
+ * cycle started stays marked.  A target whose refcount drops to zero is
+ * unreachable and needs no shading.
+ */
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+#define DUK_HEAPHDR_MS_BARRIER(heap,h) do { \
+		if (DUK_UNLIKELY((heap)->ms_incremental != 0)) { \
+			duk_heap_mark_shade((heap), (duk_heaphdr *) (h)); \
+		} \
+	} while (0)
+/* Heap elements allocated during a marking cycle are born marked. */
+#define DUK_HEAPHDR_MS_NEW(heap,h) do { \
+		if (DUK_UNLIKELY((heap)->ms_incremental != 0)) { \
+			DUK_HEAPHDR_SET_REACHABLE((duk_heaphdr *) (h)); \
+		} \
+	} while (0)
+#else
+#define DUK_HEAPHDR_MS_BARRIER(heap,h) do {} while (0)
+#define DUK_HEAPHDR_MS_NEW(heap,h) do {} while (0)
+#endif
+
 #if defined(DUK_USE_REFERENCE_COUNTING)
 
 #if defined(DUK_USE_ROM_OBJECTS)
@@ -4804,6 +4883,8 @@ DUK_INTERNAL_DECL void duk_heaphdr_assert_valid(duk_heaphdr *h);
 			DUK_ASSERT(DUK_HEAPHDR_GET_REFCOUNT(duk__h) > 0); \
 			if (DUK_HEAPHDR_PREDEC_REFCOUNT(duk__h) == 0) { \
 				duk_heaphdr_refzero((thr), duk__h); \
+			} else { \
+				DUK_HEAPHDR_MS_BARRIER((thr)->heap, duk__h); \
 			} \
 		} \
 	} while (0)
@@ -4817,6 +4898,8 @@ DUK_INTERNAL_DECL void duk_heaphdr_assert_valid(duk_heaphdr *h);
 			DUK_ASSERT(DUK_HEAPHDR_GET_REFCOUNT(duk__h) > 0); \
 			if (DUK_HEAPHDR_PREDEC_REFCOUNT(duk__h) == 0) { \
 				duk_heaphdr_refzero_norz((thr), duk__h); \
+			} else { \
+				DUK_HEAPHDR_MS_BARRIER((thr)->heap, duk__h); \
 			} \
 		} \
 	} while (0)
@@ -4837,6 +4920,8 @@ DUK_INTERNAL_DECL void duk_heaphdr_assert_valid(duk_heaphdr *h);
 		if (DUK_HEAPHDR_NEEDS_REFCOUNT_UPDATE(duk__h)) { \
 			if (DUK_HEAPHDR_PREDEC_REFCOUNT(duk__h) == 0) { \
 				(rzcall)((thr), (rzcast) duk__h); \
+			} else { \
+				DUK_HEAPHDR_MS_BARRIER((thr)->heap, duk__h); \
 			} \
 		} \
 	} while (0)
@@ -6481,16 +6566,16 @@ DUK_INTERNAL_DECL void duk_hobject_assert_valid(duk_hobject *h);
 
 #if defined(DUK_USE_HOBJECT_LAYOUT_1)
 /* LAYOUT 1 */
-#define DUK_HOBJECT_E_GET_KEY_BASE(heap,h) \
+#define DUK_HOBJECT_E_GET_KEY_BASE_DICT(heap,h) \
 	((duk_hstring **) (void *) ( \
 		DUK_HOBJECT_GET_PROPS((heap), (h)) \
 	))
-#define DUK_HOBJECT_E_GET_VALUE_BASE(heap,h) \
+#define DUK_HOBJECT_E_GET_VALUE_BASE_DICT(heap,h) \
 	((duk_propvalue *) (void *) ( \
 		DUK_HOBJECT_GET_PROPS((heap), (h)) + \
 			DUK_HOBJECT_GET_ESIZE((h)) * sizeof(duk_hstring *) \
 	))
-#define DUK_HOBJECT_E_GET_FLAGS_BASE(heap,h) \
+#define DUK_HOBJECT_E_GET_FLAGS_BASE_DICT(heap,h) \
 	((duk_uint8_t *) (void *) ( \
 		DUK_HOBJECT_GET_PROPS((heap), (h)) + DUK_HOBJECT_GET_ESIZE((h)) * (sizeof(duk_hstring *) + sizeof(duk_propvalue)) \
 	))
@@ -6499,7 +6584,7 @@ DUK_INTERNAL_DECL void duk_hobject_assert_valid(duk_hobject *h);
 		DUK_HOBJECT_GET_PROPS((heap), (h)) + \
 			DUK_HOBJECT_GET_ESIZE((h)) * (sizeof(duk_hstring *) + sizeof(duk_propvalue) + sizeof(duk_uint8_t)) \
 	))
-#define DUK_HOBJECT_H_GET_BASE(heap,h) \
+#define DUK_HOBJECT_H_GET_BASE_DICT(heap,h) \
 	((duk_uint32_t *) (void *) ( \
 		DUK_HOBJECT_GET_PROPS((heap), (h)) + \
 			DUK_HOBJECT_GET_ESIZE((h)) * (sizeof(duk_hstring *) + sizeof(duk_propvalue) + sizeof(duk_uint8_t)) + \
@@ -6529,16 +6614,16 @@ DUK_INTERNAL_DECL void duk_hobject_assert_valid(duk_hobject *h);
 #else
 #error invalid DUK_USE_ALIGN_BY
 #endif
-#define DUK_HOBJECT_E_GET_KEY_BASE(heap,h) \
+#define DUK_HOBJECT_E_GET_KEY_BASE_DICT(heap,h) \
 	((duk_hstring **) (void *) ( \
 		DUK_HOBJECT_GET_PROPS((heap), (h)) + \
 			DUK_HOBJECT_GET_ESIZE((h)) * sizeof(duk_propvalue) \
 	))
-#define DUK_HOBJECT_E_GET_VALUE_BASE(heap,h) \
+#define DUK_HOBJECT_E_GET_VALUE_BASE_DICT(heap,h) \
 	((duk_propvalue *) (void *) ( \
 		DUK_HOBJECT_GET_PROPS((heap), (h)) \
 	))
-#define DUK_HOBJECT_E_GET_FLAGS_BASE(heap,h) \
+#define DUK_HOBJECT_E_GET_FLAGS_BASE_DICT(heap,h) \
 	((duk_uint8_t *) (void *) ( \
 		DUK_HOBJECT_GET_PROPS((heap), (h)) + DUK_HOBJECT_GET_ESIZE((h)) * (sizeof(duk_hstring *) + sizeof(duk_propvalue)) \
 	))
@@ -6548,7 +6633,7 @@ DUK_INTERNAL_DECL void duk_hobject_assert_valid(duk_hobject *h);
 			DUK_HOBJECT_GET_ESIZE((h)) * (sizeof(duk_hstring *) + sizeof(duk_propvalue) + sizeof(duk_uint8_t)) + \
 			DUK_HOBJECT_E_FLAG_PADDING(DUK_HOBJECT_GET_ESIZE((h))) \
 	))
-#define DUK_HOBJECT_H_GET_BASE(heap,h) \
+#define DUK_HOBJECT_H_GET_BASE_DICT(heap,h) \
 	((duk_uint32_t *) (void *) ( \
 		DUK_HOBJECT_GET_PROPS((heap), (h)) + \
 			DUK_HOBJECT_GET_ESIZE((h)) * (sizeof(duk_hstring *) + sizeof(duk_propvalue) + sizeof(duk_uint8_t)) + \
@@ -6573,17 +6658,17 @@ DUK_INTERNAL_DECL void duk_hobject_assert_valid(duk_hobject *h);
 	} while (0)
 #elif defined(DUK_USE_HOBJECT_LAYOUT_3)
 /* LAYOUT 3 */
-#define DUK_HOBJECT_E_GET_KEY_BASE(heap,h) \
+#define DUK_HOBJECT_E_GET_KEY_BASE_DICT(heap,h) \
 	((duk_hstring **) (void *) ( \
 		DUK_HOBJECT_GET_PROPS((heap), (h)) + \
 			DUK_HOBJECT_GET_ESIZE((h)) * sizeof(duk_propvalue) + \
 			DUK_HOBJECT_GET_ASIZE((h)) * sizeof(duk_tval) \
 	))
-#define DUK_HOBJECT_E_GET_VALUE_BASE(heap,h) \
+#define DUK_HOBJECT_E_GET_VALUE_BASE_DICT(heap,h) \
 	((duk_propvalue *) (void *) ( \
 		DUK_HOBJECT_GET_PROPS((heap), (h)) \
 	))
-#define DUK_HOBJECT_E_GET_FLAGS_BASE(heap,h) \
+#define DUK_HOBJECT_E_GET_FLAGS_BASE_DICT(heap,h) \
 	((duk_uint8_t *) (void *) ( \
 		DUK_HOBJECT_GET_PROPS((heap), (h)) + \
 			DUK_HOBJECT_GET_ESIZE((h)) * (sizeof(duk_propvalue) + sizeof(duk_hstring *)) + \
@@ -6595,7 +6680,7 @@ DUK_INTERNAL_DECL void duk_hobject_assert_valid(duk_hobject *h);
 		DUK_HOBJECT_GET_PROPS((heap), (h)) + \
 			DUK_HOBJECT_GET_ESIZE((h)) * sizeof(duk_propvalue) \
 	))
-#define DUK_HOBJECT_H_GET_BASE(heap,h) \
+#define DUK_HOBJECT_H_GET_BASE_DICT(heap,h) \
 	((duk_uint32_t *) (void *) ( \
 		DUK_HOBJECT_GET_PROPS((heap), (h)) + \
 			DUK_HOBJECT_GET_ESIZE((h)) * (sizeof(duk_propvalue) + sizeof(duk_hstring *)) + \
@@ -6618,8 +6703,45 @@ DUK_INTERNAL_DECL void duk_hobject_assert_valid(duk_hobject *h);
 #error invalid hobject layout defines
 #endif  /* hobject property layout */
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+/* An object sharing a shape keeps only its entry values in 'props' (with
+ * e_size == e_next and no array part); keys, flags and the hash part are
+ * read from the shape.  Any write to them must first go back to the
+ * dictionary layout using DUK_HOBJECT_UNSHAPE().
+ */
+#define DUK_HOBJECT_HAS_SHAPE(h)  DUK_UNLIKELY((h)->shape != NULL)  /* keep dictionary accesses fast */
+#define DUK_HOBJECT_E_GET_KEY_BASE(heap,h) \
+	(DUK_HOBJECT_HAS_SHAPE((h)) ? DUK_PROPSHAPE_GET_KEYS((h)->shape) : DUK_HOBJECT_E_GET_KEY_BASE_DICT((heap), (h)))
+#if defined(DUK_USE_HOBJECT_LAYOUT_1)
+#define DUK_HOBJECT_E_GET_VALUE_BASE(heap,h) \
+	(DUK_HOBJECT_HAS_SHAPE((h)) ? (duk_propvalue *) (void *) DUK_HOBJECT_GET_PROPS((heap), (h)) : DUK_HOBJECT_E_GET_VALUE_BASE_DICT((heap), (h)))
+#else
+/* Layouts 2 and 3 start with the values, same as a shaped object. */
+#define DUK_HOBJECT_E_GET_VALUE_BASE(heap,h)  DUK_HOBJECT_E_GET_VALUE_BASE_DICT((heap), (h))
+#endif
+#define DUK_HOBJECT_E_GET_FLAGS_BASE(heap,h) \
+	(DUK_HOBJECT_HAS_SHAPE((h)) ? DUK_PROPSHAPE_GET_FLAGS((h)->shape) : DUK_HOBJECT_E_GET_FLAGS_BASE_DICT((heap), (h)))
+#define DUK_HOBJECT_H_GET_BASE(heap,h) \
+	(DUK_HOBJECT_HAS_SHAPE((h)) ? DUK_PROPSHAPE_GET_HASH((h)->shape) : DUK_HOBJECT_H_GET_BASE_DICT((heap), (h)))
+#define DUK_HOBJECT_P_ALLOC_SIZE(h) \
+	(DUK_HOBJECT_HAS_SHAPE((h)) ? \
+		DUK_HOBJECT_GET_ESIZE((h)) * sizeof(duk_propvalue) : \
+		DUK_HOBJECT_P_COMPUTE_SIZE(DUK_HOBJECT_GET_ESIZE((h)), DUK_HOBJECT_GET_ASIZE((h)), DUK_HOBJECT_GET_HSIZE((h))))
+#define DUK_HOBJECT_UNSHAPE(thr,h)  do { \
+		if (DUK_HOBJECT_HAS_SHAPE((h))) { \
+			duk_hobject_unshape_props((thr), (h)); \
+		} \
+	} while (0)
+#else  /* DUK_USE_HOBJECT_SHAPES */
+#define DUK_HOBJECT_HAS_SHAPE(h)  0
+#define DUK_HOBJECT_E_GET_KEY_BASE(heap,h)    DUK_HOBJECT_E_GET_KEY_BASE_DICT((heap), (h))
+#define DUK_HOBJECT_E_GET_VALUE_BASE(heap,h)  DUK_HOBJECT_E_GET_VALUE_BASE_DICT((heap), (h))
+#define DUK_HOBJECT_E_GET_FLAGS_BASE(heap,h)  DUK_HOBJECT_E_GET_FLAGS_BASE_DICT((heap), (h))
+#define DUK_HOBJECT_H_GET_BASE(heap,h)        DUK_HOBJECT_H_GET_BASE_DICT((heap), (h))
 #define DUK_HOBJECT_P_ALLOC_SIZE(h) \
 	DUK_HOBJECT_P_COMPUTE_SIZE(DUK_HOBJECT_GET_ESIZE((h)), DUK_HOBJECT_GET_ASIZE((h)), DUK_HOBJECT_GET_HSIZE((h)))
+#define DUK_HOBJECT_UNSHAPE(thr,h)  do {} while (0)
+#endif  /* DUK_USE_HOBJECT_SHAPES */
 
 #define DUK_HOBJECT_E_GET_KEY(heap,h,i)              (DUK_HOBJECT_E_GET_KEY_BASE((heap), (h))[(i)])
 #define DUK_HOBJECT_E_GET_KEY_PTR(heap,h,i)          (&DUK_HOBJECT_E_GET_KEY_BASE((heap), (h))[(i)])
@@ -6639,6 +6761,7 @@ DUK_INTERNAL_DECL void duk_hobject_assert_valid(duk_hobject *h);
 #define DUK_HOBJECT_H_GET_INDEX_PTR(heap,h,i)        (&DUK_HOBJECT_H_GET_BASE((heap), (h))[(i)])
 
 #define DUK_HOBJECT_E_SET_KEY(heap,h,i,k)  do { \
+		DUK_ASSERT(!DUK_HOBJECT_HAS_SHAPE((h))); \
 		DUK_HOBJECT_E_GET_KEY((heap), (h), (i)) = (k); \
 	} while (0)
 #define DUK_HOBJECT_E_SET_VALUE(heap,h,i,v)  do { \
@@ -6654,6 +6777,7 @@ DUK_INTERNAL_DECL void duk_hobject_assert_valid(duk_hobject *h);
 		DUK_HOBJECT_E_GET_VALUE((heap), (h), (i)).a.set = (v); \
 	} while (0)
 #define DUK_HOBJECT_E_SET_FLAGS(heap,h,i,f)  do { \
+		DUK_ASSERT(!DUK_HOBJECT_HAS_SHAPE((h))); \
 		DUK_HOBJECT_E_GET_FLAGS((heap), (h), (i)) = (duk_uint8_t) (f); \
 	} while (0)
 #define DUK_HOBJECT_A_SET_VALUE(heap,h,i,v)  do { \
@@ -6662,14 +6786,17 @@ DUK_INTERNAL_DECL void duk_hobject_assert_valid(duk_hobject *h);
 #define DUK_HOBJECT_A_SET_VALUE_TVAL(heap,h,i,v) \
 	DUK_HOBJECT_A_SET_VALUE((heap), (h), (i), (v))  /* alias for above */
 #define DUK_HOBJECT_H_SET_INDEX(heap,h,i,v)  do { \
+		DUK_ASSERT(!DUK_HOBJECT_HAS_SHAPE((h))); \
 		DUK_HOBJECT_H_GET_INDEX((heap), (h), (i)) = (v); \
 	} while (0)
 
 #define DUK_HOBJECT_E_SET_FLAG_BITS(heap,h,i,mask)  do { \
+		DUK_ASSERT(!DUK_HOBJECT_HAS_SHAPE((h))); \
 		DUK_HOBJECT_E_GET_FLAGS_BASE((heap), (h))[(i)] |= (mask); \
 	} while (0)
 
 #define DUK_HOBJECT_E_CLEAR_FLAG_BITS(heap,h,i,mask)  do { \
+		DUK_ASSERT(!DUK_HOBJECT_HAS_SHAPE((h))); \
 		DUK_HOBJECT_E_GET_FLAGS_BASE((heap), (h))[(i)] &= ~(mask); \
 	} while (0)
 
@@ -6864,6 +6991,36 @@ struct duk_propdesc {
 	duk_int_t a_idx;  /* prop index in 'array part', < 0 if not there */
 };
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+/* Shared object shape: the key, flags and hash parts of objects with the
+ * same properties (same keys and attributes in the same order).  Not a heap
+ * object; reference counted by the objects using it and kept in a heap
+ * hash table (heap->shapetab) for lookup.  The shape owns one reference to
+ * each key.
+ */
+struct duk_propshape {
+	duk_propshape *next;    /* heap->shapetab chain */
+	duk_uint32_t refcount;  /* number of objects using the shape */
+	duk_uint32_t hash;      /* hash of keys and flags */
+	duk_uint32_t e_size;    /* number of entries, also e_size and e_next of objects */
+	duk_uint32_t h_size;    /* hash part size, 0 if none */
+
+	/* Followed by:
+	 *   e_size * sizeof(duk_hstring *)  keys
+	 *   h_size * sizeof(duk_uint32_t)   hash part, as in duk_hobject 'props'
+	 *   e_size * sizeof(duk_uint8_t)    flags
+	 */
+};
+
+#define DUK_PROPSHAPE_GET_KEYS(s)    ((duk_hstring **) (void *) ((s) + 1))
+#define DUK_PROPSHAPE_GET_HASH(s)    ((duk_uint32_t *) (void *) (DUK_PROPSHAPE_GET_KEYS((s)) + (s)->e_size))
+#define DUK_PROPSHAPE_GET_FLAGS(s)   ((duk_uint8_t *) (void *) (DUK_PROPSHAPE_GET_HASH((s)) + (s)->h_size))
+#define DUK_PROPSHAPE_ALLOC_SIZE(e_size,h_size) \
+	(sizeof(duk_propshape) + \
+	 (e_size) * (sizeof(duk_hstring *) + sizeof(duk_uint8_t)) + \
+	 (h_size) * sizeof(duk_uint32_t))
+#endif  /* DUK_USE_HOBJECT_SHAPES */
+
 struct duk_hobject {
 	duk_heaphdr hdr;
 
@@ -6963,6 +7120,13 @@ struct duk_hobject {
 	duk_uint32_t h_size;  /* hash part size or 0 if unused */
 #endif
 #endif
+
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	/* Shared keys, flags and hash part; NULL when the object owns them
+	 * (dictionary layout).
+	 */
+	duk_propshape *shape;
+#endif
 };
 
 /*
@@ -7020,6 +7184,10 @@ DUK_INTERNAL_DECL duk_bool_t duk_hobject_get_own_propdesc(duk_hthread *thr, duk_
 /* core property functions */
 DUK_INTERNAL_DECL duk_bool_t duk_hobject_getprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key);
 DUK_INTERNAL_DECL duk_bool_t duk_hobject_putprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, duk_tval *tv_val, duk_bool_t throw_flag);
+#if defined(DUK_USE_PROPERTY_IC)
+DUK_INTERNAL_DECL void duk_hobject_getprop_ic(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, const duk_instr_t *pc);
+DUK_INTERNAL_DECL void duk_hobject_putprop_ic(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, duk_tval *tv_val, duk_bool_t throw_flag, const duk_instr_t *pc);
+#endif
 DUK_INTERNAL_DECL duk_bool_t duk_hobject_delprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, duk_bool_t throw_flag);
 DUK_INTERNAL_DECL duk_bool_t duk_hobject_hasprop(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key);
 
@@ -7067,6 +7235,11 @@ DUK_INTERNAL_DECL duk_hobject *duk_hobject_get_varmap(duk_hthread *thr, duk_hobj
 
 /* hobject management functions */
 DUK_INTERNAL_DECL void duk_hobject_compact_props(duk_hthread *thr, duk_hobject *obj);
+#if defined(DUK_USE_HOBJECT_SHAPES)
+DUK_INTERNAL_DECL duk_bool_t duk_hobject_shape_props(duk_heap *heap, duk_hobject *obj);
+DUK_INTERNAL_DECL void duk_hobject_unshape_props(duk_hthread *thr, duk_hobject *obj);
+DUK_INTERNAL_DECL void duk_propshape_decref(duk_heap *heap, duk_propshape *shape, duk_bool_t decref_keys);
+#endif
 
 /* ES2015 proxy */
 #if defined(DUK_USE_ES6_PROXY)
@@ -7086,6 +7259,7 @@ DUK_INTERNAL_DECL void duk_hobject_set_prototype_updref(duk_hthread *thr, duk_ho
 #if defined(DUK_USE_PC2LINE)
 DUK_INTERNAL_DECL void duk_hobject_pc2line_pack(duk_hthread *thr, duk_compiler_instr *instrs, duk_uint_fast32_t length);
 DUK_INTERNAL_DECL duk_uint_fast32_t duk_hobject_pc2line_query(duk_hthread *thr, duk_idx_t idx_func, duk_uint_fast32_t pc);
+DUK_INTERNAL_DECL duk_uint_fast32_t duk_hobject_pc2line_query_func(duk_hthread *thr, duk_hobject *func, duk_uint_fast32_t pc);
 #endif
 
 /* misc */
@@ -7230,6 +7404,15 @@ DUK_INTERNAL_DECL duk_ret_t duk_bi_function_prototype(duk_hthread *thr);
 #define DUK_HCOMPFUNC_GET_CODE_COUNT(heap,h)  \
 	((duk_size_t) (DUK_HCOMPFUNC_GET_CODE_SIZE((heap), (h)) / sizeof(duk_instr_t)))
 
+#if defined(DUK_USE_COMPILER_LAZY)
+/* An inner function whose compilation was deferred has no bytecode until
+ * duk_js_compile_lazy() provides it on the first call; every compiled
+ * function has at least a final RETURN.
+ */
+#define DUK_HCOMPFUNC_IS_LAZY(heap,h)  \
+	(DUK_HCOMPFUNC_GET_BYTECODE((heap), (h)) == DUK_HCOMPFUNC_GET_CODE_END((heap), (h)))
+#endif
+
 /*
  *  Validity assert
  */
@@ -7327,6 +7510,9 @@ struct duk_hcompfunc {
 
 	duk_uint16_t nregs;                /* regs to allocate */
 	duk_uint16_t nargs;                /* number of arguments allocated to regs */
+#if defined(DUK_USE_STRING_APPEND_INPLACE)
+	duk_uint16_t temp_first;           /* first temporary register, 0 = unknown */
+#endif
 
 	/*
 	 *  Additional control information is placed into the object itself
@@ -7371,6 +7557,7 @@ struct duk_hcompfunc {
 	duk_uint32_t start_line;
 	duk_uint32_t end_line;
 #endif
+
 };
 
 #endif  /* DUK_HCOMPFUNC_H_INCLUDED */
@@ -7832,6 +8019,10 @@ struct duk_activation {
 	duk_uint32_t prev_line; /* needed for stepping */
 #endif
 
+#if defined(DUK_USE_PROFILER_INSTRUMENT)
+	duk_double_t prof_start; /* entry time for instrumentation, < 0 if not instrumented */
+#endif
+
 	duk_small_uint_t flags;
 };
 
@@ -8583,6 +8774,34 @@ struct duk_hproxy {
 #define DUK_HEAP_MARK_AND_SWEEP_TRIGGER_SKIP              256L
 #endif
 
+/* Incremental mark-and-sweep: once a cycle has been started by the trigger
+ * above, a bounded marking step is taken every 'STEP_INTERVAL' (re)allocations
+ * until marking completes.  The write barrier is based on DECREF so reference
+ * counting is required.
+ */
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+#if !defined(DUK_USE_REFERENCE_COUNTING)
+#error DUK_USE_MARK_AND_SWEEP_INCREMENTAL requires DUK_USE_REFERENCE_COUNTING
+#endif
+#define DUK_HEAP_MARK_AND_SWEEP_STEP_INTERVAL             256L
+#define DUK_HEAP_MARK_AND_SWEEP_GREY_MINSIZE              64
+/* Thread value stacks are shaded when a cycle starts, so garbage cycles
+ * through a thread survive incremental cycles; every 'FULL_INTERVAL'th
+ * voluntary collection is a full non-incremental one to catch them.
+ */
+#define DUK_HEAP_MARK_AND_SWEEP_FULL_INTERVAL             16
+#endif
+
+/* Idle time GC (duk_gc_idle()) is due once 1/IDLE_DIV of the voluntary
+ * trigger interval has been used up.
+ */
+#define DUK_HEAP_MARK_AND_SWEEP_IDLE_DIV                  2
+
+/* Pause histogram buckets: bucket N counts pauses of [2^N, 2^(N+1))
+ * microseconds, the first and last buckets are open ended.
+ */
+#define DUK_HEAP_MS_PAUSE_BUCKETS                         16
+
 /* GC torture. */
 #if defined(DUK_USE_GC_TORTURE)
 #define DUK_GC_TORTURE(heap) do { duk_heap_mark_and_sweep((heap), 0); } while (0)
@@ -8596,6 +8815,27 @@ struct duk_hproxy {
 #define DUK_HEAP_STRCACHE_SIZE                            4
 #define DUK_HEAP_STRINGCACHE_NOCACHE_LIMIT                16  /* strings up to the this length are not cached */
 
+/* Sparse char offset -> byte offset indices for long non-ASCII strings,
+ * built on the first access which would otherwise need a long scan.
+ */
+#define DUK_HEAP_STRCACHE_INDEX_SLOTS                     8   /* max number of indexed strings */
+#define DUK_HEAP_STRCACHE_INDEX_SHIFT                     5   /* one entry per 32 characters */
+#define DUK_HEAP_STRCACHE_INDEX_MINLEN                    256 /* shorter strings are never indexed */
+#define DUK_HEAP_STRCACHE_INDEX_TRIGGER                   64  /* build index when scan would be longer */
+
+/* Property access inline caches: max prototype chain distance from the
+ * receiver to the object holding a cached property.
+ */
+#define DUK_HEAP_PROPIC_MAX_DEPTH                         4
+
+/* Shared object shapes: shape hash table size, and number of slots
+ * remembering recently seen layouts; a shape is only created for a
+ * layout seen on a second object.
+ */
+#define DUK_HEAP_SHAPETAB_SIZE                            32
+#define DUK_HEAP_SHAPE_CAND_SIZE                          16
+#define DUK_HEAP_SHAPE_MAX_KEYS                           64
+
 /* Some list management macros. */
 #define DUK_HEAP_INSERT_INTO_HEAP_ALLOCATED(heap,hdr)     duk_heap_insert_into_heap_allocated((heap), (hdr))
 #if defined(DUK_USE_REFERENCE_COUNTING)
@@ -8748,6 +8988,20 @@ struct duk_strcache_entry {
 	duk_uint32_t cidx;
 };
 
+/* Sparse index for a long non-ASCII string: boffs[i] is the byte offset
+ * of character (i << DUK_HEAP_STRCACHE_INDEX_SHIFT).  The string reference
+ * is weak like in duk_strcache_entry.  While boffs is NULL the entry is a
+ * candidate which accumulates scan lengths until an index is worth building.
+ */
+#if defined(DUK_USE_STRCACHE_INDEX)
+struct duk_strcache_index {
+	duk_hstring *h;
+	duk_uint32_t *boffs;
+	duk_uint32_t count;
+	duk_uint32_t scanned;
+};
+#endif
+
 /*
  *  Longjmp state, contains the information needed to perform a longjmp.
  *  Longjmp related values are written to value1, value2, and iserror.
@@ -8782,6 +9036,87 @@ struct duk_litcache_entry {
 	duk_hstring *h;
 };
 
+/*
+ *  Property access inline cache entry (DUK_USE_PROPERTY_IC)
+ *
+ *  All references are weak and only compared, never dereferenced without
+ *  validation.
+ */
+
+#if defined(DUK_USE_PROPERTY_IC)
+struct duk_propic_entry {
+	const duk_instr_t *pc;  /* instruction owning the entry */
+	duk_hstring *key;
+	duk_uint32_t e_idx;     /* entry part index of 'key' in the holder */
+	duk_uint32_t depth;     /* prototype chain distance from receiver to holder */
+};
+#endif
+
+/*
+ *  RegExp compile cache entry (DUK_USE_REGEXP_CACHE)
+ *
+ *  Holds a reference to each string; entries are reachability roots.
+ */
+
+#if defined(DUK_USE_REGEXP_CACHE)
+struct duk_re_cache_entry {
+	duk_hstring *pattern;   /* NULL for an unused entry */
+	duk_hstring *flags;
+	duk_hstring *source;    /* escaped source */
+	duk_hstring *bytecode;
+};
+#endif
+
+/*
+ *  Instrumentation counters of one compiled function
+ *  (DUK_USE_PROFILER_INSTRUMENT)
+ *
+ *  Keyed by the 'data' buffer which the function template and all its
+ *  closures share.  Holds a reference to the buffer (so that the key can't
+ *  be reused by another function) and to the name and fileName strings, so
+ *  counts survive the closures.  Entries are reachability roots until
+ *  duk_profiler_reset().
+ */
+
+#if defined(DUK_USE_PROFILER_INSTRUMENT)
+struct duk_prof_entry {
+	duk_hbuffer *data;      /* NULL for an unused slot */
+	duk_hstring *name;      /* NULL if none */
+	duk_hstring *filename;  /* NULL if none */
+	duk_uint32_t line;
+	duk_uint32_t calls;     /* number of calls */
+	duk_uint32_t depth;     /* currently active instrumented activations */
+	duk_double_t time;      /* inclusive time, milliseconds */
+};
+#endif
+
+/*
+ *  Open addressing string table slot (DUK_USE_STRTAB_PROBE)
+ */
+
+#if defined(DUK_USE_STRTAB_PROBE)
+struct duk_strtab_entry {
+	duk_uint32_t hash;  /* cached tag of string hash, 0 = empty */
+	duk_hstring *h;
+};
+#endif
+
+/*
+ *  Resumable string hash state (DUK_USE_STRHASH_FULL)
+ */
+
+#if defined(DUK_USE_STRHASH_FULL)
+struct duk_strhash_state {
+#if defined(DUK_USE_64BIT_OPS) && (DUK_SIZE_MAX > 0xffffffffUL)
+	duk_uint64_t h;
+#else
+	duk_uint32_t a;
+	duk_uint32_t b;
+#endif
+	duk_size_t off;  /* bytes consumed, always a multiple of 8 */
+};
+#endif
+
 /*
  *  Main heap structure
  */
@@ -8852,6 +9187,10 @@ struct duk_heap {
 	 */
 #if defined(DUK_USE_VOLUNTARY_GC)
 	duk_int_t ms_trigger_counter;
+	/* Trigger counter value at the last reset, used to decide whether
+	 * an idle time GC is due.
+	 */
+	duk_int_t ms_trigger_limit;
 #endif
 
 	/* Mark-and-sweep recursion control: too deep recursion causes
@@ -8880,6 +9219,39 @@ struct duk_heap {
 	 */
 	duk_uint_t ms_prevent_count;
 
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	/* Incremental marking state.  While ms_incremental is set the heap is
+	 * between marking steps: DECREF shades its target (snapshot-at-the-
+	 * beginning write barrier), new objects and strings are allocated
+	 * marked, and ms_grey holds marked objects whose children haven't been
+	 * marked yet (also flagged TEMPROOT).  If ms_grey can't grow, objects
+	 * are left flagged TEMPROOT only and the final heap scan finds them.
+	 */
+	duk_bool_t ms_incremental;
+	duk_heaphdr **ms_grey;
+	duk_size_t ms_grey_used;
+	duk_size_t ms_grey_size;
+	duk_uint32_t ms_steps;
+	duk_uint32_t ms_cycles;
+#endif
+
+#if defined(DUK_USE_MARK_AND_SWEEP_PAUSE_STATS)
+	/* GC pause statistics, times in milliseconds.  ms_pause_start is
+	 * negative when no pause is being timed.
+	 */
+	duk_double_t ms_pause_start;
+	duk_double_t ms_pause_total;
+	duk_double_t ms_pause_max;
+	duk_uint32_t ms_pause_count;
+	duk_uint32_t ms_pause_hist[DUK_HEAP_MS_PAUSE_BUCKETS];
+
+	/* Collections completed from duk_gc_idle() vs. from the voluntary
+	 * allocation trigger.
+	 */
+	duk_uint32_t ms_count_idle;
+	duk_uint32_t ms_count_alloc;
+#endif
+
 	/* Finalizer processing prevent count, stacking.  Bumped when finalizers
 	 * are processed to prevent recursive finalizer processing (first call site
 	 * processing finalizers handles all finalizers until the list is empty).
@@ -9004,15 +9376,41 @@ struct duk_heap {
 	duk_bool_t dbg_calling_transport;       /* transport call in progress, calling into Duktape forbidden */
 #endif
 
+	/* Sampling profiler state.  Samples are aggregated as folded stack
+	 * records into a fixed size native buffer (DUK_USE_PROFILER_BUFSIZE)
+	 * which is allocated on first start and kept until heap destruction.
+	 */
+#if defined(DUK_USE_PROFILER_SAMPLING)
+	duk_uint8_t *prof_buf;                  /* folded stack records, NULL if never started */
+	duk_uint32_t prof_used;                 /* bytes used in prof_buf */
+	duk_uint32_t prof_interval;             /* opcodes executed between samples */
+	duk_uint32_t prof_samples;              /* samples recorded into prof_buf */
+	duk_uint32_t prof_dropped;              /* samples dropped because prof_buf was full */
+	duk_double_t prof_overhead;             /* cumulative time spent sampling, milliseconds */
+	duk_bool_t prof_enabled;
+#endif
+#if defined(DUK_USE_PROFILER_INSTRUMENT)
+	/* Instrumentation counters, an open addressing hash table of
+	 * prof_funcs_size (power of two) entries allocated with the raw
+	 * allocator so that call setup can insert without side effects.
+	 */
+	duk_bool_t prof_instrument;             /* count calls and time for compiled functions */
+	duk_prof_entry *prof_funcs;             /* NULL if nothing counted yet */
+	duk_uint32_t prof_funcs_size;
+	duk_uint32_t prof_funcs_used;
+#endif
+
 	/* String intern table (weak refs). */
 #if defined(DUK_USE_STRTAB_PTRCOMP)
 	duk_uint16_t *strtable16;
+#elif defined(DUK_USE_STRTAB_PROBE)
+	duk_strtab_entry *strtable;
 #else
 	duk_hstring **strtable;
 #endif
 	duk_uint32_t st_mask;    /* mask for lookup, st_size - 1 */
 	duk_uint32_t st_size;    /* stringtable size */
-#if (DUK_USE_STRTAB_MINSIZE != DUK_USE_STRTAB_MAXSIZE)
+#if (DUK_USE_STRTAB_MINSIZE != DUK_USE_STRTAB_MAXSIZE) || defined(DUK_USE_STRTAB_PROBE)
 	duk_uint32_t st_count;   /* string count for resize load factor checks */
 #endif
 	duk_bool_t st_resizing;  /* string table is being resized; avoid recursive resize */
@@ -9022,6 +9420,71 @@ struct duk_heap {
 	 */
 	duk_strcache_entry strcache[DUK_HEAP_STRCACHE_SIZE];
 
+#if defined(DUK_USE_STRCACHE_INDEX)
+	/* Sparse char offset indices (or candidates) for random access into
+	 * long non-ASCII strings, in LRU order.  Total size of the indices is
+	 * capped to DUK_USE_STRCACHE_INDEX_LIMIT bytes.
+	 */
+	duk_strcache_index strcache_index[DUK_HEAP_STRCACHE_INDEX_SLOTS];
+	duk_size_t strcache_index_bytes;
+#endif
+
+#if defined(DUK_USE_PROPERTY_IC)
+	/* Inline caches for property reads and writes, indexed by bytecode
+	 * instruction address.
+	 */
+	duk_propic_entry propic[DUK_USE_PROPERTY_IC_SIZE];
+	duk_uint32_t propic_get_hit;
+	duk_uint32_t propic_get_miss;
+	duk_uint32_t propic_put_hit;
+	duk_uint32_t propic_put_miss;
+#endif
+
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	/* Shared object shapes, chained by hash, and hashes of recently seen
+	 * layouts without a shape.
+	 */
+	duk_propshape *shapetab[DUK_HEAP_SHAPETAB_SIZE];
+	duk_uint32_t shape_cand[DUK_HEAP_SHAPE_CAND_SIZE];
+#endif
+
+#if defined(DUK_USE_REGEXP_CACHE)
+	/* Compiled regexps keyed by (pattern, flags), most recently used
+	 * first.
+	 */
+	duk_re_cache_entry re_cache[DUK_USE_REGEXP_CACHE_SIZE];
+#endif
+
+#if defined(DUK_USE_STRING_APPEND_INPLACE)
+	/* String most recently grown in place by 's += x', its allocated
+	 * data capacity, and the hash state over its full 8-byte words.
+	 * Weak reference, cleared by duk_free_hstring().
+	 */
+	duk_hstring *strapp_h;
+	duk_size_t strapp_cap;
+#if defined(DUK_USE_STRHASH_FULL)
+	duk_strhash_state strapp_hash;
+#endif
+#endif
+
+#if defined(DUK_USE_COMPILER_STATS)
+	/* Compiler statistics for duk_compile_inspect(): the 'last' fields
+	 * describe the most recent duk_js_compile() call.  Sizes in bytes,
+	 * times in milliseconds.
+	 */
+	duk_uint32_t comp_count;
+	duk_uint32_t comp_last_funcs;
+	duk_size_t comp_last_source;
+	duk_size_t comp_last_stack;
+	duk_size_t comp_max_stack;
+#if defined(DUK_USE_GET_FREE_HEAP_SIZE)
+	duk_size_t comp_last_heap;
+	duk_size_t comp_max_heap;
+#endif
+	duk_double_t comp_last_time;
+	duk_double_t comp_total_time;
+#endif
+
 #if defined(DUK_USE_LITCACHE_SIZE)
 	/* Literal intern cache.  When enabled, strings interned as literals
 	 * (e.g. duk_push_literal()) will be pinned and cached for the lifetime
@@ -9133,10 +9596,15 @@ DUK_INTERNAL_DECL duk_hstring *duk_heap_strtable_intern_literal_checked(duk_hthr
 #endif
 DUK_INTERNAL_DECL duk_hstring *duk_heap_strtable_intern_u32(duk_heap *heap, duk_uint32_t val);
 DUK_INTERNAL_DECL duk_hstring *duk_heap_strtable_intern_u32_checked(duk_hthread *thr, duk_uint32_t val);
-#if defined(DUK_USE_REFERENCE_COUNTING)
+#if defined(DUK_USE_STRING_APPEND_INPLACE)
+DUK_INTERNAL_DECL duk_hstring *duk_heap_strtable_append(duk_hthread *thr, duk_hstring *h, duk_hstring *h_add);
+#endif
+#if defined(DUK_USE_REFERENCE_COUNTING) || defined(DUK_USE_STRTAB_PROBE)
 DUK_INTERNAL_DECL void duk_heap_strtable_unlink(duk_heap *heap, duk_hstring *h);
 #endif
+#if !defined(DUK_USE_STRTAB_PROBE)
 DUK_INTERNAL_DECL void duk_heap_strtable_unlink_prev(duk_heap *heap, duk_hstring *h, duk_hstring *prev);
+#endif
 DUK_INTERNAL_DECL void duk_heap_strtable_force_resize(duk_heap *heap);
 DUK_INTERNAL void duk_heap_strtable_free(duk_heap *heap);
 #if defined(DUK_USE_DEBUG)
@@ -9168,8 +9636,26 @@ DUK_INTERNAL_DECL void duk_heap_process_finalize_list(duk_heap *heap);
 #endif  /* DUK_USE_FINALIZER_SUPPORT */
 
 DUK_INTERNAL_DECL void duk_heap_mark_and_sweep(duk_heap *heap, duk_small_uint_t flags);
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+DUK_INTERNAL_DECL duk_bool_t duk_heap_mark_and_sweep_step(duk_heap *heap, duk_double_t budget);
+DUK_INTERNAL_DECL void duk_heap_mark_shade(duk_heap *heap, duk_heaphdr *h);
+#endif
+DUK_INTERNAL_DECL duk_bool_t duk_heap_mark_and_sweep_idle(duk_heap *heap, duk_double_t budget, duk_small_uint_t flags);
 
 DUK_INTERNAL_DECL duk_uint32_t duk_heap_hashstring(duk_heap *heap, const duk_uint8_t *str, duk_size_t len);
+#if defined(DUK_USE_STRHASH_FULL)
+DUK_INTERNAL_DECL void duk_heap_hashstring_init(duk_heap *heap, duk_strhash_state *st);
+DUK_INTERNAL_DECL void duk_heap_hashstring_update(duk_strhash_state *st, const duk_uint8_t *str, duk_size_t len);
+DUK_INTERNAL_DECL duk_uint32_t duk_heap_hashstring_final(const duk_strhash_state *st, const duk_uint8_t *str, duk_size_t len);
+#endif
+
+#if defined(DUK_USE_PROFILER_SAMPLING)
+DUK_INTERNAL_DECL void duk_heap_profiler_sample(duk_hthread *thr);
+#endif
+#if defined(DUK_USE_PROFILER_INSTRUMENT)
+DUK_INTERNAL_DECL duk_prof_entry *duk_heap_profiler_func_lookup(duk_heap *heap, duk_hcompfunc *fun);
+DUK_INTERNAL_DECL duk_prof_entry *duk_heap_profiler_func_enter(duk_hthread *thr, duk_hcompfunc *fun);
+#endif
 
 #endif  /* DUK_HEAP_H_INCLUDED */
 /* #include duk_debugger.h */
@@ -10349,6 +10835,17 @@ DUK_INTERNAL_DECL duk_small_int_t duk_unicode_re_is_wordchar(duk_codepoint_t cp)
 /* How large a loop detection stack to use */
 #define DUK_JSON_ENC_LOOPARRAY                64
 
+/* Streamed stringify output (DUK_USE_JSON_STRINGIFY_SINK): chunks go
+ * either to a native callback or to a function at valstack index
+ * 'idx_func'.  A native callback must not call into Duktape.
+ */
+typedef struct {
+	duk_json_sink_function func;  /* native sink, NULL for a function sink */
+	void *udata;
+	duk_idx_t idx_func;
+	duk_size_t chunk_size;
+} duk_json_sink;
+
 /* Encoding state.  Heap object references are all borrowed. */
 typedef struct {
 	duk_hthread *thr;
@@ -10374,6 +10871,12 @@ typedef struct {
 	duk_small_uint_t stridx_custom_neginf;
 	duk_small_uint_t stridx_custom_posinf;
 	duk_small_uint_t stridx_custom_function;
+#endif
+#if defined(DUK_USE_JSON_STRINGIFY_SINK)
+	const duk_json_sink *sink;   /* output sink, NULL if the result is a string */
+	duk_size_t sink_chunk;       /* chunk size, clamped */
+	duk_size_t sink_flushed;     /* bytes delivered to the sink so far */
+	duk_size_t sink_skip;        /* bytes to drop when the slow path redoes fast path output */
 #endif
 	duk_hobject *visiting[DUK_JSON_ENC_LOOPARRAY];  /* indexed by recursion_depth */
 } duk_json_enc_ctx;
@@ -10392,6 +10895,13 @@ typedef struct {
 #endif
 	duk_int_t recursion_depth;
 	duk_int_t recursion_limit;
+#if defined(DUK_USE_JSON_DEC_KEYCACHE_SIZE)
+	duk_idx_t idx_keycache;      /* valstack index of key cache array (undefined until first miss) */
+	duk_hstring *keycache[DUK_USE_JSON_DEC_KEYCACHE_SIZE];  /* borrowed, kept reachable by idx_keycache */
+#endif
+#if defined(DUK_USE_JSON_INCREMENTAL_PARSER)
+	duk_size_t offset;           /* input offset of p_start, for error messages */
+#endif
 } duk_json_dec_ctx;
 
 #endif  /* DUK_JSON_H_INCLUDED */
@@ -10615,6 +11125,9 @@ DUK_INTERNAL_DECL void duk_js_execute_bytecode(duk_hthread *exec_thr);
 
 DUK_INTERNAL_DECL void duk_numconv_stringify(duk_hthread *thr, duk_small_int_t radix, duk_small_int_t digits, duk_small_uint_t flags);
 DUK_INTERNAL_DECL void duk_numconv_parse(duk_hthread *thr, duk_small_int_t radix, duk_small_uint_t flags);
+#if defined(DUK_USE_NUMCONV_PARSE_FASTPATH) && defined(DUK_USE_64BIT_OPS)
+DUK_INTERNAL_DECL duk_bool_t duk_numconv_parse_decimal(duk_uint64_t w, duk_int_t q, duk_double_t *out);
+#endif
 
 #endif  /* DUK_NUMCONV_H_INCLUDED */
 /* #include duk_bi_protos.h */
@@ -10690,10 +11203,38 @@ void duk_bi_json_stringify_helper(duk_hthread *thr,
                                   duk_idx_t idx_value,
                                   duk_idx_t idx_replacer,
                                   duk_idx_t idx_space,
-                                  duk_small_uint_t flags);
+                                  duk_small_uint_t flags,
+                                  const duk_json_sink *sink);
 
 DUK_INTERNAL_DECL duk_ret_t duk_textdecoder_decode_utf8_nodejs(duk_hthread *thr);
 
+#if defined(DUK_USE_JSON_BUILTIN) && defined(DUK_USE_JSON_STRINGIFY_SINK)
+/* JSON.stringifyTo(), added by duk_hthread_create_builtin_objects(). */
+DUK_INTERNAL_DECL duk_ret_t duk_bi_json_object_stringify_to(duk_hthread *thr);
+#endif
+
+#if defined(DUK_USE_JSON_BUILTIN) && defined(DUK_USE_JSON_INCREMENTAL_PARSER)
+/* JSON.Parser, added by duk_hthread_create_builtin_objects(). */
+DUK_INTERNAL_DECL duk_ret_t duk_bi_json_parser_constructor(duk_hthread *thr);
+DUK_INTERNAL_DECL duk_ret_t duk_bi_json_parser_prototype_write(duk_hthread *thr);
+DUK_INTERNAL_DECL duk_ret_t duk_bi_json_parser_prototype_end(duk_hthread *thr);
+#endif
+
+#if defined(DUK_USE_CBOR_BUILTIN) && defined(DUK_USE_CBOR_SUPPORT) && defined(DUK_USE_CBOR_STREAMING)
+/* CBOR.encodeInto() and CBOR.Decoder, added by duk_hthread_create_builtin_objects(). */
+DUK_INTERNAL_DECL duk_ret_t duk_bi_cbor_encode_into(duk_hthread *thr);
+DUK_INTERNAL_DECL duk_ret_t duk_bi_cbor_decoder_constructor(duk_hthread *thr);
+DUK_INTERNAL_DECL duk_ret_t duk_bi_cbor_decoder_prototype_write(duk_hthread *thr);
+DUK_INTERNAL_DECL duk_ret_t duk_bi_cbor_decoder_prototype_end(duk_hthread *thr);
+#endif
+
+#if defined(DUK_USE_BUFFEROBJECT_SUPPORT) && defined(DUK_USE_TYPEDARRAY_KERNELS)
+/* %TypedArray%.prototype methods added by duk_hthread_create_builtin_objects(). */
+DUK_INTERNAL_DECL duk_ret_t duk_bi_typedarray_fill(duk_hthread *thr);
+DUK_INTERNAL_DECL duk_ret_t duk_bi_typedarray_indexof_shared(duk_hthread *thr);
+DUK_INTERNAL_DECL duk_ret_t duk_bi_typedarray_reverse(duk_hthread *thr);
+#endif
+
 #if defined(DUK_USE_ES6_PROXY)
 DUK_INTERNAL_DECL void duk_proxy_ownkeys_postprocess(duk_hthread *thr, duk_hobject *h_proxy_target, duk_uint_t flags);
 #endif
@@ -13960,6 +14501,13 @@ static duk_uint8_t *duk__dump_func(duk_hthread *thr, duk_hcompfunc *func, duk_bu
 	duk_uint16_t tmp16;
 	duk_double_t d;
 
+#if defined(DUK_USE_COMPILER_LAZY)
+	/* Bytecode dumps are always fully compiled. */
+	if (DUK_HCOMPFUNC_IS_LAZY(thr->heap, func)) {
+		duk_js_compile_lazy(thr, func);
+	}
+#endif
+
 	DUK_DD(DUK_DDPRINT("dumping function %p to %p: "
 	                   "consts=[%p,%p[ (%ld bytes, %ld items), "
 	                   "funcs=[%p,%p[ (%ld bytes, %ld items), "
@@ -14005,6 +14553,7 @@ static duk_uint8_t *duk__dump_func(duk_hthread *thr, duk_hcompfunc *func, duk_bu
 #endif
 	tmp32 = DUK_HEAPHDR_GET_FLAGS((duk_heaphdr *) func);  /* masks flags, only duk_hobject flags */
 	tmp32 &= ~(DUK_HOBJECT_FLAG_HAVE_FINALIZER);  /* finalizer flag is lost */
+	tmp32 &= ~DUK_HEAPHDR_FLAGS_HEAP_MASK;  /* GC flags, may be set during incremental marking */
 	DUK_RAW_WRITEINC_U32_BE(p, tmp32);
 
 	/* Bytecode instructions: endian conversion needed unless
@@ -14173,6 +14722,8 @@ static const duk_uint8_t *duk__load_func(duk_hthread *thr, const duk_uint8_t *p,
 
 	/* duk_hcompfunc flags; quite version specific */
 	tmp32 = DUK_RAW_READINC_U32_BE(p);
+	tmp32 = (tmp32 & ~DUK_HEAPHDR_FLAGS_HEAP_MASK) |
+	        (DUK_HEAPHDR_GET_FLAGS((duk_heaphdr *) h_fun) & DUK_HEAPHDR_FLAGS_HEAP_MASK);
 	DUK_HEAPHDR_SET_FLAGS((duk_heaphdr *) h_fun, tmp32);  /* masks flags to only change duk_hobject flags */
 
 	/* standard prototype (no need to set here, already set) */
@@ -15112,6 +15663,102 @@ DUK_LOCAL const duk_int8_t duk__base64_dectab_fast[256] = {
 };
 #endif  /* DUK_USE_BASE64_FASTPATH */
 
+#if defined(DUK_USE_BASE64_FASTPATH) && defined(DUK_USE_BASE64_DECODE_TABLES)
+/* Decode tables for the fast path: each input character position of a
+ * 4-character group has its own table, pre-shifted into place so that a
+ * group decodes with four lookups and three ORs.  All non-alphabet
+ * characters (whitespace, padding, errors) map to -1 so that a negative
+ * result means "not a clean group".  The last position uses
+ * duk__base64_dectab_fast[] directly; all of its special values are negative.
+ */
+DUK_LOCAL const duk_int32_t duk__base64_dectab_shift18[256] = {
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x00...0x07 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x08...0x0f */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x10...0x17 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x18...0x1f */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x20...0x27 */
+	        -1,         -1,         -1, 0x00f80000,         -1,         -1,         -1, 0x00fc0000,  /* 0x28...0x2f */
+	0x00d00000, 0x00d40000, 0x00d80000, 0x00dc0000, 0x00e00000, 0x00e40000, 0x00e80000, 0x00ec0000,  /* 0x30...0x37 */
+	0x00f00000, 0x00f40000,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x38...0x3f */
+	        -1, 0x00000000, 0x00040000, 0x00080000, 0x000c0000, 0x00100000, 0x00140000, 0x00180000,  /* 0x40...0x47 */
+	0x001c0000, 0x00200000, 0x00240000, 0x00280000, 0x002c0000, 0x00300000, 0x00340000, 0x00380000,  /* 0x48...0x4f */
+	0x003c0000, 0x00400000, 0x00440000, 0x00480000, 0x004c0000, 0x00500000, 0x00540000, 0x00580000,  /* 0x50...0x57 */
+	0x005c0000, 0x00600000, 0x00640000,         -1,         -1,         -1,         -1,         -1,  /* 0x58...0x5f */
+	        -1, 0x00680000, 0x006c0000, 0x00700000, 0x00740000, 0x00780000, 0x007c0000, 0x00800000,  /* 0x60...0x67 */
+	0x00840000, 0x00880000, 0x008c0000, 0x00900000, 0x00940000, 0x00980000, 0x009c0000, 0x00a00000,  /* 0x68...0x6f */
+	0x00a40000, 0x00a80000, 0x00ac0000, 0x00b00000, 0x00b40000, 0x00b80000, 0x00bc0000, 0x00c00000,  /* 0x70...0x77 */
+	0x00c40000, 0x00c80000, 0x00cc0000,         -1,         -1,         -1,         -1,         -1,  /* 0x78...0x7f */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x80...0x87 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x88...0x8f */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x90...0x97 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x98...0x9f */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xa0...0xa7 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xa8...0xaf */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xb0...0xb7 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xb8...0xbf */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xc0...0xc7 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xc8...0xcf */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xd0...0xd7 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xd8...0xdf */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xe0...0xe7 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xe8...0xef */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xf0...0xf7 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1   /* 0xf8...0xff */
+};
+DUK_LOCAL const duk_int32_t duk__base64_dectab_shift12[256] = {
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x00...0x07 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x08...0x0f */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x10...0x17 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x18...0x1f */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x20...0x27 */
+	        -1,         -1,         -1, 0x0003e000,         -1,         -1,         -1, 0x0003f000,  /* 0x28...0x2f */
+	0x00034000, 0x00035000, 0x00036000, 0x00037000, 0x00038000, 0x00039000, 0x0003a000, 0x0003b000,  /* 0x30...0x37 */
+	0x0003c000, 0x0003d000,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x38...0x3f */
+	        -1, 0x00000000, 0x00001000, 0x00002000, 0x00003000, 0x00004000, 0x00005000, 0x00006000,  /* 0x40...0x47 */
+	0x00007000, 0x00008000, 0x00009000, 0x0000a000, 0x0000b000, 0x0000c000, 0x0000d000, 0x0000e000,  /* 0x48...0x4f */
+	0x0000f000, 0x00010000, 0x00011000, 0x00012000, 0x00013000, 0x00014000, 0x00015000, 0x00016000,  /* 0x50...0x57 */
+	0x00017000, 0x00018000, 0x00019000,         -1,         -1,         -1,         -1,         -1,  /* 0x58...0x5f */
+	        -1, 0x0001a000, 0x0001b000, 0x0001c000, 0x0001d000, 0x0001e000, 0x0001f000, 0x00020000,  /* 0x60...0x67 */
+	0x00021000, 0x00022000, 0x00023000, 0x00024000, 0x00025000, 0x00026000, 0x00027000, 0x00028000,  /* 0x68...0x6f */
+	0x00029000, 0x0002a000, 0x0002b000, 0x0002c000, 0x0002d000, 0x0002e000, 0x0002f000, 0x00030000,  /* 0x70...0x77 */
+	0x00031000, 0x00032000, 0x00033000,         -1,         -1,         -1,         -1,         -1,  /* 0x78...0x7f */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x80...0x87 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x88...0x8f */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x90...0x97 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0x98...0x9f */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xa0...0xa7 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xa8...0xaf */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xb0...0xb7 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xb8...0xbf */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xc0...0xc7 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xc8...0xcf */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xd0...0xd7 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xd8...0xdf */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xe0...0xe7 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xe8...0xef */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1,  /* 0xf0...0xf7 */
+	        -1,         -1,         -1,         -1,         -1,         -1,         -1,         -1   /* 0xf8...0xff */
+};
+DUK_LOCAL const duk_int16_t duk__base64_dectab_shift6[256] = {
+	    -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,  /* 0x00...0x0f */
+	    -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,  /* 0x10...0x1f */
+	    -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1, 0x0f80,     -1,     -1,     -1, 0x0fc0,  /* 0x20...0x2f */
+	0x0d00, 0x0d40, 0x0d80, 0x0dc0, 0x0e00, 0x0e40, 0x0e80, 0x0ec0, 0x0f00, 0x0f40,     -1,     -1,     -1,     -1,     -1,     -1,  /* 0x30...0x3f */
+	    -1, 0x0000, 0x0040, 0x0080, 0x00c0, 0x0100, 0x0140, 0x0180, 0x01c0, 0x0200, 0x0240, 0x0280, 0x02c0, 0x0300, 0x0340, 0x0380,  /* 0x40...0x4f */
+	0x03c0, 0x0400, 0x0440, 0x0480, 0x04c0, 0x0500, 0x0540, 0x0580, 0x05c0, 0x0600, 0x0640,     -1,     -1,     -1,     -1,     -1,  /* 0x50...0x5f */
+	    -1, 0x0680, 0x06c0, 0x0700, 0x0740, 0x0780, 0x07c0, 0x0800, 0x0840, 0x0880, 0x08c0, 0x0900, 0x0940, 0x0980, 0x09c0, 0x0a00,  /* 0x60...0x6f */
+	0x0a40, 0x0a80, 0x0ac0, 0x0b00, 0x0b40, 0x0b80, 0x0bc0, 0x0c00, 0x0c40, 0x0c80, 0x0cc0,     -1,     -1,     -1,     -1,     -1,  /* 0x70...0x7f */
+	    -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,  /* 0x80...0x8f */
+	    -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,  /* 0x90...0x9f */
+	    -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,  /* 0xa0...0xaf */
+	    -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,  /* 0xb0...0xbf */
+	    -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,  /* 0xc0...0xcf */
+	    -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,  /* 0xd0...0xdf */
+	    -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,  /* 0xe0...0xef */
+	    -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1,     -1   /* 0xf0...0xff */
+};
+#endif  /* DUK_USE_BASE64_DECODE_TABLES */
+
 #if defined(DUK_USE_BASE64_FASTPATH)
 DUK_LOCAL DUK_ALWAYS_INLINE void duk__base64_encode_fast_3(const duk_uint8_t *src, duk_uint8_t *dst) {
 	duk_uint_t t;
@@ -15292,8 +15939,12 @@ DUK_LOCAL void duk__base64_encode_helper(const duk_uint8_t *src, duk_size_t srcl
 }
 #endif  /* DUK_USE_BASE64_FASTPATH */
 
+/* Decode 'src' into [dst,dst_end[.  Returns 1 on success, 0 for invalid
+ * input, and -1 if the output doesn't fit; in the latter two cases
+ * [dst,dst_end[ may contain partial output.
+ */
 #if defined(DUK_USE_BASE64_FASTPATH)
-DUK_LOCAL duk_bool_t duk__base64_decode_helper(const duk_uint8_t *src, duk_size_t srclen, duk_uint8_t *dst, duk_uint8_t **out_dst_final) {
+DUK_LOCAL duk_small_int_t duk__base64_decode_helper(const duk_uint8_t *src, duk_size_t srclen, duk_uint8_t *dst, duk_uint8_t *dst_end, duk_uint8_t **out_dst_final) {
 	duk_int_t x;
 	duk_uint_t t;
 	duk_small_uint_t n_equal;
@@ -15304,6 +15955,7 @@ DUK_LOCAL duk_bool_t duk__base64_decode_helper(const duk_uint8_t *src, duk_size_
 	duk_uint8_t *q;
 
 	DUK_ASSERT(src != NULL);  /* Required by pointer arithmetic below, which fails for NULL. */
+	DUK_ASSERT(dst_end >= dst);
 
 	p = src;
 	p_end = src + srclen;
@@ -15323,8 +15975,14 @@ DUK_LOCAL duk_bool_t duk__base64_decode_helper(const duk_uint8_t *src, duk_size_
 		 * nothing and drop out.  This approach could be extended to
 		 * more groups per loop, but for inputs with e.g. periodic
 		 * newlines (which are common) it might not be an improvement.
+		 *
+		 * Output is only written for clean groups so that nothing is
+		 * written past the final output.  The fast path needs room
+		 * for 6 bytes; near the end of a caller provided buffer the
+		 * slow path handles the remaining groups with exact bounds
+		 * checks.
 		 */
-		while (DUK_LIKELY(p <= p_end_safe)) {
+		while (DUK_LIKELY(p <= p_end_safe && (duk_size_t) (dst_end - q) >= 6U)) {
 			duk_int_t t1, t2;
 
 			/* The lookup byte is intentionally sign extended to
@@ -15339,6 +15997,19 @@ DUK_LOCAL duk_bool_t duk__base64_decode_helper(const duk_uint8_t *src, duk_size_
 			DUK_DDD(DUK_DDDPRINT("fast loop: p=%p, p_end_safe=%p, p_end=%p",
 			                     (const void *) p, (const void *) p_end_safe, (const void *) p_end));
 
+#if defined(DUK_USE_BASE64_DECODE_TABLES)
+			/* Same idea with pre-shifted tables, which avoids the
+			 * dependent shift chain.
+			 */
+			t1 = (duk_int_t) duk__base64_dectab_shift18[p[0]] |
+			     (duk_int_t) duk__base64_dectab_shift12[p[1]] |
+			     (duk_int_t) duk__base64_dectab_shift6[p[2]] |
+			     (duk_int_t) duk__base64_dectab_fast[p[3]];
+			t2 = (duk_int_t) duk__base64_dectab_shift18[p[4]] |
+			     (duk_int_t) duk__base64_dectab_shift12[p[5]] |
+			     (duk_int_t) duk__base64_dectab_shift6[p[6]] |
+			     (duk_int_t) duk__base64_dectab_fast[p[7]];
+#else  /* DUK_USE_BASE64_DECODE_TABLES */
 			t1 = (duk_int_t) duk__base64_dectab_fast[p[0]];
 			t1 = (duk_int_t) ((duk_uint_t) t1 << 6) | (duk_int_t) duk__base64_dectab_fast[p[1]];
 			t1 = (duk_int_t) ((duk_uint_t) t1 << 6) | (duk_int_t) duk__base64_dectab_fast[p[2]];
@@ -15348,22 +16019,29 @@ DUK_LOCAL duk_bool_t duk__base64_decode_helper(const duk_uint8_t *src, duk_size_
 			t2 = (duk_int_t) ((duk_uint_t) t2 << 6) | (duk_int_t) duk__base64_dectab_fast[p[5]];
 			t2 = (duk_int_t) ((duk_uint_t) t2 << 6) | (duk_int_t) duk__base64_dectab_fast[p[6]];
 			t2 = (duk_int_t) ((duk_uint_t) t2 << 6) | (duk_int_t) duk__base64_dectab_fast[p[7]];
-
-			q[0] = (duk_uint8_t) (((duk_uint_t) t1 >> 16) & 0xffU);
-			q[1] = (duk_uint8_t) (((duk_uint_t) t1 >> 8) & 0xffU);
-			q[2] = (duk_uint8_t) ((duk_uint_t) t1 & 0xffU);
-
-			q[3] = (duk_uint8_t) (((duk_uint_t) t2 >> 16) & 0xffU);
-			q[4] = (duk_uint8_t) (((duk_uint_t) t2 >> 8) & 0xffU);
-			q[5] = (duk_uint8_t) ((duk_uint_t) t2 & 0xffU);
+#endif  /* DUK_USE_BASE64_DECODE_TABLES */
 
 			/* Optimistic check using one branch. */
 			if (DUK_LIKELY((t1 | t2) >= 0)) {
+#if defined(DUK_USE_BASE64_DECODE_TABLES)
+				DUK_RAW_WRITE_U32_BE(q, ((duk_uint32_t) t1 << 8) | ((duk_uint32_t) t2 >> 16));
+				DUK_RAW_WRITE_U16_BE(q + 4, (duk_uint32_t) t2 & 0xffffUL);
+#else
+				q[0] = (duk_uint8_t) (((duk_uint_t) t1 >> 16) & 0xffU);
+				q[1] = (duk_uint8_t) (((duk_uint_t) t1 >> 8) & 0xffU);
+				q[2] = (duk_uint8_t) ((duk_uint_t) t1 & 0xffU);
+				q[3] = (duk_uint8_t) (((duk_uint_t) t2 >> 16) & 0xffU);
+				q[4] = (duk_uint8_t) (((duk_uint_t) t2 >> 8) & 0xffU);
+				q[5] = (duk_uint8_t) ((duk_uint_t) t2 & 0xffU);
+#endif
 				p += 8;
 				q += 6;
 			} else if (t1 >= 0) {
 				DUK_DDD(DUK_DDDPRINT("fast loop first group was clean, second was not, process one slow path group"));
 				DUK_ASSERT(t2 < 0);
+				q[0] = (duk_uint8_t) (((duk_uint_t) t1 >> 16) & 0xffU);
+				q[1] = (duk_uint8_t) (((duk_uint_t) t1 >> 8) & 0xffU);
+				q[2] = (duk_uint8_t) ((duk_uint_t) t1 & 0xffU);
 				p += 4;
 				q += 3;
 				break;
@@ -15421,9 +16099,8 @@ DUK_LOCAL duk_bool_t duk__base64_decode_helper(const duk_uint8_t *src, duk_size_
 		}
 
 		/* Slow path step 2: deal with full/partial group, padding,
-		 * etc.  Note that for num chars in [0,3] we intentionally emit
-		 * 3 bytes but don't step forward that much, buffer space is
-		 * guaranteed in setup.
+		 * etc.  Only 'step' bytes are written so that the output
+		 * bound is exact.
 		 *
 		 *  num chars:
 		 *   0      ####   no output (= step 0)
@@ -15432,15 +16109,23 @@ DUK_LOCAL duk_bool_t duk__base64_decode_helper(const duk_uint8_t *src, duk_size_
 		 *   3      ###=   18 bits of data, output 2 bytes (= step 2)
 		 *   4      ####   24 bits of data, output 3 bytes (= step 3)
 		 */
-		q[0] = (duk_uint8_t) ((t >> 16) & 0xffU);
-		q[1] = (duk_uint8_t) ((t >> 8) & 0xffU);
-		q[2] = (duk_uint8_t) (t & 0xffU);
-
 		DUK_ASSERT(n_equal <= 4);
 		step = duk__base64_decode_nequal_step[n_equal];
 		if (DUK_UNLIKELY(step < 0)) {
 			goto decode_error;
 		}
+		if (DUK_UNLIKELY((duk_size_t) (dst_end - q) < (duk_size_t) step)) {
+			goto output_full;
+		}
+		if (step >= 1) {
+			q[0] = (duk_uint8_t) ((t >> 16) & 0xffU);
+		}
+		if (step >= 2) {
+			q[1] = (duk_uint8_t) ((t >> 8) & 0xffU);
+		}
+		if (step >= 3) {
+			q[2] = (duk_uint8_t) (t & 0xffU);
+		}
 		q += step;
 
 		/* Slow path step 3: read and ignore padding and whitespace
@@ -15487,9 +16172,12 @@ DUK_LOCAL duk_bool_t duk__base64_decode_helper(const duk_uint8_t *src, duk_size_
 
  decode_error:
 	return 0;
+
+ output_full:
+	return -1;
 }
 #else  /* DUK_USE_BASE64_FASTPATH */
-DUK_LOCAL duk_bool_t duk__base64_decode_helper(const duk_uint8_t *src, duk_size_t srclen, duk_uint8_t *dst, duk_uint8_t **out_dst_final) {
+DUK_LOCAL duk_small_int_t duk__base64_decode_helper(const duk_uint8_t *src, duk_size_t srclen, duk_uint8_t *dst, duk_uint8_t *dst_end, duk_uint8_t **out_dst_final) {
 	duk_uint_t t, x;
 	duk_int_t y;
 	duk_int8_t step;
@@ -15599,16 +16287,24 @@ DUK_LOCAL duk_bool_t duk__base64_decode_helper(const duk_uint8_t *src, duk_size_
 			n_equal++;
 		}
 
-		/* Output 3 bytes from 't' and advance as needed. */
-		q[0] = (duk_uint8_t) ((t >> 16) & 0xffU);
-		q[1] = (duk_uint8_t) ((t >> 8) & 0xffU);
-		q[2] = (duk_uint8_t) (t & 0xffU);
-
+		/* Output 'step' bytes from 't'. */
 		DUK_ASSERT(n_equal <= 4U);
 		step = duk__base64_decode_nequal_step[n_equal];
 		if (step < 0) {
 			goto decode_error;
 		}
+		if ((duk_size_t) (dst_end - q) < (duk_size_t) step) {
+			goto output_full;
+		}
+		if (step >= 1) {
+			q[0] = (duk_uint8_t) ((t >> 16) & 0xffU);
+		}
+		if (step >= 2) {
+			q[1] = (duk_uint8_t) ((t >> 8) & 0xffU);
+		}
+		if (step >= 3) {
+			q[2] = (duk_uint8_t) (t & 0xffU);
+		}
 		q += step;
 
 		/* Re-enter loop.  The actual padding characters are skipped
@@ -15626,6 +16322,9 @@ DUK_LOCAL duk_bool_t duk__base64_decode_helper(const duk_uint8_t *src, duk_size_
 
  decode_error:
 	return 0;
+
+ output_full:
+	return -1;
 }
 #endif  /* DUK_USE_BASE64_FASTPATH */
 
@@ -15687,9 +16386,9 @@ DUK_EXTERNAL void duk_base64_decode(duk_hthread *thr, duk_idx_t idx) {
 	 */
 	dstlen = (srclen / 4) * 3 + 6;  /* upper limit, assuming no whitespace etc */
 	dst = (duk_uint8_t *) duk_push_dynamic_buffer(thr, dstlen);
-	/* Note: for dstlen=0, dst may be NULL */
+	DUK_ASSERT(dst != NULL);  /* dstlen > 0 */
 
-	if (!duk__base64_decode_helper((const duk_uint8_t *) src, srclen, dst, &dst_final)) {
+	if (duk__base64_decode_helper((const duk_uint8_t *) src, srclen, dst, dst + dstlen, &dst_final) <= 0) {
 		goto type_error;
 	}
 
@@ -15702,6 +16401,48 @@ DUK_EXTERNAL void duk_base64_decode(duk_hthread *thr, duk_idx_t idx) {
 	DUK_ERROR_TYPE(thr, DUK_STR_BASE64_DECODE_FAILED);
 	DUK_WO_NORETURN(return;);
 }
+
+#if defined(DUK_USE_CODEC_DECODE_INTO)
+/* Decode into [buf,buf+len[ and return the number of bytes written.  The
+ * decoder never writes ahead of the input it has consumed, so 'buf' may
+ * overlap the input if it starts at or before it, e.g. for in-place
+ * decoding.  On error the target may contain partial output.
+ */
+DUK_EXTERNAL duk_size_t duk_base64_decode_into(duk_hthread *thr, duk_idx_t idx, void *buf, duk_size_t len) {
+	const duk_uint8_t *src;
+	duk_size_t srclen;
+	duk_uint8_t dummy;
+	duk_uint8_t *dst;
+	duk_uint8_t *dst_final;
+	duk_small_int_t rc;
+
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_ASSERT(buf != NULL || len == 0);
+
+	idx = duk_require_normalize_index(thr, idx);
+	src = duk__prep_codec_arg(thr, idx, &srclen);
+	DUK_ASSERT(src != NULL);
+
+	dst = (buf != NULL ? (duk_uint8_t *) buf : &dummy);  /* avoid NULL pointer arithmetic */
+	rc = duk__base64_decode_helper(src, srclen, dst, dst + (buf != NULL ? len : 0), &dst_final);
+	if (DUK_UNLIKELY(rc < 0)) {
+		DUK_ERROR_RANGE(thr, DUK_STR_RESULT_TOO_LONG);
+		DUK_WO_NORETURN(return 0;);
+	} else if (DUK_UNLIKELY(rc == 0)) {
+		DUK_ERROR_TYPE(thr, DUK_STR_BASE64_DECODE_FAILED);
+		DUK_WO_NORETURN(return 0;);
+	}
+	return (duk_size_t) (dst_final - dst);
+}
+#else  /* DUK_USE_CODEC_DECODE_INTO */
+DUK_EXTERNAL duk_size_t duk_base64_decode_into(duk_hthread *thr, duk_idx_t idx, void *buf, duk_size_t len) {
+	DUK_UNREF(idx);
+	DUK_UNREF(buf);
+	DUK_UNREF(len);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return 0;);
+}
+#endif  /* DUK_USE_CODEC_DECODE_INTO */
 #else  /* DUK_USE_BASE64_SUPPORT */
 DUK_EXTERNAL const char *duk_base64_encode(duk_hthread *thr, duk_idx_t idx) {
 	DUK_UNREF(idx);
@@ -15714,6 +16455,14 @@ DUK_EXTERNAL void duk_base64_decode(duk_hthread *thr, duk_idx_t idx) {
 	DUK_ERROR_UNSUPPORTED(thr);
 	DUK_WO_NORETURN(return;);
 }
+
+DUK_EXTERNAL duk_size_t duk_base64_decode_into(duk_hthread *thr, duk_idx_t idx, void *buf, duk_size_t len) {
+	DUK_UNREF(idx);
+	DUK_UNREF(buf);
+	DUK_UNREF(len);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return 0;);
+}
 #endif  /* DUK_USE_BASE64_SUPPORT */
 
 /*
@@ -15777,31 +16526,21 @@ DUK_EXTERNAL const char *duk_hex_encode(duk_hthread *thr, duk_idx_t idx) {
 	return ret;
 }
 
-DUK_EXTERNAL void duk_hex_decode(duk_hthread *thr, duk_idx_t idx) {
-	const duk_uint8_t *inp;
-	duk_size_t len;
+/* Decode 'len' (even) hex characters into 'buf', which must have room for
+ * len / 2 bytes.  Returns 0 for invalid input, in which case 'buf' may
+ * contain partial output.  Output is never written ahead of the input
+ * consumed, so in-place decoding is safe.
+ */
+DUK_LOCAL duk_bool_t duk__hex_decode_helper(const duk_uint8_t *inp, duk_size_t len, duk_uint8_t *buf) {
 	duk_size_t i;
 	duk_int_t t;
-	duk_uint8_t *buf;
 #if defined(DUK_USE_HEX_FASTPATH)
 	duk_int_t chk;
 	duk_uint8_t *p;
 	duk_size_t len_safe;
 #endif
 
-	DUK_ASSERT_API_ENTRY(thr);
-
-	idx = duk_require_normalize_index(thr, idx);
-	inp = duk__prep_codec_arg(thr, idx, &len);
-	DUK_ASSERT(inp != NULL);
-
-	if (len & 0x01) {
-		goto type_error;
-	}
-
-	/* Fixed buffer, no zeroing because we'll fill all the data. */
-	buf = (duk_uint8_t *) duk_push_fixed_buffer_nozero(thr, len / 2);
-	DUK_ASSERT(buf != NULL);
+	DUK_ASSERT((len & 0x01U) == 0);
 
 #if defined(DUK_USE_HEX_FASTPATH)
 	p = buf;
@@ -15827,7 +16566,7 @@ DUK_EXTERNAL void duk_hex_decode(duk_hthread *thr, duk_idx_t idx) {
 
 		/* Check if any lookup above had a negative result. */
 		if (DUK_UNLIKELY(chk < 0)) {
-			goto type_error;
+			return 0;
 		}
 	}
 	for (; i < len; i += 2) {
@@ -15838,7 +16577,7 @@ DUK_EXTERNAL void duk_hex_decode(duk_hthread *thr, duk_idx_t idx) {
 		t = (duk_int_t) ((((duk_uint_t) (duk_int_t) duk_hex_dectab[inp[i]]) << 4U) |
 		                 ((duk_uint_t) (duk_int_t) duk_hex_dectab[inp[i + 1]]));
 		if (DUK_UNLIKELY(t < 0)) {
-			goto type_error;
+			return 0;
 		}
 		*p++ = (duk_uint8_t) t;
 	}
@@ -15851,12 +16590,38 @@ DUK_EXTERNAL void duk_hex_decode(duk_hthread *thr, duk_idx_t idx) {
 		t = (duk_int_t) ((((duk_uint_t) (duk_int_t) duk_hex_dectab[inp[i]]) << 4U) |
 		                 ((duk_uint_t) (duk_int_t) duk_hex_dectab[inp[i + 1]]));
 		if (DUK_UNLIKELY(t < 0)) {
-			goto type_error;
+			return 0;
 		}
 		buf[i >> 1] = (duk_uint8_t) t;
 	}
 #endif  /* DUK_USE_HEX_FASTPATH */
 
+	return 1;
+}
+
+DUK_EXTERNAL void duk_hex_decode(duk_hthread *thr, duk_idx_t idx) {
+	const duk_uint8_t *inp;
+	duk_size_t len;
+	duk_uint8_t *buf;
+
+	DUK_ASSERT_API_ENTRY(thr);
+
+	idx = duk_require_normalize_index(thr, idx);
+	inp = duk__prep_codec_arg(thr, idx, &len);
+	DUK_ASSERT(inp != NULL);
+
+	if (len & 0x01) {
+		goto type_error;
+	}
+
+	/* Fixed buffer, no zeroing because we'll fill all the data. */
+	buf = (duk_uint8_t *) duk_push_fixed_buffer_nozero(thr, len / 2);
+	DUK_ASSERT(buf != NULL);
+
+	if (!duk__hex_decode_helper(inp, len, buf)) {
+		goto type_error;
+	}
+
 	duk_replace(thr, idx);
 	return;
 
@@ -15864,6 +16629,47 @@ DUK_EXTERNAL void duk_hex_decode(duk_hthread *thr, duk_idx_t idx) {
 	DUK_ERROR_TYPE(thr, DUK_STR_HEX_DECODE_FAILED);
 	DUK_WO_NORETURN(return;);
 }
+
+#if defined(DUK_USE_CODEC_DECODE_INTO)
+/* Like duk_base64_decode_into(), but the output size is known up front so
+ * a target that is too small is rejected before anything is written.
+ */
+DUK_EXTERNAL duk_size_t duk_hex_decode_into(duk_hthread *thr, duk_idx_t idx, void *buf, duk_size_t len) {
+	const duk_uint8_t *inp;
+	duk_size_t inp_len;
+
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_ASSERT(buf != NULL || len == 0);
+
+	idx = duk_require_normalize_index(thr, idx);
+	inp = duk__prep_codec_arg(thr, idx, &inp_len);
+	DUK_ASSERT(inp != NULL);
+
+	if (inp_len & 0x01) {
+		goto type_error;
+	}
+	if (inp_len / 2 > len) {
+		DUK_ERROR_RANGE(thr, DUK_STR_RESULT_TOO_LONG);
+		DUK_WO_NORETURN(return 0;);
+	}
+	if (inp_len > 0 && !duk__hex_decode_helper(inp, inp_len, (duk_uint8_t *) buf)) {
+		goto type_error;
+	}
+	return inp_len / 2;
+
+ type_error:
+	DUK_ERROR_TYPE(thr, DUK_STR_HEX_DECODE_FAILED);
+	DUK_WO_NORETURN(return 0;);
+}
+#else  /* DUK_USE_CODEC_DECODE_INTO */
+DUK_EXTERNAL duk_size_t duk_hex_decode_into(duk_hthread *thr, duk_idx_t idx, void *buf, duk_size_t len) {
+	DUK_UNREF(idx);
+	DUK_UNREF(buf);
+	DUK_UNREF(len);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return 0;);
+}
+#endif  /* DUK_USE_CODEC_DECODE_INTO */
 #else  /* DUK_USE_HEX_SUPPORT */
 DUK_EXTERNAL const char *duk_hex_encode(duk_hthread *thr, duk_idx_t idx) {
 	DUK_UNREF(idx);
@@ -15875,6 +16681,13 @@ DUK_EXTERNAL void duk_hex_decode(duk_hthread *thr, duk_idx_t idx) {
 	DUK_ERROR_UNSUPPORTED(thr);
 	DUK_WO_NORETURN(return;);
 }
+DUK_EXTERNAL duk_size_t duk_hex_decode_into(duk_hthread *thr, duk_idx_t idx, void *buf, duk_size_t len) {
+	DUK_UNREF(idx);
+	DUK_UNREF(buf);
+	DUK_UNREF(len);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return 0;);
+}
 #endif  /* DUK_USE_HEX_SUPPORT */
 
 /*
@@ -15898,7 +16711,8 @@ DUK_EXTERNAL const char *duk_json_encode(duk_hthread *thr, duk_idx_t idx) {
 	                             idx /*idx_value*/,
 	                             DUK_INVALID_INDEX /*idx_replacer*/,
 	                             DUK_INVALID_INDEX /*idx_space*/,
-	                             0 /*flags*/);
+	                             0 /*flags*/,
+	                             NULL /*sink*/);
 	DUK_ASSERT(duk_is_string(thr, -1));
 	duk_replace(thr, idx);
 	ret = duk_get_string(thr, idx);
@@ -15908,6 +16722,45 @@ DUK_EXTERNAL const char *duk_json_encode(duk_hthread *thr, duk_idx_t idx) {
 	return ret;
 }
 
+DUK_EXTERNAL duk_size_t duk_json_encode_sink(duk_hthread *thr, duk_idx_t idx, duk_json_sink_function sink, void *udata, duk_size_t chunk_size) {
+#if defined(DUK_USE_JSON_STRINGIFY_SINK)
+	duk_json_sink sink_alloc;
+	duk_size_t ret;
+
+	DUK_ASSERT_API_ENTRY(thr);
+
+	if (sink == NULL) {
+		DUK_ERROR_TYPE_INVALID_ARGS(thr);
+		DUK_WO_NORETURN(return 0;);
+	}
+
+	idx = duk_require_normalize_index(thr, idx);
+	sink_alloc.func = sink;
+	sink_alloc.udata = udata;
+	sink_alloc.idx_func = DUK_INVALID_INDEX;
+	sink_alloc.chunk_size = chunk_size;
+	duk_bi_json_stringify_helper(thr,
+	                             idx /*idx_value*/,
+	                             DUK_INVALID_INDEX /*idx_replacer*/,
+	                             DUK_INVALID_INDEX /*idx_space*/,
+	                             0 /*flags*/,
+	                             &sink_alloc);
+
+	/* Byte count, or undefined if nothing was serialized. */
+	ret = (duk_size_t) duk_get_uint(thr, -1);
+	duk_pop(thr);
+	return ret;
+#else
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_UNREF(idx);
+	DUK_UNREF(sink);
+	DUK_UNREF(udata);
+	DUK_UNREF(chunk_size);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return 0;);
+#endif
+}
+
 DUK_EXTERNAL void duk_json_decode(duk_hthread *thr, duk_idx_t idx) {
 #if defined(DUK_USE_ASSERTIONS)
 	duk_idx_t top_at_entry;
@@ -15935,6 +16788,16 @@ DUK_EXTERNAL const char *duk_json_encode(duk_hthread *thr, duk_idx_t idx) {
 	DUK_WO_NORETURN(return NULL;);
 }
 
+DUK_EXTERNAL duk_size_t duk_json_encode_sink(duk_hthread *thr, duk_idx_t idx, duk_json_sink_function sink, void *udata, duk_size_t chunk_size) {
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_UNREF(idx);
+	DUK_UNREF(sink);
+	DUK_UNREF(udata);
+	DUK_UNREF(chunk_size);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return 0;);
+}
+
 DUK_EXTERNAL void duk_json_decode(duk_hthread *thr, duk_idx_t idx) {
 	DUK_ASSERT_API_ENTRY(thr);
 	DUK_UNREF(idx);
@@ -16147,7 +17010,8 @@ DUK_EXTERNAL void duk_push_context_dump(duk_hthread *thr) {
 	                             DUK_INVALID_INDEX,  /*idx_space*/
 	                             DUK_JSON_FLAG_EXT_CUSTOM |
 	                             DUK_JSON_FLAG_ASCII_ONLY |
-	                             DUK_JSON_FLAG_AVOID_KEY_QUOTES /*flags*/);
+	                             DUK_JSON_FLAG_AVOID_KEY_QUOTES /*flags*/,
+	                             NULL /*sink*/);
 
 	duk_push_sprintf(thr, "ctx: top=%ld, stack=%s", (long) top, (const char *) duk_safe_to_string(thr, -1));
 	duk_replace(thr, -3);  /* [ ... arr jsonx(arr) res ] -> [ ... res jsonx(arr) ] */
@@ -16831,6 +17695,592 @@ DUK_EXTERNAL void duk_inspect_callstack_entry(duk_hthread *thr, duk_int_t level)
 #undef DUK__IDX_TSTATE
 #undef DUK__IDX_TYPE
 #undef DUK__IDX_VARIANT
+/*
+ *  Profiler: sampling and instrumentation.
+ *
+ *  Samples are taken from the executor interrupt every 'prof_interval'
+ *  opcodes.  Each sample walks the current activation chain (up to
+ *  DUK_USE_PROFILER_MAXDEPTH frames) and formats it as a folded stack line
+ *  ("outer:12;inner:40") which is then aggregated into a fixed size native
+ *  buffer.  Sampling never allocates or touches the value stack, so its
+ *  cost is bounded by the max depth and the buffer size.  The buffer can
+ *  be exported as folded stack text ("<stack> <count>\n" lines) which is
+ *  the input format of the usual flamegraph tools.
+ *
+ *  Instrumentation counts calls and inclusive time per compiled function
+ *  (see duk__call_profiler_enter() and duk__activation_unwind_nofree_norz()).
+ *  Counters live in a heap table keyed by the function's 'data' buffer so
+ *  that all closures of a function share one entry.  It has a cost on every
+ *  call so it's a separate option, and compiles out entirely when disabled.
+ */
+
+/* #include duk_internal.h -> already included */
+
+#if defined(DUK_USE_PROFILER_SAMPLING)
+
+/* Record header in heap->prof_buf, followed by 'len' bytes of folded stack
+ * text, padded to a multiple of 4 bytes.
+ */
+typedef struct {
+	duk_uint32_t hash;
+	duk_uint32_t count;
+	duk_uint32_t len;
+} duk__prof_record;
+
+#define DUK__PROF_NAME_MAXLEN   32
+#define DUK__PROF_LINE_MAXLEN   (DUK_USE_PROFILER_MAXDEPTH * (DUK__PROF_NAME_MAXLEN + 12) + 4)
+#define DUK__PROF_ALIGN(x)      (((x) + 3U) & ~((duk_uint32_t) 3U))
+
+DUK_LOCAL duk_uint8_t *duk__prof_append_frame(duk_hthread *thr, duk_activation *act, duk_uint8_t *p) {
+	duk_hobject *func;
+	duk_tval *tv;
+	duk_hstring *h_name;
+	const duk_uint8_t *name;
+	duk_size_t name_len;
+	duk_size_t i;
+
+	func = DUK_ACT_GET_FUNC(act);
+	if (func == NULL) {
+		/* Lightfuncs have no name property of their own. */
+		name = (const duk_uint8_t *) "(lightfunc)";
+		name_len = 11;
+	} else {
+		tv = duk_hobject_find_entry_tval_ptr_stridx(thr->heap, func, DUK_STRIDX_NAME);
+		h_name = (tv != NULL && DUK_TVAL_IS_STRING(tv)) ? DUK_TVAL_GET_STRING(tv) : NULL;
+		if (h_name != NULL && DUK_HSTRING_GET_BYTELEN(h_name) > 0) {
+			name = DUK_HSTRING_GET_DATA(h_name);
+			name_len = DUK_HSTRING_GET_BYTELEN(h_name);
+		} else {
+			name = (const duk_uint8_t *) "(anon)";
+			name_len = 6;
+		}
+	}
+
+	if (name_len > DUK__PROF_NAME_MAXLEN) {
+		/* Don't cut in the middle of an UTF-8 sequence. */
+		name_len = DUK__PROF_NAME_MAXLEN;
+		while (name_len > 0 && (name[name_len] & 0xc0U) == 0x80U) {
+			name_len--;
+		}
+	}
+	for (i = 0; i < name_len; i++) {
+		duk_uint8_t c = name[i];
+		/* ';' and whitespace are separators in the folded format. */
+		*p++ = (c == (duk_uint8_t) ';' || c <= 0x20U) ? (duk_uint8_t) '_' : c;
+	}
+
+#if defined(DUK_USE_PC2LINE)
+	if (func != NULL && DUK_HOBJECT_IS_COMPFUNC(func)) {
+		duk_uint_fast32_t line;
+
+		line = duk_hobject_pc2line_query_func(thr, func, duk_hthread_get_act_prev_pc(thr, act));
+		p += DUK_SPRINTF((char *) p, ":%lu", (unsigned long) line);
+	}
+#endif
+
+	return p;
+}
+
+DUK_INTERNAL void duk_heap_profiler_sample(duk_hthread *thr) {
+	duk_heap *heap;
+	duk_activation *frames[DUK_USE_PROFILER_MAXDEPTH];
+	duk_activation *act;
+	duk_uint8_t line[DUK__PROF_LINE_MAXLEN];
+	duk_uint8_t *p;
+	duk_small_uint_t nframes;
+	duk_uint32_t len;
+	duk_uint32_t hash;
+	duk_uint32_t off;
+	duk_uint32_t i;
+	duk__prof_record *rec;
+	duk_double_t t_start;
+
+	DUK_ASSERT(thr != NULL);
+	heap = thr->heap;
+	DUK_ASSERT(heap->prof_buf != NULL);
+
+	t_start = duk_time_get_monotonic_time(thr);
+
+	/* Activations are linked leaf first, folded stacks are root first. */
+	nframes = 0;
+	for (act = thr->callstack_curr; act != NULL && nframes < DUK_USE_PROFILER_MAXDEPTH; act = act->parent) {
+		frames[nframes++] = act;
+	}
+
+	p = line;
+	if (act != NULL) {
+		/* Truncated, mark the missing outer frames. */
+		*p++ = (duk_uint8_t) '.';
+		*p++ = (duk_uint8_t) '.';
+		*p++ = (duk_uint8_t) '.';
+	}
+	while (nframes > 0) {
+		if (p != line) {
+			*p++ = (duk_uint8_t) ';';
+		}
+		p = duk__prof_append_frame(thr, frames[--nframes], p);
+	}
+	len = (duk_uint32_t) (p - line);
+	DUK_ASSERT(len <= sizeof(line));
+
+	/* FNV-1a; only used to make the record scan cheap. */
+	hash = 2166136261UL;
+	for (i = 0; i < len; i++) {
+		hash = (hash ^ (duk_uint32_t) line[i]) * 16777619UL;
+	}
+
+	off = 0;
+	while (off < heap->prof_used) {
+		rec = (duk__prof_record *) (void *) (heap->prof_buf + off);
+		if (rec->hash == hash && rec->len == len &&
+		    duk_memcmp((const void *) (rec + 1), (const void *) line, (size_t) len) == 0) {
+			rec->count++;
+			heap->prof_samples++;
+			goto done;
+		}
+		off += (duk_uint32_t) sizeof(duk__prof_record) + DUK__PROF_ALIGN(rec->len);
+	}
+
+	if ((duk_uint32_t) sizeof(duk__prof_record) + DUK__PROF_ALIGN(len) > (duk_uint32_t) DUK_USE_PROFILER_BUFSIZE - heap->prof_used) {
+		heap->prof_dropped++;
+		goto done;
+	}
+	rec = (duk__prof_record *) (void *) (heap->prof_buf + heap->prof_used);
+	rec->hash = hash;
+	rec->count = 1;
+	rec->len = len;
+	duk_memcpy((void *) (rec + 1), (const void *) line, (size_t) len);
+	heap->prof_used += (duk_uint32_t) sizeof(duk__prof_record) + DUK__PROF_ALIGN(len);
+	heap->prof_samples++;
+
+ done:
+	heap->prof_overhead += duk_time_get_monotonic_time(thr) - t_start;
+}
+
+DUK_EXTERNAL void duk_profiler_start(duk_hthread *thr, duk_uint_t interval) {
+	duk_heap *heap;
+
+	DUK_ASSERT_API_ENTRY(thr);
+	heap = thr->heap;
+
+	if (heap->prof_buf == NULL) {
+		heap->prof_buf = (duk_uint8_t *) DUK_ALLOC_CHECKED(thr, DUK_USE_PROFILER_BUFSIZE);
+		heap->prof_used = 0;
+	}
+	if (interval == 0) {
+		interval = DUK_USE_PROFILER_INTERVAL;
+	} else if (interval > (duk_uint_t) DUK_HTHREAD_INTCTR_DEFAULT) {
+		interval = (duk_uint_t) DUK_HTHREAD_INTCTR_DEFAULT;
+	}
+	heap->prof_interval = (duk_uint32_t) interval;
+	heap->prof_enabled = 1;
+
+	DUK_D(DUK_DPRINT("profiler started, interval=%ld opcodes", (long) interval));
+
+	/* Interrupt on the next opcode so that the new interval takes effect
+	 * right away instead of after the default interrupt interval.
+	 */
+	thr->interrupt_init = 1;
+	thr->interrupt_counter = 0;
+}
+
+DUK_EXTERNAL void duk_profiler_stop(duk_hthread *thr) {
+	DUK_ASSERT_API_ENTRY(thr);
+
+	/* Samples are kept until duk_profiler_reset(). */
+	thr->heap->prof_enabled = 0;
+}
+
+DUK_EXTERNAL void duk_profiler_push_folded(duk_hthread *thr) {
+	duk_heap *heap;
+	duk_bufwriter_ctx bw_alloc;
+	duk_bufwriter_ctx *bw = &bw_alloc;
+	duk_uint32_t off;
+	duk__prof_record *rec;
+	char count_buf[16];
+	duk_size_t count_len;
+
+	DUK_ASSERT_API_ENTRY(thr);
+	heap = thr->heap;
+
+	DUK_BW_INIT_PUSHBUF(thr, bw, (duk_size_t) heap->prof_used);
+	off = 0;
+	while (off < heap->prof_used) {
+		/* prof_buf is a native allocation, so it's stable across
+		 * bufwriter resizes.
+		 */
+		rec = (duk__prof_record *) (void *) (heap->prof_buf + off);
+		count_len = (duk_size_t) DUK_SNPRINTF(count_buf, sizeof(count_buf), " %lu\n", (unsigned long) rec->count);
+		count_buf[sizeof(count_buf) - 1] = (char) 0;
+		DUK_BW_WRITE_ENSURE_BYTES(thr, bw, (const duk_uint8_t *) (rec + 1), (duk_size_t) rec->len);
+		DUK_BW_WRITE_ENSURE_BYTES(thr, bw, (const duk_uint8_t *) count_buf, count_len);
+		off += (duk_uint32_t) sizeof(duk__prof_record) + DUK__PROF_ALIGN(rec->len);
+	}
+	DUK_BW_COMPACT(thr, bw);
+	(void) duk_buffer_to_string(thr, -1);
+}
+
+DUK_EXTERNAL void duk_profiler_inspect(duk_hthread *thr) {
+	duk_heap *heap;
+
+	DUK_ASSERT_API_ENTRY(thr);
+	heap = thr->heap;
+
+	duk_push_bare_object(thr);
+	duk_push_boolean(thr, heap->prof_enabled);
+	duk_put_prop_literal(thr, -2, "running");
+	duk_push_uint(thr, (duk_uint_t) heap->prof_interval);
+	duk_put_prop_literal(thr, -2, "interval");
+	duk_push_uint(thr, (duk_uint_t) heap->prof_samples);
+	duk_put_prop_literal(thr, -2, "samples");
+	duk_push_uint(thr, (duk_uint_t) heap->prof_dropped);
+	duk_put_prop_literal(thr, -2, "dropped");
+	duk_push_uint(thr, (duk_uint_t) heap->prof_used);
+	duk_put_prop_literal(thr, -2, "bytesUsed");
+	duk_push_uint(thr, (duk_uint_t) DUK_USE_PROFILER_BUFSIZE);
+	duk_put_prop_literal(thr, -2, "bytesTotal");
+	duk_push_number(thr, heap->prof_overhead);
+	duk_put_prop_literal(thr, -2, "overheadMs");
+}
+
+#else  /* DUK_USE_PROFILER_SAMPLING */
+
+DUK_EXTERNAL void duk_profiler_start(duk_hthread *thr, duk_uint_t interval) {
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_UNREF(interval);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return;);
+}
+
+DUK_EXTERNAL void duk_profiler_stop(duk_hthread *thr) {
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return;);
+}
+
+DUK_EXTERNAL void duk_profiler_push_folded(duk_hthread *thr) {
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return;);
+}
+
+DUK_EXTERNAL void duk_profiler_inspect(duk_hthread *thr) {
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return;);
+}
+
+#endif  /* DUK_USE_PROFILER_SAMPLING */
+
+#if defined(DUK_USE_PROFILER_INSTRUMENT)
+
+#define DUK__PROF_FUNCS_MINSIZE  16
+#define DUK__PROF_FUNCS_MAXSIZE  65536UL  /* table stops growing, further functions aren't counted */
+
+DUK_LOCAL duk_uint32_t duk__prof_func_hash(duk_hbuffer *data) {
+	/* Heap pointers are at least 8 byte aligned in practice. */
+	return (duk_uint32_t) ((duk_uintptr_t) (void *) data >> 3) * 2654435761UL;
+}
+
+/* Find the slot for 'data' in 'funcs', which is the matching entry or the
+ * unused slot where it would be inserted.
+ */
+DUK_LOCAL duk_prof_entry *duk__prof_func_slot(duk_prof_entry *funcs, duk_uint32_t size, duk_hbuffer *data) {
+	duk_uint32_t mask;
+	duk_uint32_t i;
+
+	DUK_ASSERT(funcs != NULL);
+	DUK_ASSERT(size > 0 && (size & (size - 1)) == 0);
+
+	mask = size - 1;
+	i = duk__prof_func_hash(data) & mask;
+	while (funcs[i].data != NULL && funcs[i].data != data) {
+		i = (i + 1) & mask;
+	}
+	return funcs + i;
+}
+
+/* Resize the table to 'new_size' slots, rehashing the current entries.
+ * No side effects; returns 0 and leaves the table as is if allocation
+ * fails.
+ */
+DUK_LOCAL duk_bool_t duk__prof_funcs_resize(duk_heap *heap, duk_uint32_t new_size) {
+	duk_prof_entry *old_funcs;
+	duk_prof_entry *new_funcs;
+	duk_uint32_t old_size;
+	duk_uint32_t i;
+
+	new_funcs = NULL;
+	if (new_size <= DUK__PROF_FUNCS_MAXSIZE) {
+		new_funcs = (duk_prof_entry *) DUK_ALLOC_RAW(heap, sizeof(duk_prof_entry) * (duk_size_t) new_size);
+	}
+	if (new_funcs == NULL) {
+		DUK_D(DUK_DPRINT("failed to resize instrumentation table to %ld entries", (long) new_size));
+		return 0;
+	}
+	duk_memzero((void *) new_funcs, sizeof(duk_prof_entry) * (duk_size_t) new_size);
+#if defined(DUK_USE_EXPLICIT_NULL_INIT)
+	for (i = 0; i < new_size; i++) {
+		new_funcs[i].data = NULL;
+	}
+#endif
+
+	old_funcs = heap->prof_funcs;
+	old_size = heap->prof_funcs_size;
+	for (i = 0; i < old_size; i++) {
+		if (old_funcs[i].data != NULL) {
+			*duk__prof_func_slot(new_funcs, new_size, old_funcs[i].data) = old_funcs[i];
+		}
+	}
+	DUK_FREE_RAW(heap, old_funcs);
+
+	heap->prof_funcs = new_funcs;
+	heap->prof_funcs_size = new_size;
+	return 1;
+}
+
+DUK_INTERNAL duk_prof_entry *duk_heap_profiler_func_lookup(duk_heap *heap, duk_hcompfunc *fun) {
+	duk_hbuffer *data;
+	duk_prof_entry *e;
+
+	if (heap->prof_funcs == NULL) {
+		return NULL;
+	}
+	data = (duk_hbuffer *) DUK_HCOMPFUNC_GET_DATA(heap, fun);
+	DUK_ASSERT(data != NULL);
+	e = duk__prof_func_slot(heap->prof_funcs, heap->prof_funcs_size, data);
+	return (e->data != NULL ? e : NULL);
+}
+
+/* Entry for 'fun', created on its first instrumented call.  Called from
+ * call setup so there must be no side effects: the table uses the raw
+ * allocator and the name, fileName and line are read directly from the
+ * function.  Returns NULL if the table can't grow.
+ */
+DUK_INTERNAL duk_prof_entry *duk_heap_profiler_func_enter(duk_hthread *thr, duk_hcompfunc *fun) {
+	duk_heap *heap;
+	duk_hbuffer *data;
+	duk_prof_entry *e;
+	duk_tval *tv;
+
+	heap = thr->heap;
+	data = (duk_hbuffer *) DUK_HCOMPFUNC_GET_DATA(heap, fun);
+	DUK_ASSERT(data != NULL);
+
+	if (heap->prof_funcs != NULL) {
+		e = duk__prof_func_slot(heap->prof_funcs, heap->prof_funcs_size, data);
+		if (DUK_LIKELY(e->data != NULL)) {
+			return e;
+		}
+	}
+
+	/* Keep load factor at or below 3/4 so that probing stays short. */
+	if ((heap->prof_funcs_used + 1) * 4 > heap->prof_funcs_size * 3) {
+		if (!duk__prof_funcs_resize(heap, heap->prof_funcs_size == 0 ? DUK__PROF_FUNCS_MINSIZE : heap->prof_funcs_size * 2)) {
+			return NULL;
+		}
+	}
+	e = duk__prof_func_slot(heap->prof_funcs, heap->prof_funcs_size, data);
+	DUK_ASSERT(e->data == NULL);
+	heap->prof_funcs_used++;
+
+	e->data = data;
+	DUK_HBUFFER_INCREF(thr, data);
+	tv = duk_hobject_find_entry_tval_ptr_stridx(heap, (duk_hobject *) fun, DUK_STRIDX_NAME);
+	e->name = NULL;
+	if (tv != NULL && DUK_TVAL_IS_STRING(tv)) {
+		e->name = DUK_TVAL_GET_STRING(tv);
+		DUK_HSTRING_INCREF(thr, e->name);
+	}
+	tv = duk_hobject_find_entry_tval_ptr_stridx(heap, (duk_hobject *) fun, DUK_STRIDX_FILE_NAME);
+	e->filename = NULL;
+	if (tv != NULL && DUK_TVAL_IS_STRING(tv)) {
+		e->filename = DUK_TVAL_GET_STRING(tv);
+		DUK_HSTRING_INCREF(thr, e->filename);
+	}
+#if defined(DUK_USE_PC2LINE)
+	e->line = (duk_uint32_t) duk_hobject_pc2line_query_func(thr, (duk_hobject *) fun, 0);
+#else
+	e->line = 0;
+#endif
+	e->calls = 0;
+	e->depth = 0;
+	e->time = 0.0;
+
+	DUK_DD(DUK_DDPRINT("new instrumentation entry for %!O, %ld entries", (duk_heaphdr *) fun, (long) heap->prof_funcs_used));
+	return e;
+}
+
+DUK_EXTERNAL void duk_profiler_instrument(duk_hthread *thr, duk_bool_t enable) {
+	DUK_ASSERT_API_ENTRY(thr);
+
+	/* Activations already running when this is toggled are handled
+	 * consistently because each activation records whether it was
+	 * instrumented on entry.
+	 */
+	thr->heap->prof_instrument = enable;
+}
+
+DUK_EXTERNAL void duk_profiler_push_report(duk_hthread *thr) {
+	duk_heap *heap;
+	duk_prof_entry *e;
+	duk_idx_t idx_arr;
+	duk_idx_t idx_val;
+	duk_uarridx_t count;
+	duk_uarridx_t i;
+
+	DUK_ASSERT_API_ENTRY(thr);
+	heap = thr->heap;
+
+	idx_arr = duk_push_array(thr);
+
+	/* Count first and reserve value stack so that the second walk, which
+	 * copies each entry to the value stack, can't trigger a GC.  A GC
+	 * during the reserve may add entries (finalizer calls), which are
+	 * then left out.
+	 */
+	count = 0;
+	for (i = 0; i < heap->prof_funcs_size; i++) {
+		if (heap->prof_funcs[i].data != NULL && heap->prof_funcs[i].calls > 0) {
+			count++;
+		}
+	}
+	duk_require_stack(thr, (duk_idx_t) count * 5);
+	idx_val = duk_get_top(thr);
+	for (i = 0; i < heap->prof_funcs_size && count > 0; i++) {
+		e = heap->prof_funcs + i;
+		if (e->data == NULL || e->calls == 0) {
+			continue;
+		}
+		if (e->name != NULL) {
+			duk_push_hstring(thr, e->name);
+		} else {
+			duk_push_undefined(thr);
+		}
+		if (e->filename != NULL) {
+			duk_push_hstring(thr, e->filename);
+		} else {
+			duk_push_undefined(thr);
+		}
+		duk_push_uint(thr, (duk_uint_t) e->line);
+		duk_push_uint(thr, (duk_uint_t) e->calls);
+		duk_push_number(thr, e->time);
+		count--;
+	}
+
+	for (i = 0; idx_val + (duk_idx_t) i * 5 < duk_get_top(thr); i++) {
+		duk_push_bare_object(thr);
+		duk_dup(thr, idx_val + (duk_idx_t) i * 5);
+		duk_put_prop_stridx_short(thr, -2, DUK_STRIDX_NAME);
+		duk_dup(thr, idx_val + (duk_idx_t) i * 5 + 1);
+		duk_put_prop_stridx_short(thr, -2, DUK_STRIDX_FILE_NAME);
+		duk_dup(thr, idx_val + (duk_idx_t) i * 5 + 2);
+		duk_put_prop_stridx_short(thr, -2, DUK_STRIDX_LINE_NUMBER);
+		duk_dup(thr, idx_val + (duk_idx_t) i * 5 + 3);
+		duk_put_prop_literal(thr, -2, "calls");
+		duk_dup(thr, idx_val + (duk_idx_t) i * 5 + 4);
+		duk_put_prop_literal(thr, -2, "time");
+		duk_put_prop_index(thr, idx_arr, i);
+	}
+
+	duk_set_top(thr, idx_arr + 1);
+}
+
+#else  /* DUK_USE_PROFILER_INSTRUMENT */
+
+DUK_EXTERNAL void duk_profiler_instrument(duk_hthread *thr, duk_bool_t enable) {
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_UNREF(enable);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return;);
+}
+
+DUK_EXTERNAL void duk_profiler_push_report(duk_hthread *thr) {
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return;);
+}
+
+#endif  /* DUK_USE_PROFILER_INSTRUMENT */
+
+#if defined(DUK_USE_PROFILER_SAMPLING) || defined(DUK_USE_PROFILER_INSTRUMENT)
+DUK_EXTERNAL void duk_profiler_reset(duk_hthread *thr) {
+	duk_heap *heap;
+#if defined(DUK_USE_PROFILER_INSTRUMENT)
+	duk_prof_entry *old_funcs;
+	duk_uint32_t old_size;
+	duk_prof_entry *e;
+	duk_uint32_t i;
+#endif
+
+	DUK_ASSERT_API_ENTRY(thr);
+	heap = thr->heap;
+
+#if defined(DUK_USE_PROFILER_SAMPLING)
+	heap->prof_used = 0;
+	heap->prof_samples = 0;
+	heap->prof_dropped = 0;
+	heap->prof_overhead = 0.0;
+#endif
+#if defined(DUK_USE_PROFILER_INSTRUMENT)
+	/* Drop all entries except those of functions with live instrumented
+	 * activations: their depth must be kept for the unwind.  The old
+	 * table is detached first; releasing strings and buffers has no side
+	 * effects.
+	 */
+	old_funcs = heap->prof_funcs;
+	old_size = heap->prof_funcs_size;
+	heap->prof_funcs = NULL;
+	heap->prof_funcs_size = 0;
+	heap->prof_funcs_used = 0;
+	for (i = 0; i < old_size; i++) {
+		e = old_funcs + i;
+		if (e->data == NULL) {
+			continue;
+		}
+		if (e->depth > 0) {
+			if (heap->prof_funcs == NULL && !duk__prof_funcs_resize(heap, DUK__PROF_FUNCS_MINSIZE)) {
+				/* The live activations are then left uncounted
+				 * on unwind.
+				 */
+				goto release;
+			}
+			if ((heap->prof_funcs_used + 1) * 4 > heap->prof_funcs_size * 3 &&
+			    !duk__prof_funcs_resize(heap, heap->prof_funcs_size * 2)) {
+				goto release;
+			}
+			e->calls = 0;
+			e->time = 0.0;
+			*duk__prof_func_slot(heap->prof_funcs, heap->prof_funcs_size, e->data) = *e;  /* references move over */
+			heap->prof_funcs_used++;
+			continue;
+		}
+	 release:
+		DUK_HBUFFER_DECREF(thr, e->data);
+		if (e->name != NULL) {
+			DUK_HSTRING_DECREF(thr, e->name);
+		}
+		if (e->filename != NULL) {
+			DUK_HSTRING_DECREF(thr, e->filename);
+		}
+	}
+	DUK_FREE_RAW(heap, old_funcs);
+#endif
+}
+#else  /* DUK_USE_PROFILER_SAMPLING || DUK_USE_PROFILER_INSTRUMENT */
+DUK_EXTERNAL void duk_profiler_reset(duk_hthread *thr) {
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return;);
+}
+#endif  /* DUK_USE_PROFILER_SAMPLING || DUK_USE_PROFILER_INSTRUMENT */
+
+/* automatic undefs */
+#undef DUK__PROF_ALIGN
+#undef DUK__PROF_FUNCS_MAXSIZE
+#undef DUK__PROF_FUNCS_MINSIZE
+#undef DUK__PROF_LINE_MAXLEN
+#undef DUK__PROF_NAME_MAXLEN
 /*
  *  Memory calls.
  */
@@ -16911,6 +18361,153 @@ DUK_EXTERNAL void duk_gc(duk_hthread *thr, duk_uint_t flags) {
 	ms_flags = (duk_small_uint_t) flags;
 	duk_heap_mark_and_sweep(heap, ms_flags);
 }
+
+DUK_EXTERNAL duk_bool_t duk_gc_idle(duk_hthread *thr, duk_double_t budget_ms, duk_uint_t flags) {
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_ASSERT(thr->heap != NULL);
+	DUK_ASSERT(DUK_GC_COMPACT == DUK_MS_FLAG_EMERGENCY);
+
+	return duk_heap_mark_and_sweep_idle(thr->heap, budget_ms, (duk_small_uint_t) flags);
+}
+
+DUK_EXTERNAL duk_bool_t duk_gc_step(duk_hthread *thr, duk_double_t budget_ms) {
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_ASSERT(thr->heap != NULL);
+
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	return duk_heap_mark_and_sweep_step(thr->heap, budget_ms);
+#else
+	/* Without incremental marking a step is a full collection. */
+	DUK_UNREF(budget_ms);
+	duk_heap_mark_and_sweep(thr->heap, 0);
+	return 1;
+#endif
+}
+
+#if defined(DUK_USE_MARK_AND_SWEEP_PAUSE_STATS)
+DUK_EXTERNAL void duk_gc_inspect(duk_hthread *thr) {
+	duk_heap *heap;
+	duk_small_uint_t i;
+
+	DUK_ASSERT_API_ENTRY(thr);
+	heap = thr->heap;
+
+	duk_push_bare_object(thr);
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	duk_push_true(thr);
+	duk_put_prop_literal(thr, -2, "incremental");
+	duk_push_boolean(thr, heap->ms_incremental);
+	duk_put_prop_literal(thr, -2, "marking");
+	duk_push_uint(thr, (duk_uint_t) heap->ms_cycles);
+	duk_put_prop_literal(thr, -2, "cycles");
+	duk_push_uint(thr, (duk_uint_t) heap->ms_steps);
+	duk_put_prop_literal(thr, -2, "steps");
+#else
+	duk_push_false(thr);
+	duk_put_prop_literal(thr, -2, "incremental");
+#endif
+	duk_push_uint(thr, (duk_uint_t) heap->ms_pause_count);
+	duk_put_prop_literal(thr, -2, "pauses");
+	duk_push_number(thr, heap->ms_pause_total);
+	duk_put_prop_literal(thr, -2, "pauseTotalMs");
+	duk_push_number(thr, heap->ms_pause_max);
+	duk_put_prop_literal(thr, -2, "pauseMaxMs");
+	duk_push_uint(thr, (duk_uint_t) heap->ms_count_idle);
+	duk_put_prop_literal(thr, -2, "idleCollections");
+	duk_push_uint(thr, (duk_uint_t) heap->ms_count_alloc);
+	duk_put_prop_literal(thr, -2, "allocCollections");
+
+	/* histogram[N] counts pauses of [2^N, 2^(N+1)) microseconds. */
+	duk_push_array(thr);
+	for (i = 0; i < DUK_HEAP_MS_PAUSE_BUCKETS; i++) {
+		duk_push_uint(thr, (duk_uint_t) heap->ms_pause_hist[i]);
+		duk_put_prop_index(thr, -2, (duk_uarridx_t) i);
+	}
+	duk_put_prop_literal(thr, -2, "histogram");
+}
+#else  /* DUK_USE_MARK_AND_SWEEP_PAUSE_STATS */
+DUK_EXTERNAL void duk_gc_inspect(duk_hthread *thr) {
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return;);
+}
+#endif  /* DUK_USE_MARK_AND_SWEEP_PAUSE_STATS */
+
+#if defined(DUK_USE_PROPERTY_IC)
+DUK_EXTERNAL void duk_ic_inspect(duk_hthread *thr) {
+	duk_heap *heap;
+	duk_small_uint_t i;
+	duk_uint_t used;
+
+	DUK_ASSERT_API_ENTRY(thr);
+	heap = thr->heap;
+
+	used = 0;
+	for (i = 0; i < DUK_USE_PROPERTY_IC_SIZE; i++) {
+		if (heap->propic[i].pc != NULL) {
+			used++;
+		}
+	}
+
+	duk_push_bare_object(thr);
+	duk_push_uint(thr, (duk_uint_t) DUK_USE_PROPERTY_IC_SIZE);
+	duk_put_prop_literal(thr, -2, "size");
+	duk_push_uint(thr, used);
+	duk_put_prop_literal(thr, -2, "used");
+	duk_push_uint(thr, (duk_uint_t) heap->propic_get_hit);
+	duk_put_prop_literal(thr, -2, "getHits");
+	duk_push_uint(thr, (duk_uint_t) heap->propic_get_miss);
+	duk_put_prop_literal(thr, -2, "getMisses");
+	duk_push_uint(thr, (duk_uint_t) heap->propic_put_hit);
+	duk_put_prop_literal(thr, -2, "putHits");
+	duk_push_uint(thr, (duk_uint_t) heap->propic_put_miss);
+	duk_put_prop_literal(thr, -2, "putMisses");
+}
+#else  /* DUK_USE_PROPERTY_IC */
+DUK_EXTERNAL void duk_ic_inspect(duk_hthread *thr) {
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return;);
+}
+#endif  /* DUK_USE_PROPERTY_IC */
+
+#if defined(DUK_USE_COMPILER_STATS)
+DUK_EXTERNAL void duk_compile_inspect(duk_hthread *thr) {
+	duk_heap *heap;
+
+	DUK_ASSERT_API_ENTRY(thr);
+	heap = thr->heap;
+
+	duk_push_bare_object(thr);
+	duk_push_uint(thr, (duk_uint_t) heap->comp_count);
+	duk_put_prop_literal(thr, -2, "compiles");
+	duk_push_number(thr, heap->comp_total_time);
+	duk_put_prop_literal(thr, -2, "totalMs");
+	duk_push_number(thr, heap->comp_last_time);
+	duk_put_prop_literal(thr, -2, "lastMs");
+	duk_push_uint(thr, (duk_uint_t) heap->comp_last_source);
+	duk_put_prop_literal(thr, -2, "lastSourceBytes");
+	duk_push_uint(thr, (duk_uint_t) heap->comp_last_funcs);
+	duk_put_prop_literal(thr, -2, "lastFunctions");
+	duk_push_uint(thr, (duk_uint_t) heap->comp_last_stack);
+	duk_put_prop_literal(thr, -2, "lastStackBytes");
+	duk_push_uint(thr, (duk_uint_t) heap->comp_max_stack);
+	duk_put_prop_literal(thr, -2, "maxStackBytes");
+#if defined(DUK_USE_GET_FREE_HEAP_SIZE)
+	/* Peak heap use above the free heap at compile start. */
+	duk_push_uint(thr, (duk_uint_t) heap->comp_last_heap);
+	duk_put_prop_literal(thr, -2, "lastHeapBytes");
+	duk_push_uint(thr, (duk_uint_t) heap->comp_max_heap);
+	duk_put_prop_literal(thr, -2, "maxHeapBytes");
+#endif
+}
+#else  /* DUK_USE_COMPILER_STATS */
+DUK_EXTERNAL void duk_compile_inspect(duk_hthread *thr) {
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_ERROR_UNSUPPORTED(thr);
+	DUK_WO_NORETURN(return;);
+}
+#endif  /* DUK_USE_COMPILER_STATS */
 /*
  *  Object handling: property access and other support functions.
  */
@@ -23678,6 +25275,8 @@ DUK_LOCAL void duk__validate_push_heapptr(duk_hthread *thr, void *ptr) {
 		for (i = 0; i < heap->st_size; i++) {
 #if defined(DUK_USE_STRTAB_PTRCOMP)
 			str = DUK_USE_HEAPPTR_DEC16((heap)->heap_udata, heap->strtable16[i]);
+#elif defined(DUK_USE_STRTAB_PROBE)
+			str = heap->strtable[i].h;
 #else
 			str = heap->strtable[i];
 #endif
@@ -23778,6 +25377,11 @@ DUK_EXTERNAL duk_idx_t duk_push_heapptr(duk_hthread *thr, void *ptr) {
 		/* Continue with the rest. */
 	}
 
+	/* The application holds 'ptr' outside the heap graph, so shade it
+	 * if an incremental marking cycle is in progress.
+	 */
+	DUK_HEAPHDR_MS_BARRIER(thr->heap, (duk_heaphdr *) ptr);
+
 	switch (DUK_HEAPHDR_GET_TYPE((duk_heaphdr *) ptr)) {
 	case DUK_HTYPE_STRING:
 		DUK_TVAL_SET_STRING(tv, (duk_hstring *) ptr);
@@ -25967,311 +27571,401 @@ DUK_INTERNAL duk_ret_t duk_bi_array_prototype_push(duk_hthread *thr) {
 /*
  *  sort()
  *
- *  Currently qsort with random pivot.  This is now really, really slow,
- *  because there is no fast path for array parts.
+ *  Stable merge sort.  Defined elements are first read into a temporary
+ *  array (directly from the array part for dense Arrays), sorted there by
+ *  index, and then written back followed by undefined values and holes,
+ *  which is the order required by the specification.  Reading everything
+ *  first also means that a throwing compareFn leaves the input unchanged.
+ *
+ *  The sort works on an array of indices: runs of DUK__SORT_RUN elements
+ *  are binary insertion sorted, and then merged bottom-up.  Merging two
+ *  runs which are already in order costs a single comparison, so sorted
+ *  and nearly sorted input is close to linear.  The temporary arrays are
+ *  reachable only from the value stack, but emergency GC may still resize
+ *  their property tables, so array parts are looked up again after every
+ *  call that may have side effects.  The arrays are kept filled (with
+ *  undefined initially) so that compaction never shrinks or abandons them.
  *
- *  Signed indices are used because qsort() leaves and degenerate cases
- *  may use a negative offset.
+ *  Comparisons avoid calls when possible:
+ *
+ *    - Default order compares ToString() results, which are computed
+ *      once per element (or used as is for strings).
+ *
+ *    - A compareFn whose bytecode is exactly 'return a - b;' (or b - a)
+ *      is evaluated natively when all elements are numbers.  Skipping the
+ *      calls isn't observable because the function has no side effects
+ *      for number arguments.
  */
 
-DUK_LOCAL duk_small_int_t duk__array_sort_compare(duk_hthread *thr, duk_int_t idx1, duk_int_t idx2) {
-	duk_bool_t have1, have2;
-	duk_bool_t undef1, undef2;
-	duk_small_int_t ret;
-	duk_idx_t idx_obj = 1;  /* fixed offsets in valstack */
-	duk_idx_t idx_fn = 0;
-	duk_hstring *h1, *h2;
+#define DUK__SORT_RUN            16
 
-	/* Fast exit if indices are identical.  This is valid for a non-existent property,
-	 * for an undefined value, and almost always for ToString() coerced comparison of
-	 * arbitrary values (corner cases where this is not the case include e.g. a an
-	 * object with varying ToString() coercion).
-	 *
-	 * The specification does not prohibit "caching" of values read from the array, so
-	 * assuming equality for comparing an index with itself falls into the category of
-	 * "caching".
-	 *
-	 * Also, compareFn may be inconsistent, so skipping a call to compareFn here may
-	 * have an effect on the final result.  The specification does not require any
-	 * specific behavior for inconsistent compare functions, so again, this fast path
-	 * is OK.
-	 */
+#define DUK__SORT_CMP_FN         0  /* call compareFn */
+#define DUK__SORT_CMP_STRING     1  /* default, compare ToString() keys */
+#define DUK__SORT_CMP_NUMBER     2  /* function (a, b) { return a - b; } */
+#define DUK__SORT_CMP_NUMBER_REV 3  /* function (a, b) { return b - a; } */
 
-	if (idx1 == idx2) {
-		DUK_DDD(DUK_DDDPRINT("duk__array_sort_compare: idx1=%ld, idx2=%ld -> indices identical, quick exit",
-		                     (long) idx1, (long) idx2));
-		return 0;
+typedef struct {
+	duk_hthread *thr;
+	duk_hobject *h_vals;       /* temporary array, values at [0,n[ */
+	duk_hobject *h_keys;       /* ToString() keys at [0,n[, h_vals if all strings */
+	duk_small_uint_t mode;
+} duk__sort_state;
+
+/* Fixed value stack offsets. */
+#define DUK__SORT_IDX_FN         0
+#define DUK__SORT_IDX_OBJ        1
+#define DUK__SORT_IDX_VALS       3
+#define DUK__SORT_IDX_KEYS       4
+
+DUK_LOCAL duk_small_uint_t duk__array_sort_get_mode(duk_hthread *thr) {
+	duk_hobject *h_fn;
+	duk_hcompfunc *h_comp;
+	duk_instr_t *code;
+	duk_instr_t ins;
+	duk_uint_fast32_t reg;
+
+	if (duk_is_undefined(thr, DUK__SORT_IDX_FN)) {
+		return DUK__SORT_CMP_STRING;
+	}
+	h_fn = duk_get_hobject(thr, DUK__SORT_IDX_FN);
+	if (h_fn == NULL || !DUK_HOBJECT_IS_COMPFUNC(h_fn)) {
+		return DUK__SORT_CMP_FN;
+	}
+	h_comp = (duk_hcompfunc *) h_fn;
+	if (h_comp->nargs != 2 || DUK_HCOMPFUNC_GET_CODE_COUNT(thr->heap, h_comp) < 2) {
+		return DUK__SORT_CMP_FN;
 	}
 
-	have1 = duk_get_prop_index(thr, idx_obj, (duk_uarridx_t) idx1);
-	have2 = duk_get_prop_index(thr, idx_obj, (duk_uarridx_t) idx2);
+	/* Arguments are in registers 0 and 1 at function entry.  Match
+	 * SUB_RR rX, r0, r1 (or r1, r0) followed by RETREG rX.
+	 */
+	code = DUK_HCOMPFUNC_GET_CODE_BASE(thr->heap, h_comp);
+	ins = code[0];
+	if (DUK_DEC_OP(ins) != DUK_OP_SUB_RR) {
+		return DUK__SORT_CMP_FN;
+	}
+	reg = DUK_DEC_A(ins);
+	if (DUK_DEC_OP(code[1]) != DUK_OP_RETREG || DUK_DEC_BC(code[1]) != reg) {
+		return DUK__SORT_CMP_FN;
+	}
+	if (DUK_DEC_B(ins) == 0 && DUK_DEC_C(ins) == 1) {
+		return DUK__SORT_CMP_NUMBER;
+	} else if (DUK_DEC_B(ins) == 1 && DUK_DEC_C(ins) == 0) {
+		return DUK__SORT_CMP_NUMBER_REV;
+	}
+	return DUK__SORT_CMP_FN;
+}
 
-	DUK_DDD(DUK_DDDPRINT("duk__array_sort_compare: idx1=%ld, idx2=%ld, have1=%ld, have2=%ld, val1=%!T, val2=%!T",
-	                     (long) idx1, (long) idx2, (long) have1, (long) have2,
-	                     (duk_tval *) duk_get_tval(thr, -2), (duk_tval *) duk_get_tval(thr, -1)));
+/* Push a temporary array of 'size' undefined values. */
+DUK_LOCAL duk_hobject *duk__array_sort_push_temp(duk_hthread *thr, duk_uint32_t size) {
+	duk_harray *h;
+	duk_tval *tv;
+	duk_uint32_t i;
 
-	if (have1) {
-		if (have2) {
-			;
-		} else {
-			ret = -1;
-			goto pop_ret;
-		}
-	} else {
-		if (have2) {
-			ret = 1;
-			goto pop_ret;
-		} else {
-			ret = 0;
-			goto pop_ret;
-		}
+	h = duk_push_harray_with_size(thr, size);
+	tv = DUK_HOBJECT_A_GET_BASE(thr->heap, (duk_hobject *) h);
+	for (i = 0; i < size; i++) {
+		DUK_TVAL_SET_UNDEFINED(tv + i);
 	}
+	return (duk_hobject *) h;
+}
 
-	undef1 = duk_is_undefined(thr, -2);
-	undef2 = duk_is_undefined(thr, -1);
-	if (undef1) {
-		if (undef2) {
-			ret = 0;
-			goto pop_ret;
-		} else {
-			ret = 1;
-			goto pop_ret;
-		}
-	} else {
-		if (undef2) {
-			ret = -1;
-			goto pop_ret;
-		} else {
-			;
-		}
-	}
+/* Compare values at temporary array indices i1 and i2, returns <0, 0, >0. */
+DUK_LOCAL duk_small_int_t duk__array_sort_compare(duk__sort_state *st, duk_uint32_t i1, duk_uint32_t i2) {
+	duk_hthread *thr = st->thr;
+	duk_tval *tv_base;
+	duk_double_t d;
 
-	if (!duk_is_undefined(thr, idx_fn)) {
-		duk_double_t d;
+	tv_base = DUK_HOBJECT_A_GET_BASE(thr->heap, st->h_vals);
 
-		/* No need to check callable; duk_call() will do that. */
-		duk_dup(thr, idx_fn);    /* -> [ ... x y fn ] */
-		duk_insert(thr, -3);     /* -> [ ... fn x y ] */
-		duk_call(thr, 2);        /* -> [ ... res ] */
+	switch (st->mode) {
+	case DUK__SORT_CMP_STRING:
+		tv_base = DUK_HOBJECT_A_GET_BASE(thr->heap, st->h_keys);
+		return duk_js_string_compare(DUK_TVAL_GET_STRING(tv_base + i1),
+		                             DUK_TVAL_GET_STRING(tv_base + i2));
+	case DUK__SORT_CMP_NUMBER:
+		d = DUK_TVAL_GET_NUMBER(tv_base + i1) - DUK_TVAL_GET_NUMBER(tv_base + i2);
+		break;
+	case DUK__SORT_CMP_NUMBER_REV:
+		d = DUK_TVAL_GET_NUMBER(tv_base + i2) - DUK_TVAL_GET_NUMBER(tv_base + i1);
+		break;
+	default:
+		/* No need to check callable; duk_call() will do that.  The
+		 * call may have arbitrary side effects, 'tv_base' must not
+		 * be used after it.
+		 */
+		duk_dup(thr, DUK__SORT_IDX_FN);
+		duk_push_tval(thr, tv_base + i1);
+		duk_push_tval(thr, DUK_HOBJECT_A_GET_BASE(thr->heap, st->h_vals) + i2);
+		duk_call(thr, 2);
 
 		/* ES5 is a bit vague about what to do if the return value is
 		 * not a number.  ES2015 provides a concrete description:
 		 * http://www.ecma-international.org/ecma-262/6.0/#sec-sortcompare.
 		 */
-
 		d = duk_to_number_m1(thr);
-		if (d < 0.0) {
-			ret = -1;
-		} else if (d > 0.0) {
-			ret = 1;
-		} else {
-			/* Because NaN compares to false, NaN is handled here
-			 * without an explicit check above.
-			 */
-			ret = 0;
-		}
-
 		duk_pop_nodecref_unsafe(thr);
-		DUK_DDD(DUK_DDDPRINT("-> result %ld (from comparefn, after coercion)", (long) ret));
-		return ret;
+		break;
 	}
 
-	/* string compare is the default (a bit oddly) */
+	/* Because NaN compares to false, NaN is handled as equal here
+	 * without an explicit check.
+	 */
+	if (d < 0.0) {
+		return -1;
+	} else if (d > 0.0) {
+		return 1;
+	}
+	return 0;
+}
 
-	/* XXX: any special handling for plain array; causes repeated coercion now? */
-	h1 = duk_to_hstring(thr, -2);
-	h2 = duk_to_hstring_m1(thr);
-	DUK_ASSERT(h1 != NULL);
-	DUK_ASSERT(h2 != NULL);
+/* Binary insertion sort for idx[lo,hi[, equal elements keep their order. */
+DUK_LOCAL void duk__array_sort_insertion(duk__sort_state *st, duk_uint32_t *idx, duk_uint32_t lo, duk_uint32_t hi) {
+	duk_uint32_t i;
 
-	ret = duk_js_string_compare(h1, h2);  /* retval is directly usable */
-	goto pop_ret;
+	for (i = lo + 1; i < hi; i++) {
+		duk_uint32_t x = idx[i];
+		duk_uint32_t l = lo;
+		duk_uint32_t r = i;
 
- pop_ret:
-	duk_pop_2_unsafe(thr);
-	DUK_DDD(DUK_DDDPRINT("-> result %ld", (long) ret));
-	return ret;
+		while (l < r) {
+			duk_uint32_t m = l + ((r - l) >> 1);
+			if (duk__array_sort_compare(st, x, idx[m]) < 0) {
+				r = m;
+			} else {
+				l = m + 1;
+			}
+		}
+		if (l < i) {
+			duk_memmove((void *) (idx + l + 1), (const void *) (idx + l), (size_t) (i - l) * sizeof(duk_uint32_t));
+			idx[l] = x;
+		}
+	}
 }
 
-DUK_LOCAL void duk__array_sort_swap(duk_hthread *thr, duk_int_t l, duk_int_t r) {
-	duk_bool_t have_l, have_r;
-	duk_idx_t idx_obj = 1;  /* fixed offset in valstack */
+/* Merge src[lo,mid[ and src[mid,hi[ into dst[lo,hi[, left side wins ties. */
+DUK_LOCAL void duk__array_sort_merge(duk__sort_state *st, duk_uint32_t *src, duk_uint32_t *dst, duk_uint32_t lo, duk_uint32_t mid, duk_uint32_t hi) {
+	duk_uint32_t i = lo;
+	duk_uint32_t j = mid;
+	duk_uint32_t k = lo;
 
-	if (l == r) {
+	if (mid >= hi || duk__array_sort_compare(st, src[mid - 1], src[mid]) <= 0) {
+		/* Already in order (or a single run). */
+		duk_memcpy((void *) (dst + lo), (const void *) (src + lo), (size_t) (hi - lo) * sizeof(duk_uint32_t));
 		return;
 	}
 
-	/* swap elements; deal with non-existent elements correctly */
-	have_l = duk_get_prop_index(thr, idx_obj, (duk_uarridx_t) l);
-	have_r = duk_get_prop_index(thr, idx_obj, (duk_uarridx_t) r);
-
-	if (have_r) {
-		/* right exists, [[Put]] regardless whether or not left exists */
-		duk_put_prop_index(thr, idx_obj, (duk_uarridx_t) l);
-	} else {
-		duk_del_prop_index(thr, idx_obj, (duk_uarridx_t) l);
-		duk_pop_undefined(thr);
+	while (i < mid && j < hi) {
+		if (duk__array_sort_compare(st, src[j], src[i]) < 0) {
+			dst[k++] = src[j++];
+		} else {
+			dst[k++] = src[i++];
+		}
 	}
-
-	if (have_l) {
-		duk_put_prop_index(thr, idx_obj, (duk_uarridx_t) r);
-	} else {
-		duk_del_prop_index(thr, idx_obj, (duk_uarridx_t) r);
-		duk_pop_undefined(thr);
+	while (i < mid) {
+		dst[k++] = src[i++];
+	}
+	while (j < hi) {
+		dst[k++] = src[j++];
 	}
 }
 
-#if defined(DUK_USE_DEBUG_LEVEL) && (DUK_USE_DEBUG_LEVEL >= 2)
-/* Debug print which visualizes the qsort partitioning process. */
-DUK_LOCAL void duk__debuglog_qsort_state(duk_hthread *thr, duk_int_t lo, duk_int_t hi, duk_int_t pivot) {
-	char buf[4096];
-	char *ptr = buf;
-	duk_int_t i, n;
-	n = (duk_int_t) duk_get_length(thr, 1);
-	if (n > 4000) {
-		n = 4000;
+/* Sort indices [0,n[ in 'buf' (2 * n entries), returns sorted index array. */
+DUK_LOCAL duk_uint32_t *duk__array_sort_indices(duk__sort_state *st, duk_uint32_t *buf, duk_uint32_t n) {
+	duk_uint32_t *src = buf;
+	duk_uint32_t *dst = buf + n;
+	duk_uint32_t *tmp;
+	duk_uint32_t width;
+	duk_uint32_t lo;
+
+	for (lo = 0; lo < n; lo++) {
+		src[lo] = lo;
 	}
-	*ptr++ = '[';
-	for (i = 0; i < n; i++) {
-		if (i == pivot) {
-			*ptr++ = '|';
-		} else if (i == lo) {
-			*ptr++ = '<';
-		} else if (i == hi) {
-			*ptr++ = '>';
-		} else if (i >= lo && i <= hi) {
-			*ptr++ = '-';
-		} else {
-			*ptr++ = ' ';
+	for (lo = 0; lo < n; lo += DUK__SORT_RUN) {
+		duk__array_sort_insertion(st, src, lo, (n - lo > DUK__SORT_RUN ? lo + DUK__SORT_RUN : n));
+	}
+	for (width = DUK__SORT_RUN; width < n; width *= 2) {
+		for (lo = 0; lo < n; lo += 2 * width) {
+			duk_uint32_t mid = (n - lo > width ? lo + width : n);
+			duk_uint32_t hi = (n - mid > width ? mid + width : n);
+			duk__array_sort_merge(st, src, dst, lo, mid, hi);
+		}
+		tmp = src;
+		src = dst;
+		dst = tmp;
+		if (width > (DUK_UINT32_MAX >> 1)) {
+			break;
 		}
 	}
-	*ptr++ = ']';
-	*ptr++ = '\0';
-
-	DUK_DDD(DUK_DDDPRINT("%s   (lo=%ld, hi=%ld, pivot=%ld)",
-	                     (const char *) buf, (long) lo, (long) hi, (long) pivot));
+	return src;
 }
-#endif
-
-DUK_LOCAL void duk__array_qsort(duk_hthread *thr, duk_int_t lo, duk_int_t hi) {
-	duk_int_t p, l, r;
-
-	/* The lo/hi indices may be crossed and hi < 0 is possible at entry. */
 
-	DUK_DDD(DUK_DDDPRINT("duk__array_qsort: lo=%ld, hi=%ld, obj=%!T",
-	                     (long) lo, (long) hi, (duk_tval *) duk_get_tval(thr, 1)));
+DUK_INTERNAL duk_ret_t duk_bi_array_prototype_sort(duk_hthread *thr) {
+	duk__sort_state st;
+	duk_uint32_t len;
+	duk_uint32_t n;            /* defined values */
+	duk_uint32_t n_undef;      /* undefined values */
+	duk_uint32_t i;
+	duk_uint32_t *idx;
+	duk_tval *tv_vals;
+	duk_bool_t all_numbers = 1;
+	duk_bool_t all_strings = 1;
+	duk_bool_t fast_gather = 0;
+#if defined(DUK_USE_ARRAY_FASTPATH)
+	duk_harray *h_arr;
+#endif
 
-	DUK_ASSERT_TOP(thr, 3);
+	/* XXX: len >= 0x80000000 is rejected for consistency with other
+	 * methods, the sort itself uses unsigned indices.
+	 */
+	len = duk__push_this_obj_len_u32_limited(thr);
 
-	/* In some cases it may be that lo > hi, or hi < 0; these
-	 * degenerate cases happen e.g. for empty arrays, and in
-	 * recursion leaves.
+	/* stack[0] = compareFn
+	 * stack[1] = ToObject(this)
+	 * stack[2] = ToUint32(length)
 	 */
 
-	/* trivial cases */
-	if (hi - lo < 1) {
-		DUK_DDD(DUK_DDDPRINT("degenerate case, return immediately"));
-		return;
+	if (len <= 1) {
+		duk_pop_nodecref_unsafe(thr);
+		return 1;  /* return ToObject(this) */
 	}
-	DUK_ASSERT(hi > lo);
-	DUK_ASSERT(hi - lo + 1 >= 2);
 
-	/* randomized pivot selection */
-	p = lo + (duk_int_t) (DUK_UTIL_GET_RANDOM_DOUBLE(thr) * (duk_double_t) (hi - lo + 1));
-	DUK_ASSERT(p >= lo && p <= hi);
-	DUK_DDD(DUK_DDDPRINT("lo=%ld, hi=%ld, chose pivot p=%ld", (long) lo, (long) hi, (long) p));
+	st.thr = thr;
+	st.mode = duk__array_sort_get_mode(thr);
+	st.h_vals = duk__array_sort_push_temp(thr, len);
+	st.h_keys = st.h_vals;
+	DUK_ASSERT_TOP(thr, DUK__SORT_IDX_VALS + 1);
+	n = 0;
+	n_undef = 0;
 
-	/* move pivot out of the way */
-	duk__array_sort_swap(thr, p, lo);
-	p = lo;
-	DUK_DDD(DUK_DDDPRINT("pivot moved out of the way: %!T", (duk_tval *) duk_get_tval(thr, 1)));
+#if defined(DUK_USE_ARRAY_FASTPATH)
+	h_arr = duk__arraypart_fastpath_this(thr);
+	if (h_arr != NULL && h_arr->length == len) {
+		duk_tval *tv_src;
 
-	l = lo + 1;
-	r = hi;
-	for (;;) {
-		/* find elements to swap */
-		for (;;) {
-			DUK_DDD(DUK_DDDPRINT("left scan: l=%ld, r=%ld, p=%ld",
-			                     (long) l, (long) r, (long) p));
-			if (l >= hi) {
-				break;
-			}
-			if (duk__array_sort_compare(thr, l, p) >= 0) {  /* !(l < p) */
-				break;
+		tv_src = DUK_HOBJECT_A_GET_BASE(thr->heap, (duk_hobject *) h_arr);
+		for (i = 0; i < len; i++) {
+			if (DUK_TVAL_IS_UNUSED(tv_src + i)) {
+				break;  /* gap, may inherit a value */
 			}
-			l++;
 		}
-		for (;;) {
-			DUK_DDD(DUK_DDDPRINT("right scan: l=%ld, r=%ld, p=%ld",
-			                     (long) l, (long) r, (long) p));
-			if (r <= lo) {
-				break;
-			}
-			if (duk__array_sort_compare(thr, p, r) >= 0) {  /* !(p < r) */
-				break;
+		if (i == len) {
+			fast_gather = 1;
+			tv_vals = DUK_HOBJECT_A_GET_BASE(thr->heap, st.h_vals);
+			for (i = 0; i < len; i++) {
+				duk_tval *tv = tv_src + i;
+				if (DUK_TVAL_IS_UNDEFINED(tv)) {
+					n_undef++;
+					continue;
+				}
+				all_numbers &= DUK_TVAL_IS_NUMBER(tv);
+				all_strings &= DUK_TVAL_IS_STRING(tv);
+				DUK_TVAL_SET_TVAL(tv_vals + n, tv);
+				DUK_TVAL_INCREF(thr, tv_vals + n);
+				n++;
 			}
-			r--;
-		}
-		if (l >= r) {
-			goto done;
 		}
-		DUK_ASSERT(l < r);
-
-		DUK_DDD(DUK_DDDPRINT("swap %ld and %ld", (long) l, (long) r));
+	}
+#endif  /* DUK_USE_ARRAY_FASTPATH */
 
-		duk__array_sort_swap(thr, l, r);
+	if (!fast_gather) {
+		for (i = 0; i < len; i++) {
+			duk_tval *tv;
 
-		DUK_DDD(DUK_DDDPRINT("after swap: %!T", (duk_tval *) duk_get_tval(thr, 1)));
-		l++;
-		r--;
+			if (!duk_get_prop_index(thr, DUK__SORT_IDX_OBJ, (duk_uarridx_t) i)) {
+				duk_pop_unsafe(thr);
+				continue;
+			}
+			tv = DUK_GET_TVAL_NEGIDX(thr, -1);
+			if (DUK_TVAL_IS_UNDEFINED(tv)) {
+				n_undef++;
+				duk_pop_unsafe(thr);
+				continue;
+			}
+			all_numbers &= DUK_TVAL_IS_NUMBER(tv);
+			all_strings &= DUK_TVAL_IS_STRING(tv);
+			tv_vals = DUK_HOBJECT_A_GET_BASE(thr->heap, st.h_vals);
+			DUK_TVAL_SET_TVAL(tv_vals + n, tv);
+			DUK_TVAL_INCREF(thr, tv_vals + n);
+			n++;
+			duk_pop_unsafe(thr);
+		}
 	}
- done:
-	/* Note that 'l' and 'r' may cross, i.e. r < l */
-	DUK_ASSERT(l >= lo && l <= hi);
-	DUK_ASSERT(r >= lo && r <= hi);
+	DUK_ASSERT(n + n_undef <= len);
 
-	/* XXX: there's no explicit recursion bound here now.  For the average
-	 * qsort recursion depth O(log n) that's not really necessary: e.g. for
-	 * 2**32 recursion depth would be about 32 which is OK.  However, qsort
-	 * worst case recursion depth is O(n) which may be a problem.
-	 */
+	if (st.mode == DUK__SORT_CMP_STRING && !all_strings) {
+		st.h_keys = duk__array_sort_push_temp(thr, n);
+		DUK_ASSERT_TOP(thr, DUK__SORT_IDX_KEYS + 1);
+		for (i = 0; i < n; i++) {
+			duk_tval *tv_keys;
 
-	/* move pivot to its final place */
-	DUK_DDD(DUK_DDDPRINT("before final pivot swap: %!T", (duk_tval *) duk_get_tval(thr, 1)));
-	duk__array_sort_swap(thr, lo, r);
+			duk_push_tval(thr, DUK_HOBJECT_A_GET_BASE(thr->heap, st.h_vals) + i);
+			(void) duk_to_hstring_m1(thr);  /* may have side effects */
+			tv_keys = DUK_HOBJECT_A_GET_BASE(thr->heap, st.h_keys);
+			DUK_TVAL_SET_TVAL(tv_keys + i, DUK_GET_TVAL_NEGIDX(thr, -1));
+			DUK_TVAL_INCREF(thr, tv_keys + i);
+			duk_pop_unsafe(thr);
+		}
+	} else if ((st.mode == DUK__SORT_CMP_NUMBER || st.mode == DUK__SORT_CMP_NUMBER_REV) && !all_numbers) {
+		st.mode = DUK__SORT_CMP_FN;
+	}
 
-#if defined(DUK_USE_DEBUG_LEVEL) && (DUK_USE_DEBUG_LEVEL >= 2)
-	duk__debuglog_qsort_state(thr, lo, hi, r);
-#endif
+	DUK_DDD(DUK_DDDPRINT("sort: len=%ld, n=%ld, n_undef=%ld, mode=%ld, fast_gather=%ld",
+	                     (long) len, (long) n, (long) n_undef, (long) st.mode, (long) fast_gather));
 
-	DUK_DDD(DUK_DDDPRINT("recurse: pivot=%ld, obj=%!T", (long) r, (duk_tval *) duk_get_tval(thr, 1)));
-	duk__array_qsort(thr, lo, r - 1);
-	duk__array_qsort(thr, r + 1, hi);
-}
+	idx = (duk_uint32_t *) duk_push_fixed_buffer_nozero(thr, (duk_size_t) n * 2 * sizeof(duk_uint32_t));
+	idx = duk__array_sort_indices(&st, idx, n);
 
-DUK_INTERNAL duk_ret_t duk_bi_array_prototype_sort(duk_hthread *thr) {
-	duk_uint32_t len;
+	/* Write back: sorted values, undefined values, then holes. */
 
-	/* XXX: len >= 0x80000000 won't work below because a signed type
-	 * is needed by qsort.
-	 */
-	len = duk__push_this_obj_len_u32_limited(thr);
+#if defined(DUK_USE_ARRAY_FASTPATH)
+	if (fast_gather && duk__arraypart_fastpath_this(thr) == h_arr && h_arr->length == len) {
+		duk_tval *tv_dst;
 
-	/* stack[0] = compareFn
-	 * stack[1] = ToObject(this)
-	 * stack[2] = ToUint32(length)
-	 */
+		/* No side effects until the refzero check, as every previous
+		 * value is still referenced by the temporary array, unless
+		 * compareFn replaced some.
+		 */
+		tv_dst = DUK_HOBJECT_A_GET_BASE(thr->heap, (duk_hobject *) h_arr);
+		tv_vals = DUK_HOBJECT_A_GET_BASE(thr->heap, st.h_vals);
+		for (i = 0; i < n; i++) {
+			DUK_TVAL_SET_TVAL_UPDREF_NORZ(thr, tv_dst + i, tv_vals + idx[i]);
+		}
+		for (; i < len; i++) {
+			DUK_TVAL_SET_UNDEFINED_UPDREF_NORZ(thr, tv_dst + i);
+		}
+		DUK_REFZERO_CHECK_SLOW(thr);
+		goto done;
+	}
+#endif  /* DUK_USE_ARRAY_FASTPATH */
 
-	if (len > 0) {
-		/* avoid degenerate cases, so that (len - 1) won't underflow */
-		duk__array_qsort(thr, (duk_int_t) 0, (duk_int_t) (len - 1));
+	for (i = 0; i < n; i++) {
+		duk_push_tval(thr, DUK_HOBJECT_A_GET_BASE(thr->heap, st.h_vals) + idx[i]);
+		duk_put_prop_index(thr, DUK__SORT_IDX_OBJ, (duk_uarridx_t) i);
+	}
+	for (; i < n + n_undef; i++) {
+		duk_push_undefined(thr);
+		duk_put_prop_index(thr, DUK__SORT_IDX_OBJ, (duk_uarridx_t) i);
+	}
+	for (; i < len; i++) {
+		duk_del_prop_index(thr, DUK__SORT_IDX_OBJ, (duk_uarridx_t) i);
 	}
 
-	DUK_ASSERT_TOP(thr, 3);
-	duk_pop_nodecref_unsafe(thr);
+ done:
+	duk_set_top(thr, DUK__SORT_IDX_OBJ + 1);
 	return 1;  /* return ToObject(this) */
 }
 
+#undef DUK__SORT_RUN
+#undef DUK__SORT_CMP_FN
+#undef DUK__SORT_CMP_STRING
+#undef DUK__SORT_CMP_NUMBER
+#undef DUK__SORT_CMP_NUMBER_REV
+#undef DUK__SORT_IDX_FN
+#undef DUK__SORT_IDX_OBJ
+#undef DUK__SORT_IDX_VALS
+#undef DUK__SORT_IDX_KEYS
+
 /*
  *  splice()
  */
@@ -28618,6 +30312,355 @@ DUK_INTERNAL duk_ret_t duk_bi_nodejs_buffer_copy(duk_hthread *thr) {
 }
 #endif  /* DUK_USE_BUFFEROBJECT_SUPPORT */
 
+/*
+ *  TypedArray element kernels
+ *
+ *  Loops over raw element data of a fixed element type, used by set(),
+ *  fill(), indexOf(), includes() and reverse().  Elements are accessed
+ *  using a constant size duk_memcpy() so that unaligned data (e.g. an
+ *  external buffer) is safe; compilers turn these into plain loads and
+ *  stores, and the fill and conversion loops vectorize.
+ *
+ *  Callers must validate the slices and finish all argument coercions
+ *  before calling the kernels.
+ */
+
+#if defined(DUK_USE_BUFFEROBJECT_SUPPORT) && defined(DUK_USE_TYPEDARRAY_KERNELS)
+#define DUK__TA_LOAD(ctype,p,i,out) \
+	duk_memcpy((void *) &(out), (const void *) ((p) + (duk_size_t) (i) * sizeof(ctype)), sizeof(ctype))
+#define DUK__TA_STORE(ctype,p,i,in) \
+	duk_memcpy((void *) ((p) + (duk_size_t) (i) * sizeof(ctype)), (const void *) &(in), sizeof(ctype))
+
+/* Element conversions for duk__ta_convert().  Integer targets use ToInt32()
+ * or ToUint32() semantics which, for integer sources, keep the low bits.
+ */
+#define DUK__TA_CONV_NONE(x)      (x)
+#define DUK__TA_CONV_INT(x)       ((duk_uint32_t) (x))
+#define DUK__TA_CONV_CLAMP_S8(x)  ((x) < 0 ? 0 : (x))
+#define DUK__TA_CONV_CLAMP_S(x)   ((x) < 0 ? 0 : ((x) > 255 ? 255 : (x)))
+#define DUK__TA_CONV_CLAMP_U(x)   ((x) > 255U ? 255U : (x))
+#define DUK__TA_CONV_TO_FLOAT(x)  duk_double_to_float_t((x))
+
+#define DUK__TA_CONVERT(dst_ctype,src_ctype,conv)  do { \
+		duk_uint_t duk__i; \
+		for (duk__i = 0; duk__i < n; duk__i++) { \
+			src_ctype duk__s; \
+			dst_ctype duk__d; \
+			DUK__TA_LOAD(src_ctype, p_src, duk__i, duk__s); \
+			duk__d = (dst_ctype) conv(duk__s); \
+			DUK__TA_STORE(dst_ctype, p_dst, duk__i, duk__d); \
+		} \
+	} while (0)
+
+/* Integer sources; source types are signed where needed for a correct
+ * sign extension.
+ */
+#define DUK__TA_CONVERT_FROM_INT(dst_ctype,conv)  do { \
+		switch (src_type) { \
+		case DUK_HBUFOBJ_ELEM_UINT8: \
+		case DUK_HBUFOBJ_ELEM_UINT8CLAMPED: \
+			DUK__TA_CONVERT(dst_ctype, duk_uint8_t, conv); \
+			return 1; \
+		case DUK_HBUFOBJ_ELEM_INT8: \
+			DUK__TA_CONVERT(dst_ctype, duk_int8_t, conv); \
+			return 1; \
+		case DUK_HBUFOBJ_ELEM_UINT16: \
+			DUK__TA_CONVERT(dst_ctype, duk_uint16_t, conv); \
+			return 1; \
+		case DUK_HBUFOBJ_ELEM_INT16: \
+			DUK__TA_CONVERT(dst_ctype, duk_int16_t, conv); \
+			return 1; \
+		case DUK_HBUFOBJ_ELEM_UINT32: \
+			DUK__TA_CONVERT(dst_ctype, duk_uint32_t, conv); \
+			return 1; \
+		case DUK_HBUFOBJ_ELEM_INT32: \
+			DUK__TA_CONVERT(dst_ctype, duk_int32_t, conv); \
+			return 1; \
+		} \
+	} while (0)
+
+/* Convert 'n' elements from 'p_src' to 'p_dst' (non-overlapping).  Returns
+ * 0 if there's no kernel for the type combination (float to integer), in
+ * which case the caller must use the generic element read/write helpers.
+ */
+DUK_LOCAL duk_bool_t duk__ta_convert(duk_uint8_t *p_dst, duk_small_uint_t dst_type, const duk_uint8_t *p_src, duk_small_uint_t src_type, duk_uint_t n) {
+	switch (dst_type) {
+	case DUK_HBUFOBJ_ELEM_FLOAT32:
+		DUK__TA_CONVERT_FROM_INT(duk_float_t, DUK__TA_CONV_NONE);
+		if (src_type == DUK_HBUFOBJ_ELEM_FLOAT32) {
+			DUK__TA_CONVERT(duk_float_t, duk_float_t, DUK__TA_CONV_NONE);
+		} else {
+			DUK_ASSERT(src_type == DUK_HBUFOBJ_ELEM_FLOAT64);
+			DUK__TA_CONVERT(duk_float_t, duk_double_t, DUK__TA_CONV_TO_FLOAT);
+		}
+		return 1;
+	case DUK_HBUFOBJ_ELEM_FLOAT64:
+		DUK__TA_CONVERT_FROM_INT(duk_double_t, DUK__TA_CONV_NONE);
+		if (src_type == DUK_HBUFOBJ_ELEM_FLOAT32) {
+			DUK__TA_CONVERT(duk_double_t, duk_float_t, DUK__TA_CONV_NONE);
+		} else {
+			DUK_ASSERT(src_type == DUK_HBUFOBJ_ELEM_FLOAT64);
+			DUK__TA_CONVERT(duk_double_t, duk_double_t, DUK__TA_CONV_NONE);
+		}
+		return 1;
+	case DUK_HBUFOBJ_ELEM_UINT8CLAMPED:
+		switch (src_type) {
+		case DUK_HBUFOBJ_ELEM_UINT8:
+		case DUK_HBUFOBJ_ELEM_UINT8CLAMPED:
+			DUK__TA_CONVERT(duk_uint8_t, duk_uint8_t, DUK__TA_CONV_NONE);
+			return 1;
+		case DUK_HBUFOBJ_ELEM_INT8:
+			DUK__TA_CONVERT(duk_uint8_t, duk_int8_t, DUK__TA_CONV_CLAMP_S8);
+			return 1;
+		case DUK_HBUFOBJ_ELEM_UINT16:
+			DUK__TA_CONVERT(duk_uint8_t, duk_uint16_t, DUK__TA_CONV_CLAMP_U);
+			return 1;
+		case DUK_HBUFOBJ_ELEM_INT16:
+			DUK__TA_CONVERT(duk_uint8_t, duk_int16_t, DUK__TA_CONV_CLAMP_S);
+			return 1;
+		case DUK_HBUFOBJ_ELEM_UINT32:
+			DUK__TA_CONVERT(duk_uint8_t, duk_uint32_t, DUK__TA_CONV_CLAMP_U);
+			return 1;
+		case DUK_HBUFOBJ_ELEM_INT32:
+			DUK__TA_CONVERT(duk_uint8_t, duk_int32_t, DUK__TA_CONV_CLAMP_S);
+			return 1;
+		}
+		break;
+	case DUK_HBUFOBJ_ELEM_UINT8:
+	case DUK_HBUFOBJ_ELEM_INT8:
+		DUK__TA_CONVERT_FROM_INT(duk_uint8_t, DUK__TA_CONV_INT);
+		break;
+	case DUK_HBUFOBJ_ELEM_UINT16:
+	case DUK_HBUFOBJ_ELEM_INT16:
+		DUK__TA_CONVERT_FROM_INT(duk_uint16_t, DUK__TA_CONV_INT);
+		break;
+	case DUK_HBUFOBJ_ELEM_UINT32:
+	case DUK_HBUFOBJ_ELEM_INT32:
+		DUK__TA_CONVERT_FROM_INT(duk_uint32_t, DUK__TA_CONV_INT);
+		break;
+	}
+	return 0;
+}
+
+/* Fill 'n' elements of 'elem_size' bytes with the encoded value 'val'. */
+DUK_LOCAL void duk__ta_fill(duk_uint8_t *p, const duk_uint8_t *val, duk_small_uint_t elem_size, duk_uint_t n) {
+	duk_uint_t i;
+
+	switch (elem_size) {
+	case 1:
+		duk_memset_unsafe((void *) p, (duk_small_int_t) val[0], (duk_size_t) n);
+		break;
+	case 2: {
+		duk_uint16_t v;
+		duk_memcpy((void *) &v, (const void *) val, sizeof(v));
+		for (i = 0; i < n; i++) {
+			DUK__TA_STORE(duk_uint16_t, p, i, v);
+		}
+		break;
+	}
+	case 4: {
+		duk_uint32_t v;
+		duk_memcpy((void *) &v, (const void *) val, sizeof(v));
+		for (i = 0; i < n; i++) {
+			DUK__TA_STORE(duk_uint32_t, p, i, v);
+		}
+		break;
+	}
+	default: {
+		duk_double_t v;
+		DUK_ASSERT(elem_size == 8);
+		duk_memcpy((void *) &v, (const void *) val, sizeof(v));
+		for (i = 0; i < n; i++) {
+			DUK__TA_STORE(duk_double_t, p, i, v);
+		}
+		break;
+	}
+	}
+}
+
+#define DUK__TA_REVERSE(ctype)  do { \
+		duk_uint_t duk__i = 0; \
+		duk_uint_t duk__j = n; \
+		while (duk__j > duk__i + 1) { \
+			ctype duk__a; \
+			ctype duk__b; \
+			duk__j--; \
+			DUK__TA_LOAD(ctype, p, duk__i, duk__a); \
+			DUK__TA_LOAD(ctype, p, duk__j, duk__b); \
+			DUK__TA_STORE(ctype, p, duk__i, duk__b); \
+			DUK__TA_STORE(ctype, p, duk__j, duk__a); \
+			duk__i++; \
+		} \
+	} while (0)
+
+/* Reverse 'n' elements of 'elem_size' bytes in place. */
+DUK_LOCAL void duk__ta_reverse(duk_uint8_t *p, duk_small_uint_t elem_size, duk_uint_t n) {
+	switch (elem_size) {
+	case 1:
+		DUK__TA_REVERSE(duk_uint8_t);
+		break;
+	case 2:
+		DUK__TA_REVERSE(duk_uint16_t);
+		break;
+	case 4:
+		DUK__TA_REVERSE(duk_uint32_t);
+		break;
+	default:
+		DUK_ASSERT(elem_size == 8);
+		DUK__TA_REVERSE(duk_double_t);
+		break;
+	}
+}
+
+#define DUK__TA_FIND(ctype,key)  do { \
+		for (i = start; i < n; i++) { \
+			ctype duk__x; \
+			DUK__TA_LOAD(ctype, p, i, duk__x); \
+			if (duk__x == (key)) { \
+				return (duk_int_t) i; \
+			} \
+		} \
+	} while (0)
+
+#define DUK__TA_FIND_NAN(ctype)  do { \
+		for (i = start; i < n; i++) { \
+			ctype duk__x; \
+			DUK__TA_LOAD(ctype, p, i, duk__x); \
+			if (DUK_ISNAN((duk_double_t) duk__x)) { \
+				return (duk_int_t) i; \
+			} \
+		} \
+	} while (0)
+
+/* Find the first element in [start,n[ equal to 'd' using strict equality
+ * (indexOf) or SameValueZero (includes, 'match_nan' set).  Returns the
+ * element index, or -1 if not found.  A value which the element type can't
+ * represent exactly (e.g. 1.5 or 256 for Uint8Array) never matches.
+ */
+DUK_LOCAL duk_int_t duk__ta_index_of(const duk_uint8_t *p, duk_small_uint_t elem_type, duk_uint_t start, duk_uint_t n, duk_double_t d, duk_bool_t match_nan) {
+	duk_uint_t i;
+
+	if (DUK_ISNAN(d)) {
+		if (!match_nan) {
+			return -1;
+		}
+		if (elem_type == DUK_HBUFOBJ_ELEM_FLOAT32) {
+			DUK__TA_FIND_NAN(duk_float_t);
+		} else if (elem_type == DUK_HBUFOBJ_ELEM_FLOAT64) {
+			DUK__TA_FIND_NAN(duk_double_t);
+		}
+		return -1;
+	}
+
+	switch (elem_type) {
+	case DUK_HBUFOBJ_ELEM_UINT8:
+	case DUK_HBUFOBJ_ELEM_UINT8CLAMPED:
+	case DUK_HBUFOBJ_ELEM_INT8: {
+		const duk_uint8_t *q;
+		duk_uint8_t key;
+
+		if (elem_type == DUK_HBUFOBJ_ELEM_INT8) {
+			if (!(d >= -128.0 && d <= 127.0)) {
+				return -1;
+			}
+			key = (duk_uint8_t) (duk_int8_t) d;
+			if ((duk_double_t) (duk_int8_t) key != d) {
+				return -1;
+			}
+		} else {
+			if (!(d >= 0.0 && d <= 255.0)) {
+				return -1;
+			}
+			key = (duk_uint8_t) d;
+			if ((duk_double_t) key != d) {
+				return -1;
+			}
+		}
+		if (start >= n) {
+			return -1;
+		}
+		q = (const duk_uint8_t *) DUK_MEMCHR((const void *) (p + start), (int) key, (size_t) (n - start));
+		return (q != NULL ? (duk_int_t) (q - p) : -1);
+	}
+	case DUK_HBUFOBJ_ELEM_UINT16: {
+		duk_uint16_t key;
+		if (!(d >= 0.0 && d <= 65535.0)) {
+			return -1;
+		}
+		key = (duk_uint16_t) d;
+		if ((duk_double_t) key != d) {
+			return -1;
+		}
+		DUK__TA_FIND(duk_uint16_t, key);
+		break;
+	}
+	case DUK_HBUFOBJ_ELEM_INT16: {
+		duk_int16_t key;
+		if (!(d >= -32768.0 && d <= 32767.0)) {
+			return -1;
+		}
+		key = (duk_int16_t) d;
+		if ((duk_double_t) key != d) {
+			return -1;
+		}
+		DUK__TA_FIND(duk_int16_t, key);
+		break;
+	}
+	case DUK_HBUFOBJ_ELEM_UINT32: {
+		duk_uint32_t key;
+		if (!(d >= 0.0 && d <= 4294967295.0)) {
+			return -1;
+		}
+		key = (duk_uint32_t) d;
+		if ((duk_double_t) key != d) {
+			return -1;
+		}
+		DUK__TA_FIND(duk_uint32_t, key);
+		break;
+	}
+	case DUK_HBUFOBJ_ELEM_INT32: {
+		duk_int32_t key;
+		if (!(d >= -2147483648.0 && d <= 2147483647.0)) {
+			return -1;
+		}
+		key = (duk_int32_t) d;
+		if ((duk_double_t) key != d) {
+			return -1;
+		}
+		DUK__TA_FIND(duk_int32_t, key);
+		break;
+	}
+	case DUK_HBUFOBJ_ELEM_FLOAT32: {
+		duk_float_t key;
+		key = duk_double_to_float_t(d);
+		if ((duk_double_t) key != d) {
+			return -1;
+		}
+		DUK__TA_FIND(duk_float_t, key);
+		break;
+	}
+	default: {
+		DUK_ASSERT(elem_type == DUK_HBUFOBJ_ELEM_FLOAT64);
+		DUK__TA_FIND(duk_double_t, d);
+		break;
+	}
+	}
+	return -1;
+}
+
+#undef DUK__TA_CONV_NONE
+#undef DUK__TA_CONV_INT
+#undef DUK__TA_CONV_CLAMP_S8
+#undef DUK__TA_CONV_CLAMP_S
+#undef DUK__TA_CONV_CLAMP_U
+#undef DUK__TA_CONV_TO_FLOAT
+#undef DUK__TA_CONVERT
+#undef DUK__TA_CONVERT_FROM_INT
+#undef DUK__TA_REVERSE
+#undef DUK__TA_FIND
+#undef DUK__TA_FIND_NAN
+#endif  /* DUK_USE_BUFFEROBJECT_SUPPORT && DUK_USE_TYPEDARRAY_KERNELS */
+
 /*
  *  TypedArray.prototype.set()
  *
@@ -28849,6 +30892,13 @@ DUK_INTERNAL duk_ret_t duk_bi_typedarray_set(duk_hthread *thr) {
 		 * numbers are handled which should be side effect safe.
 		 */
 
+#if defined(DUK_USE_TYPEDARRAY_KERNELS)
+		if (duk__ta_convert(p_dst_base, h_this->elem_type, p_src_base, h_bufarg->elem_type, dst_length_elems)) {
+			return 0;
+		}
+		DUK_DDD(DUK_DDDPRINT("no kernel for element types, copy by item"));
+#endif
+
 		src_elem_size = (duk_small_uint_t) (1U << h_bufarg->shift);
 		dst_elem_size = (duk_small_uint_t) (1U << h_this->shift);
 		p_src = p_src_base;
@@ -28913,6 +30963,130 @@ DUK_INTERNAL duk_ret_t duk_bi_typedarray_set(duk_hthread *thr) {
 }
 #endif  /* DUK_USE_BUFFEROBJECT_SUPPORT */
 
+/*
+ *  TypedArray.prototype.fill()
+ *  TypedArray.prototype.indexOf()
+ *  TypedArray.prototype.includes()
+ *  TypedArray.prototype.reverse()
+ *
+ *  ES2015+ methods which are not part of the init data; they're added to
+ *  %TypedArray%.prototype by duk_hthread_create_builtin_objects().  All
+ *  argument coercions happen before the slice is validated, so that
+ *  side effects can't invalidate it.  A neutered view or a view not
+ *  covered by its underlying buffer is treated like an empty one.
+ */
+
+#if defined(DUK_USE_BUFFEROBJECT_SUPPORT) && defined(DUK_USE_TYPEDARRAY_KERNELS)
+DUK_LOCAL duk_hbufobj *duk__require_typedarray_this(duk_hthread *thr) {
+	duk_hbufobj *h_this;
+
+	h_this = duk__require_bufobj_this(thr);
+	DUK_ASSERT(h_this != NULL);
+	DUK_HBUFOBJ_ASSERT_VALID(h_this);
+	if (!h_this->is_typedarray) {
+		DUK_ERROR_TYPE(thr, DUK_STR_NOT_BUFFER);
+		DUK_WO_NORETURN(return NULL;);
+	}
+	return h_this;
+}
+
+DUK_INTERNAL duk_ret_t duk_bi_typedarray_fill(duk_hthread *thr) {
+	duk_hbufobj *h_this;
+	duk_int_t start_offset;
+	duk_int_t end_offset;
+	duk_uint8_t val[8];
+	duk_small_uint_t elem_size;
+
+	h_this = duk__require_typedarray_this(thr);
+
+	(void) duk_to_number(thr, 0);
+	duk__clamp_startend_negidx_shifted(thr,
+	                                   (duk_int_t) h_this->length,
+	                                   h_this->shift,
+	                                   1 /*idx_start*/,
+	                                   2 /*idx_end*/,
+	                                   &start_offset,
+	                                   &end_offset);
+	DUK_ASSERT(start_offset >= 0);
+	DUK_ASSERT(end_offset >= start_offset);
+
+	if (h_this->buf != NULL &&
+	    DUK_HBUFOBJ_VALID_BYTEOFFSET_EXCL(h_this, (duk_uint_t) end_offset)) {
+		/* Encode once; coercion of a number is side effect free. */
+		elem_size = (duk_small_uint_t) (1U << h_this->shift);
+		duk_dup_0(thr);
+		duk_hbufobj_validated_write(thr, h_this, val, elem_size);
+		duk_pop(thr);
+
+		duk__ta_fill(DUK_HBUFOBJ_GET_SLICE_BASE(thr->heap, h_this) + start_offset,
+		             val,
+		             elem_size,
+		             (duk_uint_t) (end_offset - start_offset) >> h_this->shift);
+	}
+
+	duk_push_this(thr);
+	return 1;
+}
+
+/* Magic: 0=indexOf, 1=includes. */
+DUK_INTERNAL duk_ret_t duk_bi_typedarray_indexof_shared(duk_hthread *thr) {
+	duk_hbufobj *h_this;
+	duk_small_int_t magic;
+	duk_int_t len;
+	duk_int_t from;
+	duk_int_t ret = -1;
+
+	h_this = duk__require_typedarray_this(thr);
+	magic = duk_get_current_magic(thr);
+
+	len = (duk_int_t) (h_this->length >> h_this->shift);
+	if (len == 0) {
+		goto done;
+	}
+	from = duk_to_int(thr, 1);
+	if (from < 0) {
+		from += len;
+		if (from < 0) {
+			from = 0;
+		}
+	}
+	if (from >= len || !duk_is_number(thr, 0)) {
+		goto done;
+	}
+
+	if (h_this->buf != NULL && DUK_HBUFOBJ_VALID_SLICE(h_this)) {
+		ret = duk__ta_index_of(DUK_HBUFOBJ_GET_SLICE_BASE(thr->heap, h_this),
+		                       h_this->elem_type,
+		                       (duk_uint_t) from,
+		                       (duk_uint_t) len,
+		                       duk_get_number(thr, 0),
+		                       (duk_bool_t) magic /*match_nan*/);
+	}
+
+ done:
+	if (magic) {
+		duk_push_boolean(thr, ret >= 0);
+	} else {
+		duk_push_int(thr, ret);
+	}
+	return 1;
+}
+
+DUK_INTERNAL duk_ret_t duk_bi_typedarray_reverse(duk_hthread *thr) {
+	duk_hbufobj *h_this;
+
+	h_this = duk__require_typedarray_this(thr);
+	if (h_this->buf != NULL && DUK_HBUFOBJ_VALID_SLICE(h_this)) {
+		duk__ta_reverse(DUK_HBUFOBJ_GET_SLICE_BASE(thr->heap, h_this),
+		                (duk_small_uint_t) (1U << h_this->shift),
+		                h_this->length >> h_this->shift);
+	}
+
+	duk_push_this(thr);
+	return 1;
+}
+#endif  /* DUK_USE_BUFFEROBJECT_SUPPORT && DUK_USE_TYPEDARRAY_KERNELS */
+
 /*
  *  Node.js Buffer.prototype.slice([start], [end])
  *  ArrayBuffer.prototype.slice(begin, [end])
@@ -30031,6 +32205,10 @@ typedef struct {
 	duk_idx_t idx_buf;
 	duk_uint_t recursion_depth;
 	duk_uint_t recursion_limit;
+#if defined(DUK_USE_CBOR_STREAMING)
+	duk_uint8_t *out;  /* caller owned output (CBOR.encodeInto()), NULL if none */
+	duk_size_t out_len;
+#endif
 } duk_cbor_encode_context;
 
 typedef struct {
@@ -30098,6 +32276,40 @@ DUK_LOCAL void duk__cbor_encode_sizet_uint32_check(duk_cbor_encode_context *enc_
 	}
 }
 
+#if defined(DUK_USE_CBOR_STREAMING)
+/* Output goes to a caller owned buffer.  Values reserve 1 + 8 bytes for
+ * their initial byte and argument even when they need less, so a failed
+ * reserve near the end of the output doesn't yet mean the value won't fit.
+ * Fail right away if the output can't fit even allowing for that slack,
+ * otherwise continue in a temporary buffer which has room for it; the
+ * caller copies the result back.
+ */
+DUK_LOCAL void duk__cbor_encode_ensure_fixed(duk_cbor_encode_context *enc_ctx, duk_size_t len) {
+	duk_size_t used;
+	duk_uint8_t *p_new;
+
+	used = (duk_size_t) (enc_ctx->ptr - enc_ctx->buf);
+	DUK_ASSERT(used <= enc_ctx->out_len + 8U);
+	if (DUK_UNLIKELY(len > enc_ctx->out_len + 8U - used)) {
+		DUK_ERROR_RANGE(enc_ctx->thr, DUK_STR_RESULT_TOO_LONG);
+		DUK_WO_NORETURN(return;);
+	}
+
+	/* The temporary buffer can't run out without failing above. */
+	DUK_ASSERT(enc_ctx->buf == enc_ctx->out);
+
+	DUK_DD(DUK_DDPRINT("cbor encode output near end of caller buffer, continue in temporary buffer"));
+
+	p_new = (duk_uint8_t *) duk_push_fixed_buffer_nozero(enc_ctx->thr, enc_ctx->out_len + 8U);
+	duk_replace(enc_ctx->thr, enc_ctx->idx_buf);
+	duk_memcpy((void *) p_new, (const void *) enc_ctx->buf, used);
+	enc_ctx->buf = p_new;
+	enc_ctx->ptr = p_new + used;
+	enc_ctx->len = enc_ctx->out_len + 8U;
+	enc_ctx->buf_end = p_new + enc_ctx->len;
+}
+#endif  /* DUK_USE_CBOR_STREAMING */
+
 DUK_LOCAL DUK_NOINLINE void duk__cbor_encode_ensure_slowpath(duk_cbor_encode_context *enc_ctx, duk_size_t len) {
 	duk_size_t oldlen;
 	duk_size_t minlen;
@@ -30109,6 +32321,13 @@ DUK_LOCAL DUK_NOINLINE void duk__cbor_encode_ensure_slowpath(duk_cbor_encode_con
 	DUK_ASSERT(enc_ctx->buf_end >= enc_ctx->ptr);
 	DUK_ASSERT(enc_ctx->buf_end >= enc_ctx->buf);
 
+#if defined(DUK_USE_CBOR_STREAMING)
+	if (enc_ctx->out != NULL) {
+		duk__cbor_encode_ensure_fixed(enc_ctx, len);
+		return;
+	}
+#endif
+
 	/* Overflow check.
 	 *
 	 * Limit example: 0xffffffffUL / 2U = 0x7fffffffUL, we reject >= 0x80000000UL.
@@ -30482,6 +32701,80 @@ DUK_LOCAL void duk__cbor_encode_string_top(duk_cbor_encode_context *enc_ctx) {
 	enc_ctx->ptr = p;
 }
 
+#if defined(DUK_USE_CBOR_STREAMING)
+/* Buffer data being encoded can't share memory with the caller owned
+ * output, it would be overwritten while being copied.
+ */
+DUK_LOCAL void duk__cbor_encode_check_overlap(duk_cbor_encode_context *enc_ctx, const duk_uint8_t *buf, duk_size_t len) {
+	if (enc_ctx->out != NULL && len > 0U &&
+	    buf < enc_ctx->out + enc_ctx->out_len && enc_ctx->out < buf + len) {
+		DUK_ERROR_TYPE_INVALID_ARGS(enc_ctx->thr);
+		DUK_WO_NORETURN(return;);
+	}
+}
+
+/* Encode the own enumerable properties of a plain object straight from its
+ * property table, avoiding the enumerator object duk_enum() allocates.
+ * Objects which need the enumerator for key order or exotic behavior are
+ * rejected before anything is emitted.  A getter reached through a nested
+ * value may mutate the object; the table is re-read on every step so that
+ * is memory safe, but like with arrays the mutation may then show in the
+ * output (the enumerator would work from a snapshot of the keys).
+ */
+DUK_LOCAL duk_bool_t duk__cbor_encode_object_props_fast(duk_cbor_encode_context *enc_ctx, duk_uint32_t *out_count) {
+	duk_hthread *thr = enc_ctx->thr;
+	duk_hobject *obj;
+	duk_hstring *k;
+	duk_idx_t idx_obj;
+	duk_uint_fast32_t i, n;
+	duk_uint32_t count;
+
+	obj = duk_known_hobject(thr, -1);
+	if (DUK_HOBJECT_GET_CLASS_NUMBER(obj) != DUK_HOBJECT_CLASS_OBJECT ||
+	    DUK_HOBJECT_HAS_EXOTIC_BEHAVIOR(obj) ||
+	    DUK_HOBJECT_IS_PROXY(obj) ||
+	    DUK_HOBJECT_HAS_ARRAY_PART(obj)) {
+		return 0;
+	}
+	n = (duk_uint_fast32_t) DUK_HOBJECT_GET_ENEXT(obj);
+	for (i = 0; i < n; i++) {
+		/* The enumerator sorts array index keys first. */
+		k = DUK_HOBJECT_E_GET_KEY(thr->heap, obj, i);
+		if (k != NULL && DUK_HSTRING_HAS_ARRIDX(k)) {
+			return 0;
+		}
+	}
+
+	idx_obj = duk_get_top_index(thr);
+	count = 0U;
+	for (i = 0; i < n && i < (duk_uint_fast32_t) DUK_HOBJECT_GET_ENEXT(obj); i++) {
+		k = DUK_HOBJECT_E_GET_KEY(thr->heap, obj, i);
+		if (k == NULL ||
+		    DUK_HSTRING_HAS_SYMBOL(k) ||
+		    !DUK_HOBJECT_E_SLOT_IS_ENUMERABLE(thr->heap, obj, i)) {
+			continue;
+		}
+		duk_push_hstring(thr, k);
+		if (DUK_HOBJECT_E_SLOT_IS_ACCESSOR(thr->heap, obj, i)) {
+			duk_dup_top(thr);
+			duk_get_prop(thr, idx_obj);
+		} else {
+			duk_push_tval(thr, DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(thr->heap, obj, i));
+		}
+		duk_insert(thr, -2);  /* [ ... key value ] -> [ ... value key ] */
+		duk__cbor_encode_value(enc_ctx);
+		duk__cbor_encode_value(enc_ctx);
+		count++;
+		if (count == 0U) {
+			duk__cbor_encode_error(enc_ctx);
+		}
+	}
+
+	*out_count = count;
+	return 1;
+}
+#endif  /* DUK_USE_CBOR_STREAMING */
+
 DUK_LOCAL void duk__cbor_encode_object(duk_cbor_encode_context *enc_ctx) {
 	duk_uint8_t *buf;
 	duk_size_t len;
@@ -30516,6 +32809,9 @@ DUK_LOCAL void duk__cbor_encode_object(duk_cbor_encode_context *enc_ctx) {
 		 */
 		buf = (duk_uint8_t *) duk_require_buffer_data(enc_ctx->thr, -1, &len);
 		duk__cbor_encode_sizet_uint32_check(enc_ctx, len);
+#if defined(DUK_USE_CBOR_STREAMING)
+		duk__cbor_encode_check_overlap(enc_ctx, buf, len);
+#endif
 		duk__cbor_encode_uint32(enc_ctx, (duk_uint32_t) len, 0x40U);
 		duk__cbor_encode_ensure(enc_ctx, len);
 		p = enc_ctx->ptr;
@@ -30537,17 +32833,22 @@ DUK_LOCAL void duk__cbor_encode_object(duk_cbor_encode_context *enc_ctx) {
 		p = enc_ctx->ptr;
 		*p++ = 0xa0U + 0x1fU;  /* indefinite length */
 		enc_ctx->ptr = p;
-		duk_enum(enc_ctx->thr, -1, DUK_ENUM_OWN_PROPERTIES_ONLY);
-		while (duk_next(enc_ctx->thr, -1, 1 /*get_value*/)) {
-			duk_insert(enc_ctx->thr, -2);  /* [ ... key value ] -> [ ... value key ] */
-			duk__cbor_encode_value(enc_ctx);
-			duk__cbor_encode_value(enc_ctx);
-			count++;
-			if (count == 0U) {
-				duk__cbor_encode_error(enc_ctx);
+#if defined(DUK_USE_CBOR_STREAMING)
+		if (!duk__cbor_encode_object_props_fast(enc_ctx, &count))
+#endif
+		{
+			duk_enum(enc_ctx->thr, -1, DUK_ENUM_OWN_PROPERTIES_ONLY);
+			while (duk_next(enc_ctx->thr, -1, 1 /*get_value*/)) {
+				duk_insert(enc_ctx->thr, -2);  /* [ ... key value ] -> [ ... value key ] */
+				duk__cbor_encode_value(enc_ctx);
+				duk__cbor_encode_value(enc_ctx);
+				count++;
+				if (count == 0U) {
+					duk__cbor_encode_error(enc_ctx);
+				}
 			}
+			duk_pop(enc_ctx->thr);
 		}
-		duk_pop(enc_ctx->thr);
 		if (count <= 0x17U) {
 			DUK_ASSERT(off_ib < enc_ctx->len);
 			enc_ctx->buf[off_ib] = 0xa0U + (duk_uint8_t) count;
@@ -30573,6 +32874,9 @@ DUK_LOCAL void duk__cbor_encode_buffer(duk_cbor_encode_context *enc_ctx) {
 	/* Tag buffer data? */
 	buf = (duk_uint8_t *) duk_require_buffer(enc_ctx->thr, -1, &len);
 	duk__cbor_encode_sizet_uint32_check(enc_ctx, len);
+#if defined(DUK_USE_CBOR_STREAMING)
+	duk__cbor_encode_check_overlap(enc_ctx, buf, len);
+#endif
 	duk__cbor_encode_uint32(enc_ctx, (duk_uint32_t) len, 0x40U);
 	duk__cbor_encode_ensure(enc_ctx, len);
 	p = enc_ctx->ptr;
@@ -31633,6 +33937,10 @@ DUK_LOCAL void duk__cbor_encode(duk_hthread *thr, duk_idx_t idx, duk_uint_t enco
 
 	enc_ctx.recursion_depth = 0;
 	enc_ctx.recursion_limit = DUK_USE_CBOR_ENC_RECLIMIT;
+#if defined(DUK_USE_CBOR_STREAMING)
+	enc_ctx.out = NULL;
+	enc_ctx.out_len = 0;
+#endif
 
 	duk_dup(thr, idx);
 	duk__cbor_encode_req_stack(&enc_ctx);
@@ -31642,22 +33950,158 @@ DUK_LOCAL void duk__cbor_encode(duk_hthread *thr, duk_idx_t idx, duk_uint_t enco
 	duk_replace(thr, idx);
 }
 
-DUK_LOCAL void duk__cbor_decode(duk_hthread *thr, duk_idx_t idx, duk_uint_t decode_flags) {
-	duk_cbor_decode_context dec_ctx;
+#if defined(DUK_USE_CBOR_STREAMING)
+/* Encode the value at idx into out[0,out_len) and return the number of
+ * bytes written.  Throws a RangeError if the output doesn't fit; the
+ * contents of 'out' are then unspecified.
+ */
+DUK_LOCAL duk_size_t duk__cbor_encode_into(duk_hthread *thr, duk_idx_t idx, duk_uint8_t *out, duk_size_t out_len) {
+	duk_cbor_encode_context enc_ctx;
+	duk_size_t used;
 
-	DUK_UNREF(decode_flags);
+	idx = duk_require_normalize_index(thr, idx);
 
-	/* Suppress compile warnings for functions only needed with e.g.
-	 * asserts enabled.
-	 */
-	DUK_UNREF(duk__cbor_get_reserve);
+	if (out_len == 0U) {
+		/* Every value needs at least one byte. */
+		DUK_ERROR_RANGE(thr, DUK_STR_RESULT_TOO_LONG);
+		DUK_WO_NORETURN(return 0;);
+	}
+	DUK_ASSERT(out != NULL);
 
-	idx = duk_require_normalize_index(thr, idx);
+	enc_ctx.thr = thr;
+	enc_ctx.idx_buf = duk_get_top(thr);
+	duk_push_undefined(thr);  /* temporary buffer, see duk__cbor_encode_ensure_fixed() */
+
+	enc_ctx.len = out_len;
+	enc_ctx.ptr = out;
+	enc_ctx.buf = out;
+	enc_ctx.buf_end = out + out_len;
+	enc_ctx.out = out;
+	enc_ctx.out_len = out_len;
+
+	enc_ctx.recursion_depth = 0;
+	enc_ctx.recursion_limit = DUK_USE_CBOR_ENC_RECLIMIT;
+
+	duk_dup(thr, idx);
+	duk__cbor_encode_req_stack(&enc_ctx);
+	duk__cbor_encode_value(&enc_ctx);
+	DUK_ASSERT(enc_ctx.recursion_depth == 0);
+
+	used = (duk_size_t) (enc_ctx.ptr - enc_ctx.buf);
+	if (used > out_len) {
+		DUK_ERROR_RANGE(thr, DUK_STR_RESULT_TOO_LONG);
+		DUK_WO_NORETURN(return 0;);
+	}
+	if (enc_ctx.buf != out) {
+		duk_memcpy((void *) out, (const void *) enc_ctx.buf, used);
+	}
+	duk_pop(thr);
+	return used;
+}
+
+/* Find the end of the item at dec_ctx->off without decoding it, so that a
+ * streamed item is only decoded once all of it has arrived.  Returns 0 if
+ * the input ends first.  Lengths and nesting are checked here, other format
+ * errors are left to the decoder.
+ */
+DUK_LOCAL duk_bool_t duk__cbor_decode_frame(duk_cbor_decode_context *dec_ctx) {
+	duk_uint8_t ib;
+	duk_uint8_t ai;
+	duk_uint8_t major;
+	duk_uint32_t n;
+	duk_uint32_t i;
+	duk_small_uint_t skip;
+	duk_bool_t complete;
+
+	if (dec_ctx->off >= dec_ctx->len) {
+		return 0;
+	}
+	ib = dec_ctx->buf[dec_ctx->off++];
+	major = ib >> 5;
+	ai = ib & 0x1fU;
+
+	if (ai == 0x1fU && major >= 2U && major <= 5U) {
+		/* Indefinite length string, array or map: items until a break. */
+		duk__cbor_decode_objarr_entry(dec_ctx);
+		for (;;) {
+			if (dec_ctx->off >= dec_ctx->len) {
+				complete = 0;
+				break;
+			}
+			if (dec_ctx->buf[dec_ctx->off] == 0xffU) {
+				dec_ctx->off++;
+				complete = 1;
+				break;
+			}
+			if (!duk__cbor_decode_frame(dec_ctx)) {
+				complete = 0;
+				break;
+			}
+		}
+		duk__cbor_decode_objarr_exit(dec_ctx);
+		return complete;
+	}
+	if (ai >= 0x1cU) {
+		/* Reserved, indefinite integer or tag, or a stray break. */
+		duk__cbor_decode_error(dec_ctx);
+	}
+
+	n = 0U;
+	if (ai >= 0x18U) {
+		skip = 1U << (ai - 0x18U);
+		if (dec_ctx->len - dec_ctx->off < skip) {
+			return 0;
+		}
+		if (major >= 2U && major <= 5U) {
+			n = duk__cbor_decode_aival_uint32(dec_ctx, ib);
+		} else {
+			dec_ctx->off += skip;
+		}
+	} else {
+		n = ai;
+	}
+
+	switch (major) {
+	case 2U:  /* byte string */
+	case 3U:  /* text string */
+		if (dec_ctx->len - dec_ctx->off < n) {
+			return 0;
+		}
+		dec_ctx->off += n;
+		return 1;
+	case 4U:  /* array */
+	case 5U:  /* map */
+	case 6U:  /* tag, followed by one item */
+		duk__cbor_decode_objarr_entry(dec_ctx);
+		complete = 1;
+		if (major == 6U) {
+			complete = duk__cbor_decode_frame(dec_ctx);
+		} else {
+			for (i = 0; i < n && complete; i++) {
+				complete = duk__cbor_decode_frame(dec_ctx);
+				if (major == 5U && complete) {
+					complete = duk__cbor_decode_frame(dec_ctx);
+				}
+			}
+		}
+		duk__cbor_decode_objarr_exit(dec_ctx);
+		return complete;
+	default:  /* integers and simple values, argument skipped above */
+		return 1;
+	}
+}
+#endif  /* DUK_USE_CBOR_STREAMING */
+
+/* Decode a single item from buf[off,end) and push it. */
+DUK_LOCAL void duk__cbor_decode_range(duk_hthread *thr, const duk_uint8_t *buf, duk_size_t off, duk_size_t end) {
+	duk_cbor_decode_context dec_ctx;
+
+	DUK_ASSERT(off <= end);
 
 	dec_ctx.thr = thr;
-	dec_ctx.buf = (const duk_uint8_t *) duk_require_buffer_data(thr, idx, &dec_ctx.len);
-	dec_ctx.off = 0;
-	/* dec_ctx.len: set above */
+	dec_ctx.buf = buf;
+	dec_ctx.off = off;
+	dec_ctx.len = end;
 
 	dec_ctx.recursion_depth = 0;
 	dec_ctx.recursion_limit = DUK_USE_CBOR_DEC_RECLIMIT;
@@ -31668,7 +34112,23 @@ DUK_LOCAL void duk__cbor_decode(duk_hthread *thr, duk_idx_t idx, duk_uint_t deco
 	if (dec_ctx.off != dec_ctx.len) {
 		(void) duk_type_error(thr, "trailing garbage");
 	}
+}
+
+DUK_LOCAL void duk__cbor_decode(duk_hthread *thr, duk_idx_t idx, duk_uint_t decode_flags) {
+	const duk_uint8_t *buf;
+	duk_size_t len;
+
+	DUK_UNREF(decode_flags);
 
+	/* Suppress compile warnings for functions only needed with e.g.
+	 * asserts enabled.
+	 */
+	DUK_UNREF(duk__cbor_get_reserve);
+
+	idx = duk_require_normalize_index(thr, idx);
+
+	buf = (const duk_uint8_t *) duk_require_buffer_data(thr, idx, &len);
+	duk__cbor_decode_range(thr, buf, 0, len);
 	duk_replace(thr, idx);
 }
 
@@ -31716,12 +34176,246 @@ DUK_INTERNAL duk_ret_t duk_bi_cbor_encode(duk_hthread *thr) {
 	return 1;
 }
 
+#if defined(DUK_USE_CBOR_STREAMING)
+/* Validate an optional [offset, [length]] view starting at 'idx' into a
+ * buffer of *p_len bytes.  Returns the offset and sets *p_len to the view
+ * length.
+ */
+DUK_LOCAL duk_size_t duk__cbor_get_view(duk_hthread *thr, duk_idx_t idx, duk_size_t *p_len) {
+	duk_int_t off;
+	duk_int_t len;
+
+	off = duk_to_int(thr, idx);
+	if (off < 0 || (duk_size_t) off > *p_len) {
+		goto fail_args;
+	}
+	*p_len -= (duk_size_t) off;
+	if (duk_get_top(thr) > idx + 1 && !duk_is_undefined(thr, idx + 1)) {
+		len = duk_to_int(thr, idx + 1);
+		if (len < 0 || (duk_size_t) len > *p_len) {
+			goto fail_args;
+		}
+		*p_len = (duk_size_t) len;
+	}
+	return (duk_size_t) off;
+
+ fail_args:
+	DUK_ERROR_RANGE_INVALID_ARGS(thr);
+	DUK_WO_NORETURN(return 0;);
+}
+
+/* CBOR.decode(buffer, [offset], [length]): registered again with nargs 3
+ * by duk_hthread_create_builtin_objects().
+ */
+DUK_INTERNAL duk_ret_t duk_bi_cbor_decode(duk_hthread *thr) {
+	const duk_uint8_t *buf;
+	duk_size_t len;
+	duk_size_t off;
+
+	DUK_ASSERT_TOP(thr, 3);
+	buf = (const duk_uint8_t *) duk_require_buffer_data(thr, 0, &len);
+	off = duk__cbor_get_view(thr, 1, &len);
+	duk__cbor_decode_range(thr, buf, off, off + len);
+	return 1;
+}
+
+/* CBOR.encodeInto(value, buffer, [offset]): encode into an existing buffer
+ * and return the number of bytes written.  Nothing is allocated unless the
+ * output ends within a few bytes of the end of the buffer.
+ */
+DUK_INTERNAL duk_ret_t duk_bi_cbor_encode_into(duk_hthread *thr) {
+	duk_uint8_t *buf;
+	duk_size_t len;
+	duk_size_t off;
+
+	DUK_ASSERT_TOP(thr, 3);
+	buf = (duk_uint8_t *) duk_require_buffer_data(thr, 1, &len);
+	off = duk__cbor_get_view(thr, 2, &len);
+	len = duk__cbor_encode_into(thr, 0, buf + off, len);
+	duk_push_uint(thr, (duk_uint_t) len);
+	return 1;
+}
+
+/* CBOR.Decoder state, kept with the pending input and the handler in a
+ * bare array in the instance's hidden Context property.  An error thrown
+ * while decoding, or by the handler, leaves the decoder busy and unusable.
+ */
+typedef struct {
+	duk_size_t pending_len;  /* start of an incomplete item, kept in the pending buffer */
+	duk_uint8_t busy;
+} duk__cbor_dec_state;
+
+#define DUK__CBOR_DEC_SLOT_STATE    0
+#define DUK__CBOR_DEC_SLOT_PENDING  1
+#define DUK__CBOR_DEC_SLOT_HANDLER  2
+
+#define DUK__CBOR_DEC_IDX_CHUNK     0
+#define DUK__CBOR_DEC_IDX_CONTEXT   2
+#define DUK__CBOR_DEC_IDX_PENDING   3
+#define DUK__CBOR_DEC_IDX_HANDLER   4
+
+/* [ chunk ] -> [ chunk this context pending handler ] */
+DUK_LOCAL duk__cbor_dec_state *duk__cbor_decoder_begin(duk_hthread *thr) {
+	duk__cbor_dec_state *st;
+	duk_size_t size;
+
+	DUK_ASSERT_TOP(thr, 1);
+	duk_push_this(thr);
+	duk_get_prop_literal(thr, -1, DUK_INTERNAL_SYMBOL("Context"));
+	duk_get_prop_index(thr, DUK__CBOR_DEC_IDX_CONTEXT, DUK__CBOR_DEC_SLOT_STATE);
+	st = (duk__cbor_dec_state *) duk_require_buffer(thr, -1, &size);
+	if (size != sizeof(duk__cbor_dec_state) || st->busy) {
+		DUK_ERROR_TYPE(thr, DUK_STR_INVALID_STATE);
+		DUK_WO_NORETURN(return NULL;);
+	}
+	duk_pop(thr);
+	duk_get_prop_index(thr, DUK__CBOR_DEC_IDX_CONTEXT, DUK__CBOR_DEC_SLOT_PENDING);
+	duk_get_prop_index(thr, DUK__CBOR_DEC_IDX_CONTEXT, DUK__CBOR_DEC_SLOT_HANDLER);
+	st->busy = 1;
+	return st;
+}
+
+/* Decode and hand out the complete items in the first 'len' bytes of the
+ * buffer at 'idx', returning the number of bytes they took.  The data
+ * pointer is looked up again after each handler call.
+ */
+DUK_LOCAL duk_size_t duk__cbor_decoder_emit(duk_hthread *thr, duk_idx_t idx, duk_size_t len) {
+	duk_cbor_decode_context dec_ctx;
+	duk_size_t off;
+	duk_size_t buf_len;
+
+	dec_ctx.thr = thr;
+	dec_ctx.recursion_limit = DUK_USE_CBOR_DEC_RECLIMIT;
+	off = 0;
+	for (;;) {
+		dec_ctx.buf = (const duk_uint8_t *) duk_require_buffer_data(thr, idx, &buf_len);
+		dec_ctx.off = off;
+		dec_ctx.len = len < buf_len ? len : buf_len;
+		dec_ctx.recursion_depth = 0;
+		if (!duk__cbor_decode_frame(&dec_ctx)) {
+			break;
+		}
+		DUK_ASSERT(dec_ctx.recursion_depth == 0);
+
+		duk_dup(thr, DUK__CBOR_DEC_IDX_HANDLER);
+		duk__cbor_decode_range(thr, dec_ctx.buf, off, dec_ctx.off);
+		off = dec_ctx.off;
+		duk_call(thr, 1);
+		duk_pop(thr);
+	}
+	return off;
+}
+
+/* Append chunk[off,len) to the pending input. */
+DUK_LOCAL void duk__cbor_decoder_append(duk_hthread *thr, duk__cbor_dec_state *st, const duk_uint8_t *chunk, duk_size_t off, duk_size_t len) {
+	duk_uint8_t *pending;
+	duk_size_t size;
+	duk_size_t need;
+
+	DUK_ASSERT(off <= len);
+	pending = (duk_uint8_t *) duk_require_buffer(thr, DUK__CBOR_DEC_IDX_PENDING, &size);
+	need = st->pending_len + (len - off);
+	if (need < st->pending_len) {
+		DUK_ERROR_RANGE(thr, DUK_STR_RESULT_TOO_LONG);
+		DUK_WO_NORETURN(return;);
+	}
+	if (need > size) {
+		size = size * 2U > need ? size * 2U : need;
+		pending = (duk_uint8_t *) duk_resize_buffer(thr, DUK__CBOR_DEC_IDX_PENDING, size);
+	}
+	duk_memcpy_unsafe((void *) (pending + st->pending_len), (const void *) (chunk + off), len - off);
+	st->pending_len = need;
+}
+
+DUK_LOCAL void duk__cbor_decoder_write_chunk(duk_hthread *thr, duk__cbor_dec_state *st) {
+	const duk_uint8_t *chunk;
+	duk_uint8_t *pending;
+	duk_size_t len;
+	duk_size_t used;
+
+	(void) duk_require_buffer_data(thr, DUK__CBOR_DEC_IDX_CHUNK, &len);
+	if (st->pending_len == 0) {
+		/* Common case: decode straight from the chunk and keep only
+		 * a trailing partial item.
+		 */
+		used = duk__cbor_decoder_emit(thr, DUK__CBOR_DEC_IDX_CHUNK, len);
+		chunk = (const duk_uint8_t *) duk_require_buffer_data(thr, DUK__CBOR_DEC_IDX_CHUNK, &len);
+		if (used < len) {
+			duk__cbor_decoder_append(thr, st, chunk, used, len);
+		}
+		return;
+	}
+
+	chunk = (const duk_uint8_t *) duk_require_buffer_data(thr, DUK__CBOR_DEC_IDX_CHUNK, &len);
+	duk__cbor_decoder_append(thr, st, chunk, 0, len);
+	used = duk__cbor_decoder_emit(thr, DUK__CBOR_DEC_IDX_PENDING, st->pending_len);
+	if (used > 0) {
+		pending = (duk_uint8_t *) duk_require_buffer(thr, DUK__CBOR_DEC_IDX_PENDING, NULL);
+		duk_memmove((void *) pending, (const void *) (pending + used), st->pending_len - used);
+		st->pending_len -= used;
+	}
+}
+
+/* new CBOR.Decoder(handler) */
+DUK_INTERNAL duk_ret_t duk_bi_cbor_decoder_constructor(duk_hthread *thr) {
+	duk__cbor_dec_state *st;
+
+	DUK_ASSERT_TOP(thr, 1);
+	duk_require_constructor_call(thr);
+	duk_require_callable(thr, 0);
+
+	duk_push_this(thr);
+	duk_push_bare_array(thr);
+
+	st = (duk__cbor_dec_state *) duk_push_fixed_buffer(thr, sizeof(duk__cbor_dec_state));
+	duk_memzero((void *) st, sizeof(duk__cbor_dec_state));
+	duk_put_prop_index(thr, -2, DUK__CBOR_DEC_SLOT_STATE);
+	duk_push_dynamic_buffer(thr, 0);
+	duk_put_prop_index(thr, -2, DUK__CBOR_DEC_SLOT_PENDING);
+	duk_dup_0(thr);
+	duk_put_prop_index(thr, -2, DUK__CBOR_DEC_SLOT_HANDLER);
+
+	duk_put_prop_literal(thr, -2, DUK_INTERNAL_SYMBOL("Context"));
+	return 0;
+}
+
+/* CBOR.Decoder.prototype.write(chunk): call the handler for each item
+ * completed by the chunk.  Items may span chunks.
+ */
+DUK_INTERNAL duk_ret_t duk_bi_cbor_decoder_prototype_write(duk_hthread *thr) {
+	duk__cbor_dec_state *st;
+
+	st = duk__cbor_decoder_begin(thr);
+	duk__cbor_decoder_write_chunk(thr, st);
+	st->busy = 0;
+	return 0;
+}
+
+/* CBOR.Decoder.prototype.end([chunk]): write the last chunk and check
+ * that no partial item is left.  The decoder may then be reused.
+ */
+DUK_INTERNAL duk_ret_t duk_bi_cbor_decoder_prototype_end(duk_hthread *thr) {
+	duk__cbor_dec_state *st;
+
+	st = duk__cbor_decoder_begin(thr);
+	if (!duk_is_undefined(thr, DUK__CBOR_DEC_IDX_CHUNK)) {
+		duk__cbor_decoder_write_chunk(thr, st);
+	}
+	if (st->pending_len != 0) {
+		(void) duk_type_error(thr, "cbor decode error");
+	}
+	duk_resize_buffer(thr, DUK__CBOR_DEC_IDX_PENDING, 0);
+	st->busy = 0;
+	return 0;
+}
+#else  /* DUK_USE_CBOR_STREAMING */
 DUK_INTERNAL duk_ret_t duk_bi_cbor_decode(duk_hthread *thr) {
 	DUK_ASSERT_TOP(thr, 1);
 
 	duk__cbor_decode(thr, -1, 0 /*flags*/);
 	return 1;
 }
+#endif  /* DUK_USE_CBOR_STREAMING */
 #else  /* DUK_USE_CBOR_SUPPORT */
 DUK_INTERNAL duk_ret_t duk_bi_cbor_encode(duk_hthread *thr) {
 	DUK_ERROR_UNSUPPORTED(thr);
@@ -31736,6 +34430,13 @@ DUK_INTERNAL duk_ret_t duk_bi_cbor_decode(duk_hthread *thr) {
 
 /* automatic undefs */
 #undef DUK__CBOR_AI
+#undef DUK__CBOR_DEC_IDX_CHUNK
+#undef DUK__CBOR_DEC_IDX_CONTEXT
+#undef DUK__CBOR_DEC_IDX_HANDLER
+#undef DUK__CBOR_DEC_IDX_PENDING
+#undef DUK__CBOR_DEC_SLOT_HANDLER
+#undef DUK__CBOR_DEC_SLOT_PENDING
+#undef DUK__CBOR_DEC_SLOT_STATE
 /*
  *  Date built-ins
  *
@@ -34167,7 +36868,8 @@ DUK_INTERNAL duk_ret_t duk_bi_duktape_object_enc(duk_hthread *thr) {
 		                             3 /*idx_space*/,
 		                             DUK_JSON_FLAG_EXT_CUSTOM |
 		                             DUK_JSON_FLAG_ASCII_ONLY |
-		                             DUK_JSON_FLAG_AVOID_KEY_QUOTES /*flags*/);
+		                             DUK_JSON_FLAG_AVOID_KEY_QUOTES /*flags*/,
+		                             NULL /*sink*/);
 #endif
 #if defined(DUK_USE_JSON_SUPPORT) && defined(DUK_USE_JC)
 	} else if (h_str == DUK_HTHREAD_STRING_JC(thr)) {
@@ -34176,7 +36878,8 @@ DUK_INTERNAL duk_ret_t duk_bi_duktape_object_enc(duk_hthread *thr) {
 		                             2 /*idx_replacer*/,
 		                             3 /*idx_space*/,
 		                             DUK_JSON_FLAG_EXT_COMPATIBLE |
-		                             DUK_JSON_FLAG_ASCII_ONLY /*flags*/);
+		                             DUK_JSON_FLAG_ASCII_ONLY /*flags*/,
+		                             NULL /*sink*/);
 #endif
 	} else {
 		DUK_DCERROR_TYPE_INVALID_ARGS(thr);
@@ -34223,6 +36926,39 @@ DUK_INTERNAL duk_ret_t duk_bi_duktape_object_dec(duk_hthread *thr) {
 	return 1;
 }
 
+#if defined(DUK_USE_CODEC_DECODE_INTO)
+/* Duktape.decInto(format, value, buffer, [offset]): decode 'hex' or 'base64'
+ * directly into an existing buffer and return the number of bytes written.
+ * The target may be the input buffer itself for in-place decoding.
+ */
+DUK_INTERNAL duk_ret_t duk_bi_duktape_object_dec_into(duk_hthread *thr) {
+	duk_hstring *h_str;
+	duk_uint8_t *buf;
+	duk_size_t len;
+	duk_int_t off;
+
+	DUK_ASSERT_TOP(thr, 4);
+	h_str = duk_require_hstring(thr, 0);
+	buf = (duk_uint8_t *) duk_require_buffer_data(thr, 2, &len);
+	off = duk_to_int(thr, 3);
+	if (off < 0 || (duk_size_t) off > len) {
+		DUK_DCERROR_RANGE_INVALID_ARGS(thr);
+	}
+	buf += off;
+	len -= (duk_size_t) off;
+
+	if (h_str == DUK_HTHREAD_STRING_HEX(thr)) {
+		len = duk_hex_decode_into(thr, 1, (void *) buf, len);
+	} else if (h_str == DUK_HTHREAD_STRING_BASE64(thr)) {
+		len = duk_base64_decode_into(thr, 1, (void *) buf, len);
+	} else {
+		DUK_DCERROR_TYPE_INVALID_ARGS(thr);
+	}
+	duk_push_uint(thr, (duk_uint_t) len);
+	return 1;
+}
+#endif  /* DUK_USE_CODEC_DECODE_INTO */
+
 /*
  *  Compact an object
  */
@@ -34272,10 +37008,19 @@ typedef struct {
 #define DUK__CP_ERROR      (-2)  /* decoding error */
 #define DUK__CP_RETRY      (-3)  /* decoding error; retry last byte */
 
+#if defined(DUK_USE_ENCODING_BUILTINS) && \
+    (defined(DUK_USE_ENCODING_FASTPATH) || defined(DUK_USE_TEXTENCODER_ENCODE_INTO))
+#define DUK__UTF8_ENCODE_STRING
+#endif
+#if defined(DUK_USE_ENCODING_FASTPATH) || defined(DUK__UTF8_ENCODE_STRING)
+#define DUK__UTF8_COPY_PLAIN
+#endif
+
 /*
  *  Raw helpers for encoding/decoding
  */
 
+#if !defined(DUK_USE_ENCODING_FASTPATH)
 /* Emit UTF-8 (= CESU-8) encoded U+FFFD (replacement char), i.e. ef bf bd. */
 DUK_LOCAL duk_uint8_t *duk__utf8_emit_repl(duk_uint8_t *ptr) {
 	*ptr++ = 0xef;
@@ -34283,6 +37028,7 @@ DUK_LOCAL duk_uint8_t *duk__utf8_emit_repl(duk_uint8_t *ptr) {
 	*ptr++ = 0xbd;
 	return ptr;
 }
+#endif
 
 DUK_LOCAL void duk__utf8_decode_init(duk__decode_context *dec_ctx) {
 	/* (Re)init the decoding state of 'dec_ctx' but leave decoder
@@ -34379,7 +37125,137 @@ DUK_LOCAL duk_codepoint_t duk__utf8_decode_next(duk__decode_context *dec_ctx, du
 	}
 }
 
-#if defined(DUK_USE_ENCODING_BUILTINS)
+#if defined(DUK__UTF8_COPY_PLAIN)
+/* ASCII is scanned a word at a time.  Words are only read from aligned
+ * addresses (required on e.g. Xtensa) and never past the end of the input.
+ */
+#if (DUK_SIZE_MAX > 0xffffffffUL) && defined(DUK_USE_64BIT_OPS)
+typedef duk_uint64_t duk__utf8_word;
+#define DUK__UTF8_WORD_HIGHS            DUK_U64_CONSTANT(0x8080808080808080)
+#else
+typedef duk_uint32_t duk__utf8_word;
+#define DUK__UTF8_WORD_HIGHS            0x80808080UL
+#endif
+#define DUK__UTF8_WORD_IS_ALIGNED(p) \
+	((((duk_size_t) (const void *) (p)) & (sizeof(duk__utf8_word) - 1U)) == 0)
+
+/* Copy a run of well-formed UTF-8 from [*p_ptr,p_end) to 'q', which may be
+ * NULL to only scan.  The run only contains 1-3 byte sequences other than
+ * surrogates, which are encoded identically in UTF-8 and CESU-8, so it can
+ * be copied as is in both directions.  Stops at a 4-byte sequence, at an
+ * invalid byte, and at a sequence truncated by 'p_end'.  Returns the
+ * updated 'q'.
+ */
+DUK_LOCAL duk_uint8_t *duk__utf8_copy_plain(const duk_uint8_t **p_ptr, const duk_uint8_t *p_end, duk_uint8_t *q) {
+	const duk_uint8_t *p = *p_ptr;
+	const duk_uint8_t *p_start = p;
+	duk_uint8_t x;
+	duk_uint8_t y;
+
+	while (p < p_end) {
+		x = *p;
+		if (x <= 0x7f) {
+			p++;
+			if (DUK__UTF8_WORD_IS_ALIGNED(p)) {
+				while ((duk_size_t) (p_end - p) >= sizeof(duk__utf8_word) &&
+				       ((*((const duk__utf8_word *) (const void *) p)) & DUK__UTF8_WORD_HIGHS) == 0) {
+					p += sizeof(duk__utf8_word);
+				}
+			}
+		} else if (x >= 0xc2 && x <= 0xdf) {
+			/* U+0080-U+07FF */
+			if ((duk_size_t) (p_end - p) < 2 || (p[1] & 0xc0) != 0x80) {
+				break;
+			}
+			p += 2;
+		} else if (x >= 0xe0 && x <= 0xef) {
+			/* U+0800-U+FFFF, shortest form only and no surrogates */
+			if ((duk_size_t) (p_end - p) < 3) {
+				break;
+			}
+			y = p[1];
+			if ((y & 0xc0) != 0x80 || (p[2] & 0xc0) != 0x80 ||
+			    (x == 0xe0 && y < 0xa0) || (x == 0xed && y > 0x9f)) {
+				break;
+			}
+			p += 3;
+		} else {
+			break;
+		}
+	}
+
+	if (q != NULL && p != p_start) {
+		duk_memcpy((void *) q, (const void *) p_start, (size_t) (p - p_start));
+		q += p - p_start;
+	}
+	*p_ptr = p;
+	return q;
+}
+#endif  /* DUK__UTF8_COPY_PLAIN */
+
+#if defined(DUK__UTF8_ENCODE_STRING)
+/* Encode string 'h_input' into UTF-8 at 'out', writing at most 'out_len'
+ * bytes and never splitting a codepoint or a surrogate pair.  Surrogate
+ * pairs are combined; unpaired surrogates and codepoints above U+10FFFF
+ * become U+FFFD.  Output is never longer than the input bytes consumed,
+ * whose count is written to '*out_consumed'.  Returns bytes written.
+ */
+DUK_LOCAL duk_size_t duk__utf8_encode_string(duk_hthread *thr, duk_hstring *h_input, duk_uint8_t *out, duk_size_t out_len, duk_size_t *out_consumed) {
+	const duk_uint8_t *p_start;
+	const duk_uint8_t *p_end;
+	const duk_uint8_t *p;
+	const duk_uint8_t *p_prev;
+	const duk_uint8_t *p_next;
+	duk_uint8_t *q;
+	duk_uint8_t *q_end;
+	duk_codepoint_t cp;
+	duk_codepoint_t cp_low;
+
+	p_start = (const duk_uint8_t *) DUK_HSTRING_GET_DATA(h_input);
+	p_end = p_start + DUK_HSTRING_GET_BYTELEN(h_input);
+	p = p_start;
+	q = out;
+	q_end = out + out_len;
+
+	for (;;) {
+		/* Copied runs have the same length in the output. */
+		q = duk__utf8_copy_plain(&p, ((duk_size_t) (p_end - p) <= (duk_size_t) (q_end - q) ? p_end : p + (q_end - q)), q);
+		if (p >= p_end) {
+			break;
+		}
+
+		p_prev = p;
+		cp = (duk_codepoint_t) duk_unicode_decode_xutf8_checked(thr, &p, p_start, p_end);
+		if (cp >= 0xd800L && cp <= 0xdbffL) {
+			/* high surrogate, combine with a following low surrogate */
+			p_next = p;
+			if (p < p_end &&
+			    (cp_low = (duk_codepoint_t) duk_unicode_decode_xutf8_checked(thr, &p_next, p_start, p_end)) >= 0xdc00L &&
+			    cp_low <= 0xdfffL) {
+				cp = (duk_codepoint_t) (0x010000L + ((cp - 0xd800L) << 10) + (cp_low - 0xdc00L));
+				p = p_next;
+			} else {
+				cp = DUK_UNICODE_CP_REPLACEMENT_CHARACTER;
+			}
+		} else if ((cp >= 0xdc00L && cp <= 0xdfffL) || DUK_UNLIKELY(cp > 0x10ffffL)) {
+			/* unpaired low surrogate, or cannot legally encode in UTF-8 */
+			cp = DUK_UNICODE_CP_REPLACEMENT_CHARACTER;
+		}
+
+		if ((duk_size_t) duk_unicode_get_xutf8_length((duk_ucodepoint_t) cp) > (duk_size_t) (q_end - q)) {
+			p = p_prev;
+			break;
+		}
+		q += duk_unicode_encode_xutf8((duk_ucodepoint_t) cp, q);
+		DUK_ASSERT(q - out <= p - p_start);
+	}
+
+	*out_consumed = (duk_size_t) (p - p_start);
+	return (duk_size_t) (q - out);
+}
+#endif  /* DUK__UTF8_ENCODE_STRING */
+
+#if defined(DUK_USE_ENCODING_BUILTINS) && !defined(DUK_USE_ENCODING_FASTPATH)
 DUK_LOCAL void duk__utf8_encode_char(void *udata, duk_codepoint_t codepoint) {
 	duk__encode_context *enc_ctx;
 
@@ -34434,7 +37310,7 @@ DUK_LOCAL void duk__utf8_encode_char(void *udata, duk_codepoint_t codepoint) {
 	 */
 	enc_ctx->out += duk_unicode_encode_xutf8((duk_ucodepoint_t) codepoint, enc_ctx->out);
 }
-#endif  /* DUK_USE_ENCODING_BUILTINS */
+#endif  /* DUK_USE_ENCODING_BUILTINS && !DUK_USE_ENCODING_FASTPATH */
 
 /* Shared helper for buffer-to-string using a TextDecoder() compatible UTF-8
  * decoder.
@@ -34446,8 +37322,12 @@ DUK_LOCAL duk_ret_t duk__decode_helper(duk_hthread *thr, duk__decode_context *de
 	duk_bool_t stream = 0;
 	duk_codepoint_t codepoint;
 	duk_uint8_t *output;
+	duk_size_t out_size;
 	const duk_uint8_t *in;
 	duk_uint8_t *out;
+#if defined(DUK_USE_ENCODING_FASTPATH)
+	duk_size_t n_plain = 0;
+#endif
 
 	DUK_ASSERT(dec_ctx != NULL);
 
@@ -34492,7 +37372,22 @@ DUK_LOCAL duk_ret_t duk__decode_helper(duk_hthread *thr, duk__decode_context *de
 		DUK_ERROR_TYPE(thr, DUK_STR_RESULT_TOO_LONG);
 		DUK_WO_NORETURN(return 0;);
 	}
-	output = (duk_uint8_t *) duk_push_fixed_buffer_nozero(thr, 3 + (3 * len));  /* used parts will be always manually written over */
+	out_size = 3 + (3 * len);
+#if defined(DUK_USE_ENCODING_FASTPATH)
+	/* A leading run which is copied as is needs no U+FFFD allowance, so
+	 * scan it now (no side effects in between) and size the output for
+	 * it exactly.  For typical inputs the output is then ~len bytes.
+	 */
+	if (dec_ctx->needed == 0 && len > 0) {
+		input = (const duk_uint8_t *) duk_get_buffer_data(thr, 0, &len_tmp);
+		DUK_ASSERT(input != NULL && len_tmp == len);
+		in = input;
+		(void) duk__utf8_copy_plain(&in, input + len, NULL);
+		n_plain = (duk_size_t) (in - input);
+		out_size = n_plain + 3 + (3 * (len - n_plain));
+	}
+#endif
+	output = (duk_uint8_t *) duk_push_fixed_buffer_nozero(thr, out_size);  /* used parts will be always manually written over */
 
 	input = (const duk_uint8_t *) duk_get_buffer_data(thr, 0, &len_tmp);
 	DUK_ASSERT(input != NULL || len == 0);
@@ -34514,7 +37409,35 @@ DUK_LOCAL duk_ret_t duk__decode_helper(duk_hthread *thr, duk__decode_context *de
 
 	in = input;
 	out = output;
+#if defined(DUK_USE_ENCODING_FASTPATH)
+	if (n_plain > 0) {
+		/* A BOM at the start is a plain 3-byte sequence.  If the run
+		 * is now shorter, the input was modified by a side effect and
+		 * the output may be too small, so fail like for a resize.
+		 */
+		if (!dec_ctx->bom_handled) {
+			dec_ctx->bom_handled = 1;
+			if (!dec_ctx->ignore_bom && n_plain >= 3 &&
+			    in[0] == 0xefU && in[1] == 0xbbU && in[2] == 0xbfU) {
+				in += 3;
+			}
+		}
+		out = duk__utf8_copy_plain(&in, input + n_plain, out);
+		if (DUK_UNLIKELY(in != input + n_plain)) {
+			DUK_D(DUK_DPRINT("input buffer modified by side effect, fail"));
+			goto fail_type;
+		}
+	}
+#endif
 	while (in < input + len) {
+#if defined(DUK_USE_ENCODING_FASTPATH)
+		if (dec_ctx->needed == 0 && dec_ctx->bom_handled) {
+			out = duk__utf8_copy_plain(&in, input + len, out);
+			if (in >= input + len) {
+				break;
+			}
+		}
+#endif
 		codepoint = duk__utf8_decode_next(dec_ctx, *in++);
 		if (codepoint < 0) {
 			if (codepoint == DUK__CP_CONTINUE) {
@@ -34544,7 +37467,7 @@ DUK_LOCAL duk_ret_t duk__decode_helper(duk_hthread *thr, duk__decode_context *de
 		}
 
 		out += duk_unicode_encode_cesu8((duk_ucodepoint_t) codepoint, out);
-		DUK_ASSERT(out <= output + (3 + (3 * len)));
+		DUK_ASSERT(out <= output + out_size);
 	}
 
 	if (!stream) {
@@ -34554,7 +37477,7 @@ DUK_LOCAL duk_ret_t duk__decode_helper(duk_hthread *thr, duk__decode_context *de
 				goto fail_type;
 			} else {
 				out += duk_unicode_encode_cesu8(DUK_UNICODE_CP_REPLACEMENT_CHARACTER, out);
-				DUK_ASSERT(out <= output + (3 + (3 * len)));
+				DUK_ASSERT(out <= output + out_size);
 			}
 		}
 		duk__utf8_decode_init(dec_ctx);  /* Initialize decoding state for potential reuse. */
@@ -34591,12 +37514,49 @@ DUK_INTERNAL duk_ret_t duk_bi_textencoder_prototype_encoding_getter(duk_hthread
 }
 
 DUK_INTERNAL duk_ret_t duk_bi_textencoder_prototype_encode(duk_hthread *thr) {
+#if defined(DUK_USE_ENCODING_FASTPATH)
+	duk_hstring *h_input = NULL;
+	duk_size_t consumed;
+#else
 	duk__encode_context enc_ctx;
+#endif
 	duk_size_t len;
 	duk_size_t final_len;
 	duk_uint8_t *output;
 
 	DUK_ASSERT_TOP(thr, 1);
+#if defined(DUK_USE_ENCODING_FASTPATH)
+	if (duk_is_undefined(thr, 0)) {
+		len = 0;
+	} else {
+		h_input = duk_to_hstring(thr, 0);
+		DUK_ASSERT(h_input != NULL);
+
+		len = (duk_size_t) DUK_HSTRING_GET_BYTELEN(h_input);
+		if (len > DUK_HBUFFER_MAX_BYTELEN) {
+			DUK_ERROR_TYPE(thr, DUK_STR_RESULT_TOO_LONG);
+			DUK_WO_NORETURN(return 0;);
+		}
+	}
+
+	/* UTF-8 output is never longer than the CESU-8 input: a surrogate
+	 * pair shrinks from 6 to 4 bytes and U+FFFD only replaces sequences
+	 * of 3 or more bytes.  Plain runs are copied as is.
+	 */
+	output = (duk_uint8_t *) duk_push_dynamic_buffer(thr, len);
+
+	if (len > 0) {
+		DUK_ASSERT(h_input != NULL);
+		final_len = duk__utf8_encode_string(thr, h_input, output, len, &consumed);
+		DUK_ASSERT(consumed == len);
+		DUK_UNREF(consumed);
+
+		DUK_ASSERT_TOP(thr, 2);
+		duk_resize_buffer(thr, -1, final_len);
+	} else {
+		final_len = 0;
+	}
+#else  /* DUK_USE_ENCODING_FASTPATH */
 	if (duk_is_undefined(thr, 0)) {
 		len = 0;
 	} else {
@@ -34660,6 +37620,7 @@ DUK_INTERNAL duk_ret_t duk_bi_textencoder_prototype_encode(duk_hthread *thr) {
 	} else {
 		final_len = 0;
 	}
+#endif  /* DUK_USE_ENCODING_FASTPATH */
 
 	/* Standard WHATWG output is a Uint8Array.  Here the Uint8Array will
 	 * be backed by a dynamic buffer which differs from e.g. Uint8Arrays
@@ -34673,6 +37634,46 @@ DUK_INTERNAL duk_ret_t duk_bi_textencoder_prototype_encode(duk_hthread *thr) {
 	return 1;
 }
 
+#if defined(DUK_USE_TEXTENCODER_ENCODE_INTO)
+/* TextEncoder.prototype.encodeInto(source, destination): encode as much of
+ * 'source' as fits into 'destination' (any buffer type), without splitting
+ * a codepoint.  Returns { read, written } where 'read' counts UTF-16 code
+ * units of 'source'.
+ */
+DUK_INTERNAL duk_ret_t duk_bi_textencoder_prototype_encode_into(duk_hthread *thr) {
+	duk_hstring *h_input;
+	duk_uint8_t *output;
+	duk_uint8_t dummy;
+	duk_size_t out_len;
+	duk_size_t consumed;
+	duk_size_t written;
+	duk_size_t read;
+
+	DUK_ASSERT_TOP(thr, 2);
+	h_input = duk_to_hstring(thr, 0);
+	DUK_ASSERT(h_input != NULL);
+	output = (duk_uint8_t *) duk_require_buffer_data(thr, 1, &out_len);
+	if (output == NULL) {
+		DUK_ASSERT(out_len == 0);
+		output = &dummy;
+	}
+
+	written = duk__utf8_encode_string(thr, h_input, output, out_len, &consumed);
+	if (consumed == (duk_size_t) DUK_HSTRING_GET_BYTELEN(h_input)) {
+		read = (duk_size_t) DUK_HSTRING_GET_CHARLEN(h_input);
+	} else {
+		read = duk_unicode_unvalidated_utf8_length((const duk_uint8_t *) DUK_HSTRING_GET_DATA(h_input), consumed);
+	}
+
+	duk_push_object(thr);
+	duk_push_uint(thr, (duk_uint_t) read);
+	duk_put_prop_literal(thr, -2, "read");
+	duk_push_uint(thr, (duk_uint_t) written);
+	duk_put_prop_literal(thr, -2, "written");
+	return 1;
+}
+#endif  /* DUK_USE_TEXTENCODER_ENCODE_INTO */
+
 DUK_INTERNAL duk_ret_t duk_bi_textdecoder_constructor(duk_hthread *thr) {
 	duk__decode_context *dec_ctx;
 	duk_bool_t fatal = 0;
@@ -34772,6 +37773,10 @@ DUK_INTERNAL duk_ret_t duk_textdecoder_decode_utf8_nodejs(duk_hthread *thr) {
 #undef DUK__CP_CONTINUE
 #undef DUK__CP_ERROR
 #undef DUK__CP_RETRY
+#undef DUK__UTF8_COPY_PLAIN
+#undef DUK__UTF8_ENCODE_STRING
+#undef DUK__UTF8_WORD_HIGHS
+#undef DUK__UTF8_WORD_IS_ALIGNED
 /*
  *  Error built-ins
  */
@@ -36374,9 +39379,12 @@ DUK_INTERNAL duk_ret_t duk_bi_global_object_unescape(duk_hthread *thr) {
 
 #define DUK__JSON_DECSTR_BUFSIZE 128
 #define DUK__JSON_DECSTR_CHUNKSIZE 64
+#define DUK__JSON_DEC_KEYCACHE_MAXLEN 32
 #define DUK__JSON_ENCSTR_CHUNKSIZE 64
 #define DUK__JSON_STRINGIFY_BUFSIZE 128
 #define DUK__JSON_MAX_ESC_LEN 10  /* '\Udeadbeef' */
+#define DUK__JSON_SINK_CHUNKSIZE 512
+#define DUK__JSON_SINK_MIN_CHUNKSIZE 16  /* room for any character */
 
 DUK_LOCAL_DECL void duk__json_dec_syntax_error(duk_json_dec_ctx *js_ctx);
 DUK_LOCAL_DECL void duk__json_dec_eat_white(duk_json_dec_ctx *js_ctx);
@@ -36388,11 +39396,17 @@ DUK_LOCAL_DECL duk_uint8_t duk__json_dec_get_nonwhite(duk_json_dec_ctx *js_ctx);
 DUK_LOCAL_DECL duk_uint_fast32_t duk__json_dec_decode_hex_escape(duk_json_dec_ctx *js_ctx, duk_small_uint_t n);
 DUK_LOCAL_DECL void duk__json_dec_req_stridx(duk_json_dec_ctx *js_ctx, duk_small_uint_t stridx);
 DUK_LOCAL_DECL void duk__json_dec_string(duk_json_dec_ctx *js_ctx);
+#if defined(DUK_USE_JSON_DEC_KEYCACHE_SIZE)
+DUK_LOCAL_DECL void duk__json_dec_key(duk_json_dec_ctx *js_ctx);
+#endif
 #if defined(DUK_USE_JX)
 DUK_LOCAL_DECL void duk__json_dec_plain_string(duk_json_dec_ctx *js_ctx);
 DUK_LOCAL_DECL void duk__json_dec_pointer(duk_json_dec_ctx *js_ctx);
 DUK_LOCAL_DECL void duk__json_dec_buffer(duk_json_dec_ctx *js_ctx);
 #endif
+#if defined(DUK_USE_NUMCONV_PARSE_FASTPATH) && defined(DUK_USE_64BIT_OPS)
+DUK_LOCAL_DECL duk_bool_t duk__json_dec_number_fast(const duk_uint8_t *p, const duk_uint8_t *p_end, duk_double_t *out);
+#endif
 DUK_LOCAL_DECL void duk__json_dec_number(duk_json_dec_ctx *js_ctx);
 DUK_LOCAL_DECL void duk__json_dec_objarr_entry(duk_json_dec_ctx *js_ctx);
 DUK_LOCAL_DECL void duk__json_dec_objarr_exit(duk_json_dec_ctx *js_ctx);
@@ -36431,6 +39445,10 @@ DUK_LOCAL_DECL void duk__json_enc_bufobj(duk_json_enc_ctx *js_ctx, duk_hbufobj *
 #endif
 #if defined(DUK_USE_JSON_STRINGIFY_FASTPATH)
 DUK_LOCAL_DECL void duk__json_enc_buffer_json_fastpath(duk_json_enc_ctx *js_ctx, duk_hbuffer *h);
+DUK_NORETURN(DUK_LOCAL_DECL void duk__json_stringify_fast_abort(duk_hthread *thr));
+#endif
+#if defined(DUK_USE_JSON_STRINGIFY_SINK)
+DUK_LOCAL_DECL void duk__json_enc_sink_flush(duk_json_enc_ctx *js_ctx, duk_bool_t final);
 #endif
 DUK_LOCAL_DECL void duk__json_enc_newline_indent(duk_json_enc_ctx *js_ctx, duk_uint_t depth);
 
@@ -36544,6 +39562,122 @@ DUK_LOCAL const duk_uint8_t duk__json_decnumber_lookup[256] = {
 };
 #endif  /* DUK_USE_JSON_DECNUMBER_FASTPATH */
 
+#if defined(DUK_USE_JSON_QUOTESTRING_FASTPATH) || defined(DUK_USE_JSON_DECSTRING_FASTPATH)
+/* Word-at-a-time scanning for runs of string bytes which can be copied as
+ * is.  Words are only read from aligned addresses (required on e.g. Xtensa)
+ * and never past the end of the input.  Each test is non-zero if some byte
+ * in the word matches; the position of the match doesn't matter because a
+ * matching word is rescanned a byte at a time.
+ */
+#if (DUK_SIZE_MAX > 0xffffffffUL) && defined(DUK_USE_64BIT_OPS)
+typedef duk_uint64_t duk__json_word;
+#define DUK__JSON_WORD_ONES             DUK_U64_CONSTANT(0x0101010101010101)
+#define DUK__JSON_WORD_HIGHS            DUK_U64_CONSTANT(0x8080808080808080)
+#else
+typedef duk_uint32_t duk__json_word;
+#define DUK__JSON_WORD_ONES             0x01010101UL
+#define DUK__JSON_WORD_HIGHS            0x80808080UL
+#endif
+#define DUK__JSON_WORD_HAS_LESS(w,n) \
+	(((w) - DUK__JSON_WORD_ONES * (n)) & ~(w) & DUK__JSON_WORD_HIGHS)  /* n <= 0x80 */
+#define DUK__JSON_WORD_HAS_BYTE(w,n) \
+	DUK__JSON_WORD_HAS_LESS((w) ^ (DUK__JSON_WORD_ONES * (n)), 1)
+#define DUK__JSON_WORD_IS_ALIGNED(p) \
+	((((duk_size_t) (const void *) (p)) & (sizeof(duk__json_word) - 1U)) == 0)
+#endif
+
+#if defined(DUK_USE_JSON_QUOTESTRING_FASTPATH)
+/* Copy bytes which JSON.stringify() emits as is (printable ASCII other than
+ * '"' and '\\') from [*p_ptr,p_end) to 'q'.  DEL is left to the caller
+ * because it's escaped in ASCII only mode.  Returns the updated 'q'.
+ */
+DUK_LOCAL duk_uint8_t *duk__json_enc_copy_plain(const duk_uint8_t **p_ptr, const duk_uint8_t *p_end, duk_uint8_t *q) {
+	const duk_uint8_t *p = *p_ptr;
+	duk__json_word w;
+	duk_uint8_t x;
+
+	while (p < p_end && !DUK__JSON_WORD_IS_ALIGNED(p)) {
+		x = *p;
+		if (x < 0x20 || x >= 0x7f || x == DUK_ASC_DOUBLEQUOTE || x == DUK_ASC_BACKSLASH) {
+			goto done;
+		}
+		*q++ = x;
+		p++;
+	}
+	while ((duk_size_t) (p_end - p) >= sizeof(duk__json_word)) {
+		w = *((const duk__json_word *) (const void *) p);
+		if ((DUK__JSON_WORD_HAS_LESS(w, 0x20) |
+		     DUK__JSON_WORD_HAS_BYTE(w, DUK_ASC_DOUBLEQUOTE) |
+		     DUK__JSON_WORD_HAS_BYTE(w, DUK_ASC_BACKSLASH) |
+		     DUK__JSON_WORD_HAS_BYTE(w, 0x7f) |
+		     (w & DUK__JSON_WORD_HIGHS)) != 0) {
+			break;
+		}
+		duk_memcpy((void *) q, (const void *) &w, sizeof(duk__json_word));
+		q += sizeof(duk__json_word);
+		p += sizeof(duk__json_word);
+	}
+	while (p < p_end) {
+		x = *p;
+		if (x < 0x20 || x >= 0x7f || x == DUK_ASC_DOUBLEQUOTE || x == DUK_ASC_BACKSLASH) {
+			break;
+		}
+		*q++ = x;
+		p++;
+	}
+
+ done:
+	*p_ptr = p;
+	return q;
+}
+#endif  /* DUK_USE_JSON_QUOTESTRING_FASTPATH */
+
+#if defined(DUK_USE_JSON_DECSTRING_FASTPATH)
+/* Copy string bytes which JSON.parse() keeps as is (anything except '"',
+ * '\\' and control characters, including the NUL terminator) from
+ * [*p_ptr,p_end) to 'q', which may be NULL to only scan.  Returns the
+ * updated 'q'.
+ */
+DUK_LOCAL duk_uint8_t *duk__json_dec_copy_plain(const duk_uint8_t **p_ptr, const duk_uint8_t *p_end, duk_uint8_t *q) {
+	const duk_uint8_t *p = *p_ptr;
+	const duk_uint8_t *p_start = p;
+	duk__json_word w;
+	duk_uint8_t x;
+
+	while (p < p_end && !DUK__JSON_WORD_IS_ALIGNED(p)) {
+		x = *p;
+		if (x < 0x20 || x == DUK_ASC_DOUBLEQUOTE || x == DUK_ASC_BACKSLASH) {
+			goto done;
+		}
+		p++;
+	}
+	while ((duk_size_t) (p_end - p) >= sizeof(duk__json_word)) {
+		w = *((const duk__json_word *) (const void *) p);
+		if ((DUK__JSON_WORD_HAS_LESS(w, 0x20) |
+		     DUK__JSON_WORD_HAS_BYTE(w, DUK_ASC_DOUBLEQUOTE) |
+		     DUK__JSON_WORD_HAS_BYTE(w, DUK_ASC_BACKSLASH)) != 0) {
+			break;
+		}
+		p += sizeof(duk__json_word);
+	}
+	while (p < p_end) {
+		x = *p;
+		if (x < 0x20 || x == DUK_ASC_DOUBLEQUOTE || x == DUK_ASC_BACKSLASH) {
+			break;
+		}
+		p++;
+	}
+
+ done:
+	if (q != NULL && p != p_start) {
+		duk_memcpy((void *) q, (const void *) p_start, (size_t) (p - p_start));
+		q += p - p_start;
+	}
+	*p_ptr = p;
+	return q;
+}
+#endif  /* DUK_USE_JSON_DECSTRING_FASTPATH */
+
 /*
  *  Parsing implementation.
  *
@@ -36562,8 +39696,13 @@ DUK_LOCAL void duk__json_dec_syntax_error(duk_json_dec_ctx *js_ctx) {
 	 * hidden, unfortunately, but we'll have an offset which
 	 * is often quite enough.
 	 */
+#if defined(DUK_USE_JSON_INCREMENTAL_PARSER)
+	DUK_ERROR_FMT1(js_ctx->thr, DUK_ERR_SYNTAX_ERROR, DUK_STR_FMT_INVALID_JSON,
+	               (long) (js_ctx->offset + (duk_size_t) (js_ctx->p - js_ctx->p_start)));
+#else
 	DUK_ERROR_FMT1(js_ctx->thr, DUK_ERR_SYNTAX_ERROR, DUK_STR_FMT_INVALID_JSON,
 	               (long) (js_ctx->p - js_ctx->p_start));
+#endif
 	DUK_WO_NORETURN(return;);
 }
 
@@ -36770,6 +39909,15 @@ DUK_LOCAL void duk__json_dec_string(duk_json_dec_ctx *js_ctx) {
 
 		p = js_ctx->p;  /* temp copy, write back for next loop */
 		for (;;) {
+			const duk_uint8_t *p_run;
+
+			/* Copy a run of plain bytes in bulk.  The run ends at
+			 * the NUL terminator at the latest.
+			 */
+			p_run = p;
+			q = duk__json_dec_copy_plain(&p, ((duk_size_t) (js_ctx->p_end - p) > safe ? p + safe : js_ctx->p_end), q);
+			safe -= (duk_small_uint_t) (p - p_run);
+
 			if (safe == 0) {
 				js_ctx->p = p;
 				break;
@@ -36839,6 +39987,92 @@ DUK_LOCAL void duk__json_dec_string(duk_json_dec_ctx *js_ctx) {
 	DUK_UNREACHABLE();
 }
 
+#if defined(DUK_USE_JSON_DEC_KEYCACHE_SIZE)
+/* Decode an object key.  Keys without escapes are interned directly from
+ * the input without going through a bufwriter.  Short keys also go through
+ * a small direct mapped cache keyed by length and a few sampled bytes, so
+ * that keys repeated across objects (e.g. an array of records) avoid the
+ * string table hash and lookup entirely.
+ *
+ * Cached pointers are borrowed; the strings are kept reachable through the
+ * key cache array on the value stack because a key may be dropped after
+ * use (e.g. when an array index key is overwritten).
+ */
+DUK_LOCAL void duk__json_dec_key(duk_json_dec_ctx *js_ctx) {
+	duk_hthread *thr = js_ctx->thr;
+	const duk_uint8_t *p_key;
+	const duk_uint8_t *p;
+	duk_size_t blen;
+	duk_uint_t slot;
+	duk_hstring *h;
+
+	/* '"' was eaten by caller */
+
+	p_key = js_ctx->p;
+#if defined(DUK_USE_JSON_DECSTRING_FASTPATH)
+	p = p_key;
+	(void) duk__json_dec_copy_plain(&p, js_ctx->p_end, NULL);
+	if (*p != DUK_ASC_DOUBLEQUOTE) {
+		/* Escapes and errors (including EOF NUL) are handled
+		 * by the generic string decoder.
+		 */
+		duk__json_dec_string(js_ctx);
+		return;
+	}
+#else
+	p = p_key;
+	for (;;) {
+		duk_uint8_t x;
+
+		x = *p;
+		if (x == DUK_ASC_DOUBLEQUOTE) {
+			break;
+		} else if (x < 0x20 || x == DUK_ASC_BACKSLASH) {
+			/* Escapes and errors (including EOF NUL) are handled
+			 * by the generic string decoder.
+			 */
+			duk__json_dec_string(js_ctx);
+			return;
+		}
+		p++;
+	}
+#endif
+	blen = (duk_size_t) (p - p_key);
+	js_ctx->p = p + 1;
+
+	if (blen == 0 || blen > DUK__JSON_DEC_KEYCACHE_MAXLEN) {
+		(void) duk_push_lstring(thr, (const char *) p_key, blen);
+		return;
+	}
+
+	DUK_ASSERT(DUK_IS_POWER_OF_TWO((duk_uint_t) DUK_USE_JSON_DEC_KEYCACHE_SIZE));
+	slot = ((duk_uint_t) blen * 31U +
+	        (duk_uint_t) p_key[0] * 7U +
+	        (duk_uint_t) p_key[blen >> 1] * 3U +
+	        (duk_uint_t) p_key[blen - 1]) & (duk_uint_t) (DUK_USE_JSON_DEC_KEYCACHE_SIZE - 1);
+	h = js_ctx->keycache[slot];
+	if (h != NULL &&
+	    DUK_HSTRING_GET_BYTELEN(h) == blen &&
+	    duk_memcmp_unsafe((const void *) p_key, (const void *) DUK_HSTRING_GET_DATA(h), (size_t) blen) == 0) {
+		duk_push_hstring(thr, h);
+		return;
+	}
+
+	/* Miss: intern and replace the cache entry. */
+	(void) duk_push_lstring(thr, (const char *) p_key, blen);
+	h = duk_known_hstring(thr, -1);
+	if (DUK_UNLIKELY(duk_is_undefined(thr, js_ctx->idx_keycache))) {
+		duk_push_bare_array(thr);
+		duk_replace(thr, js_ctx->idx_keycache);
+	}
+	duk_dup_top(thr);
+	duk_put_prop_index(thr, js_ctx->idx_keycache, (duk_uarridx_t) slot);
+	js_ctx->keycache[slot] = h;
+
+	/* [ ... key ] */
+}
+#endif  /* DUK_USE_JSON_DEC_KEYCACHE_SIZE */
+
 #if defined(DUK_USE_JX)
 /* Decode a plain string consisting entirely of identifier characters.
  * Used to parse plain keys (e.g. "foo: 123").
@@ -36995,6 +40229,102 @@ DUK_LOCAL void duk__json_dec_buffer(duk_json_dec_ctx *js_ctx) {
 }
 #endif  /* DUK_USE_JX */
 
+#if defined(DUK_USE_NUMCONV_PARSE_FASTPATH) && defined(DUK_USE_64BIT_OPS)
+/* Convert a strict JSON number with at most 19 significant digits and a
+ * small exponent directly from the input, without interning the number
+ * text.  Returns 0 for anything else, including syntax errors, so that
+ * the caller can use the full parser.
+ */
+DUK_LOCAL duk_bool_t duk__json_dec_number_fast(const duk_uint8_t *p, const duk_uint8_t *p_end, duk_double_t *out) {
+	const duk_uint8_t *p_dig;
+	duk_uint64_t w = 0;
+	duk_int_t q = 0;
+	duk_int_t expt;
+	duk_small_int_t dig_prec = 0;
+	duk_bool_t neg = 0;
+	duk_bool_t expt_neg;
+	duk_small_uint_t x;
+
+	if (p < p_end && *p == DUK_ASC_MINUS) {
+		neg = 1;
+		p++;
+	}
+
+	/* Whole part: '0' or digits without leading zeroes. */
+	if (p < p_end && *p == DUK_ASC_0) {
+		p++;
+	} else {
+		for (p_dig = p; p < p_end; p++) {
+			x = (duk_small_uint_t) (*p - DUK_ASC_0);
+			if (x > 9) {
+				break;
+			}
+			if (dig_prec >= 19) {
+				return 0;
+			}
+			w = w * 10U + x;
+			dig_prec++;
+		}
+		if (p == p_dig) {
+			return 0;
+		}
+	}
+
+	/* Fraction part, leading zeroes don't count towards precision. */
+	if (p < p_end && *p == DUK_ASC_PERIOD) {
+		for (p_dig = ++p; p < p_end; p++) {
+			x = (duk_small_uint_t) (*p - DUK_ASC_0);
+			if (x > 9) {
+				break;
+			}
+			if (dig_prec >= 19) {
+				return 0;
+			}
+			w = w * 10U + x;
+			q--;
+			if (w != 0) {
+				dig_prec++;
+			}
+		}
+		if (p == p_dig) {
+			return 0;
+		}
+	}
+
+	if (p < p_end && (*p == DUK_ASC_LC_E || *p == DUK_ASC_UC_E)) {
+		p++;
+		expt = 0;
+		expt_neg = 0;
+		if (p < p_end && (*p == DUK_ASC_PLUS || *p == DUK_ASC_MINUS)) {
+			expt_neg = (*p == DUK_ASC_MINUS);
+			p++;
+		}
+		for (p_dig = p; p < p_end; p++) {
+			x = (duk_small_uint_t) (*p - DUK_ASC_0);
+			if (x > 9) {
+				break;
+			}
+			expt = expt * 10 + (duk_int_t) x;
+			if (expt > 1000) {
+				return 0;
+			}
+		}
+		if (p == p_dig) {
+			return 0;
+		}
+		q += (expt_neg ? -expt : expt);
+	}
+
+	if (p != p_end || !duk_numconv_parse_decimal(w, q, out)) {
+		return 0;
+	}
+	if (neg) {
+		*out = -*out;
+	}
+	return 1;
+}
+#endif  /* DUK_USE_NUMCONV_PARSE_FASTPATH && DUK_USE_64BIT_OPS */
+
 /* Parse a number, other than NaN or +/- Infinity */
 DUK_LOCAL void duk__json_dec_number(duk_json_dec_ctx *js_ctx) {
 	duk_hthread *thr = js_ctx->thr;
@@ -37002,6 +40332,9 @@ DUK_LOCAL void duk__json_dec_number(duk_json_dec_ctx *js_ctx) {
 	const duk_uint8_t *p;
 	duk_uint8_t x;
 	duk_small_uint_t s2n_flags;
+#if defined(DUK_USE_NUMCONV_PARSE_FASTPATH) && defined(DUK_USE_64BIT_OPS)
+	duk_double_t d;
+#endif
 
 	DUK_DDD(DUK_DDDPRINT("parse_number"));
 
@@ -37042,6 +40375,13 @@ DUK_LOCAL void duk__json_dec_number(duk_json_dec_ctx *js_ctx) {
 	js_ctx->p = p;
 
 	DUK_ASSERT(js_ctx->p > p_start);
+#if defined(DUK_USE_NUMCONV_PARSE_FASTPATH) && defined(DUK_USE_64BIT_OPS)
+	if (duk__json_dec_number_fast(p_start, p, &d)) {
+		DUK_DDD(DUK_DDDPRINT("parse_number: fast path: %lf", (double) d));
+		duk_push_number(thr, d);
+		return;
+	}
+#endif
 	duk_push_lstring(thr, (const char *) p_start, (duk_size_t) (p - p_start));
 
 	s2n_flags = DUK_S2N_FLAG_ALLOW_EXP |
@@ -37128,7 +40468,11 @@ DUK_LOCAL void duk__json_dec_object(duk_json_dec_ctx *js_ctx) {
 		/* parse key and value */
 
 		if (x == DUK_ASC_DOUBLEQUOTE) {
+#if defined(DUK_USE_JSON_DEC_KEYCACHE_SIZE)
+			duk__json_dec_key(js_ctx);
+#else
 			duk__json_dec_string(js_ctx);
+#endif
 #if defined(DUK_USE_JX)
 		} else if (js_ctx->flag_ext_custom &&
 		           duk_unicode_is_identifier_start((duk_codepoint_t) x)) {
@@ -37158,6 +40502,11 @@ DUK_LOCAL void duk__json_dec_object(duk_json_dec_ctx *js_ctx) {
 
 	/* [ ... obj ] */
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	/* Parsed objects are typically uniform records which won't change. */
+	(void) duk_hobject_shape_props(thr->heap, duk_known_hobject(thr, -1));
+#endif
+
 	DUK_DDD(DUK_DDDPRINT("parse_object: final object is %!T",
 	                     (duk_tval *) duk_get_tval(thr, -1)));
 
@@ -37414,6 +40763,21 @@ DUK_LOCAL void duk__json_dec_reviver_walk(duk_json_dec_ctx *js_ctx) {
 #define DUK__EMIT_STRIDX(js_ctx,i)      duk__emit_stridx((js_ctx), (i))
 #define DUK__UNEMIT_1(js_ctx)           duk__unemit_1((js_ctx))
 
+/* Flush point for streamed output: only used between array elements and
+ * object properties, before the separating comma, so that nothing already
+ * delivered is later rewound by DUK__UNEMIT_1() or DUK_BW_SET_SIZE().
+ */
+#if defined(DUK_USE_JSON_STRINGIFY_SINK)
+#define DUK__SINK_CHECK(js_ctx) do { \
+		if (DUK_UNLIKELY((js_ctx)->sink != NULL && \
+		                 DUK_BW_GET_SIZE((js_ctx)->thr, &(js_ctx)->bw) >= (js_ctx)->sink_chunk)) { \
+			duk__json_enc_sink_flush((js_ctx), 0 /*final*/); \
+		} \
+	} while (0)
+#else
+#define DUK__SINK_CHECK(js_ctx) do {} while (0)
+#endif
+
 DUK_LOCAL void duk__emit_1(duk_json_enc_ctx *js_ctx, duk_uint_fast8_t ch) {
 	DUK_BW_WRITE_ENSURE_U8(js_ctx->thr, &js_ctx->bw, ch);
 }
@@ -37447,6 +40811,77 @@ DUK_LOCAL void duk__unemit_1(duk_json_enc_ctx *js_ctx) {
 	DUK_BW_ADD_PTR(js_ctx->thr, &js_ctx->bw, -1);
 }
 
+#if defined(DUK_USE_JSON_STRINGIFY_SINK)
+/* Deliver buffered output to the sink in chunks of at most sink_chunk
+ * bytes and keep the remainder buffered, unless 'final' is set.  Chunks
+ * end on a character boundary so that a function sink gets whole
+ * characters.
+ */
+DUK_LOCAL void duk__json_enc_sink_flush(duk_json_enc_ctx *js_ctx, duk_bool_t final) {
+	duk_hthread *thr = js_ctx->thr;
+	const duk_json_sink *sink = js_ctx->sink;
+	duk_uint8_t *p_base;
+	duk_size_t len, off, n;
+
+	DUK_ASSERT(sink != NULL);
+	DUK_ASSERT(js_ctx->sink_chunk >= DUK__JSON_SINK_MIN_CHUNKSIZE);
+
+	p_base = DUK_BW_GET_BASEPTR(thr, &js_ctx->bw);
+	len = DUK_BW_GET_SIZE(thr, &js_ctx->bw);
+
+	/* An abandoned fast path may have delivered a prefix of the output
+	 * already; the slow path produces the same bytes again, drop them.
+	 */
+	off = (js_ctx->sink_skip < len ? js_ctx->sink_skip : len);
+	js_ctx->sink_skip -= off;
+
+	while (off < len) {
+		n = len - off;
+		if (n > js_ctx->sink_chunk) {
+			n = js_ctx->sink_chunk;
+			while ((p_base[off + n] & 0xc0U) == 0x80U) {
+				/* Don't split a multibyte character. */
+				DUK_ASSERT(n > 1);
+				n--;
+			}
+		} else if (n < js_ctx->sink_chunk && !final) {
+			break;
+		}
+
+		if (sink->func != NULL) {
+			sink->func(sink->udata, (const char *) (p_base + off), n);
+		} else {
+			duk_require_stack(thr, 2);
+			duk_dup(thr, sink->idx_func);
+			duk_push_lstring(thr, (const char *) (p_base + off), n);
+			duk_call(thr, 1);
+			duk_pop(thr);
+
+			/* The sink can't reach the buffer, but don't assume
+			 * anything about side effects.
+			 */
+			p_base = DUK_BW_GET_BASEPTR(thr, &js_ctx->bw);
+			DUK_ASSERT(DUK_BW_GET_SIZE(thr, &js_ctx->bw) == len);
+		}
+		js_ctx->sink_flushed += n;
+		off += n;
+	}
+
+	if (off > 0) {
+		duk_memmove((void *) p_base, (const void *) (p_base + off), (size_t) (len - off));
+		DUK_BW_SET_SIZE(thr, &js_ctx->bw, len - off);
+	}
+}
+
+/* Flush the rest of the output and push the total byte count. */
+DUK_LOCAL void duk__json_enc_sink_finish(duk_json_enc_ctx *js_ctx) {
+	duk__json_enc_sink_flush(js_ctx, 1 /*final*/);
+	DUK_ASSERT(DUK_BW_GET_SIZE(js_ctx->thr, &js_ctx->bw) == 0);
+	DUK_ASSERT(js_ctx->sink_skip == 0);
+	duk_push_number(js_ctx->thr, (duk_double_t) js_ctx->sink_flushed);
+}
+#endif  /* DUK_USE_JSON_STRINGIFY_SINK */
+
 #define DUK__MKESC(nybbles,esc1,esc2)  \
 	(((duk_uint_fast32_t) (nybbles)) << 16) | \
 	(((duk_uint_fast32_t) (esc1)) << 8) | \
@@ -37597,6 +41032,12 @@ DUK_LOCAL void duk__json_enc_quote_string(duk_json_enc_ctx *js_ctx, duk_hstring
 #if defined(DUK_USE_JSON_QUOTESTRING_FASTPATH)
 			duk_uint8_t b;
 
+			/* Copy a run of bytes needing no escaping word by word. */
+			q = duk__json_enc_copy_plain(&p, p_now, q);
+			if (p >= p_now) {
+				break;
+			}
+
 			b = duk__json_quotestr_lookup[*p++];
 			if (DUK_LIKELY(b < 0x80)) {
 				/* Most input bytes go through here. */
@@ -38246,6 +41687,7 @@ DUK_LOCAL void duk__json_enc_object(duk_json_enc_ctx *js_ctx) {
 			 */
 			DUK_BW_SET_SIZE(js_ctx->thr, &js_ctx->bw, prev_size);
 		} else {
+			DUK__SINK_CHECK(js_ctx);
 			DUK__EMIT_1(js_ctx, DUK_ASC_COMMA);
 			emitted = 1;
 		}
@@ -38315,6 +41757,7 @@ DUK_LOCAL void duk__json_enc_array(duk_json_enc_ctx *js_ctx) {
 
 		/* [ ... ] */
 
+		DUK__SINK_CHECK(js_ctx);
 		DUK__EMIT_1(js_ctx, DUK_ASC_COMMA);
 		emitted = 1;
 	}
@@ -38732,15 +42175,14 @@ DUK_LOCAL duk_bool_t duk__json_stringify_fast_value(duk_json_enc_ctx *js_ctx, du
 		DUK_ASSERT(js_ctx->recursion_depth <= js_ctx->recursion_limit);
 		if (js_ctx->recursion_depth >= js_ctx->recursion_limit) {
 			DUK_DD(DUK_DDPRINT("fast path recursion limit"));
-			DUK_ERROR_RANGE(js_ctx->thr, DUK_STR_DEC_RECLIMIT);
-			DUK_WO_NORETURN(return 0;);
+			goto abort_fastpath;
 		}
 
 		for (i = 0, n = (duk_uint_fast32_t) js_ctx->recursion_depth; i < n; i++) {
 			if (DUK_UNLIKELY(js_ctx->visiting[i] == obj)) {
+				/* The slow path throws the actual error. */
 				DUK_DD(DUK_DDPRINT("fast path loop detect"));
-				DUK_ERROR_TYPE(js_ctx->thr, DUK_STR_CYCLIC_INPUT);
-				DUK_WO_NORETURN(return 0;);
+				goto abort_fastpath;
 			}
 		}
 
@@ -38871,6 +42313,7 @@ DUK_LOCAL duk_bool_t duk__json_stringify_fast_value(duk_json_enc_ctx *js_ctx, du
 					DUK_DD(DUK_DDPRINT("prop value not supported, rewind key and colon"));
 					DUK_BW_SET_SIZE(js_ctx->thr, &js_ctx->bw, prev_size);
 				} else {
+					DUK__SINK_CHECK(js_ctx);
 					DUK__EMIT_1(js_ctx, DUK_ASC_COMMA);
 					emitted = 1;
 				}
@@ -38954,6 +42397,7 @@ DUK_LOCAL duk_bool_t duk__json_stringify_fast_value(duk_json_enc_ctx *js_ctx, du
 				/* fall through */
 
 			 elem_done:
+				DUK__SINK_CHECK(js_ctx);
 				DUK__EMIT_1(js_ctx, DUK_ASC_COMMA);
 				emitted = 1;
 			}
@@ -39118,12 +42562,26 @@ DUK_LOCAL duk_bool_t duk__json_stringify_fast_value(duk_json_enc_ctx *js_ctx, du
 	return 0;  /* value was undefined/unsupported */
 
  abort_fastpath:
-	/* Error message doesn't matter: the error is ignored anyway. */
-	DUK_DD(DUK_DDPRINT("aborting fast path"));
-	DUK_ERROR_INTERNAL(js_ctx->thr);
+	duk__json_stringify_fast_abort(js_ctx->thr);
 	DUK_WO_NORETURN(return 0;);
 }
 
+/* Abort the fast path by throwing 'undefined'.  The thrown value is
+ * ignored, and creating an actual error would run errCreate/errThrow
+ * (user code) and debugger hooks for an internal condition.
+ */
+DUK_LOCAL void duk__json_stringify_fast_abort(duk_hthread *thr) {
+	duk_tval tv_tmp;
+
+	DUK_DD(DUK_DDPRINT("aborting fast path"));
+
+	duk_hthread_sync_and_null_currpc(thr);
+	DUK_TVAL_SET_UNDEFINED(&tv_tmp);
+	duk_err_setup_ljstate1(thr, DUK_LJ_TYPE_THROW, &tv_tmp);
+	duk_err_longjmp(thr);
+	DUK_UNREACHABLE();
+}
+
 DUK_LOCAL duk_ret_t duk__json_stringify_fast(duk_hthread *thr, void *udata) {
 	duk_json_enc_ctx *js_ctx;
 	duk_tval *tv;
@@ -39137,7 +42595,7 @@ DUK_LOCAL duk_ret_t duk__json_stringify_fast(duk_hthread *thr, void *udata) {
 	tv = DUK_GET_TVAL_NEGIDX(thr, -1);
 	if (duk__json_stringify_fast_value(js_ctx, tv) == 0) {
 		DUK_DD(DUK_DDPRINT("top level value not supported, fail fast path"));
-		DUK_DCERROR_TYPE_INVALID_ARGS(thr);  /* Error message is ignored, so doesn't matter. */
+		duk__json_stringify_fast_abort(thr);
 	}
 
 	return 0;
@@ -39206,6 +42664,12 @@ void duk_bi_json_parse_helper(duk_hthread *thr,
 	                DUK_HSTRING_GET_BYTELEN(h_text);
 	DUK_ASSERT(*(js_ctx->p_end) == 0x00);
 
+#if defined(DUK_USE_JSON_DEC_KEYCACHE_SIZE)
+	/* Reserve a slot for the key cache array, created on first miss. */
+	duk_push_undefined(thr);
+	js_ctx->idx_keycache = duk_get_top_index(thr);
+#endif
+
 	duk__json_dec_value(js_ctx);  /* -> [ ... value ] */
 	DUK_ASSERT(js_ctx->recursion_depth == 0);
 
@@ -39217,6 +42681,10 @@ void duk_bi_json_parse_helper(duk_hthread *thr,
 		duk__json_dec_syntax_error(js_ctx);
 	}
 
+#if defined(DUK_USE_JSON_DEC_KEYCACHE_SIZE)
+	duk_remove_m2(thr);  /* [ ... keycache value ] -> [ ... value ] */
+#endif
+
 	if (duk_is_callable(thr, idx_reviver)) {
 		DUK_DDD(DUK_DDDPRINT("applying reviver: %!T",
 		                     (duk_tval *) duk_get_tval(thr, idx_reviver)));
@@ -39258,7 +42726,8 @@ void duk_bi_json_stringify_helper(duk_hthread *thr,
                                   duk_idx_t idx_value,
                                   duk_idx_t idx_replacer,
                                   duk_idx_t idx_space,
-                                  duk_small_uint_t flags) {
+                                  duk_small_uint_t flags,
+                                  const duk_json_sink *sink) {
 	duk_json_enc_ctx js_ctx_alloc;
 	duk_json_enc_ctx *js_ctx = &js_ctx_alloc;
 	duk_hobject *h;
@@ -39291,6 +42760,25 @@ void duk_bi_json_stringify_helper(duk_hthread *thr,
 #endif
 	js_ctx->idx_proplist = -1;
 
+#if defined(DUK_USE_JSON_STRINGIFY_SINK)
+	/* Streamed output is only used for plain JSON without a replacer
+	 * or gap, so the sink doesn't interact with them.
+	 */
+	js_ctx->sink = sink;
+	if (sink != NULL) {
+		DUK_ASSERT(flags == 0);
+		DUK_ASSERT(idx_replacer == DUK_INVALID_INDEX && idx_space == DUK_INVALID_INDEX);
+		DUK_ASSERT(sink->func != NULL || sink->idx_func >= 0);
+		js_ctx->sink_chunk = sink->chunk_size;
+		if (js_ctx->sink_chunk < DUK__JSON_SINK_MIN_CHUNKSIZE) {
+			js_ctx->sink_chunk = DUK__JSON_SINK_MIN_CHUNKSIZE;
+		}
+	}
+#else
+	DUK_ASSERT(sink == NULL);
+	DUK_UNREF(sink);
+#endif
+
 	/* Flag handling currently assumes that flags are consistent.  This is OK
 	 * because the call sites are now strictly controlled.
 	 */
@@ -39470,6 +42958,9 @@ void duk_bi_json_stringify_helper(duk_hthread *thr,
 
 #if defined(DUK_USE_JSON_STRINGIFY_FASTPATH)
 	if (js_ctx->h_replacer == NULL &&  /* replacer is a mutation risk */
+#if defined(DUK_USE_JSON_STRINGIFY_SINK)
+	    (sink == NULL || sink->func != NULL) &&  /* function sink is a mutation risk */
+#endif
 	    js_ctx->idx_proplist == -1) {  /* proplist is very rare */
 		duk_int_t pcall_rc;
 		duk_small_uint_t prev_ms_base_flags;
@@ -39508,7 +42999,14 @@ void duk_bi_json_stringify_helper(duk_hthread *thr,
 
 		if (pcall_rc == DUK_EXEC_SUCCESS) {
 			DUK_DD(DUK_DDPRINT("fast path successful"));
-			DUK_BW_PUSH_AS_STRING(thr, &js_ctx->bw);
+#if defined(DUK_USE_JSON_STRINGIFY_SINK)
+			if (sink != NULL) {
+				duk__json_enc_sink_finish(js_ctx);
+			} else
+#endif
+			{
+				DUK_BW_PUSH_AS_STRING(thr, &js_ctx->bw);
+			}
 			goto replace_finished;
 		}
 
@@ -39520,6 +43018,9 @@ void duk_bi_json_stringify_helper(duk_hthread *thr,
 		DUK_D(DUK_DPRINT("fast path failed, serialize using slow path instead"));
 		DUK_BW_RESET_SIZE(thr, &js_ctx->bw);
 		js_ctx->recursion_depth = 0;
+#if defined(DUK_USE_JSON_STRINGIFY_SINK)
+		js_ctx->sink_skip = js_ctx->sink_flushed;
+#endif
 	}
 #endif
 
@@ -39552,6 +43053,11 @@ void duk_bi_json_stringify_helper(duk_hthread *thr,
 	if (DUK_UNLIKELY(duk__json_enc_value(js_ctx, idx_holder) == 0)) {  /* [ ... holder key ] -> [ ... holder ] */
 		/* Result is undefined. */
 		duk_push_undefined(thr);
+#if defined(DUK_USE_JSON_STRINGIFY_SINK)
+	} else if (sink != NULL) {
+		/* Deliver the rest, result is the byte count. */
+		duk__json_enc_sink_finish(js_ctx);
+#endif
 	} else {
 		/* Convert buffer to result string. */
 		DUK_BW_PUSH_AS_STRING(thr, &js_ctx->bw);
@@ -39607,10 +43113,641 @@ DUK_INTERNAL duk_ret_t duk_bi_json_object_stringify(duk_hthread *thr) {
 	                             0 /*idx_value*/,
 	                             1 /*idx_replacer*/,
 	                             2 /*idx_space*/,
-	                             0 /*flags*/);
+	                             0 /*flags*/,
+	                             NULL /*sink*/);
 	return 1;
 }
 
+#if defined(DUK_USE_JSON_STRINGIFY_SINK)
+/* JSON.stringifyTo(value, sink, [chunkSize]): like JSON.stringify(value)
+ * but the output is passed to sink() as string chunks of at most
+ * chunkSize bytes.  Returns the total byte count, or undefined if
+ * JSON.stringify() would return undefined.
+ */
+DUK_INTERNAL duk_ret_t duk_bi_json_object_stringify_to(duk_hthread *thr) {
+	duk_json_sink sink;
+
+	duk_require_callable(thr, 1);
+
+	sink.func = NULL;
+	sink.udata = NULL;
+	sink.idx_func = 1;
+	sink.chunk_size = (duk_size_t) duk_get_uint_default(thr, 2, DUK__JSON_SINK_CHUNKSIZE);
+	duk_bi_json_stringify_helper(thr,
+	                             0 /*idx_value*/,
+	                             DUK_INVALID_INDEX /*idx_replacer*/,
+	                             DUK_INVALID_INDEX /*idx_space*/,
+	                             0 /*flags*/,
+	                             &sink);
+	return 1;
+}
+#endif  /* DUK_USE_JSON_STRINGIFY_SINK */
+
+#if defined(DUK_USE_JSON_INCREMENTAL_PARSER)
+/*
+ *  Incremental parser (JSON.Parser)
+ *
+ *  duk__json_dec_value() needs the whole document as one NUL terminated
+ *  string and recurses per nesting level.  JSON.Parser is fed the input
+ *  in chunks (strings or buffers) with write() and keeps an explicit
+ *  container stack instead.  Only a scalar token (string, number or
+ *  literal) split across chunks is buffered; complete tokens are decoded
+ *  with the normal duk__json_dec_xxx() helpers, directly from the chunk
+ *  when possible.
+ *
+ *  Without a handler the value is built like JSON.parse() would build it
+ *  and end() returns it.  With a handler nothing is kept and the handler
+ *  is called as handler(event, value) with the parser as 'this'; event is
+ *  one of 'startObject', 'endObject', 'startArray', 'endArray', 'key' and
+ *  'value'.
+ *
+ *  State lives in an internal _Context array on the parser:
+ *
+ *    [ state token handler root cont0 key0 cont1 key1 ... ]
+ *
+ *  where 'state' is a duk__json_inc_state fixed buffer, 'token' a dynamic
+ *  buffer for a split token and contN/keyN the open containers with their
+ *  pending key (or next index for arrays) in tree mode.  The innermost
+ *  container and key are kept in value stack slots during a call and the
+ *  innermost array index in the state, so that adding a value doesn't go
+ *  through the _Context array.
+ */
+
+/* What is expected next. */
+#define DUK__JSON_INC_ST_VALUE          0  /* top level, after ':' or after ',' in an array */
+#define DUK__JSON_INC_ST_VALUE_OR_END   1  /* after '[' */
+#define DUK__JSON_INC_ST_KEY            2  /* after ',' in an object */
+#define DUK__JSON_INC_ST_KEY_OR_END     3  /* after '{' */
+#define DUK__JSON_INC_ST_COLON          4
+#define DUK__JSON_INC_ST_COMMA_OR_END   5
+#define DUK__JSON_INC_ST_DONE           6  /* top level value complete, only whitespace allowed */
+
+/* Scalar token in progress. */
+#define DUK__JSON_INC_TOK_NONE          0
+#define DUK__JSON_INC_TOK_STRING        1
+#define DUK__JSON_INC_TOK_KEY           2
+#define DUK__JSON_INC_TOK_NUMBER        3
+#define DUK__JSON_INC_TOK_LITERAL       4
+
+/* _Context array slots. */
+#define DUK__JSON_INC_SLOT_STATE        0
+#define DUK__JSON_INC_SLOT_TOKEN        1
+#define DUK__JSON_INC_SLOT_HANDLER      2
+#define DUK__JSON_INC_SLOT_ROOT         3
+#define DUK__JSON_INC_SLOT_LEVEL        4
+
+/* Value stack layout in write() and end(). */
+#define DUK__JSON_INC_IDX_CHUNK         0
+#define DUK__JSON_INC_IDX_THIS          1
+#define DUK__JSON_INC_IDX_CONTEXT       2
+#define DUK__JSON_INC_IDX_TOKEN         3
+#define DUK__JSON_INC_IDX_HANDLER       4
+#define DUK__JSON_INC_IDX_CONT          5  /* innermost container (tree mode) */
+#define DUK__JSON_INC_IDX_KEY           6  /* its pending key */
+
+#if defined(DUK_USE_JSON_DECNUMBER_FASTPATH)
+#define DUK__JSON_INC_IS_NUMCHAR(x)     (duk__json_decnumber_lookup[(x)] != 0)
+#else
+#define DUK__JSON_INC_IS_NUMCHAR(x) \
+	(((x) >= DUK_ASC_0 && (x) <= DUK_ASC_9) || \
+	 (x) == DUK_ASC_PERIOD || (x) == DUK_ASC_LC_E || \
+	 (x) == DUK_ASC_UC_E || (x) == DUK_ASC_MINUS || (x) == DUK_ASC_PLUS)
+#endif
+
+typedef struct {
+	duk_uint8_t state;           /* DUK__JSON_INC_ST_xxx */
+	duk_uint8_t token;           /* DUK__JSON_INC_TOK_xxx */
+	duk_uint8_t escape;          /* string token: last byte was an unescaped backslash */
+	duk_uint8_t events;          /* handler given, emit events instead of building a value */
+	duk_uint8_t busy;            /* inside write() or end(); stays set if they throw */
+	duk_uint_t depth;            /* number of open containers */
+	duk_uarridx_t arr_idx;       /* next index of the innermost array (tree mode) */
+	duk_size_t token_len;        /* bytes of a split token in the token buffer */
+	duk_size_t token_offset;     /* input offset of the token, for error messages */
+	duk_size_t offset;           /* input offset of the current chunk */
+	duk_uint8_t objects[(DUK_USE_JSON_DEC_RECLIMIT + 7) / 8];  /* bit per open level, set for objects */
+} duk__json_inc_state;
+
+DUK_LOCAL void duk__json_inc_syntax_error(duk_hthread *thr, duk_size_t offset) {
+	DUK_ERROR_FMT1(thr, DUK_ERR_SYNTAX_ERROR, DUK_STR_FMT_INVALID_JSON, (long) offset);
+	DUK_WO_NORETURN(return;);
+}
+
+DUK_LOCAL duk_bool_t duk__json_inc_level_is_object(duk__json_inc_state *st, duk_uint_t level) {
+	return (st->objects[level >> 3] & (1U << (level & 0x07U))) != 0;
+}
+
+/* [ ... event value ] -> [ ... ], calls handler(event, value). */
+DUK_LOCAL void duk__json_inc_emit(duk_hthread *thr) {
+	duk_dup(thr, DUK__JSON_INC_IDX_HANDLER);
+	duk_dup(thr, DUK__JSON_INC_IDX_THIS);
+	duk_pull(thr, -4);
+	duk_pull(thr, -4);
+	duk_call_method(thr, 2);
+	duk_pop(thr);
+}
+
+/* A value is complete: [ ... val ] -> [ ... ].  Stores it as the result
+ * or adds it to the innermost open container (tree mode only).
+ */
+DUK_LOCAL void duk__json_inc_add(duk_hthread *thr, duk__json_inc_state *st) {
+	if (st->depth == 0) {
+		duk_put_prop_index(thr, DUK__JSON_INC_IDX_CONTEXT, DUK__JSON_INC_SLOT_ROOT);
+	} else if (duk__json_inc_level_is_object(st, st->depth - 1)) {
+		duk_dup(thr, DUK__JSON_INC_IDX_KEY);
+		duk_insert(thr, -2);
+		duk_xdef_prop_wec(thr, DUK__JSON_INC_IDX_CONT);
+	} else {
+		duk_xdef_prop_index_wec(thr, DUK__JSON_INC_IDX_CONT, st->arr_idx);
+		st->arr_idx++;
+	}
+}
+
+/* Save the innermost key or array index into the _Context array. */
+DUK_LOCAL void duk__json_inc_save_level(duk_hthread *thr, duk__json_inc_state *st) {
+	duk_uarridx_t slot;
+
+	DUK_ASSERT(st->depth > 0);
+	slot = (duk_uarridx_t) (DUK__JSON_INC_SLOT_LEVEL + 2 * (st->depth - 1));
+	if (duk__json_inc_level_is_object(st, st->depth - 1)) {
+		duk_dup(thr, DUK__JSON_INC_IDX_KEY);
+	} else {
+		duk_push_uint(thr, (duk_uint_t) st->arr_idx);
+	}
+	duk_put_prop_index(thr, DUK__JSON_INC_IDX_CONTEXT, slot + 1);
+}
+
+/* Load the innermost container and key or array index from the _Context
+ * array.
+ */
+DUK_LOCAL void duk__json_inc_load_level(duk_hthread *thr, duk__json_inc_state *st) {
+	duk_uarridx_t slot;
+
+	DUK_ASSERT(st->depth > 0);
+	slot = (duk_uarridx_t) (DUK__JSON_INC_SLOT_LEVEL + 2 * (st->depth - 1));
+	duk_get_prop_index(thr, DUK__JSON_INC_IDX_CONTEXT, slot);
+	duk_replace(thr, DUK__JSON_INC_IDX_CONT);
+	duk_get_prop_index(thr, DUK__JSON_INC_IDX_CONTEXT, slot + 1);
+	if (duk__json_inc_level_is_object(st, st->depth - 1)) {
+		duk_replace(thr, DUK__JSON_INC_IDX_KEY);
+	} else {
+		st->arr_idx = (duk_uarridx_t) duk_get_uint(thr, -1);
+		duk_pop(thr);
+	}
+}
+
+DUK_LOCAL void duk__json_inc_open(duk_hthread *thr, duk__json_inc_state *st, duk_bool_t is_object) {
+	if (st->depth >= DUK_USE_JSON_DEC_RECLIMIT) {
+		DUK_ERROR_RANGE(thr, DUK_STR_DEC_RECLIMIT);
+		DUK_WO_NORETURN(return;);
+	}
+	if (is_object) {
+		st->objects[st->depth >> 3] |= (duk_uint8_t) (1U << (st->depth & 0x07U));
+		st->state = DUK__JSON_INC_ST_KEY_OR_END;
+	} else {
+		st->objects[st->depth >> 3] &= (duk_uint8_t) ~(1U << (st->depth & 0x07U));
+		st->state = DUK__JSON_INC_ST_VALUE_OR_END;
+	}
+
+	if (st->events) {
+		if (is_object) {
+			duk_push_literal(thr, "startObject");
+		} else {
+			duk_push_literal(thr, "startArray");
+		}
+		duk_push_undefined(thr);
+		duk__json_inc_emit(thr);
+		st->depth++;
+	} else {
+		if (st->depth > 0) {
+			duk__json_inc_save_level(thr, st);
+		}
+		if (is_object) {
+			duk_push_object(thr);
+		} else {
+			duk_push_array(thr);
+		}
+		duk_dup_top(thr);
+		duk_replace(thr, DUK__JSON_INC_IDX_CONT);
+		duk_put_prop_index(thr, DUK__JSON_INC_IDX_CONTEXT, (duk_uarridx_t) (DUK__JSON_INC_SLOT_LEVEL + 2 * st->depth));
+		st->arr_idx = 0;
+		st->depth++;
+	}
+}
+
+DUK_LOCAL void duk__json_inc_close(duk_hthread *thr, duk__json_inc_state *st) {
+	duk_bool_t is_object;
+
+	DUK_ASSERT(st->depth > 0);
+	st->depth--;
+	is_object = duk__json_inc_level_is_object(st, st->depth);
+
+	if (st->events) {
+		if (is_object) {
+			duk_push_literal(thr, "endObject");
+		} else {
+			duk_push_literal(thr, "endArray");
+		}
+		duk_push_undefined(thr);
+		duk__json_inc_emit(thr);
+	} else {
+		duk_dup(thr, DUK__JSON_INC_IDX_CONT);
+		if (is_object) {
+#if defined(DUK_USE_HOBJECT_SHAPES)
+			(void) duk_hobject_shape_props(thr->heap, duk_known_hobject(thr, -1));
+#endif
+		} else {
+			/* Elements were added with duk_xdef_prop_index_wec(). */
+			duk_set_length(thr, -1, (duk_size_t) st->arr_idx);
+		}
+		duk_set_length(thr, DUK__JSON_INC_IDX_CONTEXT, (duk_size_t) (DUK__JSON_INC_SLOT_LEVEL + 2 * st->depth));
+		if (st->depth > 0) {
+			duk__json_inc_load_level(thr, st);
+		}
+		duk__json_inc_add(thr, st);
+	}
+	st->state = (st->depth == 0 ? DUK__JSON_INC_ST_DONE : DUK__JSON_INC_ST_COMMA_OR_END);
+}
+
+/* Append to the token buffer, keeping it NUL terminated. */
+DUK_LOCAL duk_uint8_t *duk__json_inc_token_append(duk_hthread *thr, duk__json_inc_state *st, const duk_uint8_t *p, duk_size_t len) {
+	duk_uint8_t *buf;
+	duk_size_t size;
+	duk_size_t need;
+
+	buf = (duk_uint8_t *) duk_get_buffer(thr, DUK__JSON_INC_IDX_TOKEN, &size);
+	if (len >= DUK_SIZE_MAX - st->token_len) {
+		DUK_ERROR_RANGE(thr, DUK_STR_BUFFER_TOO_LONG);
+		DUK_WO_NORETURN(return NULL;);
+	}
+	need = st->token_len + len + 1;
+	if (need > size) {
+		buf = (duk_uint8_t *) duk_resize_buffer(thr, DUK__JSON_INC_IDX_TOKEN, need + (need >> 1) + 16);
+	}
+	if (len > 0) {
+		duk_memcpy((void *) (buf + st->token_len), (const void *) p, len);
+	}
+	st->token_len += len;
+	buf[st->token_len] = 0;
+	return buf;
+}
+
+/* A scalar token is complete, push its value.  Token bytes in this chunk
+ * are [p,q): q points to the closing quote of a string, or to the byte
+ * ending a number or a literal.
+ */
+DUK_LOCAL void duk__json_inc_token(duk_json_dec_ctx *js_ctx, duk__json_inc_state *st, const duk_uint8_t *p, const duk_uint8_t *q) {
+	duk_hthread *thr = js_ctx->thr;
+	duk_small_uint_t stridx;
+	duk_bool_t is_string;
+
+	is_string = (st->token == DUK__JSON_INC_TOK_STRING || st->token == DUK__JSON_INC_TOK_KEY);
+	if (st->token_len > 0) {
+		/* Split token: complete it in the token buffer, where the NUL
+		 * terminator ends numbers and literals.
+		 */
+		p = duk__json_inc_token_append(thr, st, p, (duk_size_t) (q - p) + (is_string ? 1 : 0));
+		q = p + st->token_len - (is_string ? 1 : 0);
+	}
+
+	js_ctx->p_start = p;
+	js_ctx->p = p;
+	js_ctx->p_end = q;
+	js_ctx->offset = st->token_offset;
+
+	switch (st->token) {
+	case DUK__JSON_INC_TOK_STRING:
+		duk__json_dec_string(js_ctx);
+		break;
+	case DUK__JSON_INC_TOK_KEY:
+#if defined(DUK_USE_JSON_DEC_KEYCACHE_SIZE)
+		duk__json_dec_key(js_ctx);
+#else
+		duk__json_dec_string(js_ctx);
+#endif
+		break;
+	case DUK__JSON_INC_TOK_NUMBER:
+		duk__json_dec_number(js_ctx);
+		break;
+	default:
+		DUK_ASSERT(st->token == DUK__JSON_INC_TOK_LITERAL);
+		if (*p == DUK_ASC_LC_T) {
+			stridx = DUK_STRIDX_TRUE;
+		} else if (*p == DUK_ASC_LC_F) {
+			stridx = DUK_STRIDX_FALSE;
+		} else {
+			DUK_ASSERT(*p == DUK_ASC_LC_N);
+			stridx = DUK_STRIDX_LC_NULL;
+		}
+		js_ctx->p++;  /* first character already matched */
+		duk__json_dec_req_stridx(js_ctx, stridx);
+		if (js_ctx->p != q) {
+			duk__json_dec_syntax_error(js_ctx);
+		}
+		if (stridx == DUK_STRIDX_TRUE) {
+			duk_push_true(thr);
+		} else if (stridx == DUK_STRIDX_FALSE) {
+			duk_push_false(thr);
+		} else {
+			duk_push_null(thr);
+		}
+		break;
+	}
+	DUK_ASSERT(js_ctx->p == q + (is_string ? 1 : 0));
+
+	st->token = DUK__JSON_INC_TOK_NONE;
+	st->token_len = 0;
+}
+
+/* [ ... val ] -> [ ... ], scalar value or key complete. */
+DUK_LOCAL void duk__json_inc_scalar(duk_hthread *thr, duk__json_inc_state *st, duk_bool_t is_key) {
+	if (is_key) {
+		if (st->events) {
+			duk_push_literal(thr, "key");
+			duk_insert(thr, -2);
+			duk__json_inc_emit(thr);
+		} else {
+			duk_replace(thr, DUK__JSON_INC_IDX_KEY);
+		}
+		st->state = DUK__JSON_INC_ST_COLON;
+		return;
+	}
+
+	if (st->events) {
+		duk_push_literal(thr, "value");
+		duk_insert(thr, -2);
+		duk__json_inc_emit(thr);
+	} else {
+		duk__json_inc_add(thr, st);
+	}
+	st->state = (st->depth == 0 ? DUK__JSON_INC_ST_DONE : DUK__JSON_INC_ST_COMMA_OR_END);
+}
+
+DUK_LOCAL void duk__json_inc_feed(duk_json_dec_ctx *js_ctx, duk__json_inc_state *st, const duk_uint8_t *p, const duk_uint8_t *p_end) {
+	duk_hthread *thr = js_ctx->thr;
+	const duk_uint8_t *p_chunk;
+	const duk_uint8_t *p_tok;
+	const duk_uint8_t *q;
+	duk_uint8_t x;
+	duk_uint8_t esc;
+	duk_bool_t is_key;
+
+	p_chunk = p;
+	p_tok = p;  /* continuation of a split token, if any */
+
+	for (;;) {
+		if (st->token != DUK__JSON_INC_TOK_NONE) {
+			/* Scan to the end of the token without decoding; a token
+			 * which doesn't end in this chunk is buffered as is.
+			 */
+			q = p;
+			if (st->token == DUK__JSON_INC_TOK_STRING || st->token == DUK__JSON_INC_TOK_KEY) {
+				esc = st->escape;
+				for (; q < p_end; q++) {
+					x = *q;
+					if (esc) {
+						esc = 0;
+					} else if (x == DUK_ASC_BACKSLASH) {
+						esc = 1;
+					} else if (x == DUK_ASC_DOUBLEQUOTE) {
+						break;
+					}
+				}
+				st->escape = esc;
+			} else if (st->token == DUK__JSON_INC_TOK_NUMBER) {
+				while (q < p_end && DUK__JSON_INC_IS_NUMCHAR(*q)) {
+					q++;
+				}
+			} else {
+				while (q < p_end && *q >= DUK_ASC_LC_A && *q <= DUK_ASC_LC_Z) {
+					q++;
+				}
+			}
+			if (q == p_end) {
+				(void) duk__json_inc_token_append(thr, st, p_tok, (duk_size_t) (q - p_tok));
+				break;
+			}
+
+			is_key = (st->token == DUK__JSON_INC_TOK_KEY);
+			duk__json_inc_token(js_ctx, st, p_tok, q);
+			p = (*q == DUK_ASC_DOUBLEQUOTE ? q + 1 : q);
+			duk__json_inc_scalar(thr, st, is_key);
+			continue;
+		}
+
+		if (p >= p_end) {
+			break;
+		}
+		x = *p++;
+		if (x == 0x20 || x == 0x0a || x == 0x0d || x == 0x09) {
+			continue;
+		}
+
+		switch (st->state) {
+		case DUK__JSON_INC_ST_VALUE:
+		case DUK__JSON_INC_ST_VALUE_OR_END:
+			if (x == DUK_ASC_LCURLY) {
+				duk__json_inc_open(thr, st, 1 /*is_object*/);
+			} else if (x == DUK_ASC_LBRACKET) {
+				duk__json_inc_open(thr, st, 0 /*is_object*/);
+			} else if (x == DUK_ASC_DOUBLEQUOTE) {
+				st->token = DUK__JSON_INC_TOK_STRING;
+				st->escape = 0;
+				p_tok = p;
+			} else if (x == DUK_ASC_MINUS || (x >= DUK_ASC_0 && x <= DUK_ASC_9)) {
+				st->token = DUK__JSON_INC_TOK_NUMBER;
+				p_tok = p - 1;
+			} else if (x == DUK_ASC_LC_T || x == DUK_ASC_LC_F || x == DUK_ASC_LC_N) {
+				st->token = DUK__JSON_INC_TOK_LITERAL;
+				p_tok = p - 1;
+			} else if (x == DUK_ASC_RBRACKET && st->state == DUK__JSON_INC_ST_VALUE_OR_END) {
+				duk__json_inc_close(thr, st);
+			} else {
+				goto syntax_error;
+			}
+			if (st->token != DUK__JSON_INC_TOK_NONE) {
+				st->token_offset = st->offset + (duk_size_t) (p_tok - p_chunk);
+			}
+			break;
+		case DUK__JSON_INC_ST_KEY:
+		case DUK__JSON_INC_ST_KEY_OR_END:
+			if (x == DUK_ASC_DOUBLEQUOTE) {
+				st->token = DUK__JSON_INC_TOK_KEY;
+				st->escape = 0;
+				p_tok = p;
+				st->token_offset = st->offset + (duk_size_t) (p_tok - p_chunk);
+			} else if (x == DUK_ASC_RCURLY && st->state == DUK__JSON_INC_ST_KEY_OR_END) {
+				duk__json_inc_close(thr, st);
+			} else {
+				goto syntax_error;
+			}
+			break;
+		case DUK__JSON_INC_ST_COLON:
+			if (x != DUK_ASC_COLON) {
+				goto syntax_error;
+			}
+			st->state = DUK__JSON_INC_ST_VALUE;
+			break;
+		case DUK__JSON_INC_ST_COMMA_OR_END:
+			DUK_ASSERT(st->depth > 0);
+			if (duk__json_inc_level_is_object(st, st->depth - 1)) {
+				if (x == DUK_ASC_COMMA) {
+					st->state = DUK__JSON_INC_ST_KEY;
+				} else if (x == DUK_ASC_RCURLY) {
+					duk__json_inc_close(thr, st);
+				} else {
+					goto syntax_error;
+				}
+			} else {
+				if (x == DUK_ASC_COMMA) {
+					st->state = DUK__JSON_INC_ST_VALUE;
+				} else if (x == DUK_ASC_RBRACKET) {
+					duk__json_inc_close(thr, st);
+				} else {
+					goto syntax_error;
+				}
+			}
+			break;
+		default:
+			DUK_ASSERT(st->state == DUK__JSON_INC_ST_DONE);
+			goto syntax_error;
+		}
+	}
+
+	st->offset += (duk_size_t) (p_end - p_chunk);
+	return;
+
+ syntax_error:
+	duk__json_inc_syntax_error(thr, st->offset + (duk_size_t) (p - p_chunk));  /* same as duk__json_dec_syntax_error() */
+	DUK_UNREACHABLE();
+}
+
+/* [ chunk ] -> [ chunk this context token handler cont key (keycache) ] */
+DUK_LOCAL duk__json_inc_state *duk__json_inc_begin(duk_hthread *thr, duk_json_dec_ctx *js_ctx) {
+	duk__json_inc_state *st;
+	duk_size_t size;
+
+	DUK_ASSERT_TOP(thr, 1);
+	duk_push_this(thr);
+	duk_get_prop_literal(thr, -1, DUK_INTERNAL_SYMBOL("Context"));
+	duk_get_prop_index(thr, DUK__JSON_INC_IDX_CONTEXT, DUK__JSON_INC_SLOT_STATE);
+	st = (duk__json_inc_state *) duk_require_buffer(thr, -1, &size);
+	if (size != sizeof(duk__json_inc_state) || st->busy) {
+		DUK_ERROR_TYPE(thr, DUK_STR_INVALID_STATE);
+		DUK_WO_NORETURN(return NULL;);
+	}
+	duk_pop(thr);
+	duk_get_prop_index(thr, DUK__JSON_INC_IDX_CONTEXT, DUK__JSON_INC_SLOT_TOKEN);
+	duk_get_prop_index(thr, DUK__JSON_INC_IDX_CONTEXT, DUK__JSON_INC_SLOT_HANDLER);
+	duk_push_undefined(thr);
+	duk_push_undefined(thr);
+	if (!st->events && st->depth > 0) {
+		duk__json_inc_load_level(thr, st);
+	}
+	st->busy = 1;
+
+	duk_memzero(js_ctx, sizeof(*js_ctx));
+	js_ctx->thr = thr;
+	js_ctx->recursion_limit = DUK_USE_JSON_DEC_RECLIMIT;
+#if defined(DUK_USE_JSON_DEC_KEYCACHE_SIZE)
+	duk_push_undefined(thr);
+	js_ctx->idx_keycache = duk_get_top_index(thr);
+#endif
+	return st;
+}
+
+DUK_LOCAL void duk__json_inc_write_chunk(duk_json_dec_ctx *js_ctx, duk__json_inc_state *st) {
+	duk_hthread *thr = js_ctx->thr;
+	const duk_uint8_t *p;
+	duk_size_t len;
+
+	if (duk_is_string_notsymbol(thr, DUK__JSON_INC_IDX_CHUNK)) {
+		p = (const duk_uint8_t *) duk_get_lstring(thr, DUK__JSON_INC_IDX_CHUNK, &len);
+	} else {
+		p = (const duk_uint8_t *) duk_require_buffer_data(thr, DUK__JSON_INC_IDX_CHUNK, &len);
+	}
+	if (len > 0) {
+		duk__json_inc_feed(js_ctx, st, p, p + len);
+	}
+}
+
+/* new JSON.Parser([handler]) */
+DUK_INTERNAL duk_ret_t duk_bi_json_parser_constructor(duk_hthread *thr) {
+	duk__json_inc_state *st;
+
+	DUK_ASSERT_TOP(thr, 1);
+	duk_require_constructor_call(thr);
+	if (!duk_is_undefined(thr, 0)) {
+		duk_require_callable(thr, 0);
+	}
+
+	duk_push_this(thr);
+	duk_push_bare_array(thr);
+
+	st = (duk__json_inc_state *) duk_push_fixed_buffer(thr, sizeof(duk__json_inc_state));
+	duk_memzero((void *) st, sizeof(duk__json_inc_state));
+	st->state = DUK__JSON_INC_ST_VALUE;
+	st->token = DUK__JSON_INC_TOK_NONE;
+	st->events = (duk_uint8_t) !duk_is_undefined(thr, 0);
+	duk_put_prop_index(thr, -2, DUK__JSON_INC_SLOT_STATE);
+	duk_push_dynamic_buffer(thr, 0);
+	duk_put_prop_index(thr, -2, DUK__JSON_INC_SLOT_TOKEN);
+	duk_dup_0(thr);
+	duk_put_prop_index(thr, -2, DUK__JSON_INC_SLOT_HANDLER);
+
+	duk_put_prop_literal(thr, -2, DUK_INTERNAL_SYMBOL("Context"));
+	return 0;
+}
+
+/* JSON.Parser.prototype.write(chunk) */
+DUK_INTERNAL duk_ret_t duk_bi_json_parser_prototype_write(duk_hthread *thr) {
+	duk_json_dec_ctx js_ctx_alloc;
+	duk__json_inc_state *st;
+
+	st = duk__json_inc_begin(thr, &js_ctx_alloc);
+	duk__json_inc_write_chunk(&js_ctx_alloc, st);
+	if (!st->events && st->depth > 0) {
+		duk__json_inc_save_level(thr, st);
+	}
+	st->busy = 0;
+	return 0;
+}
+
+/* JSON.Parser.prototype.end([chunk]): parse the last chunk, check that
+ * the input is complete and return the value (undefined with a handler).
+ * The parser is then reset and may be reused.
+ */
+DUK_INTERNAL duk_ret_t duk_bi_json_parser_prototype_end(duk_hthread *thr) {
+	duk_json_dec_ctx js_ctx_alloc;
+	duk__json_inc_state *st;
+
+	st = duk__json_inc_begin(thr, &js_ctx_alloc);
+	if (!duk_is_undefined(thr, DUK__JSON_INC_IDX_CHUNK)) {
+		duk__json_inc_write_chunk(&js_ctx_alloc, st);
+	}
+
+	if (st->token == DUK__JSON_INC_TOK_NUMBER || st->token == DUK__JSON_INC_TOK_LITERAL) {
+		/* End of input ends a top level number or literal. */
+		duk__json_inc_token(&js_ctx_alloc, st, NULL, NULL);
+		duk__json_inc_scalar(thr, st, 0 /*is_key*/);
+	}
+	if (st->state != DUK__JSON_INC_ST_DONE || st->token != DUK__JSON_INC_TOK_NONE) {
+		duk__json_inc_syntax_error(thr, st->offset);
+	}
+
+	duk_get_prop_index(thr, DUK__JSON_INC_IDX_CONTEXT, DUK__JSON_INC_SLOT_ROOT);
+	duk_push_undefined(thr);
+	duk_put_prop_index(thr, DUK__JSON_INC_IDX_CONTEXT, DUK__JSON_INC_SLOT_ROOT);
+	duk_resize_buffer(thr, DUK__JSON_INC_IDX_TOKEN, 0);
+
+	DUK_ASSERT(st->depth == 0);
+	st->state = DUK__JSON_INC_ST_VALUE;
+	st->offset = 0;
+	st->busy = 0;
+	return 1;
+}
+#endif  /* DUK_USE_JSON_INCREMENTAL_PARSER */
+
 #endif  /* DUK_USE_JSON_BUILTIN */
 
 #endif  /* DUK_USE_JSON_SUPPORT */
@@ -39623,10 +43760,42 @@ DUK_INTERNAL duk_ret_t duk_bi_json_object_stringify(duk_hthread *thr) {
 #undef DUK__EMIT_STRIDX
 #undef DUK__JSON_DECSTR_BUFSIZE
 #undef DUK__JSON_DECSTR_CHUNKSIZE
+#undef DUK__JSON_DEC_KEYCACHE_MAXLEN
 #undef DUK__JSON_ENCSTR_CHUNKSIZE
+#undef DUK__JSON_INC_IDX_CHUNK
+#undef DUK__JSON_INC_IDX_CONTEXT
+#undef DUK__JSON_INC_IDX_HANDLER
+#undef DUK__JSON_INC_IDX_THIS
+#undef DUK__JSON_INC_IDX_TOKEN
+#undef DUK__JSON_INC_IS_NUMCHAR
+#undef DUK__JSON_INC_SLOT_HANDLER
+#undef DUK__JSON_INC_SLOT_LEVEL
+#undef DUK__JSON_INC_SLOT_ROOT
+#undef DUK__JSON_INC_SLOT_STATE
+#undef DUK__JSON_INC_SLOT_TOKEN
+#undef DUK__JSON_INC_ST_COLON
+#undef DUK__JSON_INC_ST_COMMA_OR_END
+#undef DUK__JSON_INC_ST_DONE
+#undef DUK__JSON_INC_ST_KEY
+#undef DUK__JSON_INC_ST_KEY_OR_END
+#undef DUK__JSON_INC_ST_VALUE
+#undef DUK__JSON_INC_ST_VALUE_OR_END
+#undef DUK__JSON_INC_TOK_KEY
+#undef DUK__JSON_INC_TOK_LITERAL
+#undef DUK__JSON_INC_TOK_NONE
+#undef DUK__JSON_INC_TOK_NUMBER
+#undef DUK__JSON_INC_TOK_STRING
 #undef DUK__JSON_MAX_ESC_LEN
+#undef DUK__JSON_SINK_CHUNKSIZE
+#undef DUK__JSON_SINK_MIN_CHUNKSIZE
 #undef DUK__JSON_STRINGIFY_BUFSIZE
+#undef DUK__JSON_WORD_HAS_BYTE
+#undef DUK__JSON_WORD_HAS_LESS
+#undef DUK__JSON_WORD_HIGHS
+#undef DUK__JSON_WORD_IS_ALIGNED
+#undef DUK__JSON_WORD_ONES
 #undef DUK__MKESC
+#undef DUK__SINK_CHECK
 #undef DUK__UNEMIT_1
 /*
  *  Math built-ins
@@ -41841,6 +46010,88 @@ DUK_LOCAL duk_hstring *duk__str_tostring_notregexp(duk_hthread *thr, duk_idx_t i
 	return h;
 }
 
+#if defined(DUK_USE_STRING_SEARCH_FASTPATH)
+/* The search starts with memchr() for the first needle byte.  If that byte
+ * is common in the haystack (false candidates closer together than a few
+ * needle lengths on average) and the needle is long enough, switch to
+ * Horspool for the rest of the haystack.
+ */
+#define DUK__STR_MEMCHR_MAX_MISSES      16
+#define DUK__STR_HORSPOOL_MIN_NEEDLE    4
+#define DUK__STR_HORSPOOL_MIN_HAYSTACK  64
+
+/* Find the first occurrence of [q_start,q_start+q_blen[ in [p,p_end[.
+ * Returns NULL if not found.  The search is bytewise; because the
+ * needle starts with a leading byte, a match in valid extended UTF-8
+ * data always begins at a character boundary.
+ */
+DUK_LOCAL const duk_uint8_t *duk__str_find_bytes(const duk_uint8_t *p, const duk_uint8_t *p_end, const duk_uint8_t *q_start, duk_size_t q_blen) {
+	const duk_uint8_t *p_first;
+	const duk_uint8_t *p_last;  /* last possible match start */
+	duk_size_t misses;
+	duk_uint8_t shift[256];
+	duk_uint8_t lastbyte;
+	duk_uint8_t t;
+	duk_size_t i;
+
+	DUK_ASSERT(p != NULL && p <= p_end);
+	DUK_ASSERT(q_start != NULL && q_blen > 0);
+
+	if ((duk_size_t) (p_end - p) < q_blen) {
+		return NULL;
+	}
+	p_first = p;
+	p_last = p_end - q_blen;
+
+	misses = 0;
+	for (;;) {
+		p = (const duk_uint8_t *) DUK_MEMCHR((const void *) p, (int) q_start[0], (size_t) (p_last - p + 1));
+		if (p == NULL) {
+			return NULL;
+		}
+		if (duk_memcmp((const void *) (p + 1), (const void *) (q_start + 1), q_blen - 1U) == 0) {
+			return p;
+		}
+		p++;
+		if (++misses >= DUK__STR_MEMCHR_MAX_MISSES &&
+		    q_blen >= DUK__STR_HORSPOOL_MIN_NEEDLE &&
+		    (duk_size_t) (p - p_first) < misses * q_blen * 4U &&
+		    p <= p_last && (duk_size_t) (p_last - p) >= DUK__STR_HORSPOOL_MIN_HAYSTACK) {
+			break;
+		}
+	}
+
+	/* Horspool: compare the byte aligned with the last needle byte and
+	 * shift by its distance from the end of the needle.  Shifts are
+	 * capped to 255 which is always safe.
+	 */
+	duk_memset((void *) shift, (int) (q_blen > 255U ? 255U : q_blen), sizeof(shift));
+	for (i = (q_blen > 255U ? q_blen - 255U : 0U); i < q_blen - 1U; i++) {
+		shift[q_start[i]] = (duk_uint8_t) (q_blen - 1U - i);
+	}
+	lastbyte = q_start[q_blen - 1U];
+
+	while (p <= p_last) {
+		t = p[q_blen - 1U];
+		if (t == lastbyte && duk_memcmp((const void *) p, (const void *) q_start, q_blen - 1U) == 0) {
+			return p;
+		}
+		p += shift[t];
+	}
+	return NULL;
+}
+
+/* Character offset of 'p' relative to 'p_base' at character offset 'base_cpos'. */
+DUK_LOCAL duk_uint32_t duk__str_cpos_at(duk_hstring *h, const duk_uint8_t *p_base, duk_uint32_t base_cpos, const duk_uint8_t *p) {
+	DUK_ASSERT(p >= p_base);
+
+	if (DUK_HSTRING_IS_ASCII(h)) {
+		return base_cpos + (duk_uint32_t) (p - p_base);
+	}
+	return base_cpos + (duk_uint32_t) duk_unicode_unvalidated_utf8_length(p_base, (duk_size_t) (p - p_base));
+}
+#endif  /* DUK_USE_STRING_SEARCH_FASTPATH */
+
 DUK_LOCAL duk_int_t duk__str_search_shared(duk_hthread *thr, duk_hstring *h_this, duk_hstring *h_search, duk_int_t start_cpos, duk_bool_t backwards) {
 	duk_int_t cpos;
 	duk_int_t bpos;
@@ -41869,6 +46120,18 @@ DUK_LOCAL duk_int_t duk__str_search_shared(duk_hthread *thr, duk_hstring *h_this
 	p_end = p_start + DUK_HSTRING_GET_BYTELEN(h_this);
 	p = p_start + bpos;
 
+#if defined(DUK_USE_STRING_SEARCH_FASTPATH)
+	if (!backwards) {
+		const duk_uint8_t *q;
+
+		q = duk__str_find_bytes(p, p_end, q_start, (duk_size_t) q_blen);
+		if (q == NULL) {
+			return -1;
+		}
+		return (duk_int_t) duk__str_cpos_at(h_this, p, (duk_uint32_t) cpos, q);
+	}
+#endif
+
 	/* This loop is optimized for size.  For speed, there should be
 	 * two separate loops, and we should ensure that memcmp() can be
 	 * used without an extra "will searchstring fit" check.  Doing
@@ -42463,6 +46726,8 @@ DUK_INTERNAL duk_ret_t duk_bi_string_prototype_replace(duk_hthread *thr) {
 
 			DUK_ASSERT(duk_get_length(thr, -1) <= DUK_INT_MAX);  /* string limits */
 			match_caps = (duk_int_t) duk_get_length(thr, -1);
+
+			match_start_boff = (duk_uint32_t) duk_heap_strcache_offset_char2byte(thr, h_input, match_start_coff);
 		} else {
 #else  /* DUK_USE_REGEXP_SUPPORT */
 		{  /* unconditionally */
@@ -42489,6 +46754,22 @@ DUK_INTERNAL duk_ret_t duk_bi_string_prototype_replace(duk_hthread *thr) {
 				break;  /* no match */
 			}
 
+#if defined(DUK_USE_STRING_SEARCH_FASTPATH)
+			if (q_blen > 0) {
+				p = duk__str_find_bytes(p, p_end, q_start, q_blen);
+				if (p == NULL) {
+					break;  /* no match */
+				}
+			}
+			match_start_coff = duk__str_cpos_at(h_input, p_start, 0, p);
+			match_start_boff = (duk_uint32_t) (p - p_start);
+			duk_dup_0(thr);
+			h_match = duk_known_hstring(thr, -1);
+#if defined(DUK_USE_REGEXP_SUPPORT)
+			match_caps = 0;
+#endif
+			goto found;
+#else  /* DUK_USE_STRING_SEARCH_FASTPATH */
 			p_end -= q_blen;  /* ensure full memcmp() fits in while */
 			DUK_ASSERT(p_end >= p);
 
@@ -42497,6 +46778,7 @@ DUK_INTERNAL duk_ret_t duk_bi_string_prototype_replace(duk_hthread *thr) {
 			while (p <= p_end) {
 				DUK_ASSERT(p + q_blen <= DUK_HSTRING_GET_DATA(h_input) + DUK_HSTRING_GET_BYTELEN(h_input));
 				if (duk_memcmp((const void *) p, (const void *) q_start, (size_t) q_blen) == 0) {
+					match_start_boff = (duk_uint32_t) (p - p_start);
 					duk_dup_0(thr);
 					h_match = duk_known_hstring(thr, -1);
 #if defined(DUK_USE_REGEXP_SUPPORT)
@@ -42514,6 +46796,7 @@ DUK_INTERNAL duk_ret_t duk_bi_string_prototype_replace(duk_hthread *thr) {
 
 			/* not found */
 			break;
+#endif  /* DUK_USE_STRING_SEARCH_FASTPATH */
 		}
 	 found:
 
@@ -42524,8 +46807,6 @@ DUK_INTERNAL duk_ret_t duk_bi_string_prototype_replace(duk_hthread *thr) {
 		 * stack[4] = regexp match OR match string
 		 */
 
-		match_start_boff = (duk_uint32_t) duk_heap_strcache_offset_char2byte(thr, h_input, match_start_coff);
-
 		tmp_sz = (duk_size_t) (match_start_boff - prev_match_end_boff);
 		DUK_BW_WRITE_ENSURE_BYTES(thr, bw, DUK_HSTRING_GET_DATA(h_input) + prev_match_end_boff, tmp_sz);
 
@@ -42874,6 +47155,19 @@ DUK_INTERNAL duk_ret_t duk_bi_string_prototype_split(duk_hthread *thr) {
 			}
 
 			DUK_ASSERT(q_blen > 0 && q_clen > 0);
+#if defined(DUK_USE_STRING_SEARCH_FASTPATH)
+			/* never an empty match, so step 13.c.iii can't be triggered */
+			if (p <= p_end) {
+				const duk_uint8_t *q;
+
+				q = duk__str_find_bytes(p, p_end + q_blen, q_start, q_blen);
+				if (q != NULL) {
+					match_start_coff = duk__str_cpos_at(h_input, p, match_start_coff, q);
+					p = q;
+					goto found;
+				}
+			}
+#else  /* DUK_USE_STRING_SEARCH_FASTPATH */
 			while (p <= p_end) {
 				DUK_ASSERT(p + q_blen <= DUK_HSTRING_GET_DATA(h_input) + DUK_HSTRING_GET_BYTELEN(h_input));
 				DUK_ASSERT(q_blen > 0);  /* no issues with empty memcmp() */
@@ -42888,6 +47182,7 @@ DUK_INTERNAL duk_ret_t duk_bi_string_prototype_split(duk_hthread *thr) {
 				}
 				p++;
 			}
+#endif  /* DUK_USE_STRING_SEARCH_FASTPATH */
 
 		 not_found:
 			/* not found */
@@ -43413,6 +47708,11 @@ DUK_INTERNAL duk_ret_t duk_bi_string_prototype_includes(duk_hthread *thr) {
 }
 #endif  /* DUK_USE_ES6 */
 #endif  /* DUK_USE_STRING_BUILTIN */
+
+/* automatic undefs */
+#undef DUK__STR_HORSPOOL_MIN_HAYSTACK
+#undef DUK__STR_HORSPOOL_MIN_NEEDLE
+#undef DUK__STR_MEMCHR_MAX_MISSES
 /*
  *  Symbol built-in
  */
@@ -43717,6 +48017,14 @@ DUK_INTERNAL duk_ret_t duk_bi_thread_resume(duk_hthread *ctx) {
 		if (!DUK_HOBJECT_IS_CALLABLE(h_fun) || !DUK_HOBJECT_IS_COMPFUNC(h_fun)) {
 			goto state_error;
 		}
+#if defined(DUK_USE_COMPILER_LAZY)
+		/* A lazy initial function can't be compiled during RESUME
+		 * handling (longjmp state is active), compile it here.
+		 */
+		if (DUK_HCOMPFUNC_IS_LAZY(thr->heap, (duk_hcompfunc *) h_fun)) {
+			duk_js_compile_lazy(thr, (duk_hcompfunc *) h_fun);
+		}
+#endif
 		duk_pop(thr);
 	}
 
@@ -46907,6 +51215,8 @@ DUK_LOCAL void duk__debug_dump_strtab(duk_hthread *thr, duk_heap *heap) {
 	for (i = 0; i < heap->st_size; i++) {
 #if defined(DUK_USE_STRTAB_PTRCOMP)
 		h = DUK_USE_HEAPPTR_DEC16((heap)->heap_udata, heap->strtable16[i]);
+#elif defined(DUK_USE_STRTAB_PROBE)
+		h = heap->strtable[i].h;
 #else
 		h = heap->strtable[i];
 #endif
@@ -49142,6 +53452,7 @@ DUK_INTERNAL duk_hbuffer *duk_hbuffer_alloc(duk_heap *heap, duk_size_t size, duk
 		DUK_ASSERT(!(flags & DUK_BUF_FLAG_EXTERNAL));
 	}
         DUK_HEAP_INSERT_INTO_HEAP_ALLOCATED(heap, &res->hdr);
+	DUK_HEAPHDR_MS_NEW(heap, &res->hdr);
 
 	DUK_DDD(DUK_DDDPRINT("allocated hbuffer: %p", (void *) res));
 	return res;
@@ -49295,6 +53606,15 @@ DUK_INTERNAL void duk_free_hobject(duk_heap *heap, duk_hobject *h) {
 	DUK_ASSERT(heap != NULL);
 	DUK_ASSERT(h != NULL);
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	if (DUK_HOBJECT_HAS_SHAPE(h)) {
+		/* Key references were dropped in refcount finalization, if
+		 * any; when freeing the heap the keys may already be gone.
+		 */
+		duk_propshape_decref(heap, h->shape, 0 /*decref_keys*/);
+		h->shape = NULL;
+	}
+#endif
 	DUK_FREE(heap, DUK_HOBJECT_GET_PROPS(heap, h));
 
 	if (DUK_HOBJECT_IS_COMPFUNC(h)) {
@@ -49372,6 +53692,11 @@ DUK_INTERNAL void duk_free_hstring(duk_heap *heap, duk_hstring *h) {
 		                     h, DUK_HSTRING_GET_EXTDATA((duk_hstring_external *) h)));
 		DUK_USE_EXTSTR_FREE(heap->heap_udata, (const void *) DUK_HSTRING_GET_EXTDATA((duk_hstring_external *) h));
 	}
+#endif
+#if defined(DUK_USE_STRING_APPEND_INPLACE)
+	if (heap->strapp_h == h) {
+		heap->strapp_h = NULL;
+	}
 #endif
 	DUK_FREE(heap, (void *) h);
 }
@@ -49651,6 +53976,9 @@ DUK_INTERNAL void duk_heap_free(duk_heap *heap) {
 	DUK_D(DUK_DPRINT("forced gc #3 in heap destruction (don't run finalizers)"));
 	heap->pf_skip_finalizers = 1;
 	duk_heap_mark_and_sweep(heap, 0);  /* Skip finalizers; queue finalizable objects to heap_allocated. */
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	DUK_ASSERT(heap->ms_incremental == 0);  /* Finished by the forced GCs above. */
+#endif
 
 	/* There are never objects in refzero_list at this point, or at any
 	 * point beyond a DECREF (even a DECREF_NORZ).  Since Duktape 2.1
@@ -49690,9 +54018,44 @@ DUK_INTERNAL void duk_heap_free(duk_heap *heap) {
 	duk__free_finalize_list(heap);
 #endif
 
+#if defined(DUK_USE_HOBJECT_SHAPES) && defined(DUK_USE_ASSERTIONS)
+	/* Shapes are freed with the last object using them. */
+	{
+		duk_uint_t i;
+		for (i = 0; i < DUK_HEAP_SHAPETAB_SIZE; i++) {
+			DUK_ASSERT(heap->shapetab[i] == NULL);
+		}
+	}
+#endif
+
 	DUK_D(DUK_DPRINT("freeing string table of heap: %p", (void *) heap));
 	duk__free_stringtable(heap);
 
+#if defined(DUK_USE_STRCACHE_INDEX)
+	/* Strings freed above don't go through duk_heap_strcache_string_remove(). */
+	{
+		duk_uint_t i;
+		for (i = 0; i < DUK_HEAP_STRCACHE_INDEX_SLOTS; i++) {
+			DUK_FREE_RAW(heap, heap->strcache_index[i].boffs);
+		}
+	}
+#endif
+
+#if defined(DUK_USE_PROFILER_SAMPLING)
+	DUK_D(DUK_DPRINT("freeing profiler buffer of heap: %p", (void *) heap));
+	DUK_FREE(heap, heap->prof_buf);
+#endif
+
+#if defined(DUK_USE_PROFILER_INSTRUMENT)
+	DUK_D(DUK_DPRINT("freeing instrumentation table of heap: %p", (void *) heap));
+	DUK_FREE_RAW(heap, heap->prof_funcs);
+#endif
+
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	DUK_D(DUK_DPRINT("freeing grey stack of heap: %p", (void *) heap));
+	heap->free_func(heap->heap_udata, (void *) heap->ms_grey);
+#endif
+
 	DUK_D(DUK_DPRINT("freeing heap structure: %p", (void *) heap));
 	heap->free_func(heap->heap_udata, heap);
 }
@@ -49963,7 +54326,16 @@ DUK_LOCAL void duk__dump_type_sizes(void) {
 	DUK__DUMPSZ(duk_activation);
 	DUK__DUMPSZ(duk_catcher);
 	DUK__DUMPSZ(duk_strcache_entry);
+#if defined(DUK_USE_STRCACHE_INDEX)
+	DUK__DUMPSZ(duk_strcache_index);
+#endif
 	DUK__DUMPSZ(duk_litcache_entry);
+#if defined(DUK_USE_PROPERTY_IC)
+	DUK__DUMPSZ(duk_propic_entry);
+#endif
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	DUK__DUMPSZ(duk_propshape);
+#endif
 	DUK__DUMPSZ(duk_ljstate);
 	DUK__DUMPSZ(duk_fixedbuffer);
 	DUK__DUMPSZ(duk_bitdecoder_ctx);
@@ -50228,6 +54600,15 @@ duk_heap *duk_heap_alloc(duk_alloc_function alloc_func,
 	res->dbg_udata = NULL;
 	res->dbg_pause_act = NULL;
 #endif
+#if defined(DUK_USE_PROFILER_SAMPLING)
+	res->prof_buf = NULL;
+#endif
+#if defined(DUK_USE_PROFILER_INSTRUMENT)
+	res->prof_funcs = NULL;
+#endif
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	res->ms_grey = NULL;
+#endif
 #endif  /* DUK_USE_EXPLICIT_NULL_INIT */
 
 	res->alloc_func = alloc_func;
@@ -50243,6 +54624,10 @@ duk_heap *duk_heap_alloc(duk_alloc_function alloc_func,
 
 	/* res->ms_trigger_counter == 0 -> now causes immediate GC; which is OK */
 
+#if defined(DUK_USE_MARK_AND_SWEEP_PAUSE_STATS)
+	res->ms_pause_start = -1.0;
+#endif
+
 	/* Prevent mark-and-sweep and finalizer execution until heap is completely
 	 * initialized.
 	 */
@@ -50294,6 +54679,11 @@ duk_heap *duk_heap_alloc(duk_alloc_function alloc_func,
 	if (res->strtable16 == NULL) {
 		goto failed;
 	}
+#elif defined(DUK_USE_STRTAB_PROBE)
+	res->strtable = (duk_strtab_entry *) alloc_func(heap_udata, sizeof(duk_strtab_entry) * st_initsize);
+	if (res->strtable == NULL) {
+		goto failed;
+	}
 #else
 	res->strtable = (duk_hstring **) alloc_func(heap_udata, sizeof(duk_hstring *) * st_initsize);
 	if (res->strtable == NULL) {
@@ -50302,7 +54692,7 @@ duk_heap *duk_heap_alloc(duk_alloc_function alloc_func,
 #endif
 	res->st_size = st_initsize;
 	res->st_mask = st_initsize - 1;
-#if (DUK_USE_STRTAB_MINSIZE != DUK_USE_STRTAB_MAXSIZE)
+#if (DUK_USE_STRTAB_MINSIZE != DUK_USE_STRTAB_MAXSIZE) || defined(DUK_USE_STRTAB_PROBE)
 	DUK_ASSERT(res->st_count == 0);
 #endif
 
@@ -50314,9 +54704,16 @@ duk_heap *duk_heap_alloc(duk_alloc_function alloc_func,
 	{
 		duk_uint32_t i;
 	        for (i = 0; i < st_initsize; i++) {
+#if defined(DUK_USE_STRTAB_PROBE)
+			res->strtable[i].hash = 0;
+			res->strtable[i].h = NULL;
+#else
 			res->strtable[i] = NULL;
+#endif
 	        }
 	}
+#elif defined(DUK_USE_STRTAB_PROBE)
+	duk_memzero(res->strtable, sizeof(duk_strtab_entry) * st_initsize);
 #else
 	duk_memzero(res->strtable, sizeof(duk_hstring *) * st_initsize);
 #endif  /* DUK_USE_EXPLICIT_NULL_INIT */
@@ -50332,6 +54729,34 @@ duk_heap *duk_heap_alloc(duk_alloc_function alloc_func,
 		for (i = 0; i < DUK_HEAP_STRCACHE_SIZE; i++) {
 			res->strcache[i].h = NULL;
 		}
+#if defined(DUK_USE_STRCACHE_INDEX)
+		for (i = 0; i < DUK_HEAP_STRCACHE_INDEX_SLOTS; i++) {
+			res->strcache_index[i].h = NULL;
+			res->strcache_index[i].boffs = NULL;
+		}
+#endif
+#if defined(DUK_USE_PROPERTY_IC)
+		for (i = 0; i < DUK_USE_PROPERTY_IC_SIZE; i++) {
+			res->propic[i].pc = NULL;
+			res->propic[i].key = NULL;
+		}
+#endif
+#if defined(DUK_USE_HOBJECT_SHAPES)
+		for (i = 0; i < DUK_HEAP_SHAPETAB_SIZE; i++) {
+			res->shapetab[i] = NULL;
+		}
+#endif
+#if defined(DUK_USE_REGEXP_CACHE)
+		for (i = 0; i < DUK_USE_REGEXP_CACHE_SIZE; i++) {
+			res->re_cache[i].pattern = NULL;
+			res->re_cache[i].flags = NULL;
+			res->re_cache[i].source = NULL;
+			res->re_cache[i].bytecode = NULL;
+		}
+#endif
+#if defined(DUK_USE_STRING_APPEND_INPLACE)
+		res->strapp_h = NULL;
+#endif
 	}
 #endif
 
@@ -50645,6 +55070,18 @@ DUK_INTERNAL void duk_heap_process_finalize_list(duk_heap *heap) {
 	DUK_ASSERT(heap->refzero_list == NULL);
 #endif
 
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	/* A finalizer may rescue its object into an already marked part of
+	 * the heap, so finish an incremental marking cycle first.  The
+	 * mark-and-sweep processes finalize_list when done; if it's not
+	 * allowed to run now, finalizers are left pending.
+	 */
+	if (heap->ms_incremental) {
+		duk_heap_mark_and_sweep(heap, 0);
+		return;
+	}
+#endif
+
 	DUK_ASSERT(heap->pf_prevent_count == 0);
 	heap->pf_prevent_count = 1;
 
@@ -50962,7 +55399,165 @@ DUK_INTERNAL void duk_heap_run_finalizer(duk_heap *heap, duk_hobject *obj) {
 
 /* #include duk_internal.h -> already included */
 
-#if defined(DUK_USE_STRHASH_DENSE)
+#if defined(DUK_USE_STRHASH_FULL)
+#if defined(DUK_USE_ROM_STRINGS)
+#error DUK_USE_STRHASH_FULL is not supported with DUK_USE_ROM_STRINGS (hash must match tools/dukutil.py)
+#endif
+
+/* Full length multiplicative hash, 8 input bytes per round.  Unlike the
+ * other variants no bytes are skipped, so long strings differing only in
+ * a few bytes (e.g. topic names with a shared prefix, JSON keys) still get
+ * distinct hashes.  64-bit targets use one 64-bit lane; 32-bit targets
+ * (where 64-bit multiplies are slow) use two independent 32-bit lanes.
+ * Words are loaded with memcpy() so unaligned input is fine; the result
+ * depends on endianness which is OK for RAM strings.  A 1-7 byte tail is
+ * read with fixed size (possibly overlapping) loads; the length is mixed
+ * in after the tail so overlaps don't matter.
+ *
+ * Because the length comes last, the state after the full words of a
+ * string can be saved and resumed for any longer string with the same
+ * prefix (init/update/final), which in-place string append relies on.
+ */
+#if defined(DUK_USE_64BIT_OPS) && (DUK_SIZE_MAX > 0xffffffffUL)
+DUK_INTERNAL void duk_heap_hashstring_init(duk_heap *heap, duk_strhash_state *st) {
+	st->h = (duk_uint64_t) heap->hash_seed * DUK_U64_CONSTANT(0x9e3779b97f4a7c15);
+	st->off = 0;
+}
+
+/* Consume the full 8-byte words of str[st->off,len). */
+DUK_INTERNAL void duk_heap_hashstring_update(duk_strhash_state *st, const duk_uint8_t *str, duk_size_t len) {
+	duk_uint64_t h;
+	duk_uint64_t w;
+	duk_size_t off;
+
+	DUK_ASSERT(st->off <= len);
+
+	h = st->h;
+	for (off = st->off; len - off >= 8; off += 8) {
+		duk_memcpy((void *) &w, (const void *) (str + off), 8);
+		h = (h ^ w) * DUK_U64_CONSTANT(0x9e3779b97f4a7c15);
+		h ^= h >> 32;
+	}
+	st->h = h;
+	st->off = off;
+}
+
+/* Hash the remaining 0-7 bytes and the length; 'st' is not modified. */
+DUK_INTERNAL duk_uint32_t duk_heap_hashstring_final(const duk_strhash_state *st, const duk_uint8_t *str, duk_size_t len) {
+	duk_uint64_t h;
+	duk_uint64_t w;
+	duk_size_t rem;
+
+	DUK_ASSERT(st->off <= len && len - st->off < 8);
+
+	h = st->h;
+	str += st->off;
+	rem = len - st->off;
+	if (rem > 0) {
+		if (rem >= 4) {
+			duk_uint32_t lo;
+			duk_uint32_t hi;
+
+			duk_memcpy((void *) &lo, (const void *) str, 4);
+			duk_memcpy((void *) &hi, (const void *) (str + rem - 4), 4);
+			w = ((duk_uint64_t) hi << 32) | (duk_uint64_t) lo;
+		} else {
+			w = ((duk_uint64_t) str[0] << 16) | ((duk_uint64_t) str[rem >> 1] << 8) | (duk_uint64_t) str[rem - 1];
+		}
+		h = (h ^ w) * DUK_U64_CONSTANT(0x9e3779b97f4a7c15);
+		h ^= h >> 32;
+	}
+	h = (h ^ (duk_uint64_t) len) * DUK_U64_CONSTANT(0x9e3779b97f4a7c15);
+	h ^= h >> 32;
+	h *= DUK_U64_CONSTANT(0xbf58476d1ce4e5b9);
+	h ^= h >> 31;
+
+#if defined(DUK_USE_STRHASH16)
+	return (duk_uint32_t) (h >> 32) & 0x0000ffffUL;
+#else
+	return (duk_uint32_t) (h >> 32);
+#endif
+}
+#else  /* 64-bit */
+DUK_INTERNAL void duk_heap_hashstring_init(duk_heap *heap, duk_strhash_state *st) {
+	st->a = heap->hash_seed;
+	st->b = st->a * 0x9e3779b1UL;
+	st->off = 0;
+}
+
+/* Consume the full 8-byte words of str[st->off,len). */
+DUK_INTERNAL void duk_heap_hashstring_update(duk_strhash_state *st, const duk_uint8_t *str, duk_size_t len) {
+	duk_uint32_t a;
+	duk_uint32_t b;
+	duk_uint32_t w0;
+	duk_uint32_t w1;
+	duk_size_t off;
+
+	DUK_ASSERT(st->off <= len);
+
+	a = st->a;
+	b = st->b;
+	for (off = st->off; len - off >= 8; off += 8) {
+		duk_memcpy((void *) &w0, (const void *) (str + off), 4);
+		duk_memcpy((void *) &w1, (const void *) (str + off + 4), 4);
+		a = (a ^ w0) * 0x9e3779b1UL;
+		a ^= a >> 15;
+		b = (b ^ w1) * 0x85ebca77UL;
+		b ^= b >> 13;
+	}
+	st->a = a;
+	st->b = b;
+	st->off = off;
+}
+
+/* Hash the remaining 0-7 bytes and the length; 'st' is not modified. */
+DUK_INTERNAL duk_uint32_t duk_heap_hashstring_final(const duk_strhash_state *st, const duk_uint8_t *str, duk_size_t len) {
+	duk_uint32_t a;
+	duk_uint32_t b;
+	duk_uint32_t w0;
+	duk_uint32_t w1;
+	duk_size_t rem;
+
+	DUK_ASSERT(st->off <= len && len - st->off < 8);
+
+	a = st->a;
+	b = st->b;
+	str += st->off;
+	rem = len - st->off;
+	if (rem > 0) {
+		if (rem >= 4) {
+			duk_memcpy((void *) &w0, (const void *) str, 4);
+			duk_memcpy((void *) &w1, (const void *) (str + rem - 4), 4);
+		} else {
+			w0 = ((duk_uint32_t) str[0] << 16) | ((duk_uint32_t) str[rem >> 1] << 8) | (duk_uint32_t) str[rem - 1];
+			w1 = 0;
+		}
+		a = (a ^ w0) * 0x9e3779b1UL;
+		a ^= a >> 15;
+		b = (b ^ w1) * 0x85ebca77UL;
+		b ^= b >> 13;
+	}
+	a = (a ^ (duk_uint32_t) len) * 0x9e3779b1UL;
+	a ^= a >> 15;
+	a ^= (b << 16) | (b >> 16);
+	a *= 0x7feb352dUL;
+	a ^= a >> 15;
+
+#if defined(DUK_USE_STRHASH16)
+	a &= 0x0000ffffUL;
+#endif
+	return a;
+}
+#endif  /* 64-bit */
+
+DUK_INTERNAL duk_uint32_t duk_heap_hashstring(duk_heap *heap, const duk_uint8_t *str, duk_size_t len) {
+	duk_strhash_state st;
+
+	duk_heap_hashstring_init(heap, &st);
+	duk_heap_hashstring_update(&st, str, len);
+	return duk_heap_hashstring_final(&st, str, len);
+}
+#elif defined(DUK_USE_STRHASH_DENSE)
 /* Constants for duk_hashstring(). */
 #define DUK__STRHASH_SHORTSTRING   4096L
 #define DUK__STRHASH_MEDIUMSTRING  (256L * 1024L)
@@ -51023,7 +55618,7 @@ DUK_INTERNAL duk_uint32_t duk_heap_hashstring(duk_heap *heap, const duk_uint8_t
 #endif
 	return hash;
 }
-#else  /* DUK_USE_STRHASH_DENSE */
+#else  /* DUK_USE_STRHASH_FULL, DUK_USE_STRHASH_DENSE */
 DUK_INTERNAL duk_uint32_t duk_heap_hashstring(duk_heap *heap, const duk_uint8_t *str, duk_size_t len) {
 	duk_uint32_t hash;
 	duk_size_t step;
@@ -51056,7 +55651,7 @@ DUK_INTERNAL duk_uint32_t duk_heap_hashstring(duk_heap *heap, const duk_uint8_t
 #endif
 	return hash;
 }
-#endif  /* DUK_USE_STRHASH_DENSE */
+#endif  /* DUK_USE_STRHASH_FULL, DUK_USE_STRHASH_DENSE */
 
 /* automatic undefs */
 #undef DUK__STRHASH_BLOCKSIZE
@@ -51072,6 +55667,9 @@ DUK_LOCAL_DECL void duk__mark_heaphdr(duk_heap *heap, duk_heaphdr *h);
 DUK_LOCAL_DECL void duk__mark_heaphdr_nonnull(duk_heap *heap, duk_heaphdr *h);
 DUK_LOCAL_DECL void duk__mark_tval(duk_heap *heap, duk_tval *tv);
 DUK_LOCAL_DECL void duk__mark_tvals(duk_heap *heap, duk_tval *tv, duk_idx_t count);
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+DUK_LOCAL_DECL void duk__mark_grey(duk_heap *heap, duk_heaphdr *h);
+#endif
 
 /*
  *  Marking functions for heap types: mark children recursively.
@@ -51104,6 +55702,12 @@ DUK_LOCAL void duk__mark_hobject(duk_heap *heap, duk_hobject *h) {
 			continue;
 		}
 		duk__mark_heaphdr_nonnull(heap, (duk_heaphdr *) key);
+#if defined(DUK_USE_HOBJECT_SHAPES) && defined(DUK_USE_ASSERTIONS) && defined(DUK_USE_REFERENCE_COUNTING)
+		/* Shared keys are counted once per shape, see duk__check_assert_refcounts(). */
+		if (DUK_HOBJECT_HAS_SHAPE(h) && !DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) key)) {
+			((duk_heaphdr *) key)->h_assert_refcount--;
+		}
+#endif
 		if (DUK_HOBJECT_E_SLOT_IS_ACCESSOR(heap, h, i)) {
 			duk__mark_heaphdr(heap, (duk_heaphdr *) DUK_HOBJECT_E_GET_VALUE_PTR(heap, h, i)->a.get);
 			duk__mark_heaphdr(heap, (duk_heaphdr *) DUK_HOBJECT_E_GET_VALUE_PTR(heap, h, i)->a.set);
@@ -51266,6 +55870,15 @@ DUK_LOCAL void duk__mark_heaphdr(duk_heap *heap, duk_heaphdr *h) {
 	DUK_HEAPHDR_SET_REACHABLE(h);
 
 	if (heap->ms_recursion_depth >= DUK_USE_MARK_AND_SWEEP_RECLIMIT) {
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+		/* Incremental steps run at the recursion limit so that children
+		 * are queued rather than marked recursively.
+		 */
+		if (heap->ms_incremental) {
+			duk__mark_grey(heap, h);
+			return;
+		}
+#endif
 		DUK_D(DUK_DPRINT("mark-and-sweep recursion limit reached, marking as temproot: %p", (void *) h));
 		DUK_HEAP_SET_MARKANDSWEEP_RECLIMIT_REACHED(heap);
 		DUK_HEAPHDR_SET_TEMPROOT(h);
@@ -51331,6 +55944,107 @@ DUK_LOCAL void duk__mark_heaphdr_nonnull(duk_heap *heap, duk_heaphdr *h) {
 	duk__mark_heaphdr(heap, h);
 }
 
+/*
+ *  Incremental marking.
+ *
+ *  Grey objects (marked, children not yet marked) are kept on an explicit
+ *  stack and flagged TEMPROOT.  The stack is grown using the raw allocation
+ *  functions to avoid GC side effects.  If that fails the object is left
+ *  flagged TEMPROOT and the final mark-and-sweep finds it by a heap scan.
+ */
+
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+DUK_LOCAL void duk__mark_grey(duk_heap *heap, duk_heaphdr *h) {
+	DUK_ASSERT(heap->ms_incremental);
+	DUK_ASSERT(DUK_HEAPHDR_HAS_REACHABLE(h));
+
+	if (DUK_HEAPHDR_GET_TYPE(h) != DUK_HTYPE_OBJECT) {
+		/* Strings and buffers have no children. */
+		return;
+	}
+
+	DUK_HEAPHDR_SET_TEMPROOT(h);
+
+	if (heap->ms_grey_used >= heap->ms_grey_size) {
+		duk_heaphdr **new_grey;
+		duk_size_t new_size;
+
+		new_size = heap->ms_grey_size * 2;
+		if (new_size < DUK_HEAP_MARK_AND_SWEEP_GREY_MINSIZE) {
+			new_size = DUK_HEAP_MARK_AND_SWEEP_GREY_MINSIZE;
+		}
+		new_grey = NULL;
+		if (new_size <= DUK_SIZE_MAX / sizeof(duk_heaphdr *)) {
+			new_grey = (duk_heaphdr **) heap->realloc_func(heap->heap_udata, (void *) heap->ms_grey, sizeof(duk_heaphdr *) * new_size);
+		}
+		if (new_grey == NULL) {
+			DUK_D(DUK_DPRINT("failed to grow grey stack, marking as temproot: %p", (void *) h));
+			DUK_HEAP_SET_MARKANDSWEEP_RECLIMIT_REACHED(heap);
+			return;
+		}
+		heap->ms_grey = new_grey;
+		heap->ms_grey_size = new_size;
+	}
+
+	heap->ms_grey[heap->ms_grey_used++] = h;
+}
+
+/* Mark grey objects until the grey stack is empty or, if 'bounded', the
+ * deadline passes.  Returns 1 if the grey stack was emptied.
+ */
+DUK_LOCAL duk_bool_t duk__mark_grey_drain(duk_heap *heap, duk_bool_t bounded, duk_double_t deadline) {
+	duk_heaphdr *h;
+	duk_small_uint_t count = 0;
+
+	while (heap->ms_grey_used > 0) {
+		h = heap->ms_grey[--heap->ms_grey_used];
+		DUK_ASSERT(h != NULL);
+		DUK_ASSERT(DUK_HEAPHDR_GET_TYPE(h) == DUK_HTYPE_OBJECT);
+		DUK_ASSERT(DUK_HEAPHDR_HAS_REACHABLE(h));
+		DUK_ASSERT(DUK_HEAPHDR_HAS_TEMPROOT(h));
+
+		DUK_HEAPHDR_CLEAR_TEMPROOT(h);
+		duk__mark_hobject(heap, (duk_hobject *) h);
+
+		if (bounded && (++count & 0x1fU) == 0U &&
+		    duk_time_get_monotonic_time(heap->heap_thread) >= deadline) {
+			return (heap->ms_grey_used == 0);
+		}
+	}
+	return 1;
+}
+
+/* Shade thread value stacks etc when a cycle starts.  Values are moved
+ * out of value stacks without DECREF in several places, so the write
+ * barrier doesn't see them.  The threads themselves are not marked.
+ */
+DUK_LOCAL void duk__mark_threads(duk_heap *heap) {
+	duk_heaphdr *hdr;
+
+	hdr = heap->heap_allocated;
+	while (hdr != NULL) {
+		if (DUK_HEAPHDR_GET_TYPE(hdr) == DUK_HTYPE_OBJECT &&
+		    DUK_HOBJECT_IS_THREAD((duk_hobject *) hdr)) {
+			duk__mark_hobject(heap, (duk_hobject *) hdr);
+		}
+		hdr = DUK_HEAPHDR_GET_NEXT(heap, hdr);
+	}
+}
+
+/* Write barrier target, see DUK_HEAPHDR_MS_BARRIER(). */
+DUK_INTERNAL void duk_heap_mark_shade(duk_heap *heap, duk_heaphdr *h) {
+	DUK_ASSERT(heap != NULL);
+	DUK_ASSERT(h != NULL);
+	DUK_ASSERT(heap->ms_incremental);
+
+	if (DUK_HEAPHDR_HAS_REACHABLE(h)) {
+		return;
+	}
+	DUK_HEAPHDR_SET_REACHABLE(h);
+	duk__mark_grey(heap, h);
+}
+#endif  /* DUK_USE_MARK_AND_SWEEP_INCREMENTAL */
+
 /*
  *  Mark the heap.
  */
@@ -51356,6 +56070,29 @@ DUK_LOCAL void duk__mark_roots_heap(duk_heap *heap) {
 		duk__mark_heaphdr(heap, (duk_heaphdr *) heap->dbg_breakpoints[i].filename);
 	}
 #endif
+
+#if defined(DUK_USE_REGEXP_CACHE)
+	for (i = 0; i < DUK_USE_REGEXP_CACHE_SIZE; i++) {
+		duk_re_cache_entry *e = heap->re_cache + i;
+		if (e->pattern != NULL) {
+			duk__mark_heaphdr(heap, (duk_heaphdr *) e->pattern);
+			duk__mark_heaphdr(heap, (duk_heaphdr *) e->flags);
+			duk__mark_heaphdr(heap, (duk_heaphdr *) e->source);
+			duk__mark_heaphdr(heap, (duk_heaphdr *) e->bytecode);
+		}
+	}
+#endif
+
+#if defined(DUK_USE_PROFILER_INSTRUMENT)
+	for (i = 0; i < heap->prof_funcs_size; i++) {
+		duk_prof_entry *e = heap->prof_funcs + i;
+		if (e->data != NULL) {
+			duk__mark_heaphdr(heap, (duk_heaphdr *) e->data);
+			duk__mark_heaphdr(heap, (duk_heaphdr *) e->name);
+			duk__mark_heaphdr(heap, (duk_heaphdr *) e->filename);
+		}
+	}
+#endif
 }
 
 /*
@@ -51629,8 +56366,13 @@ DUK_LOCAL void duk__clear_finalize_list_flags(duk_heap *heap) {
 
 DUK_LOCAL void duk__sweep_stringtable(duk_heap *heap, duk_size_t *out_count_keep) {
 	duk_hstring *h;
-	duk_hstring *prev;
 	duk_uint32_t i;
+#if defined(DUK_USE_STRTAB_PROBE)
+	duk_uint32_t start;
+	duk_uint32_t n;
+#else
+	duk_hstring *prev;
+#endif
 #if defined(DUK_USE_DEBUG)
 	duk_size_t count_free = 0;
 #endif
@@ -51646,6 +56388,45 @@ DUK_LOCAL void duk__sweep_stringtable(duk_heap *heap, duk_size_t *out_count_keep
 		goto done;
 	}
 
+#if defined(DUK_USE_STRTAB_PROBE)
+	/* Open addressing: removal shifts later entries of the same probe
+	 * run backwards.  Start the walk right after an empty slot so that
+	 * an entry is never shifted from an unvisited slot to a visited one,
+	 * and revisit a slot after a removal.
+	 */
+	for (start = 0; heap->strtable[start].hash != 0; start++) {
+		DUK_ASSERT(start < heap->st_mask);  /* At least one empty slot. */
+	}
+	i = start;
+	for (n = heap->st_size; n > 0; n--) {
+		i = (i + 1) & heap->st_mask;
+		h = heap->strtable[i].h;
+		if (h == NULL) {
+			continue;
+		}
+		DUK_ASSERT(h->hdr.h_next == NULL);
+
+		if (DUK_HEAPHDR_HAS_REACHABLE((duk_heaphdr *) h)) {
+			DUK_HEAPHDR_CLEAR_REACHABLE((duk_heaphdr *) h);
+			count_keep++;
+		} else {
+#if defined(DUK_USE_DEBUG)
+			count_free++;
+#endif
+#if defined(DUK_USE_REFERENCE_COUNTING)
+			DUK_ASSERT(DUK_HEAPHDR_GET_REFCOUNT((duk_heaphdr *) h) ==
+			           DUK_HSTRING_HAS_PINNED_LITERAL(h) ? 1U : 0U);
+#endif
+			duk_heap_strcache_string_remove(heap, (duk_hstring *) h);
+			duk_heap_strtable_unlink(heap, (duk_hstring *) h);
+			duk_free_hstring(heap, (duk_hstring *) h);
+
+			/* Slot may now hold a shifted entry. */
+			i = (i - 1) & heap->st_mask;
+			n++;
+		}
+	}
+#else  /* DUK_USE_STRTAB_PROBE */
 	for (i = 0; i < heap->st_size; i++) {
 #if defined(DUK_USE_STRTAB_PTRCOMP)
 		h = DUK_USE_HEAPPTR_DEC16(heap->heap_udata, heap->strtable16[i]);
@@ -51706,6 +56487,7 @@ DUK_LOCAL void duk__sweep_stringtable(duk_heap *heap, duk_size_t *out_count_keep
 			h = next;
 		}
 	}
+#endif  /* DUK_USE_STRTAB_PROBE */
 
  done:
 #if defined(DUK_USE_DEBUG)
@@ -52010,6 +56792,34 @@ DUK_LOCAL void duk__compact_objects(duk_heap *heap) {
 #endif
 }
 
+/*
+ *  Shared shapes for live objects.
+ */
+
+#if defined(DUK_USE_HOBJECT_SHAPES)
+DUK_LOCAL void duk__shape_objects(duk_heap *heap) {
+	duk_heaphdr *curr;
+#if defined(DUK_USE_DEBUG)
+	duk_size_t count_shaped = 0;
+#endif
+
+	for (curr = heap->heap_allocated; curr != NULL; curr = DUK_HEAPHDR_GET_NEXT(heap, curr)) {
+		if (DUK_HEAPHDR_GET_TYPE(curr) != DUK_HTYPE_OBJECT) {
+			continue;
+		}
+		if (duk_hobject_shape_props(heap, (duk_hobject *) curr)) {
+#if defined(DUK_USE_DEBUG)
+			count_shaped++;
+#endif
+		}
+	}
+
+#if defined(DUK_USE_DEBUG)
+	DUK_D(DUK_DPRINT("mark-and-sweep shape objects: %ld objects use a shared shape", (long) count_shaped));
+#endif
+}
+#endif  /* DUK_USE_HOBJECT_SHAPES */
+
 /*
  *  Assertion helpers.
  */
@@ -52033,6 +56843,8 @@ DUK_LOCAL void duk__assert_walk_strtable(duk_heap *heap, duk__gc_hstring_assert
 
 #if defined(DUK_USE_STRTAB_PTRCOMP)
 		h = DUK_USE_HEAPPTR_DEC16(heap->heap_udata, heap->strtable16[i]);
+#elif defined(DUK_USE_STRTAB_PROBE)
+		h = heap->strtable[i].h;
 #else
 		h = heap->strtable[i];
 #endif
@@ -52165,6 +56977,23 @@ DUK_LOCAL void duk__check_assert_refcounts_cb2(duk_heap *heap, duk_hstring *h) {
 	duk__check_refcount_heaphdr((duk_heaphdr *) h);
 }
 DUK_LOCAL void duk__check_assert_refcounts(duk_heap *heap) {
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	duk_uint_t i;
+	duk_uint32_t j;
+	duk_propshape *shape;
+
+	/* Each shape holds one reference to each of its keys. */
+	for (i = 0; i < DUK_HEAP_SHAPETAB_SIZE; i++) {
+		for (shape = heap->shapetab[i]; shape != NULL; shape = shape->next) {
+			for (j = 0; j < shape->e_size; j++) {
+				duk_heaphdr *key = (duk_heaphdr *) DUK_PROPSHAPE_GET_KEYS(shape)[j];
+				if (!DUK_HEAPHDR_HAS_READONLY(key)) {
+					key->h_assert_refcount++;
+				}
+			}
+		}
+	}
+#endif
 	duk__assert_walk_list(heap, heap->heap_allocated, duk__check_assert_refcounts_cb1);
 #if defined(DUK_USE_FINALIZER_SUPPORT)
 	duk__assert_walk_list(heap, heap->finalize_list, duk__check_assert_refcounts_cb1);
@@ -52250,6 +57079,37 @@ DUK_LOCAL void duk__dump_stats(duk_heap *heap) {
 }
 #endif  /* DUK_USE_DEBUG */
 
+/*
+ *  Pause statistics.
+ */
+
+#if defined(DUK_USE_MARK_AND_SWEEP_PAUSE_STATS)
+DUK_LOCAL void duk__ms_pause_end(duk_heap *heap) {
+	duk_double_t t;
+	duk_double_t us;
+	duk_small_uint_t b;
+
+	if (heap->ms_pause_start < 0.0) {
+		return;
+	}
+	t = duk_time_get_monotonic_time(heap->heap_thread) - heap->ms_pause_start;
+	heap->ms_pause_start = -1.0;
+	if (t < 0.0) {
+		t = 0.0;
+	}
+
+	heap->ms_pause_count++;
+	heap->ms_pause_total += t;
+	if (t > heap->ms_pause_max) {
+		heap->ms_pause_max = t;
+	}
+	for (us = t * 1000.0, b = 0; us >= 2.0 && b < DUK_HEAP_MS_PAUSE_BUCKETS - 1; us /= 2.0) {
+		b++;
+	}
+	heap->ms_pause_hist[b]++;
+}
+#endif  /* DUK_USE_MARK_AND_SWEEP_PAUSE_STATS */
+
 /*
  *  Main mark-and-sweep function.
  *
@@ -52265,6 +57125,9 @@ DUK_INTERNAL void duk_heap_mark_and_sweep(duk_heap *heap, duk_small_uint_t flags
 	duk_size_t tmp;
 #endif
 	duk_bool_t entry_creating_error;
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	duk_bool_t was_incremental;
+#endif
 
 	DUK_STATS_INC(heap, stats_ms_try_count);
 #if defined(DUK_USE_DEBUG)
@@ -52300,6 +57163,21 @@ DUK_INTERNAL void duk_heap_mark_and_sweep(duk_heap *heap, duk_small_uint_t flags
 	DUK_D(DUK_DPRINT("garbage collect (mark-and-sweep) starting, requested flags: 0x%08lx, effective flags: 0x%08lx",
 	                 (unsigned long) flags, (unsigned long) (flags | heap->ms_base_flags)));
 
+#if defined(DUK_USE_MARK_AND_SWEEP_PAUSE_STATS)
+	/* Already set if called from an incremental step. */
+	if (heap->ms_pause_start < 0.0) {
+		heap->ms_pause_start = duk_time_get_monotonic_time(heap->heap_thread);
+	}
+#if defined(DUK_USE_VOLUNTARY_GC)
+	if (heap->ms_trigger_counter < 0) {
+		heap->ms_count_alloc++;
+	}
+#endif
+#endif
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	was_incremental = heap->ms_incremental;
+#endif
+
 	flags |= heap->ms_base_flags;
 #if defined(DUK_USE_FINALIZER_SUPPORT)
 	if (heap->finalize_list != NULL) {
@@ -52315,9 +57193,14 @@ DUK_INTERNAL void duk_heap_mark_and_sweep(duk_heap *heap, duk_small_uint_t flags
 	DUK_ASSERT(heap->ms_prevent_count == 0);
 	DUK_ASSERT(heap->ms_running == 0);
 	DUK_ASSERT(!DUK_HEAP_HAS_DEBUGGER_PAUSED(heap));
-	DUK_ASSERT(!DUK_HEAP_HAS_MARKANDSWEEP_RECLIMIT_REACHED(heap));
 	DUK_ASSERT(heap->ms_recursion_depth == 0);
-	duk__assert_heaphdr_flags(heap);
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	if (!was_incremental)  /* Marking in progress. */
+#endif
+	{
+		DUK_ASSERT(!DUK_HEAP_HAS_MARKANDSWEEP_RECLIMIT_REACHED(heap));
+		duk__assert_heaphdr_flags(heap);
+	}
 	duk__assert_validity(heap);
 #if defined(DUK_USE_REFERENCE_COUNTING)
 	/* Note: heap->refzero_free_running may be true; a refcount
@@ -52368,6 +57251,20 @@ DUK_INTERNAL void duk_heap_mark_and_sweep(duk_heap *heap, duk_small_uint_t flags
 #endif
 #if defined(DUK_USE_LITCACHE_SIZE)
 	duk__wipe_litcache(heap);
+#endif
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	if (was_incremental) {
+		/* Finish an incremental cycle: whatever is still grey is
+		 * marked here, with the write barrier still active until
+		 * marking is done.  Grey stack overflow falls back to the
+		 * temproot heap scan below.
+		 */
+		DUK_D(DUK_DPRINT("finish incremental mark-and-sweep cycle, %ld grey objects",
+		                 (long) heap->ms_grey_used));
+		(void) duk__mark_grey_drain(heap, 0 /*bounded*/, 0.0);
+		DUK_ASSERT(heap->ms_grey_used == 0);
+		heap->ms_incremental = 0;
+	}
 #endif
 	duk__mark_roots_heap(heap);               /* Mark main reachability roots. */
 #if defined(DUK_USE_REFERENCE_COUNTING)
@@ -52403,6 +57300,10 @@ DUK_INTERNAL void duk_heap_mark_and_sweep(duk_heap *heap, duk_small_uint_t flags
 	duk__sweep_heap(heap, flags, &count_keep_obj);
 	duk__sweep_stringtable(heap, &count_keep_str);
 #if defined(DUK_USE_ASSERTIONS) && defined(DUK_USE_REFERENCE_COUNTING)
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	/* Objects marked in earlier steps weren't revisited. */
+	if (!was_incremental)
+#endif
 	duk__check_assert_refcounts(heap);
 #endif
 #if defined(DUK_USE_REFERENCE_COUNTING)
@@ -52412,6 +57313,19 @@ DUK_INTERNAL void duk_heap_mark_and_sweep(duk_heap *heap, duk_small_uint_t flags
 	duk__clear_finalize_list_flags(heap);
 #endif
 
+	/*
+	 *  Shared object shapes.  Objects which survived a collection are
+	 *  likely to stay as they are; objects matching an earlier seen
+	 *  layout switch to a shared shape.  Skipped while a property table
+	 *  resize is in progress (same condition as for compaction).
+	 */
+
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	if (!(flags & DUK_MS_FLAG_NO_OBJECT_COMPACTION)) {
+		duk__shape_objects(heap);
+	}
+#endif
+
 	/*
 	 *  Object compaction (emergency only).
 	 *
@@ -52468,6 +57382,10 @@ DUK_INTERNAL void duk_heap_mark_and_sweep(duk_heap *heap, duk_small_uint_t flags
 	heap->ms_prevent_count = 0;
 	heap->ms_running = 0;
 	heap->creating_error = entry_creating_error;  /* for nested error handling, see GH-2278 */
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	heap->ms_cycles++;
+	DUK_UNREF(was_incremental);
+#endif
 
 	/*
 	 *  Assertions after
@@ -52499,6 +57417,7 @@ DUK_INTERNAL void duk_heap_mark_and_sweep(duk_heap *heap, duk_small_uint_t flags
 	heap->ms_trigger_counter = (duk_int_t) (
 	    (tmp * DUK_HEAP_MARK_AND_SWEEP_TRIGGER_MULT) +
 	    DUK_HEAP_MARK_AND_SWEEP_TRIGGER_ADD);
+	heap->ms_trigger_limit = heap->ms_trigger_counter;
 	DUK_D(DUK_DPRINT("garbage collect (mark-and-sweep) finished: %ld objects kept, %ld strings kept, trigger reset to %ld",
 	                 (long) count_keep_obj, (long) count_keep_str, (long) heap->ms_trigger_counter));
 #else
@@ -52513,6 +57432,9 @@ DUK_INTERNAL void duk_heap_mark_and_sweep(duk_heap *heap, duk_small_uint_t flags
 #if defined(DUK_USE_DEBUG)
 	duk__dump_stats(heap);
 #endif
+#if defined(DUK_USE_MARK_AND_SWEEP_PAUSE_STATS)
+	duk__ms_pause_end(heap);
+#endif
 
 	/*
 	 *  Finalize objects in the finalization work list.  Finalized
@@ -52548,6 +57470,150 @@ DUK_INTERNAL void duk_heap_mark_and_sweep(duk_heap *heap, duk_small_uint_t flags
 	duk_heap_process_finalize_list(heap);
 #endif  /* DUK_USE_FINALIZER_SUPPORT */
 }
+
+/*
+ *  Incremental mark-and-sweep step.
+ *
+ *  Marking is spread over steps taken from the voluntary GC trigger (or
+ *  explicitly), each bounded by 'budget' milliseconds.  The snapshot-at-
+ *  the-beginning invariant is maintained by the DECREF write barrier.
+ *  Once the grey stack is empty a normal mark-and-sweep finishes the
+ *  cycle; that final pass (sweep and finalizer handling) is not
+ *  incremental.  Returns 1 if a cycle was completed.
+ */
+
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+DUK_INTERNAL duk_bool_t duk_heap_mark_and_sweep_step(duk_heap *heap, duk_double_t budget) {
+	duk_double_t start;
+	duk_bool_t done;
+
+	DUK_ASSERT(heap != NULL);
+
+	if (heap->ms_prevent_count != 0) {
+		DUK_DD(DUK_DDPRINT("reject recursive mark-and-sweep step"));
+		DUK_STATS_INC(heap, stats_ms_skip_count);
+		return 0;
+	}
+	DUK_ASSERT(heap->ms_running == 0);
+	DUK_ASSERT(heap->heap_thread != NULL);
+
+	if (!heap->ms_incremental) {
+		if (((heap->ms_cycles + 1U) % DUK_HEAP_MARK_AND_SWEEP_FULL_INTERVAL) == 0U) {
+			DUK_D(DUK_DPRINT("periodic full mark-and-sweep instead of incremental cycle"));
+			duk_heap_mark_and_sweep(heap, 0);
+			return 1;
+		}
+		if (heap->pf_prevent_count != 0) {
+			/* Finalizers being processed (or prevented): don't start
+			 * a cycle as rescued objects would be missed.
+			 */
+			DUK_DD(DUK_DDPRINT("finalizers prevented, postpone incremental cycle"));
+			heap->ms_trigger_counter = DUK_HEAP_MARK_AND_SWEEP_STEP_INTERVAL;
+			return 0;
+		}
+	}
+
+	start = duk_time_get_monotonic_time(heap->heap_thread);
+#if defined(DUK_USE_MARK_AND_SWEEP_PAUSE_STATS)
+	heap->ms_pause_start = start;
+#endif
+
+	heap->ms_prevent_count = 1;
+	heap->ms_running = 1;
+	heap->ms_recursion_depth = DUK_USE_MARK_AND_SWEEP_RECLIMIT;
+
+	if (!heap->ms_incremental) {
+		DUK_D(DUK_DPRINT("incremental mark-and-sweep cycle starting"));
+#if defined(DUK_USE_REFERENCE_COUNTING)
+		DUK_ASSERT(heap->refzero_list == NULL);
+#endif
+		DUK_ASSERT(heap->ms_grey_used == 0);
+		heap->ms_incremental = 1;
+		duk__mark_roots_heap(heap);
+		duk__mark_threads(heap);
+	}
+
+	heap->ms_steps++;
+	done = duk__mark_grey_drain(heap, 1 /*bounded*/, start + budget);
+
+	heap->ms_recursion_depth = 0;
+	heap->ms_prevent_count = 0;
+	heap->ms_running = 0;
+
+	if (done) {
+		duk_heap_mark_and_sweep(heap, 0);
+		return 1;
+	}
+
+	DUK_DD(DUK_DDPRINT("incremental mark-and-sweep step, %ld grey objects left",
+	                   (long) heap->ms_grey_used));
+#if defined(DUK_USE_MARK_AND_SWEEP_PAUSE_STATS)
+	duk__ms_pause_end(heap);
+#endif
+	heap->ms_trigger_counter = DUK_HEAP_MARK_AND_SWEEP_STEP_INTERVAL;
+	return 0;
+}
+#endif  /* DUK_USE_MARK_AND_SWEEP_INCREMENTAL */
+
+/*
+ *  Idle time mark-and-sweep.
+ *
+ *  Called by the application when it has nothing else to do.  Collects
+ *  (or takes an incremental step of at most 'budget' milliseconds) once
+ *  enough of the voluntary trigger interval has been used up.  Every
+ *  collection resets the trigger, so allocation triggered collections in
+ *  busy periods are pushed back as long as idle collections keep up.
+ *  Returns 1 if a collection was completed.
+ */
+
+DUK_INTERNAL duk_bool_t duk_heap_mark_and_sweep_idle(duk_heap *heap, duk_double_t budget, duk_small_uint_t flags) {
+	duk_bool_t done;
+
+	DUK_ASSERT(heap != NULL);
+
+	if (heap->ms_prevent_count != 0) {
+		DUK_DD(DUK_DDPRINT("reject idle mark-and-sweep"));
+		return 0;
+	}
+
+#if defined(DUK_USE_VOLUNTARY_GC)
+	if (heap->ms_trigger_counter > heap->ms_trigger_limit / DUK_HEAP_MARK_AND_SWEEP_IDLE_DIV
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	    && !heap->ms_incremental
+#endif
+	    ) {
+		DUK_DDD(DUK_DDDPRINT("idle mark-and-sweep not due, trigger counter %ld/%ld",
+		                     (long) heap->ms_trigger_counter, (long) heap->ms_trigger_limit));
+		return 0;
+	}
+	if (heap->ms_trigger_counter < 0) {
+		/* Overdue but was prevented; this is an idle collection now. */
+		heap->ms_trigger_counter = 0;
+	}
+#endif
+
+	DUK_D(DUK_DPRINT("idle mark-and-sweep, budget %lf ms, flags 0x%08lx",
+	                 (double) budget, (unsigned long) flags));
+
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	if (!(flags & DUK_MS_FLAG_EMERGENCY)) {
+		done = duk_heap_mark_and_sweep_step(heap, budget);
+	} else
+#endif
+	{
+		/* Compaction needs a full collection. */
+		DUK_UNREF(budget);
+		duk_heap_mark_and_sweep(heap, flags);
+		done = 1;
+	}
+
+#if defined(DUK_USE_MARK_AND_SWEEP_PAUSE_STATS)
+	if (done) {
+		heap->ms_count_idle++;
+	}
+#endif
+	return done;
+}
 /*
  *  Memory allocation handling.
  */
@@ -52627,7 +57693,14 @@ DUK_INTERNAL DUK_INLINE_PERF DUK_HOT void *duk_heap_mem_alloc(duk_heap *heap, du
 #if defined(DUK_USE_VOLUNTARY_GC)
 	/* Voluntary periodic GC (if enabled). */
 	if (DUK_UNLIKELY(--(heap)->ms_trigger_counter < 0)) {
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+		/* Bounded marking step; the allocation itself proceeds
+		 * normally and only falls back to a full GC on failure.
+		 */
+		(void) duk_heap_mark_and_sweep_step(heap, (duk_double_t) DUK_USE_MARK_AND_SWEEP_STEP_BUDGET);
+#else
 		goto slowpath;
+#endif
 	}
 #endif
 
@@ -52652,7 +57725,9 @@ DUK_INTERNAL DUK_INLINE_PERF DUK_HOT void *duk_heap_mem_alloc(duk_heap *heap, du
 		return res;
 	}
 
+#if (defined(DUK_USE_VOLUNTARY_GC) && !defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)) || defined(DUK_USE_GC_TORTURE)
  slowpath:
+#endif
 
 	if (size == 0) {
 		DUK_D(DUK_DPRINT("first alloc attempt returned NULL for zero size alloc, use slow path to deal with it"));
@@ -52788,7 +57863,14 @@ DUK_INTERNAL DUK_INLINE_PERF DUK_HOT void *duk_heap_mem_realloc(duk_heap *heap,
 #if defined(DUK_USE_VOLUNTARY_GC)
 	/* Voluntary periodic GC (if enabled). */
 	if (DUK_UNLIKELY(--(heap)->ms_trigger_counter < 0)) {
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+		/* Bounded marking step; the allocation itself proceeds
+		 * normally and only falls back to a full GC on failure.
+		 */
+		(void) duk_heap_mark_and_sweep_step(heap, (duk_double_t) DUK_USE_MARK_AND_SWEEP_STEP_BUDGET);
+#else
 		goto slowpath;
+#endif
 	}
 #endif
 
@@ -52809,7 +57891,9 @@ DUK_INTERNAL DUK_INLINE_PERF DUK_HOT void *duk_heap_mem_realloc(duk_heap *heap,
 		return res;
 	}
 
+#if (defined(DUK_USE_VOLUNTARY_GC) && !defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)) || defined(DUK_USE_GC_TORTURE)
  slowpath:
+#endif
 
 	if (newsize == 0) {
 		DUK_D(DUK_DPRINT("first realloc attempt returned NULL for zero size realloc, use slow path to deal with it"));
@@ -52907,10 +57991,26 @@ DUK_INTERNAL DUK_INLINE_PERF DUK_HOT void *duk_heap_mem_realloc_indirect(duk_hea
 	DUK_ASSERT(heap->realloc_func != NULL);
 	DUK_ASSERT_DISABLE(newsize >= 0);
 
+	if (DUK_UNLIKELY(newsize == 0)) {
+		/* Shrinking to zero releases the allocation and GC can't help.
+		 * Don't go through the slow path: it returns NULL without
+		 * calling realloc, which would leak the old allocation (e.g.
+		 * duk_hbuffer_resize() to zero when a voluntary GC triggers).
+		 */
+		return heap->realloc_func(heap->heap_udata, cb(heap, ud), 0);
+	}
+
 #if defined(DUK_USE_VOLUNTARY_GC)
 	/* Voluntary periodic GC (if enabled). */
 	if (DUK_UNLIKELY(--(heap)->ms_trigger_counter < 0)) {
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+		/* Bounded marking step; the allocation itself proceeds
+		 * normally and only falls back to a full GC on failure.
+		 */
+		(void) duk_heap_mark_and_sweep_step(heap, (duk_double_t) DUK_USE_MARK_AND_SWEEP_STEP_BUDGET);
+#else
 		goto slowpath;
+#endif
 	}
 #endif
 
@@ -52931,7 +58031,9 @@ DUK_INTERNAL DUK_INLINE_PERF DUK_HOT void *duk_heap_mem_realloc_indirect(duk_hea
 		return res;
 	}
 
+#if (defined(DUK_USE_VOLUNTARY_GC) && !defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)) || defined(DUK_USE_GC_TORTURE)
  slowpath:
+#endif
 
 	if (newsize == 0) {
 		DUK_D(DUK_DPRINT("first indirect realloc attempt returned NULL for zero size realloc, use slow path to deal with it"));
@@ -53219,6 +58321,9 @@ DUK_INTERNAL void duk_hobject_refcount_finalize_norz(duk_heap *heap, duk_hobject
 		if (DUK_UNLIKELY(key == NULL)) {
 			continue;
 		}
+#if defined(DUK_USE_HOBJECT_SHAPES)
+		if (!DUK_HOBJECT_HAS_SHAPE(h))  /* keys are owned by the shape */
+#endif
 		DUK_HSTRING_DECREF_NORZ(thr, key);
 		if (DUK_UNLIKELY(p_flag[n] & DUK_PROPDESC_FLAG_ACCESSOR)) {
 			duk_hobject *h_getset;
@@ -53235,6 +58340,19 @@ DUK_INTERNAL void duk_hobject_refcount_finalize_norz(duk_heap *heap, duk_hobject
 		}
 	}
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	if (DUK_HOBJECT_HAS_SHAPE(h)) {
+		/* Drop the shape while its keys are still alive; the object
+		 * is freed right after and has no entries left.
+		 */
+		duk_propshape_decref(heap, h->shape, 1 /*decref_keys*/);
+		h->shape = NULL;
+		DUK_HOBJECT_SET_ESIZE(h, 0);
+		DUK_HOBJECT_SET_ENEXT(h, 0);
+		DUK_HOBJECT_SET_HSIZE(h, 0);
+	}
+#endif
+
 	p_tv = DUK_HOBJECT_A_GET_BASE(heap, h);
 	n = DUK_HOBJECT_GET_ASIZE(h);
 	while (n-- > 0) {
@@ -53490,6 +58608,18 @@ DUK_LOCAL DUK_INLINE void duk__refcount_refzero_hobject(duk_heap *heap, duk_hobj
 
 	hdr = (duk_heaphdr *) obj;
 
+#if defined(DUK_USE_MARK_AND_SWEEP_INCREMENTAL)
+	/* A grey object may still be referenced from heap->ms_grey.  Leave
+	 * it in heap_allocated; it is freed by the next mark-and-sweep round
+	 * which finds it unreachable.
+	 */
+	if (DUK_UNLIKELY(DUK_HEAPHDR_HAS_TEMPROOT(hdr))) {
+		DUK_ASSERT(heap->ms_incremental);
+		DUK_DD(DUK_DDPRINT("refzero'd object is grey, leave for mark-and-sweep: %p", (void *) hdr));
+		return;
+	}
+#endif
+
 	/* Refzero'd objects must be in heap_allocated.  They can't be in
 	 * finalize_list because all objects on finalize_list have an
 	 * artificial +1 refcount bump.
@@ -53898,6 +59028,7 @@ DUK_INTERNAL void duk_tval_decref_norz(duk_hthread *thr, duk_tval *tv) {
 			return; \
 		} \
 		if (DUK_HEAPHDR_PREDEC_REFCOUNT((duk_heaphdr *) h) != 0) { \
+			DUK_HEAPHDR_MS_BARRIER(thr->heap, h); \
 			return; \
 		} \
 	} while (0)
@@ -53908,6 +59039,7 @@ DUK_INTERNAL void duk_tval_decref_norz(duk_hthread *thr, duk_tval *tv) {
 	} while (0)
 #define DUK__DECREF_SHARED() do { \
 		if (DUK_HEAPHDR_PREDEC_REFCOUNT((duk_heaphdr *) h) != 0) { \
+			DUK_HEAPHDR_MS_BARRIER(thr->heap, h); \
 			return; \
 		} \
 	} while (0)
@@ -54012,6 +59144,20 @@ DUK_INTERNAL void duk_hobject_decref_norz(duk_hthread *thr, duk_hobject *h) {
  *  object is about to be freed, such references need to be removed.
  */
 
+#if defined(DUK_USE_STRCACHE_INDEX)
+/* Free the index of an entry, the entry remains as a candidate. */
+DUK_LOCAL void duk__strcache_index_free(duk_heap *heap, duk_strcache_index *e) {
+	DUK_ASSERT(e->h != NULL);
+	DUK_ASSERT(heap->strcache_index_bytes >= (duk_size_t) e->count * sizeof(duk_uint32_t));
+
+	heap->strcache_index_bytes -= (duk_size_t) e->count * sizeof(duk_uint32_t);
+	DUK_FREE_RAW(heap, (void *) e->boffs);
+	e->boffs = NULL;
+	e->count = 0;
+	e->scanned = 0;
+}
+#endif  /* DUK_USE_STRCACHE_INDEX */
+
 DUK_INTERNAL void duk_heap_strcache_string_remove(duk_heap *heap, duk_hstring *h) {
 	duk_uint_t i;
 	for (i = 0; i < DUK_HEAP_STRCACHE_SIZE; i++) {
@@ -54027,6 +59173,20 @@ DUK_INTERNAL void duk_heap_strcache_string_remove(duk_heap *heap, duk_hstring *h
 			 */
 		}
 	}
+#if defined(DUK_USE_STRCACHE_INDEX)
+	for (i = 0; i < DUK_HEAP_STRCACHE_INDEX_SLOTS; i++) {
+		duk_strcache_index *e = heap->strcache_index + i;
+		if (e->h == h) {
+			DUK_DD(DUK_DDPRINT("deleting strcache index for hstring %p from heap %p",
+			                   (void *) h, (void *) heap));
+			if (e->boffs != NULL) {
+				duk__strcache_index_free(heap, e);
+			}
+			e->h = NULL;
+			break;  /* a string has at most one entry */
+		}
+	}
+#endif
 }
 
 /*
@@ -54069,6 +59229,145 @@ DUK_LOCAL const duk_uint8_t *duk__scan_backwards(const duk_uint8_t *p, const duk
 	return p;
 }
 
+/*
+ *  Sparse char offset index
+ *
+ *  A scan from the string ends or from a strcache entry is cheap for
+ *  sequential access, but random access into a long non-ASCII string (and
+ *  more than DUK_HEAP_STRCACHE_SIZE such strings being accessed) degrades
+ *  to scanning half the string on average.  For such strings, build an
+ *  index with the byte offset of every (1 << DUK_HEAP_STRCACHE_INDEX_SHIFT)th
+ *  character, so that any lookup scans at most 31 characters.
+ *
+ *  Building an index costs a scan of the whole string, so an index is only
+ *  built once lookups needing a long scan have together scanned as many
+ *  characters as the string has.  Strings which are only accessed
+ *  sequentially never get one, and when more strings are accessed randomly
+ *  than DUK_USE_STRCACHE_INDEX_LIMIT allows, rebuilding indices costs at
+ *  most as much as the scans it replaces.
+ *
+ *  Indices live outside the GC heap (raw allocations so that building one
+ *  has no side effects) and the least recently used ones are dropped to
+ *  stay within DUK_USE_STRCACHE_INDEX_LIMIT bytes.
+ */
+
+#if defined(DUK_USE_STRCACHE_INDEX)
+DUK_LOCAL const duk_uint32_t *duk__strcache_index_get(duk_heap *heap, duk_hstring *h, duk_uint_fast32_t char_length, duk_uint_fast32_t scan_length) {
+	duk_strcache_index *e;
+	duk_strcache_index tmp;
+	duk_uint_t i;
+	duk_uint32_t count;
+	duk_size_t size;
+	duk_uint32_t *boffs;
+	const duk_uint8_t *p;
+	duk_uint32_t blen;
+	duk_uint32_t boff;
+	duk_uint32_t cidx;
+
+	count = (duk_uint32_t) (char_length >> DUK_HEAP_STRCACHE_INDEX_SHIFT) + 1U;
+	size = (duk_size_t) count * sizeof(duk_uint32_t);
+
+	/* Existing entry, move to front (LRU). */
+	for (i = 0; i < DUK_HEAP_STRCACHE_INDEX_SLOTS; i++) {
+		e = heap->strcache_index + i;
+		if (e->h == h) {
+			if (i > 0) {
+				tmp = *e;
+				duk_memmove((void *) (&heap->strcache_index[1]),
+				            (const void *) (&heap->strcache_index[0]),
+				            (size_t) i * sizeof(duk_strcache_index));
+				heap->strcache_index[0] = tmp;
+			}
+			e = heap->strcache_index;
+			if (e->boffs != NULL) {
+				DUK_ASSERT(e->count == count);
+				return e->boffs;
+			}
+			goto candidate;
+		}
+	}
+
+	if (size > (duk_size_t) DUK_USE_STRCACHE_INDEX_LIMIT) {
+		DUK_DDD(DUK_DDDPRINT("string %p too long for strcache index (%ld bytes)", (void *) h, (long) size));
+		return NULL;
+	}
+
+	/* New candidate replaces the LRU entry. */
+	e = heap->strcache_index + DUK_HEAP_STRCACHE_INDEX_SLOTS - 1;
+	if (e->boffs != NULL) {
+		duk__strcache_index_free(heap, e);
+	}
+	duk_memmove((void *) (&heap->strcache_index[1]),
+	            (const void *) (&heap->strcache_index[0]),
+	            (size_t) (DUK_HEAP_STRCACHE_INDEX_SLOTS - 1) * sizeof(duk_strcache_index));
+	e = heap->strcache_index;
+	e->h = h;
+	e->boffs = NULL;
+	e->count = 0;
+	e->scanned = 0;
+
+ candidate:
+	DUK_ASSERT(e == heap->strcache_index);
+	DUK_ASSERT(e->h == h);
+	DUK_ASSERT(e->boffs == NULL);
+
+	e->scanned += (duk_uint32_t) scan_length;  /* scan_length <= char_length */
+	if (e->scanned < (duk_uint32_t) char_length) {
+		return NULL;
+	}
+	e->scanned = 0;
+
+	/* Drop least recently used indices to stay within the limit. */
+	for (i = DUK_HEAP_STRCACHE_INDEX_SLOTS; --i > 0;) {
+		if (heap->strcache_index_bytes + size <= (duk_size_t) DUK_USE_STRCACHE_INDEX_LIMIT) {
+			break;
+		}
+		if (heap->strcache_index[i].boffs != NULL) {
+			duk__strcache_index_free(heap, heap->strcache_index + i);
+		}
+	}
+	DUK_ASSERT(heap->strcache_index_bytes + size <= (duk_size_t) DUK_USE_STRCACHE_INDEX_LIMIT);
+
+	boffs = (duk_uint32_t *) DUK_ALLOC_RAW(heap, size);
+	if (boffs == NULL) {
+		return NULL;
+	}
+
+	/* Same character counting rule as duk__scan_forwards(). */
+	p = (const duk_uint8_t *) DUK_HSTRING_GET_DATA(h);
+	blen = (duk_uint32_t) DUK_HSTRING_GET_BYTELEN(h);
+	cidx = 0;
+	for (boff = 0; boff < blen; boff++) {
+		if ((p[boff] & 0xc0) != 0x80) {
+			if ((cidx & ((1U << DUK_HEAP_STRCACHE_INDEX_SHIFT) - 1U)) == 0) {
+				if ((cidx >> DUK_HEAP_STRCACHE_INDEX_SHIFT) >= count) {
+					break;
+				}
+				boffs[cidx >> DUK_HEAP_STRCACHE_INDEX_SHIFT] = boff;
+			}
+			cidx++;
+		}
+	}
+	if (cidx != (duk_uint32_t) char_length) {
+		/* Inconsistent clen/blen, leave it to the scan to fail. */
+		DUK_FREE_RAW(heap, (void *) boffs);
+		return NULL;
+	}
+	if ((cidx & ((1U << DUK_HEAP_STRCACHE_INDEX_SHIFT) - 1U)) == 0) {
+		boffs[cidx >> DUK_HEAP_STRCACHE_INDEX_SHIFT] = blen;
+	}
+
+	DUK_DD(DUK_DDPRINT("built strcache index for string %p: clen=%ld, %ld entries, %ld bytes",
+	                   (void *) h, (long) char_length, (long) count, (long) size));
+
+	e->boffs = boffs;
+	e->count = count;
+	heap->strcache_index_bytes += size;
+
+	return boffs;
+}
+#endif  /* DUK_USE_STRCACHE_INDEX */
+
 /*
  *  Convert char offset to byte offset
  *
@@ -54172,6 +59471,32 @@ DUK_INTERNAL duk_uint_fast32_t duk_heap_strcache_offset_char2byte(duk_hthread *t
 	p_end = (const duk_uint8_t *) (p_start + DUK_HSTRING_GET_BYTELEN(h));
 	p_found = NULL;
 
+#if defined(DUK_USE_STRCACHE_INDEX)
+	/* Random access into a long string: scan from the nearest index
+	 * entry unless one of the other starting points is close enough.
+	 */
+	if (char_length >= DUK_HEAP_STRCACHE_INDEX_MINLEN) {
+		duk_uint_fast32_t dist_min;
+		const duk_uint32_t *boffs;
+
+		DUK_ASSERT(use_cache);
+		dist_min = (dist_start < dist_end ? dist_start : dist_end);
+		if (sce != NULL) {
+			dist_sce = (char_offset >= sce->cidx ? char_offset - sce->cidx : sce->cidx - char_offset);
+			dist_min = (dist_sce < dist_min ? dist_sce : dist_min);
+		}
+		if (dist_min > DUK_HEAP_STRCACHE_INDEX_TRIGGER) {
+			boffs = duk__strcache_index_get(heap, h, char_length, dist_min);
+			if (boffs != NULL) {
+				p_found = duk__scan_forwards(p_start + boffs[char_offset >> DUK_HEAP_STRCACHE_INDEX_SHIFT],
+				                             p_end,
+				                             char_offset & ((1U << DUK_HEAP_STRCACHE_INDEX_SHIFT) - 1U));
+				goto scan_done;
+			}
+		}
+	}
+#endif
+
 	if (sce) {
 		if (char_offset >= sce->cidx) {
 			dist_sce = char_offset - sce->cidx;
@@ -54309,13 +59634,43 @@ DUK_INTERNAL duk_uint_fast32_t duk_heap_strcache_offset_char2byte(duk_hthread *t
 /* #include duk_internal.h -> already included */
 
 /* Resize checks not needed if minsize == maxsize, typical for low memory
- * targets.
+ * targets.  The open addressing variant has its own resize handling because
+ * it must grow before the table fills up.
  */
 #define DUK__STRTAB_RESIZE_CHECK
-#if (DUK_USE_STRTAB_MINSIZE == DUK_USE_STRTAB_MAXSIZE)
+#if (DUK_USE_STRTAB_MINSIZE == DUK_USE_STRTAB_MAXSIZE) || defined(DUK_USE_STRTAB_PROBE)
 #undef DUK__STRTAB_RESIZE_CHECK
 #endif
 
+#if defined(DUK_USE_STRTAB_PROBE)
+#if defined(DUK_USE_STRTAB_PTRCOMP)
+#error DUK_USE_STRTAB_PROBE is not compatible with DUK_USE_STRTAB_PTRCOMP
+#endif
+#if (DUK_USE_STRTAB_MAXSIZE > 0x40000000L)
+#error DUK_USE_STRTAB_PROBE requires DUK_USE_STRTAB_MAXSIZE <= 2^30
+#endif
+/* Slot tag is the scrambled string hash with the highest bit set, so that
+ * zero marks an empty slot.  The tag bit is above st_mask so (tag & st_mask)
+ * is the home slot.
+ */
+#define DUK__STRTAB_PROBE_TAG(hash)     (duk__strtable_probe_mix((hash)) | 0x80000000UL)
+/* Load factor limits, fixed point .4 like the chained variant.  Misses
+ * probe up to the next empty slot, so keep the load factor low.
+ */
+#define DUK__STRTAB_PROBE_GROW_LIMIT    8                /* 0.5 */
+#define DUK__STRTAB_PROBE_SHRINK_LIMIT  2                /* 0.125 */
+
+/* The default (sparse) string hash gives similar strings nearby hashes,
+ * which is harmless for chaining but causes long runs with linear probing.
+ */
+DUK_LOCAL DUK_ALWAYS_INLINE duk_uint32_t duk__strtable_probe_mix(duk_uint32_t h) {
+	h ^= h >> 16;
+	h *= 0x85ebca6bUL;
+	h ^= h >> 13;
+	return h;
+}
+#endif
+
 #if defined(DUK_USE_STRTAB_PTRCOMP)
 #define DUK__HEAPPTR_ENC16(heap,ptr)    DUK_USE_HEAPPTR_ENC16((heap)->heap_udata, (ptr))
 #define DUK__HEAPPTR_DEC16(heap,val)    DUK_USE_HEAPPTR_DEC16((heap)->heap_udata, (val))
@@ -54328,11 +59683,50 @@ DUK_INTERNAL duk_uint_fast32_t duk_heap_strcache_offset_char2byte(duk_hthread *t
 
 #define DUK__STRTAB_U32_MAX_STRLEN      10               /* 4'294'967'295 */
 
+/* Shortest result for which in-place append is attempted.  Also ensures
+ * the result can't be an array index or a reserved word.
+ */
+#define DUK__STRAPP_MIN_BYTELEN         256
+
 /*
  *  Debug dump stringtable.
  */
 
-#if defined(DUK_USE_DEBUG)
+#if defined(DUK_USE_DEBUG) && defined(DUK_USE_STRTAB_PROBE)
+DUK_INTERNAL void duk_heap_strtable_dump(duk_heap *heap) {
+	duk_uint32_t i;
+	duk_uint32_t tag;
+	duk_uint32_t dist;
+	duk_uint32_t dist_max = 0;
+	duk_size_t dist_total = 0;
+	duk_size_t count_total = 0;
+
+	if (heap == NULL) {
+		DUK_D(DUK_DPRINT("string table, heap=NULL"));
+		return;
+	}
+	if (heap->strtable == NULL) {
+		DUK_D(DUK_DPRINT("string table, strtab=NULL"));
+		return;
+	}
+
+	for (i = 0; i < heap->st_size; i++) {
+		tag = heap->strtable[i].hash;
+		if (tag == 0) {
+			continue;
+		}
+		dist = (i - (tag & heap->st_mask)) & heap->st_mask;
+		dist_max = (dist > dist_max ? dist : dist_max);
+		dist_total += dist;
+		count_total++;
+	}
+
+	DUK_D(DUK_DPRINT("string table, strtab=%p, size=%lu, count=%lu, load=%lf, probe distance max=%lu avg=%lf",
+	                 (void *) heap->strtable, (unsigned long) heap->st_size, (unsigned long) count_total,
+	                 (double) count_total / (double) heap->st_size, (unsigned long) dist_max,
+	                 count_total > 0 ? (double) dist_total / (double) count_total : 0.0));
+}
+#elif defined(DUK_USE_DEBUG)
 DUK_INTERNAL void duk_heap_strtable_dump(duk_heap *heap) {
 #if defined(DUK_USE_STRTAB_PTRCOMP)
 	duk_uint16_t *strtable;
@@ -54390,7 +59784,44 @@ DUK_INTERNAL void duk_heap_strtable_dump(duk_heap *heap) {
  *  Assertion helper to ensure strtable is populated correctly.
  */
 
-#if defined(DUK_USE_ASSERTIONS)
+#if defined(DUK_USE_ASSERTIONS) && defined(DUK_USE_STRTAB_PROBE)
+DUK_LOCAL void duk__strtable_assert_checks(duk_heap *heap) {
+	duk_uint32_t i;
+	duk_uint32_t j;
+	duk_uint32_t tag;
+	duk_hstring *h;
+	duk_size_t count = 0;
+
+	DUK_ASSERT(heap != NULL);
+
+	if (heap->strtable == NULL) {
+		DUK_ASSERT(heap->st_size == 0);
+		return;
+	}
+	DUK_ASSERT(heap->st_size != 0);
+	DUK_ASSERT(heap->st_mask == heap->st_size - 1);
+
+	for (i = 0; i < heap->st_size; i++) {
+		h = heap->strtable[i].h;
+		tag = heap->strtable[i].hash;
+		if (h == NULL) {
+			DUK_ASSERT(tag == 0);
+			continue;
+		}
+		DUK_ASSERT(tag == DUK__STRTAB_PROBE_TAG(DUK_HSTRING_GET_HASH(h)));
+		DUK_ASSERT(h->hdr.h_next == NULL);
+
+		/* No empty slot between home slot and actual slot. */
+		for (j = tag & heap->st_mask; j != i; j = (j + 1) & heap->st_mask) {
+			DUK_ASSERT(heap->strtable[j].hash != 0);
+		}
+		count++;
+	}
+
+	DUK_ASSERT(count == (duk_size_t) heap->st_count);
+	DUK_ASSERT(count < (duk_size_t) heap->st_size);
+}
+#elif defined(DUK_USE_ASSERTIONS)
 DUK_LOCAL void duk__strtable_assert_checks(duk_heap *heap) {
 #if defined(DUK_USE_STRTAB_PTRCOMP)
 	duk_uint16_t *strtable;
@@ -54561,6 +59992,145 @@ DUK_LOCAL duk_hstring *duk__strtable_alloc_hstring(duk_heap *heap,
 	return NULL;
 }
 
+/*
+ *  Open addressing variant: rehash into a new allocation and grow/shrink
+ *  check.  Unlike chaining, growing is mandatory before the table fills
+ *  up, so the check runs whenever the grow limit is reached and otherwise
+ *  periodically for shrinking.
+ */
+
+#if defined(DUK_USE_STRTAB_PROBE)
+DUK_LOCAL void duk__strtable_probe_rehash(duk_heap *heap, duk_uint32_t new_st_size) {
+	duk_strtab_entry *new_ptr;
+	duk_uint32_t new_mask;
+	duk_uint32_t i;
+	duk_uint32_t j;
+	duk_uint32_t tag;
+
+	DUK_DD(DUK_DDPRINT("rehash: %lu -> %lu", (unsigned long) heap->st_size, (unsigned long) new_st_size));
+
+	DUK_ASSERT(heap != NULL);
+	DUK_ASSERT(heap->st_resizing == 1);
+	DUK_ASSERT((new_st_size & (new_st_size - 1)) == 0);  /* 2^N */
+	DUK_ASSERT(heap->strtable != NULL);
+
+	/* The allocation may trigger a GC which may remove strings from the
+	 * current table (recursive resize is prevented by flags).  Rehash
+	 * only after the allocation so that the result is consistent.
+	 */
+	new_ptr = (duk_strtab_entry *) DUK_ALLOC(heap, sizeof(duk_strtab_entry) * new_st_size);
+	if (DUK_UNLIKELY(new_ptr == NULL)) {
+		/* Growing is retried on the next intern; the intern fails
+		 * only if the table is completely full.
+		 */
+		DUK_D(DUK_DPRINT("string table rehash failed, ignoring"));
+		return;
+	}
+	DUK_ASSERT(heap->st_count < new_st_size);
+
+	if (new_st_size > heap->st_size) {
+		DUK_STATS_INC(heap, stats_strtab_resize_grow);
+	} else {
+		DUK_STATS_INC(heap, stats_strtab_resize_shrink);
+	}
+
+#if defined(DUK_USE_EXPLICIT_NULL_INIT)
+	for (i = 0; i < new_st_size; i++) {
+		new_ptr[i].hash = 0;
+		new_ptr[i].h = NULL;
+	}
+#else
+	duk_memzero(new_ptr, sizeof(duk_strtab_entry) * new_st_size);
+#endif
+
+	new_mask = new_st_size - 1;
+	for (i = 0; i < heap->st_size; i++) {
+		tag = heap->strtable[i].hash;
+		if (tag == 0) {
+			continue;
+		}
+		j = tag & new_mask;
+		while (new_ptr[j].hash != 0) {
+			j = (j + 1) & new_mask;
+		}
+		new_ptr[j] = heap->strtable[i];
+	}
+
+	DUK_FREE(heap, heap->strtable);
+	heap->strtable = new_ptr;
+	heap->st_size = new_st_size;
+	heap->st_mask = new_mask;
+
+#if defined(DUK_USE_ASSERTIONS)
+	duk__strtable_assert_checks(heap);
+#endif
+}
+
+DUK_LOCAL DUK_COLD DUK_NOINLINE void duk__strtable_probe_resize_check(duk_heap *heap) {
+	duk_uint32_t load_factor;  /* fixed point */
+
+	DUK_ASSERT(heap != NULL);
+	DUK_ASSERT(heap->strtable != NULL);
+
+	DUK_STATS_INC(heap, stats_strtab_resize_check);
+
+	if (DUK_UNLIKELY(heap->st_resizing != 0U)) {
+		DUK_D(DUK_DPRINT("prevent recursive strtable resize"));
+		return;
+	}
+
+	heap->st_resizing = 1;
+
+	DUK_ASSERT(heap->st_size >= 16U);
+	load_factor = heap->st_count / (heap->st_size >> 4U);
+
+	DUK_DD(DUK_DDPRINT("resize check string table: size=%lu, count=%lu, load_factor=%lu (fixed point .4; float %lf)",
+	                   (unsigned long) heap->st_size, (unsigned long) heap->st_count,
+	                   (unsigned long) load_factor,
+	                   (double) heap->st_count / (double) heap->st_size));
+
+	if (load_factor >= DUK__STRTAB_PROBE_GROW_LIMIT) {
+		if (heap->st_size >= DUK_USE_STRTAB_MAXSIZE) {
+			DUK_DD(DUK_DDPRINT("want to grow strtable (based on load factor) but already maximum size"));
+		} else {
+			DUK_D(DUK_DPRINT("grow string table: %lu -> %lu", (unsigned long) heap->st_size, (unsigned long) heap->st_size * 2));
+			duk__strtable_probe_rehash(heap, heap->st_size << 1U);
+		}
+	} else if (load_factor <= DUK__STRTAB_PROBE_SHRINK_LIMIT) {
+		if (heap->st_size <= DUK_USE_STRTAB_MINSIZE) {
+			DUK_DD(DUK_DDPRINT("want to shrink strtable (based on load factor) but already minimum size"));
+		} else {
+			DUK_D(DUK_DPRINT("shrink string table: %lu -> %lu", (unsigned long) heap->st_size, (unsigned long) heap->st_size / 2));
+			duk__strtable_probe_rehash(heap, heap->st_size >> 1U);
+		}
+	} else {
+		DUK_DD(DUK_DDPRINT("no need for strtable resize"));
+	}
+
+	heap->st_resizing = 0;
+}
+
+#if defined(DUK_USE_STRTAB_TORTURE)
+DUK_LOCAL void duk__strtable_resize_torture(duk_heap *heap) {
+	duk_uint32_t old_st_size;
+
+	DUK_ASSERT(heap != NULL);
+
+	old_st_size = heap->st_size;
+	if (old_st_size >= DUK_USE_STRTAB_MAXSIZE) {
+		return;
+	}
+
+	heap->st_resizing = 1;
+	duk__strtable_probe_rehash(heap, old_st_size << 1U);
+	if (heap->st_size > old_st_size) {
+		duk__strtable_probe_rehash(heap, old_st_size);
+	}
+	heap->st_resizing = 0;
+}
+#endif  /* DUK_USE_STRTAB_TORTURE */
+#endif  /* DUK_USE_STRTAB_PROBE */
+
 /*
  *  Grow strtable allocation in-place.
  */
@@ -54851,18 +60421,56 @@ DUK_LOCAL void duk__strtable_resize_torture(duk_heap *heap) {
 #endif  /* DUK_USE_STRTAB_TORTURE && DUK__STRTAB_RESIZE_CHECK */
 
 /*
- *  Raw intern; string already checked not to be present.
+ *  Link a duk_hstring not currently in the string table.  For open
+ *  addressing the caller must ensure there's room.
  */
 
-DUK_LOCAL duk_hstring *duk__strtable_do_intern(duk_heap *heap, const duk_uint8_t *str, duk_uint32_t blen, duk_uint32_t strhash) {
-	duk_hstring *res;
-	const duk_uint8_t *extdata;
-#if defined(DUK_USE_STRTAB_PTRCOMP)
+DUK_LOCAL void duk__strtable_link(duk_heap *heap, duk_hstring *h, duk_uint32_t strhash) {
+#if defined(DUK_USE_STRTAB_PROBE)
+	duk_uint32_t i;
+	duk_uint32_t tag;
+#elif defined(DUK_USE_STRTAB_PTRCOMP)
 	duk_uint16_t *slot;
 #else
 	duk_hstring **slot;
 #endif
 
+#if defined(DUK_USE_STRTAB_PROBE)
+	DUK_ASSERT(heap->st_count + 1 < heap->st_size);
+	tag = DUK__STRTAB_PROBE_TAG(strhash);
+	i = tag & heap->st_mask;
+	while (heap->strtable[i].hash != 0) {
+		i = (i + 1) & heap->st_mask;
+	}
+	DUK_ASSERT(h->hdr.h_next == NULL);  /* Not used, chain walkers rely on this. */
+	heap->strtable[i].hash = tag;
+	heap->strtable[i].h = h;
+#else
+#if defined(DUK_USE_STRTAB_PTRCOMP)
+	slot = heap->strtable16 + (strhash & heap->st_mask);
+#else
+	slot = heap->strtable + (strhash & heap->st_mask);
+#endif
+	h->hdr.h_next = DUK__HEAPPTR_DEC16(heap, *slot);
+	*slot = DUK__HEAPPTR_ENC16(heap, h);
+#endif  /* DUK_USE_STRTAB_PROBE */
+	DUK_HEAPHDR_MS_NEW(heap, h);
+
+	/* Update string count only for successful inserts. */
+
+#if defined(DUK__STRTAB_RESIZE_CHECK) || defined(DUK_USE_STRTAB_PROBE)
+	heap->st_count++;
+#endif
+}
+
+/*
+ *  Raw intern; string already checked not to be present.
+ */
+
+DUK_LOCAL duk_hstring *duk__strtable_do_intern(duk_heap *heap, const duk_uint8_t *str, duk_uint32_t blen, duk_uint32_t strhash) {
+	duk_hstring *res;
+	const duk_uint8_t *extdata;
+
 	DUK_DDD(DUK_DDDPRINT("do_intern: heap=%p, str=%p, blen=%lu, strhash=%lx, st_size=%lu, st_count=%lu, load=%lf",
 	                     (void *) heap, (const void *) str, (unsigned long) blen, (unsigned long) strhash,
 	                     (unsigned long) heap->st_size, (unsigned long) heap->st_count,
@@ -54883,7 +60491,7 @@ DUK_LOCAL duk_hstring *duk__strtable_do_intern(duk_heap *heap, const duk_uint8_t
 	heap->pf_prevent_count++;
 	DUK_ASSERT(heap->pf_prevent_count != 0);  /* Wrap. */
 
-#if defined(DUK_USE_STRTAB_TORTURE) && defined(DUK__STRTAB_RESIZE_CHECK)
+#if defined(DUK_USE_STRTAB_TORTURE) && (defined(DUK__STRTAB_RESIZE_CHECK) || defined(DUK_USE_STRTAB_PROBE))
 	duk__strtable_resize_torture(heap);
 #endif
 
@@ -54905,6 +60513,24 @@ DUK_LOCAL duk_hstring *duk__strtable_do_intern(duk_heap *heap, const duk_uint8_t
 	}
 #endif
 
+#if defined(DUK_USE_STRTAB_PROBE)
+	/* Open addressing must grow when reaching the grow limit.  There
+	 * must always be at least one empty slot so that probing terminates;
+	 * if growing has failed and the table is full, fail the intern.
+	 * A GC during the string allocation below only removes strings.
+	 */
+	if (DUK_UNLIKELY(heap->st_count >= (heap->st_size >> 1) ||
+	                 (heap->st_count & DUK_USE_STRTAB_RESIZE_CHECK_MASK) == 0)) {
+		duk__strtable_probe_resize_check(heap);
+	}
+	if (DUK_UNLIKELY(heap->st_count + 1 >= heap->st_size)) {
+		DUK_D(DUK_DPRINT("string table full, reject intern"));
+		DUK_ASSERT(heap->pf_prevent_count > 0);
+		heap->pf_prevent_count--;
+		return NULL;
+	}
+#endif
+
 	/* External string check (low memory optimization). */
 
 #if defined(DUK_USE_HSTRING_EXTDATA) && defined(DUK_USE_EXTSTR_INTERN_CHECK)
@@ -54941,20 +60567,8 @@ DUK_LOCAL duk_hstring *duk__strtable_do_intern(duk_heap *heap, const duk_uint8_t
 
 	/* Insert into string table. */
 
-#if defined(DUK_USE_STRTAB_PTRCOMP)
-	slot = heap->strtable16 + (strhash & heap->st_mask);
-#else
-	slot = heap->strtable + (strhash & heap->st_mask);
-#endif
 	DUK_ASSERT(res->hdr.h_next == NULL);  /* This is the case now, but unnecessary zeroing/NULLing. */
-	res->hdr.h_next = DUK__HEAPPTR_DEC16(heap, *slot);
-	*slot = DUK__HEAPPTR_ENC16(heap, res);
-
-	/* Update string count only for successful inserts. */
-
-#if defined(DUK__STRTAB_RESIZE_CHECK)
-	heap->st_count++;
-#endif
+	duk__strtable_link(heap, res, strhash);
 
 	/* The duk_hstring is in the string table but is not yet strongly
 	 * reachable.  Calling code MUST NOT make any allocations or other
@@ -55007,25 +60621,40 @@ DUK_LOCAL duk_hstring *duk__strtab_romstring_lookup(duk_heap *heap, const duk_ui
 }
 #endif  /* DUK_USE_ROM_STRINGS */
 
-DUK_INTERNAL duk_hstring *duk_heap_strtable_intern(duk_heap *heap, const duk_uint8_t *str, duk_uint32_t blen) {
-	duk_uint32_t strhash;
+/* Look up an existing string with a precomputed hash, NULL if not found. */
+DUK_LOCAL duk_hstring *duk__strtable_lookup(duk_heap *heap, const duk_uint8_t *str, duk_uint32_t blen, duk_uint32_t strhash) {
 	duk_hstring *h;
 
-	DUK_DDD(DUK_DDDPRINT("intern check: heap=%p, str=%p, blen=%lu", (void *) heap, (const void *) str, (unsigned long) blen));
-
-	/* Preliminaries. */
-
-	/* XXX: maybe just require 'str != NULL' even for zero size? */
-	DUK_ASSERT(heap != NULL);
-	DUK_ASSERT(blen == 0 || str != NULL);
-	DUK_ASSERT(blen <= DUK_HSTRING_MAX_BYTELEN);  /* Caller is responsible for ensuring this. */
-	strhash = duk_heap_hashstring(heap, str, (duk_size_t) blen);
-
-	/* String table lookup. */
-
 	DUK_ASSERT(DUK__GET_STRTABLE(heap) != NULL);
 	DUK_ASSERT(heap->st_size > 0);
 	DUK_ASSERT(heap->st_size == heap->st_mask + 1);
+#if defined(DUK_USE_STRTAB_PROBE)
+	{
+		duk_strtab_entry *e;
+		duk_uint32_t i;
+		duk_uint32_t tag;
+
+		/* Only dereference a string whose cached hash matches. */
+		tag = DUK__STRTAB_PROBE_TAG(strhash);
+		i = tag & heap->st_mask;
+		for (;;) {
+			e = heap->strtable + i;
+			if (e->hash == tag) {
+				h = e->h;
+				DUK_ASSERT(h != NULL);
+				if (DUK_HSTRING_GET_BYTELEN(h) == blen &&
+				    duk_memcmp_unsafe((const void *) str, (const void *) DUK_HSTRING_GET_DATA(h), (size_t) blen) == 0) {
+					DUK_STATS_INC(heap, stats_strtab_intern_hit);
+					DUK_HEAPHDR_MS_BARRIER(heap, h);
+					return h;
+				}
+			} else if (e->hash == 0) {
+				break;
+			}
+			i = (i + 1) & heap->st_mask;
+		}
+	}
+#else  /* DUK_USE_STRTAB_PROBE */
 #if defined(DUK_USE_STRTAB_PTRCOMP)
 	h = DUK__HEAPPTR_DEC16(heap, heap->strtable16[strhash & heap->st_mask]);
 #else
@@ -55035,12 +60664,17 @@ DUK_INTERNAL duk_hstring *duk_heap_strtable_intern(duk_heap *heap, const duk_uin
 		if (DUK_HSTRING_GET_HASH(h) == strhash &&
 		    DUK_HSTRING_GET_BYTELEN(h) == blen &&
 		    duk_memcmp_unsafe((const void *) str, (const void *) DUK_HSTRING_GET_DATA(h), (size_t) blen) == 0) {
-			/* Found existing entry. */
+			/* Found existing entry.  The string table is a weak
+			 * reference so shade the string if a marking cycle is
+			 * in progress.
+			 */
 			DUK_STATS_INC(heap, stats_strtab_intern_hit);
+			DUK_HEAPHDR_MS_BARRIER(heap, h);
 			return h;
 		}
 		h = h->hdr.h_next;
 	}
+#endif  /* DUK_USE_STRTAB_PROBE */
 
 	/* ROM table lookup.  Because this lookup is slower, do it only after
 	 * RAM lookup.  This works because no ROM string is ever interned into
@@ -55055,6 +60689,30 @@ DUK_INTERNAL duk_hstring *duk_heap_strtable_intern(duk_heap *heap, const duk_uin
 	}
 #endif
 
+	return NULL;
+}
+
+DUK_INTERNAL duk_hstring *duk_heap_strtable_intern(duk_heap *heap, const duk_uint8_t *str, duk_uint32_t blen) {
+	duk_uint32_t strhash;
+	duk_hstring *h;
+
+	DUK_DDD(DUK_DDDPRINT("intern check: heap=%p, str=%p, blen=%lu", (void *) heap, (const void *) str, (unsigned long) blen));
+
+	/* Preliminaries. */
+
+	/* XXX: maybe just require 'str != NULL' even for zero size? */
+	DUK_ASSERT(heap != NULL);
+	DUK_ASSERT(blen == 0 || str != NULL);
+	DUK_ASSERT(blen <= DUK_HSTRING_MAX_BYTELEN);  /* Caller is responsible for ensuring this. */
+	strhash = duk_heap_hashstring(heap, str, (duk_size_t) blen);
+
+	/* String table lookup. */
+
+	h = duk__strtable_lookup(heap, str, blen, strhash);
+	if (h != NULL) {
+		return h;
+	}
+
 	/* Not found in string table; insert. */
 
 	DUK_STATS_INC(heap, stats_strtab_intern_miss);
@@ -55140,6 +60798,7 @@ DUK_INTERNAL duk_hstring *duk_heap_strtable_intern_literal_checked(duk_hthread *
 		DUK_ASSERT(ent->h != NULL);
 		DUK_ASSERT(DUK_HSTRING_HAS_PINNED_LITERAL(ent->h));
 		DUK_STATS_INC(thr->heap, stats_strtab_litcache_hit);
+		DUK_HEAPHDR_MS_BARRIER(thr->heap, ent->h);
 		return ent->h;
 	}
 
@@ -55182,6 +60841,165 @@ DUK_INTERNAL duk_hstring *duk_heap_strtable_intern_u32_checked(duk_hthread *thr,
 	return res;
 }
 
+/*
+ *  Append to a string in place (for 's += x').
+ *
+ *  A concatenation result is normally a new interned string holding a copy
+ *  of both inputs, which makes an 's += x' loop quadratic.  When the left
+ *  side has a single reference which the caller is about to overwrite with
+ *  the result, nothing can observe the old value, so its duk_hstring is
+ *  unlinked, grown with some slack, rehashed and linked back.  To the rest
+ *  of the heap this looks like a free followed by an intern, so the same
+ *  weak references (string cache, string table) are dropped first.
+ *
+ *  Returns the result which takes over the reference to 'h': either 'h'
+ *  itself (possibly moved) or, if the result was already interned, the
+ *  existing string (INCREF'd, 'h' is freed).  Returns NULL with nothing
+ *  modified if the fast path doesn't apply.
+ *
+ *  Only heap->strapp_h has a known capacity and a saved hash state, so
+ *  alternating appends to two strings still work but use no slack.
+ */
+
+#if defined(DUK_USE_STRING_APPEND_INPLACE)
+#if !defined(DUK_USE_REFERENCE_COUNTING)
+#error DUK_USE_STRING_APPEND_INPLACE requires DUK_USE_REFERENCE_COUNTING
+#endif
+DUK_INTERNAL duk_hstring *duk_heap_strtable_append(duk_hthread *thr, duk_hstring *h, duk_hstring *h_add) {
+	duk_heap *heap;
+	duk_hstring *h_res;
+	duk_uint8_t *data;
+	duk_size_t blen;
+	duk_size_t add_blen;
+	duk_size_t new_blen;
+	duk_uint32_t strhash;
+#if defined(DUK_USE_HSTRING_CLEN)
+	duk_size_t clen;
+#else
+	duk_bool_t ascii;
+#endif
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(h != NULL);
+	DUK_ASSERT(h_add != NULL);
+
+	heap = thr->heap;
+
+	blen = DUK_HSTRING_GET_BYTELEN(h);
+	add_blen = DUK_HSTRING_GET_BYTELEN(h_add);
+	if (DUK_HEAPHDR_GET_REFCOUNT((duk_heaphdr *) h) != 1 ||
+	    h == h_add ||
+	    DUK_HSTRING_HAS_SYMBOL(h) ||
+	    DUK_HSTRING_HAS_SYMBOL(h_add) ||
+	    blen == 0 || add_blen == 0 ||
+	    add_blen > DUK_HSTRING_MAX_BYTELEN - blen ||
+	    blen + add_blen < DUK__STRAPP_MIN_BYTELEN) {
+		return NULL;
+	}
+#if defined(DUK_USE_ROM_STRINGS)
+	if (DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) h)) {
+		return NULL;
+	}
+#endif
+#if defined(DUK_USE_HSTRING_EXTDATA)
+	if (DUK_HSTRING_HAS_EXTDATA(h)) {
+		return NULL;
+	}
+#endif
+	DUK_ASSERT(!DUK_HSTRING_HAS_PINNED_LITERAL(h));  /* Pin holds a reference. */
+	new_blen = blen + add_blen;
+
+	/* Charlen is kept up to date while a string is being grown; for a
+	 * lazy charlen this scans 'h' once when it's first appended to.
+	 */
+#if defined(DUK_USE_HSTRING_CLEN)
+	clen = DUK_HSTRING_GET_CHARLEN(h) + DUK_HSTRING_GET_CHARLEN(h_add);
+#else
+	ascii = DUK_HSTRING_HAS_ASCII(h) && DUK_HSTRING_HAS_ASCII(h_add);
+#endif
+
+	if (heap->strapp_h != h) {
+		heap->strapp_h = h;
+		heap->strapp_cap = blen;
+#if defined(DUK_USE_STRHASH_FULL)
+		duk_heap_hashstring_init(heap, &heap->strapp_hash);
+		duk_heap_hashstring_update(&heap->strapp_hash, (const duk_uint8_t *) (h + 1), blen);
+#endif
+	}
+
+	/* No side effects until 'h' is back in the string table: a GC would
+	 * not find it there.
+	 */
+	duk_heap_strcache_string_remove(heap, h);
+	duk_heap_strtable_unlink(heap, h);
+
+	if (new_blen > heap->strapp_cap) {
+		duk_hstring *h_new;
+		duk_size_t new_cap;
+
+		/* Grow by 1/4 to keep the slack small on low memory targets,
+		 * still amortized O(1) per appended byte.
+		 */
+		new_cap = new_blen + (new_blen >> 2);
+		if (new_cap > DUK_HSTRING_MAX_BYTELEN) {
+			new_cap = DUK_HSTRING_MAX_BYTELEN;
+		}
+		h_new = (duk_hstring *) DUK_REALLOC_RAW(heap, (void *) h, sizeof(duk_hstring) + new_cap + 1);
+		if (DUK_UNLIKELY(h_new == NULL)) {
+			DUK_D(DUK_DPRINT("in-place string append realloc failed, blen=%ld", (long) new_blen));
+			duk__strtable_link(heap, h, DUK_HSTRING_GET_HASH(h));
+			return NULL;
+		}
+		h = h_new;
+		heap->strapp_h = h;
+		heap->strapp_cap = new_cap;
+	}
+
+	data = (duk_uint8_t *) (h + 1);
+	duk_memcpy((void *) (data + blen), (const void *) DUK_HSTRING_GET_DATA(h_add), add_blen);
+	data[new_blen] = (duk_uint8_t) 0;
+
+#if defined(DUK_USE_STRHASH_FULL)
+	duk_heap_hashstring_update(&heap->strapp_hash, data, new_blen);
+	strhash = duk_heap_hashstring_final(&heap->strapp_hash, data, new_blen);
+#else
+	strhash = duk_heap_hashstring(heap, data, new_blen);
+#endif
+
+	h_res = duk__strtable_lookup(heap, data, (duk_uint32_t) new_blen, strhash);
+	if (DUK_UNLIKELY(h_res != NULL)) {
+		DUK_DDD(DUK_DDDPRINT("in-place string append result already interned: %!O", (duk_heaphdr *) h_res));
+		duk_free_hstring(heap, h);
+		DUK_HSTRING_INCREF(thr, h_res);
+		return h_res;
+	}
+
+	DUK_HSTRING_SET_BYTELEN(h, (duk_uint32_t) new_blen);
+	DUK_HSTRING_SET_HASH(h, strhash);
+	DUK_HEAPHDR_CLEAR_FLAG_BITS(&h->hdr, DUK_HSTRING_FLAG_ASCII |
+	                                     DUK_HSTRING_FLAG_ARRIDX |
+	                                     DUK_HSTRING_FLAG_RESERVED_WORD |
+	                                     DUK_HSTRING_FLAG_STRICT_RESERVED_WORD |
+	                                     DUK_HSTRING_FLAG_EVAL_OR_ARGUMENTS);
+#if defined(DUK_USE_HSTRING_ARRIDX)
+	h->arridx = DUK_HSTRING_NO_ARRAY_INDEX;
+#endif
+#if defined(DUK_USE_HSTRING_CLEN)
+	DUK_HSTRING_SET_CHARLEN(h, clen);
+	if (clen == new_blen) {
+		DUK_HSTRING_SET_ASCII(h);
+	}
+#else
+	if (ascii) {
+		DUK_HSTRING_SET_ASCII(h);
+	}
+#endif
+
+	duk__strtable_link(heap, h, strhash);
+	return h;
+}
+#endif  /* DUK_USE_STRING_APPEND_INPLACE */
+
 /*
  *  Remove (unlink) a string from the string table.
  *
@@ -55189,6 +61007,53 @@ DUK_INTERNAL duk_hstring *duk_heap_strtable_intern_u32_checked(duk_hthread *thr,
  *  Caller must free the string itself.
  */
 
+#if defined(DUK_USE_STRTAB_PROBE)
+DUK_INTERNAL void duk_heap_strtable_unlink(duk_heap *heap, duk_hstring *h) {
+	duk_uint32_t i;
+	duk_uint32_t j;
+	duk_uint32_t tag;
+	duk_uint32_t mask;
+
+	DUK_DDD(DUK_DDDPRINT("remove: heap=%p, h=%p, blen=%lu, strhash=%lx",
+	                     (void *) heap, (void *) h,
+	                     (unsigned long) (h != NULL ? DUK_HSTRING_GET_BYTELEN(h) : 0),
+	                     (unsigned long) (h != NULL ? DUK_HSTRING_GET_HASH(h) : 0)));
+
+	DUK_ASSERT(heap != NULL);
+	DUK_ASSERT(h != NULL);
+	DUK_ASSERT(heap->st_count > 0);
+	heap->st_count--;
+
+	mask = heap->st_mask;
+	tag = DUK__STRTAB_PROBE_TAG(DUK_HSTRING_GET_HASH(h));
+	i = tag & mask;
+	while (heap->strtable[i].h != h) {
+		DUK_ASSERT(heap->strtable[i].hash != 0);  /* We'll eventually find 'h'. */
+		i = (i + 1) & mask;
+	}
+
+	/* Backward shift deletion, no tombstones: move later entries of the
+	 * probe run into the hole unless that would place them before their
+	 * home slot.
+	 */
+	j = i;
+	for (;;) {
+		j = (j + 1) & mask;
+		tag = heap->strtable[j].hash;
+		if (tag == 0) {
+			break;
+		}
+		if (((j - (tag & mask)) & mask) >= ((j - i) & mask)) {
+			heap->strtable[i] = heap->strtable[j];
+			i = j;
+		}
+	}
+	heap->strtable[i].hash = 0;
+	heap->strtable[i].h = NULL;
+
+	/* Shrink check is done by the next string intern. */
+}
+#else  /* DUK_USE_STRTAB_PROBE */
 #if defined(DUK_USE_REFERENCE_COUNTING)
 /* Unlink without a 'prev' pointer. */
 DUK_INTERNAL void duk_heap_strtable_unlink(duk_heap *heap, duk_hstring *h) {
@@ -55277,6 +61142,7 @@ DUK_INTERNAL void duk_heap_strtable_unlink_prev(duk_heap *heap, duk_hstring *h,
 		*slot = DUK__HEAPPTR_ENC16(heap, h->hdr.h_next);
 	}
 }
+#endif  /* DUK_USE_STRTAB_PROBE */
 
 /*
  *  Force string table resize check in mark-and-sweep.
@@ -55290,7 +61156,11 @@ DUK_INTERNAL void duk_heap_strtable_force_resize(duk_heap *heap) {
 	DUK_ASSERT(heap != NULL);
 	DUK_UNREF(heap);
 
-#if defined(DUK__STRTAB_RESIZE_CHECK)
+#if defined(DUK_USE_STRTAB_PROBE)
+	if (heap->strtable != NULL) {
+		duk__strtable_probe_resize_check(heap);
+	}
+#elif defined(DUK__STRTAB_RESIZE_CHECK)
 #if defined(DUK_USE_STRTAB_PTRCOMP)
 	if (heap->strtable16 != NULL) {
 #else
@@ -55309,6 +61179,9 @@ DUK_INTERNAL void duk_heap_strtable_free(duk_heap *heap) {
 #if defined(DUK_USE_STRTAB_PTRCOMP)
 	duk_uint16_t *strtable;
 	duk_uint16_t *st;
+#elif defined(DUK_USE_STRTAB_PROBE)
+	duk_strtab_entry *strtable;
+	duk_strtab_entry *st;
 #else
 	duk_hstring **strtable;
 	duk_hstring **st;
@@ -55331,7 +61204,11 @@ DUK_INTERNAL void duk_heap_strtable_free(duk_heap *heap) {
 
 	while (strtable != st) {
 		--st;
+#if defined(DUK_USE_STRTAB_PROBE)
+		h = st->h;
+#else
 		h = DUK__HEAPPTR_DEC16(heap, *st);
+#endif
 		while (h) {
 			duk_hstring *h_next;
 			h_next = h->hdr.h_next;
@@ -55350,6 +61227,10 @@ DUK_INTERNAL void duk_heap_strtable_free(duk_heap *heap) {
 #undef DUK__GET_STRTABLE
 #undef DUK__HEAPPTR_DEC16
 #undef DUK__HEAPPTR_ENC16
+#undef DUK__STRAPP_MIN_BYTELEN
+#undef DUK__STRTAB_PROBE_GROW_LIMIT
+#undef DUK__STRTAB_PROBE_SHRINK_LIMIT
+#undef DUK__STRTAB_PROBE_TAG
 #undef DUK__STRTAB_U32_MAX_STRLEN
 /*
  *  duk_heaphdr assertion helpers
@@ -55457,6 +61338,9 @@ DUK_LOCAL void duk__init_object_parts(duk_heap *heap, duk_uint_t hobject_flags,
 #if defined(DUK_USE_EXPLICIT_NULL_INIT)
 	DUK_HOBJECT_SET_PROTOTYPE(heap, obj, NULL);
 	DUK_HOBJECT_SET_PROPS(heap, obj, NULL);
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	obj->shape = NULL;
+#endif
 #endif
 #if defined(DUK_USE_HEAPPTR16)
 	/* Zero encoded pointer is required to match NULL. */
@@ -55467,6 +61351,7 @@ DUK_LOCAL void duk__init_object_parts(duk_heap *heap, duk_uint_t hobject_flags,
 #endif
 	DUK_HEAPHDR_ASSERT_LINKS(heap, &obj->hdr);
 	DUK_HEAP_INSERT_INTO_HEAP_ALLOCATED(heap, &obj->hdr);
+	DUK_HEAPHDR_MS_NEW(heap, &obj->hdr);
 
 	/* obj->props is intentionally left as NULL, and duk_hobject_props.c must deal
 	 * with this properly.  This is intentional: empty objects consume a minimum
@@ -55727,6 +61612,15 @@ DUK_INTERNAL void duk_hobject_assert_valid(duk_hobject *h) {
 	/* Object is an Array <=> object has exotic array behavior */
 	DUK_ASSERT((DUK_HOBJECT_GET_CLASS_NUMBER(h) == DUK_HOBJECT_CLASS_ARRAY && DUK_HOBJECT_HAS_EXOTIC_ARRAY(h)) ||
 	           (DUK_HOBJECT_GET_CLASS_NUMBER(h) != DUK_HOBJECT_CLASS_ARRAY && !DUK_HOBJECT_HAS_EXOTIC_ARRAY(h)));
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	/* Shaped object: values only, sizes match the shape. */
+	DUK_ASSERT(h->shape == NULL ||
+	           (DUK_HOBJECT_GET_ASIZE(h) == 0 &&
+	            DUK_HOBJECT_GET_ENEXT(h) == h->shape->e_size &&
+	            DUK_HOBJECT_GET_ESIZE(h) == h->shape->e_size &&
+	            DUK_HOBJECT_GET_HSIZE(h) == h->shape->h_size &&
+	            h->shape->refcount > 0));
+#endif
 }
 
 DUK_INTERNAL void duk_harray_assert_valid(duk_harray *h) {
@@ -55946,6 +61840,7 @@ DUK_LOCAL void duk__sort_enum_keys_es6(duk_hthread *thr, duk_hobject *h_obj, duk
 		return;  /* Zero or one element(s). */
 	}
 
+	DUK_ASSERT(!DUK_HOBJECT_HAS_SHAPE(h_obj));  /* bare object, never shaped */
 	keys = DUK_HOBJECT_E_GET_KEY_BASE(thr->heap, h_obj);
 
 	for (idx = idx_start + 1; idx < idx_end; idx++) {
@@ -56839,6 +62734,29 @@ DUK_INTERNAL duk_uint_fast32_t duk_hobject_pc2line_query(duk_hthread *thr, duk_i
 	return line;
 }
 
+/* Same as duk_hobject_pc2line_query() but without touching the value stack,
+ * for callers like the sampling profiler which run inside the executor
+ * interrupt.
+ */
+DUK_INTERNAL duk_uint_fast32_t duk_hobject_pc2line_query_func(duk_hthread *thr, duk_hobject *func, duk_uint_fast32_t pc) {
+	duk_tval *tv;
+	duk_hbuffer_fixed *pc2line;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(func != NULL);
+
+	tv = duk_hobject_find_entry_tval_ptr_stridx(thr->heap, func, DUK_STRIDX_INT_PC2LINE);
+	if (tv == NULL || !DUK_TVAL_IS_BUFFER(tv)) {
+		return 0;
+	}
+	pc2line = (duk_hbuffer_fixed *) (void *) DUK_TVAL_GET_BUFFER(tv);
+	DUK_ASSERT(pc2line != NULL);
+	if (DUK_HBUFFER_HAS_DYNAMIC((duk_hbuffer *) pc2line) || DUK_HBUFFER_HAS_EXTERNAL((duk_hbuffer *) pc2line)) {
+		return 0;
+	}
+	return duk__hobject_pc2line_query_raw(thr, pc2line, pc);
+}
+
 #endif  /* DUK_USE_PC2LINE */
 /*
  *  duk_hobject property access functionality.
@@ -57857,6 +63775,24 @@ DUK_INTERNAL void duk_hobject_realloc_props(duk_hthread *thr,
 	DUK_HOBJECT_SET_ASIZE(obj, new_a_size);
 	DUK_HOBJECT_SET_HSIZE(obj, new_h_size);
 
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	/* A shaped object goes back to the dictionary layout: the copied
+	 * keys are now owned by the object, so take references before the
+	 * shape's references may go away.
+	 */
+	if (DUK_HOBJECT_HAS_SHAPE(obj)) {
+		duk_propshape *shape;
+
+		for (i = 0; i < new_e_next; i++) {
+			DUK_ASSERT(new_e_k[i] != NULL);
+			DUK_HSTRING_INCREF(thr, new_e_k[i]);
+		}
+		shape = obj->shape;
+		obj->shape = NULL;
+		duk_propshape_decref(thr->heap, shape, 1 /*decref_keys*/);
+	}
+#endif
+
 	/* Clear array part flag only after switching. */
 	if (abandon_array) {
 		DUK_HOBJECT_CLEAR_ARRAY_PART(obj);
@@ -58109,6 +64045,12 @@ DUK_INTERNAL void duk_hobject_compact_props(duk_hthread *thr, duk_hobject *obj)
 		return;
 	}
 #endif
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	if (DUK_HOBJECT_HAS_SHAPE(obj)) {
+		DUK_DD(DUK_DDPRINT("object has a shared shape, already compact"));
+		return;
+	}
+#endif
 
 	e_size = duk__count_used_e_keys(thr, obj);
 	duk__compute_a_stats(thr, obj, &a_used, &a_size);
@@ -58144,8 +64086,246 @@ DUK_INTERNAL void duk_hobject_compact_props(duk_hthread *thr, duk_hobject *obj)
 	                   (long) e_size, (long) a_size, (long) h_size, (long) abandon_array));
 
 	duk_hobject_realloc_props(thr, obj, e_size, a_size, h_size, abandon_array);
+
+#if defined(DUK_USE_HOBJECT_SHAPES)
+	(void) duk_hobject_shape_props(thr->heap, obj);
+#endif
 }
 
+/*
+ *  Shared object shapes.
+ *
+ *  Plain objects with the same own keys and attributes, in the same order,
+ *  share a single copy of the key, flags and hash parts.  Each object keeps
+ *  only its values, so for an object with N properties the allocation goes
+ *  down from N * (key + value + flags) plus the hash part to N * value.
+ *
+ *  Objects are given a shape when they are likely to stay as they are:
+ *  when compacted, at the end of JSON.parse() object parsing, and for live
+ *  objects after a mark-and-sweep pass.  A shape is only created for a
+ *  layout which has been seen on an earlier object, so that one-off objects
+ *  don't pay for shape bookkeeping.  Any change to keys or attributes
+ *  (adding or deleting a property, defineProperty() attribute changes,
+ *  freezing) first moves the object back to the dictionary layout using a
+ *  normal property table resize, which keeps entry and hash indices as is.
+ *
+ *  Shaping never throws and has no side effects: allocation is done with
+ *  DUK_ALLOC_RAW() so that it's safe to call from inside mark-and-sweep.
+ */
+
+#if defined(DUK_USE_HOBJECT_SHAPES)
+DUK_LOCAL duk_uint32_t duk__shape_hash(duk_hstring **keys, duk_uint8_t *flags, duk_uint32_t n) {
+	duk_uint32_t h;
+	duk_uint32_t i;
+
+	h = n;
+	for (i = 0; i < n; i++) {
+		h = h * 31U + DUK_HSTRING_GET_HASH(keys[i]) + (duk_uint32_t) flags[i];
+	}
+	return h;
+}
+
+DUK_LOCAL duk_propshape *duk__shape_lookup(duk_heap *heap, duk_uint32_t hash, duk_hstring **keys, duk_uint8_t *flags, duk_uint32_t n) {
+	duk_propshape *shape;
+
+	for (shape = heap->shapetab[hash % DUK_HEAP_SHAPETAB_SIZE]; shape != NULL; shape = shape->next) {
+		if (shape->hash == hash && shape->e_size == n &&
+		    duk_memcmp((const void *) DUK_PROPSHAPE_GET_KEYS(shape), (const void *) keys, sizeof(duk_hstring *) * n) == 0 &&
+		    duk_memcmp((const void *) DUK_PROPSHAPE_GET_FLAGS(shape), (const void *) flags, sizeof(duk_uint8_t) * n) == 0) {
+			return shape;
+		}
+	}
+	return NULL;
+}
+
+DUK_LOCAL duk_propshape *duk__shape_create(duk_heap *heap, duk_uint32_t hash, duk_hstring **keys, duk_uint8_t *flags, duk_uint32_t n) {
+	duk_propshape *shape;
+	duk_uint32_t h_size;
+	duk_uint32_t i;
+
+#if defined(DUK_USE_HOBJECT_HASH_PART)
+	h_size = duk__get_default_h_size(n);
+#else
+	h_size = 0;
+#endif
+
+	shape = (duk_propshape *) DUK_ALLOC_RAW(heap, DUK_PROPSHAPE_ALLOC_SIZE(n, h_size));
+	if (shape == NULL) {
+		return NULL;
+	}
+	shape->refcount = 0;
+	shape->hash = hash;
+	shape->e_size = n;
+	shape->h_size = h_size;
+	duk_memcpy((void *) DUK_PROPSHAPE_GET_KEYS(shape), (const void *) keys, sizeof(duk_hstring *) * n);
+	duk_memcpy((void *) DUK_PROPSHAPE_GET_FLAGS(shape), (const void *) flags, sizeof(duk_uint8_t) * n);
+	for (i = 0; i < n; i++) {
+		DUK_HSTRING_INCREF(heap->heap_thread, keys[i]);
+	}
+
+#if defined(DUK_USE_HOBJECT_HASH_PART)
+	if (h_size > 0) {
+		duk_uint32_t *h_base;
+		duk_uint32_t mask;
+
+		/* Same probing as in duk_hobject_realloc_props() so that
+		 * hash indices stay the same when an object is unshaped.
+		 */
+		h_base = DUK_PROPSHAPE_GET_HASH(shape);
+		duk_memset((void *) h_base, 0xff, sizeof(duk_uint32_t) * h_size);
+		mask = h_size - 1;
+		for (i = 0; i < n; i++) {
+			duk_uint32_t j;
+
+			j = DUK_HSTRING_GET_HASH(keys[i]) & mask;
+			while (h_base[j] != DUK__HASH_UNUSED) {
+				j = (j + 1) & mask;
+			}
+			h_base[j] = i;
+		}
+	}
+#endif
+
+	shape->next = heap->shapetab[hash % DUK_HEAP_SHAPETAB_SIZE];
+	heap->shapetab[hash % DUK_HEAP_SHAPETAB_SIZE] = shape;
+
+	DUK_DD(DUK_DDPRINT("created shape %p, hash 0x%08lx, e_size %ld, h_size %ld",
+	                   (void *) shape, (unsigned long) hash, (long) n, (long) h_size));
+	return shape;
+}
+
+DUK_INTERNAL duk_bool_t duk_hobject_shape_props(duk_heap *heap, duk_hobject *obj) {
+	duk_propshape *shape;
+	duk_hstring **keys;
+	duk_uint8_t *flags;
+	duk_propvalue *old_vals;
+	duk_propvalue *new_vals;
+	duk_uint32_t n;
+	duk_uint32_t hash;
+	duk_uint32_t i;
+	duk_uint32_t *cand;
+
+	DUK_ASSERT(heap != NULL);
+	DUK_ASSERT(obj != NULL);
+
+	if (DUK_HOBJECT_HAS_SHAPE(obj)) {
+		return 1;
+	}
+
+	/* Plain objects only, and only ones with a prototype: bare objects
+	 * are used internally (enumerators, varmaps) and written in place.
+	 */
+	n = DUK_HOBJECT_GET_ENEXT(obj);
+	if (n == 0 || n > DUK_HEAP_SHAPE_MAX_KEYS ||
+	    DUK_HOBJECT_GET_CLASS_NUMBER(obj) != DUK_HOBJECT_CLASS_OBJECT ||
+	    !DUK_HOBJECT_HAS_FASTREFS(obj) ||
+	    DUK_HOBJECT_HAS_EXOTIC_BEHAVIOR(obj) ||
+	    DUK_HOBJECT_GET_ASIZE(obj) != 0 ||
+	    DUK_HOBJECT_GET_PROTOTYPE(heap, obj) == NULL ||
+	    DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) obj) ||
+	    heap->heap_thread == NULL) {
+		return 0;
+	}
+
+	keys = DUK_HOBJECT_E_GET_KEY_BASE(heap, obj);
+	flags = DUK_HOBJECT_E_GET_FLAGS_BASE(heap, obj);
+	for (i = 0; i < n; i++) {
+		if (keys[i] == NULL) {
+			return 0;  /* deleted keys, keep as a dictionary */
+		}
+	}
+
+	hash = duk__shape_hash(keys, flags, n);
+	shape = duk__shape_lookup(heap, hash, keys, flags, n);
+	if (shape == NULL) {
+		cand = &heap->shape_cand[hash % DUK_HEAP_SHAPE_CAND_SIZE];
+		if (*cand != hash) {
+			*cand = hash;
+			return 0;
+		}
+		shape = duk__shape_create(heap, hash, keys, flags, n);
+		if (shape == NULL) {
+			return 0;
+		}
+	}
+
+	new_vals = (duk_propvalue *) DUK_ALLOC_RAW(heap, sizeof(duk_propvalue) * n);
+	if (new_vals == NULL) {
+		if (shape->refcount == 0) {
+			duk_propshape_decref(heap, shape, 1 /*decref_keys*/);
+		}
+		return 0;
+	}
+	old_vals = DUK_HOBJECT_E_GET_VALUE_BASE(heap, obj);
+	duk_memcpy((void *) new_vals, (const void *) old_vals, sizeof(duk_propvalue) * n);
+
+	/* Key references move from the object to the shape. */
+	for (i = 0; i < n; i++) {
+		DUK_HSTRING_DECREF_NORZ(heap->heap_thread, keys[i]);
+	}
+
+	DUK_FREE(heap, DUK_HOBJECT_GET_PROPS(heap, obj));
+	DUK_HOBJECT_SET_PROPS(heap, obj, (duk_uint8_t *) new_vals);
+	DUK_HOBJECT_SET_ESIZE(obj, n);
+	DUK_HOBJECT_SET_HSIZE(obj, shape->h_size);
+	obj->shape = shape;
+	shape->refcount++;
+
+	DUK_DDD(DUK_DDDPRINT("object %p now uses shape %p (refcount %ld)",
+	                     (void *) obj, (void *) shape, (long) shape->refcount));
+	return 1;
+}
+
+DUK_INTERNAL void duk_hobject_unshape_props(duk_hthread *thr, duk_hobject *obj) {
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(obj != NULL);
+	DUK_ASSERT(DUK_HOBJECT_HAS_SHAPE(obj));
+
+	DUK_DD(DUK_DDPRINT("object %p leaves shape %p", (void *) obj, (void *) obj->shape));
+
+	/* Same sizes: entry and hash indices are kept. */
+	duk_hobject_realloc_props(thr,
+	                          obj,
+	                          DUK_HOBJECT_GET_ESIZE(obj),
+	                          0,
+	                          DUK_HOBJECT_GET_HSIZE(obj),
+	                          0);
+	DUK_ASSERT(!DUK_HOBJECT_HAS_SHAPE(obj));
+}
+
+DUK_INTERNAL void duk_propshape_decref(duk_heap *heap, duk_propshape *shape, duk_bool_t decref_keys) {
+	duk_propshape **ptr;
+
+	DUK_ASSERT(heap != NULL);
+	DUK_ASSERT(shape != NULL);
+
+	if (shape->refcount > 0 && --shape->refcount > 0) {
+		return;
+	}
+
+	ptr = &heap->shapetab[shape->hash % DUK_HEAP_SHAPETAB_SIZE];
+	while (*ptr != shape) {
+		DUK_ASSERT(*ptr != NULL);
+		ptr = &(*ptr)->next;
+	}
+	*ptr = shape->next;
+
+	if (decref_keys) {
+		duk_hstring **keys;
+		duk_uint32_t i;
+
+		keys = DUK_PROPSHAPE_GET_KEYS(shape);
+		for (i = 0; i < shape->e_size; i++) {
+			DUK_HSTRING_DECREF_NORZ(heap->heap_thread, keys[i]);
+		}
+		DUK_UNREF(keys);  /* without refcounts */
+	}
+
+	DUK_DD(DUK_DDPRINT("freed shape %p", (void *) shape));
+	DUK_FREE(heap, (void *) shape);
+}
+#endif  /* DUK_USE_HOBJECT_SHAPES */
+
 /*
  *  Find an existing key from entry part either by linear scan or by
  *  using the hash index (if it exists).
@@ -58332,6 +64512,7 @@ DUK_LOCAL duk_int_t duk__hobject_alloc_entry_checked(duk_hthread *thr, duk_hobje
 		duk__grow_props_for_new_entry_item(thr, obj);
 	}
 	DUK_ASSERT(DUK_HOBJECT_GET_ENEXT(obj) < DUK_HOBJECT_GET_ESIZE(obj));
+	DUK_ASSERT(!DUK_HOBJECT_HAS_SHAPE(obj));  /* shaped objects are always full */
 	idx = DUK_HOBJECT_POSTINC_ENEXT(obj);
 
 	/* previous value is assumed to be garbage, so don't touch it */
@@ -61189,6 +67370,168 @@ DUK_INTERNAL duk_bool_t duk_hobject_putprop(duk_hthread *thr, duk_tval *tv_obj,
 	return 0;
 }
 
+/*
+ *  Inline caches for GETPROP/PUTPROP (DUK_USE_PROPERTY_IC).
+ *
+ *  Each property access instruction maps (by address) to an entry in a
+ *  direct mapped heap level table which remembers where the instruction
+ *  last found its property: the entry part index of the key in the object
+ *  holding it, and the holder's distance along the prototype chain.  On a
+ *  hit the value is read or written directly, skipping key coercion and
+ *  the generic [[Get]]/[[Put]] machinery.
+ *
+ *  Entries are never invalidated.  Instead a hit is validated against the
+ *  current object state: the holder must have the same key at the cached
+ *  index as a plain data property (writable for a put), and objects in
+ *  between must not have the key as an own property.  A stale entry (e.g.
+ *  for a freed function or a resized entry part) thus either validates
+ *  and gives the correct result, or is a miss.  Objects created the same
+ *  way have their keys at the same indices, so e.g. all instances of a
+ *  constructor hit the same entry.
+ *
+ *  Keys with exotic behavior (array indices, 'length') or post-processing
+ *  ('caller'), accessors, Proxy objects and puts which create a property
+ *  are left to the generic code.
+ */
+
+#if defined(DUK_USE_PROPERTY_IC)
+DUK_LOCAL DUK_ALWAYS_INLINE duk_propic_entry *duk__propic_lookup(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, const duk_instr_t *pc) {
+	duk_hstring *key;
+
+	if (DUK_UNLIKELY(!DUK_TVAL_IS_OBJECT(tv_obj) || !DUK_TVAL_IS_STRING(tv_key))) {
+		return NULL;
+	}
+	key = DUK_TVAL_GET_STRING(tv_key);
+	if (DUK_UNLIKELY(DUK_HSTRING_HAS_ARRIDX(key) ||
+	                 key == DUK_HTHREAD_STRING_LENGTH(thr) ||
+	                 key == DUK_HTHREAD_STRING_CALLER(thr))) {
+		return NULL;
+	}
+
+	DUK_ASSERT(DUK_IS_POWER_OF_TWO((duk_uint_t) DUK_USE_PROPERTY_IC_SIZE));
+	return thr->heap->propic + (((duk_uintptr_t) pc / sizeof(duk_instr_t)) & (DUK_USE_PROPERTY_IC_SIZE - 1));
+}
+
+DUK_INTERNAL void duk_hobject_getprop_ic(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, const duk_instr_t *pc) {
+	duk_heap *heap;
+	duk_propic_entry *ent;
+	duk_hobject *curr;
+	duk_hstring *key;
+	duk_uint32_t depth;
+	duk_int_t e_idx;
+	duk_int_t h_idx;
+
+	ent = duk__propic_lookup(thr, tv_obj, tv_key, pc);
+	if (ent == NULL) {
+		goto uncached;
+	}
+	heap = thr->heap;
+	curr = DUK_TVAL_GET_OBJECT(tv_obj);
+	key = DUK_TVAL_GET_STRING(tv_key);
+
+	if (ent->pc == pc && ent->key == key) {
+		for (depth = ent->depth; depth > 0; depth--) {
+			if (DUK_HOBJECT_IS_PROXY(curr) ||
+			    duk_hobject_find_entry(heap, curr, key, &e_idx, &h_idx)) {
+				goto miss;
+			}
+			curr = DUK_HOBJECT_GET_PROTOTYPE(heap, curr);
+			if (curr == NULL) {
+				goto miss;
+			}
+		}
+		if (!DUK_HOBJECT_IS_PROXY(curr) &&
+		    ent->e_idx < DUK_HOBJECT_GET_ENEXT(curr) &&
+		    DUK_HOBJECT_E_GET_KEY(heap, curr, ent->e_idx) == key &&
+		    !DUK_HOBJECT_E_SLOT_IS_ACCESSOR(heap, curr, ent->e_idx)) {
+			heap->propic_get_hit++;
+			duk_push_tval(thr, DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(heap, curr, ent->e_idx));
+			return;
+		}
+	}
+
+ miss:
+	heap->propic_get_miss++;
+	curr = DUK_TVAL_GET_OBJECT(tv_obj);
+	for (depth = 0; depth <= DUK_HEAP_PROPIC_MAX_DEPTH; depth++) {
+		if (DUK_HOBJECT_IS_PROXY(curr)) {
+			break;
+		}
+		if (duk_hobject_find_entry(heap, curr, key, &e_idx, &h_idx)) {
+			if (DUK_HOBJECT_E_SLOT_IS_ACCESSOR(heap, curr, e_idx)) {
+				break;
+			}
+			ent->pc = pc;
+			ent->key = key;
+			ent->e_idx = (duk_uint32_t) e_idx;
+			ent->depth = depth;
+			duk_push_tval(thr, DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(heap, curr, e_idx));
+			return;
+		}
+		curr = DUK_HOBJECT_GET_PROTOTYPE(heap, curr);
+		if (curr == NULL) {
+			break;
+		}
+	}
+
+ uncached:
+	(void) duk_hobject_getprop(thr, tv_obj, tv_key);
+}
+
+DUK_INTERNAL void duk_hobject_putprop_ic(duk_hthread *thr, duk_tval *tv_obj, duk_tval *tv_key, duk_tval *tv_val, duk_bool_t throw_flag, const duk_instr_t *pc) {
+	duk_heap *heap;
+	duk_propic_entry *ent;
+	duk_hobject *obj;
+	duk_hstring *key;
+	duk_tval *tv;
+	duk_int_t e_idx;
+	duk_int_t h_idx;
+
+	ent = duk__propic_lookup(thr, tv_obj, tv_key, pc);
+	if (ent == NULL) {
+		goto uncached;
+	}
+	heap = thr->heap;
+	obj = DUK_TVAL_GET_OBJECT(tv_obj);
+	key = DUK_TVAL_GET_STRING(tv_key);
+	if (DUK_HOBJECT_IS_PROXY(obj)) {
+		goto uncached;
+	}
+#if defined(DUK_USE_ROM_OBJECTS)
+	if (DUK_HEAPHDR_HAS_READONLY((duk_heaphdr *) obj)) {
+		goto uncached;
+	}
+#endif
+
+	if (ent->pc == pc && ent->key == key && ent->depth == 0 &&
+	    ent->e_idx < DUK_HOBJECT_GET_ENEXT(obj) &&
+	    DUK_HOBJECT_E_GET_KEY(heap, obj, ent->e_idx) == key &&
+	    (DUK_HOBJECT_E_GET_FLAGS(heap, obj, ent->e_idx) & (DUK_PROPDESC_FLAG_ACCESSOR | DUK_PROPDESC_FLAG_WRITABLE)) == DUK_PROPDESC_FLAG_WRITABLE) {
+		heap->propic_put_hit++;
+		e_idx = (duk_int_t) ent->e_idx;
+		goto put;
+	}
+
+	heap->propic_put_miss++;
+	if (duk_hobject_find_entry(heap, obj, key, &e_idx, &h_idx) &&
+	    (DUK_HOBJECT_E_GET_FLAGS(heap, obj, e_idx) & (DUK_PROPDESC_FLAG_ACCESSOR | DUK_PROPDESC_FLAG_WRITABLE)) == DUK_PROPDESC_FLAG_WRITABLE) {
+		ent->pc = pc;
+		ent->key = key;
+		ent->e_idx = (duk_uint32_t) e_idx;
+		ent->depth = 0;
+		goto put;
+	}
+
+ uncached:
+	(void) duk_hobject_putprop(thr, tv_obj, tv_key, tv_val, throw_flag);
+	return;
+
+ put:
+	tv = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(heap, obj, e_idx);
+	DUK_TVAL_SET_TVAL_UPDREF(thr, tv, tv_val);  /* side effects */
+}
+#endif  /* DUK_USE_PROPERTY_IC */
+
 /*
  *  ECMAScript compliant [[Delete]](P, Throw).
  */
@@ -61249,6 +67592,9 @@ DUK_INTERNAL duk_bool_t duk_hobject_delprop_raw(duk_hthread *thr, duk_hobject *o
 	} else {
 		DUK_ASSERT(desc.a_idx < 0);
 
+		/* Keys are about to change, back to a dictionary layout. */
+		DUK_HOBJECT_UNSHAPE(thr, obj);
+
 		/* remove hash entry (no decref) */
 #if defined(DUK_USE_HOBJECT_HASH_PART)
 		if (desc.h_idx >= 0) {
@@ -61588,6 +67934,7 @@ DUK_INTERNAL void duk_hobject_define_property_internal(duk_hthread *thr, duk_hob
 				goto error_internal;
 			}
 
+			DUK_HOBJECT_UNSHAPE(thr, obj);
 			DUK_HOBJECT_E_SET_FLAGS(thr->heap, obj, desc.e_idx, propflags);
 			tv1 = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(thr->heap, obj, desc.e_idx);
 		} else if (desc.a_idx >= 0) {
@@ -62491,6 +68838,7 @@ duk_bool_t duk_hobject_define_property_helper(duk_hthread *thr,
 			DUK_ASSERT(curr.e_idx >= 0);
 			DUK_ASSERT(!DUK_HOBJECT_E_SLOT_IS_ACCESSOR(thr->heap, obj, curr.e_idx));
 
+			DUK_HOBJECT_UNSHAPE(thr, obj);
 			tv1 = DUK_HOBJECT_E_GET_VALUE_TVAL_PTR(thr->heap, obj, curr.e_idx);
 			DUK_TVAL_SET_UNDEFINED_UPDREF_NORZ(thr, tv1);  /* XXX: just decref */
 
@@ -62526,6 +68874,7 @@ duk_bool_t duk_hobject_define_property_helper(duk_hthread *thr,
 
 			DUK_DDD(DUK_DDDPRINT("convert property to data property"));
 
+			DUK_HOBJECT_UNSHAPE(thr, obj);
 			DUK_ASSERT(DUK_HOBJECT_E_SLOT_IS_ACCESSOR(thr->heap, obj, curr.e_idx));
 			tmp = DUK_HOBJECT_E_GET_VALUE_GETTER(thr->heap, obj, curr.e_idx);
 			DUK_UNREF(tmp);
@@ -62649,6 +68998,7 @@ duk_bool_t duk_hobject_define_property_helper(duk_hthread *thr,
 
 	DUK_DDD(DUK_DDDPRINT("update existing property attributes"));
 	if (curr.e_idx >= 0) {
+		DUK_HOBJECT_UNSHAPE(thr, obj);
 		DUK_HOBJECT_E_SET_FLAGS(thr->heap, obj, curr.e_idx, new_flags);
 	} else {
 		/* For Array .length the only allowed transition is for .length
@@ -62955,6 +69305,7 @@ DUK_INTERNAL void duk_hobject_object_seal_freeze_helper(duk_hthread *thr, duk_ho
 
 	duk__abandon_array_part(thr, obj);
 	DUK_ASSERT(DUK_HOBJECT_GET_ASIZE(obj) == 0);
+	DUK_ASSERT(!DUK_HOBJECT_HAS_SHAPE(obj));  /* resized above */
 
 	for (i = 0; i < DUK_HOBJECT_GET_ENEXT(obj); i++) {
 		duk_uint8_t *fp;
@@ -63519,6 +69870,96 @@ DUK_LOCAL void duk__push_double(duk_hthread *thr, duk_bitdecoder_ctx *bd) {
 	duk_push_number(thr, du.d);  /* push operation normalizes NaNs */
 }
 
+#if defined(DUK_USE_CBOR_BUILTIN) && defined(DUK_USE_CBOR_SUPPORT) && defined(DUK_USE_CBOR_STREAMING)
+#define DUK__CBOR_STREAMING_BUILTINS
+#endif
+
+#if (defined(DUK_USE_BUFFEROBJECT_SUPPORT) && defined(DUK_USE_TYPEDARRAY_KERNELS)) || \
+    (defined(DUK_USE_JSON_BUILTIN) && defined(DUK_USE_JSON_STRINGIFY_SINK)) || \
+    (defined(DUK_USE_JSON_BUILTIN) && defined(DUK_USE_JSON_INCREMENTAL_PARSER)) || \
+    defined(DUK__CBOR_STREAMING_BUILTINS) || \
+    (defined(DUK_USE_DUKTAPE_BUILTIN) && defined(DUK_USE_CODEC_DECODE_INTO)) || \
+    (defined(DUK_USE_ENCODING_BUILTINS) && defined(DUK_USE_TEXTENCODER_ENCODE_INTO))
+#define DUK__EXTRA_METHODS
+#endif
+
+#if defined(DUK__EXTRA_METHODS)
+typedef struct {
+	const char *name;
+	duk_c_function func;
+	duk_small_int_t nargs;
+	duk_small_int_t length;
+	duk_small_int_t magic;
+} duk__extra_method;
+
+#if defined(DUK_USE_BUFFEROBJECT_SUPPORT) && defined(DUK_USE_TYPEDARRAY_KERNELS)
+DUK_LOCAL const duk__extra_method duk__typedarray_extra_methods[] = {
+	{ "fill", duk_bi_typedarray_fill, 3, 1, 0 },
+	{ "indexOf", duk_bi_typedarray_indexof_shared, 2, 1, 0 },
+	{ "includes", duk_bi_typedarray_indexof_shared, 2, 1, 1 },
+	{ "reverse", duk_bi_typedarray_reverse, 0, 0, 0 }
+};
+#endif
+
+#if defined(DUK_USE_JSON_BUILTIN) && defined(DUK_USE_JSON_STRINGIFY_SINK)
+DUK_LOCAL const duk__extra_method duk__json_extra_methods[] = {
+	{ "stringifyTo", duk_bi_json_object_stringify_to, 3, 2, 0 }
+};
+#endif
+
+#if defined(DUK_USE_JSON_BUILTIN) && defined(DUK_USE_JSON_INCREMENTAL_PARSER)
+DUK_LOCAL const duk__extra_method duk__json_parser_methods[] = {
+	{ "write", duk_bi_json_parser_prototype_write, 1, 1, 0 },
+	{ "end", duk_bi_json_parser_prototype_end, 1, 0, 0 }
+};
+#endif
+
+#if defined(DUK__CBOR_STREAMING_BUILTINS)
+DUK_LOCAL const duk__extra_method duk__cbor_extra_methods[] = {
+	{ "decode", duk_bi_cbor_decode, 3, 1, 0 },  /* replaces the one argument version */
+	{ "encodeInto", duk_bi_cbor_encode_into, 3, 2, 0 }
+};
+
+DUK_LOCAL const duk__extra_method duk__cbor_decoder_methods[] = {
+	{ "write", duk_bi_cbor_decoder_prototype_write, 1, 1, 0 },
+	{ "end", duk_bi_cbor_decoder_prototype_end, 1, 0, 0 }
+};
+#endif
+
+#if defined(DUK_USE_DUKTAPE_BUILTIN) && defined(DUK_USE_CODEC_DECODE_INTO)
+DUK_LOCAL const duk__extra_method duk__duktape_extra_methods[] = {
+	{ "decInto", duk_bi_duktape_object_dec_into, 4, 3, 0 }
+};
+#endif
+
+#if defined(DUK_USE_ENCODING_BUILTINS) && defined(DUK_USE_TEXTENCODER_ENCODE_INTO)
+DUK_LOCAL const duk__extra_method duk__textencoder_extra_methods[] = {
+	{ "encodeInto", duk_bi_textencoder_prototype_encode_into, 2, 2, 0 }
+};
+#endif
+
+/* Add methods which are not in the init data to the object at 'obj_idx'. */
+DUK_LOCAL void duk__add_extra_methods(duk_hthread *thr, duk_idx_t obj_idx, const duk__extra_method *methods, duk_small_uint_t count) {
+	duk_small_uint_t i;
+
+	obj_idx = duk_require_normalize_index(thr, obj_idx);
+	for (i = 0; i < count; i++) {
+		const duk__extra_method *m = methods + i;
+
+		duk_push_string(thr, m->name);
+		duk_push_c_function_builtin_noconstruct(thr, m->func, m->nargs);
+		((duk_hnatfunc *) duk_known_hobject(thr, -1))->magic = (duk_int16_t) m->magic;
+		duk_push_int(thr, m->length);
+		duk_xdef_prop_stridx_short(thr, -2, DUK_STRIDX_LENGTH, DUK_PROPDESC_FLAGS_C);
+#if defined(DUK_USE_FUNC_NAME_PROPERTY)
+		duk_dup_m2(thr);
+		duk_xdef_prop_stridx_short(thr, -2, DUK_STRIDX_NAME, DUK_PROPDESC_FLAGS_C);
+#endif
+		duk_xdef_prop(thr, obj_idx, DUK_PROPDESC_FLAGS_WC);
+	}
+}
+#endif  /* DUK__EXTRA_METHODS */
+
 DUK_INTERNAL void duk_hthread_create_builtin_objects(duk_hthread *thr) {
 	duk_bitdecoder_ctx bd_ctx;
 	duk_bitdecoder_ctx *bd = &bd_ctx;  /* convenience */
@@ -64030,6 +70471,10 @@ DUK_INTERNAL void duk_hthread_create_builtin_objects(duk_hthread *thr) {
 	 *  - Possibly remove some properties (values or methods) which are not
 	 *    desirable with current feature options but are not currently
 	 *    conditional in init data.
+	 *
+	 *  - Add %TypedArray%.prototype methods which are not in init data.
+	 *
+	 *  - Add JSON.stringifyTo() and JSON.Parser which are not in init data.
 	 */
 
 #if defined(DUK_USE_DATE_BUILTIN)
@@ -64040,6 +70485,96 @@ DUK_INTERNAL void duk_hthread_create_builtin_objects(duk_hthread *thr) {
 	h = duk_known_hobject(thr, DUK_BIDX_DOUBLE_ERROR);
 	DUK_HOBJECT_CLEAR_EXTENSIBLE(h);
 
+#if defined(DUK_USE_BUFFEROBJECT_SUPPORT) && defined(DUK_USE_TYPEDARRAY_KERNELS)
+	/* %TypedArray%.prototype is the internal prototype of e.g.
+	 * Uint8Array.prototype and has no builtin index of its own.
+	 */
+	h = DUK_HOBJECT_GET_PROTOTYPE(thr->heap, duk_known_hobject(thr, DUK_BIDX_UINT8ARRAY_PROTOTYPE));
+	DUK_ASSERT(h != NULL);
+	duk_push_hobject(thr, h);
+	duk__add_extra_methods(thr,
+	                       -1,
+	                       duk__typedarray_extra_methods,
+	                       (duk_small_uint_t) (sizeof(duk__typedarray_extra_methods) / sizeof(duk__extra_method)));
+	duk_pop(thr);
+#endif
+
+#if defined(DUK_USE_JSON_BUILTIN) && defined(DUK_USE_JSON_STRINGIFY_SINK)
+	duk_get_prop_stridx_short(thr, DUK_BIDX_GLOBAL, DUK_STRIDX_JSON);
+	duk__add_extra_methods(thr,
+	                       -1,
+	                       duk__json_extra_methods,
+	                       (duk_small_uint_t) (sizeof(duk__json_extra_methods) / sizeof(duk__extra_method)));
+	duk_pop(thr);
+#endif
+
+#if defined(DUK_USE_JSON_BUILTIN) && defined(DUK_USE_JSON_INCREMENTAL_PARSER)
+	duk_get_prop_stridx_short(thr, DUK_BIDX_GLOBAL, DUK_STRIDX_JSON);
+	duk_push_literal(thr, "Parser");
+	duk_push_c_function_builtin(thr, duk_bi_json_parser_constructor, 1);
+	duk_push_int(thr, 1);
+	duk_xdef_prop_stridx_short(thr, -2, DUK_STRIDX_LENGTH, DUK_PROPDESC_FLAGS_C);
+#if defined(DUK_USE_FUNC_NAME_PROPERTY)
+	duk_dup_m2(thr);
+	duk_xdef_prop_stridx_short(thr, -2, DUK_STRIDX_NAME, DUK_PROPDESC_FLAGS_C);
+#endif
+	duk_push_object(thr);
+	duk__add_extra_methods(thr,
+	                       -1,
+	                       duk__json_parser_methods,
+	                       (duk_small_uint_t) (sizeof(duk__json_parser_methods) / sizeof(duk__extra_method)));
+	duk_dup_m2(thr);
+	duk_xdef_prop_stridx_short(thr, -2, DUK_STRIDX_CONSTRUCTOR, DUK_PROPDESC_FLAGS_WC);
+	duk_xdef_prop_stridx_short(thr, -2, DUK_STRIDX_PROTOTYPE, DUK_PROPDESC_FLAGS_NONE);
+	duk_xdef_prop(thr, -3, DUK_PROPDESC_FLAGS_WC);  /* JSON.Parser */
+	duk_pop(thr);
+#endif
+
+#if defined(DUK__CBOR_STREAMING_BUILTINS)
+	duk_get_prop_literal(thr, DUK_BIDX_GLOBAL, "CBOR");
+	duk__add_extra_methods(thr,
+	                       -1,
+	                       duk__cbor_extra_methods,
+	                       (duk_small_uint_t) (sizeof(duk__cbor_extra_methods) / sizeof(duk__extra_method)));
+	duk_push_literal(thr, "Decoder");
+	duk_push_c_function_builtin(thr, duk_bi_cbor_decoder_constructor, 1);
+	duk_push_int(thr, 1);
+	duk_xdef_prop_stridx_short(thr, -2, DUK_STRIDX_LENGTH, DUK_PROPDESC_FLAGS_C);
+#if defined(DUK_USE_FUNC_NAME_PROPERTY)
+	duk_dup_m2(thr);
+	duk_xdef_prop_stridx_short(thr, -2, DUK_STRIDX_NAME, DUK_PROPDESC_FLAGS_C);
+#endif
+	duk_push_object(thr);
+	duk__add_extra_methods(thr,
+	                       -1,
+	                       duk__cbor_decoder_methods,
+	                       (duk_small_uint_t) (sizeof(duk__cbor_decoder_methods) / sizeof(duk__extra_method)));
+	duk_dup_m2(thr);
+	duk_xdef_prop_stridx_short(thr, -2, DUK_STRIDX_CONSTRUCTOR, DUK_PROPDESC_FLAGS_WC);
+	duk_xdef_prop_stridx_short(thr, -2, DUK_STRIDX_PROTOTYPE, DUK_PROPDESC_FLAGS_NONE);
+	duk_xdef_prop(thr, -3, DUK_PROPDESC_FLAGS_WC);  /* CBOR.Decoder */
+	duk_pop(thr);
+#endif
+
+#if defined(DUK_USE_DUKTAPE_BUILTIN) && defined(DUK_USE_CODEC_DECODE_INTO)
+	duk_push_hobject(thr, thr->builtins[DUK_BIDX_DUKTAPE]);
+	duk__add_extra_methods(thr,
+	                       -1,
+	                       duk__duktape_extra_methods,
+	                       (duk_small_uint_t) (sizeof(duk__duktape_extra_methods) / sizeof(duk__extra_method)));
+	duk_pop(thr);
+#endif
+
+#if defined(DUK_USE_ENCODING_BUILTINS) && defined(DUK_USE_TEXTENCODER_ENCODE_INTO)
+	duk_get_prop_literal(thr, DUK_BIDX_GLOBAL, "TextEncoder");
+	duk_get_prop_stridx_short(thr, -1, DUK_STRIDX_PROTOTYPE);
+	duk__add_extra_methods(thr,
+	                       -1,
+	                       duk__textencoder_extra_methods,
+	                       (duk_small_uint_t) (sizeof(duk__textencoder_extra_methods) / sizeof(duk__extra_method)));
+	duk_pop_2(thr);
+#endif
+
 #if !defined(DUK_USE_ES6_OBJECT_PROTO_PROPERTY)
 	DUK_DD(DUK_DDPRINT("delete Object.prototype.__proto__ built-in which is not enabled in features"));
 	(void) duk_hobject_delprop_raw(thr, thr->builtins[DUK_BIDX_OBJECT_PROTOTYPE], DUK_HTHREAD_STRING___PROTO__(thr), DUK_DELPROP_FLAG_THROW);
@@ -64196,6 +70731,8 @@ DUK_INTERNAL void duk_hthread_copy_builtin_objects(duk_hthread *thr_from, duk_ht
 }
 
 /* automatic undefs */
+#undef DUK__CBOR_STREAMING_BUILTINS
+#undef DUK__EXTRA_METHODS
 #undef DUK__LENGTH_PROP_BITS
 #undef DUK__NARGS_BITS
 #undef DUK__NARGS_VARARGS_MARKER
@@ -64599,6 +71136,26 @@ DUK_LOCAL void duk__activation_unwind_nofree_norz(duk_hthread *thr) {
 		thr->callstack_preventcount--;
 	}
 
+	/*
+	 *  Instrumentation: inclusive time is added when the outermost
+	 *  activation of the function unwinds.
+	 */
+
+#if defined(DUK_USE_PROFILER_INSTRUMENT)
+	if (act->prof_start >= 0.0) {
+		duk_prof_entry *e;
+
+		DUK_ASSERT(func != NULL && DUK_HOBJECT_IS_COMPFUNC(func));
+		e = duk_heap_profiler_func_lookup(thr->heap, (duk_hcompfunc *) func);
+		if (e != NULL) {  /* NULL if dropped by a failed reset */
+			DUK_ASSERT(e->depth > 0);
+			if (--e->depth == 0) {
+				e->time += duk_time_get_monotonic_time(thr) - act->prof_start;
+			}
+		}
+	}
+#endif
+
 	/*
 	 *  Reference count updates, using NORZ macros so we don't
 	 *  need to handle side effects.
@@ -66307,6 +72864,27 @@ DUK_LOCAL void duk__safe_call_adjust_valstack(duk_hthread *thr, duk_idx_t idx_re
  *  Activation setup for tailcalls and non-tailcalls.
  */
 
+#if defined(DUK_USE_PROFILER_INSTRUMENT)
+/* Instrumentation counterpart of the unwind handling in
+ * duk__activation_unwind_nofree_norz().
+ */
+DUK_LOCAL void duk__call_profiler_enter(duk_hthread *thr, duk_activation *act, duk_hobject *func) {
+	duk_prof_entry *e;
+
+	act->prof_start = -1.0;
+	if (!thr->heap->prof_instrument || func == NULL || !DUK_HOBJECT_IS_COMPFUNC(func)) {
+		return;
+	}
+	e = duk_heap_profiler_func_enter(thr, (duk_hcompfunc *) func);
+	if (e == NULL) {
+		return;  /* out of memory, call isn't counted */
+	}
+	e->calls++;
+	e->depth++;
+	act->prof_start = duk_time_get_monotonic_time(thr);
+}
+#endif  /* DUK_USE_PROFILER_INSTRUMENT */
+
 #if defined(DUK_USE_TAILCALL)
 DUK_LOCAL duk_small_uint_t duk__call_setup_act_attempt_tailcall(duk_hthread *thr,
                                                                 duk_small_uint_t call_flags,
@@ -66455,6 +73033,9 @@ DUK_LOCAL duk_small_uint_t duk__call_setup_act_attempt_tailcall(duk_hthread *thr
 #endif
 	DUK_TVAL_SET_OBJECT(&act->tv_func, func);  /* borrowed, no refcount */
 	DUK_HOBJECT_INCREF(thr, func);
+#if defined(DUK_USE_PROFILER_INSTRUMENT)
+	duk__call_profiler_enter(thr, act, func);
+#endif
 
 	act->flags = DUK_ACT_FLAG_TAILCALLED;
 	if (DUK_HOBJECT_HAS_STRICT(func)) {
@@ -66594,6 +73175,9 @@ DUK_LOCAL void duk__call_setup_act_not_tailcall(duk_hthread *thr,
 
 	/* start of arguments: idx_func + 2. */
 	act->func = func;  /* NULL for lightfunc */
+#if defined(DUK_USE_PROFILER_INSTRUMENT)
+	duk__call_profiler_enter(thr, act, func);
+#endif
 	if (DUK_LIKELY(func != NULL)) {
 		DUK_TVAL_SET_OBJECT(&act->tv_func, func);  /* borrowed, no refcount */
 		if (DUK_HOBJECT_HAS_STRICT(func)) {
@@ -66943,6 +73527,16 @@ DUK_LOCAL duk_int_t duk__handle_call_raw(duk_hthread *thr,
 	DUK_ASSERT(func == NULL || (DUK_HOBJECT_IS_COMPFUNC(func) ||
 	                            DUK_HOBJECT_IS_NATFUNC(func)));
 
+#if defined(DUK_USE_COMPILER_LAZY)
+	/* First call of a function whose compilation was deferred, generate
+	 * its bytecode before nargs/nregs are looked up.
+	 */
+	if (func != NULL && DUK_HOBJECT_IS_COMPFUNC(func) &&
+	    DUK_UNLIKELY(DUK_HCOMPFUNC_IS_LAZY(thr->heap, (duk_hcompfunc *) func))) {
+		duk_js_compile_lazy(thr, (duk_hcompfunc *) func);
+	}
+#endif
+
 	/* [ ... func this arg1 ... argN ] */
 
 	/*
@@ -67849,9 +74443,13 @@ DUK_INTERNAL DUK_NOINLINE DUK_COLD void duk_call_setup_propcall_error(duk_hthrea
 #define DUK__MAX_FUNCS                    DUK_BC_BC_MAX
 #define DUK__MAX_TEMPS                    0xffffL
 
-/* Initial bytecode size allocation. */
+/* Initial bytecode size allocation.  Every active function nesting level
+ * holds one, and most inner functions are a few dozen instructions.
+ */
 #if defined(DUK_USE_PREFER_SIZE)
 #define DUK__BC_INITIAL_INSTS             16
+#elif defined(DUK_USE_COMPILER_LOWMEM)
+#define DUK__BC_INITIAL_INSTS             32
 #else
 #define DUK__BC_INITIAL_INSTS             256
 #endif
@@ -67876,12 +74474,17 @@ DUK_INTERNAL DUK_NOINLINE DUK_COLD void duk_call_setup_propcall_error(duk_hthrea
 #define DUK__PARSE_EXPR_SLOTS             16
 
 /* Temporary structure used to pass a stack allocated region through
- * duk_safe_call().
+ * duk_safe_call().  With DUK_USE_COMPILER_LOWMEM the region is a fixed
+ * buffer on the value stack instead.
  */
 typedef struct {
 	duk_small_uint_t flags;
 	duk_compiler_ctx comp_ctx_alloc;
 	duk_lexer_point lex_pt_alloc;
+#if defined(DUK_USE_COMPILER_LAZY)
+	const duk_lexer_point *lazy_pt;     /* start of a deferred inner function, NULL for a normal compile */
+	duk_small_uint_t lazy_flags;        /* DUK__FUNC_FLAG_xxx for the deferred function */
+#endif
 } duk__compiler_stkstate;
 
 /*
@@ -67898,6 +74501,9 @@ DUK_LOCAL_DECL void duk__init_func_valstack_slots(duk_compiler_ctx *comp_ctx);
 DUK_LOCAL_DECL void duk__reset_func_for_pass2(duk_compiler_ctx *comp_ctx);
 DUK_LOCAL_DECL void duk__init_varmap_and_prologue_for_pass2(duk_compiler_ctx *comp_ctx, duk_regconst_t *out_stmt_value_reg);
 DUK_LOCAL_DECL void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx);
+#if defined(DUK_USE_COMPILER_LAZY)
+DUK_LOCAL_DECL void duk__convert_to_lazy_template(duk_compiler_ctx *comp_ctx, const duk_lexer_point *lazy_pt, duk_small_uint_t lazy_flags);
+#endif
 DUK_LOCAL_DECL duk_int_t duk__cleanup_varmap(duk_compiler_ctx *comp_ctx);
 
 /* code emission */
@@ -68036,6 +74642,19 @@ DUK_LOCAL_DECL duk_int_t duk__parse_func_like_fnum(duk_compiler_ctx *comp_ctx, d
 #define DUK__FUNC_FLAG_METDEF          (1 << 2)   /* Parsing an object literal method definition shorthand. */
 #define DUK__FUNC_FLAG_PUSHNAME_PASS1  (1 << 3)   /* Push function name when creating template (first pass only). */
 #define DUK__FUNC_FLAG_USE_PREVTOKEN   (1 << 4)   /* Use prev_token to start function parsing (workaround for object literal). */
+#if defined(DUK_USE_COMPILER_LAZY)
+#define DUK__FUNC_FLAG_STRICT          (1 << 5)   /* Deferred function inherits strict mode (lazy template flags only). */
+
+/* Flags needed to compile a deferred function later on. */
+#define DUK__LAZY_FUNC_FLAGS           (DUK__FUNC_FLAG_DECL | DUK__FUNC_FLAG_GETSET | \
+                                        DUK__FUNC_FLAG_METDEF | DUK__FUNC_FLAG_USE_PREVTOKEN)
+
+/* Leaf functions with a body shorter than this are compiled right away:
+ * their bytecode is about the size of a lazy template, and small helpers
+ * are the ones most likely to be called.
+ */
+#define DUK__LAZY_MIN_BODY_BYTES       128
+#endif
 
 /*
  *  Parser control values for tokens.  The token table is ordered by the
@@ -68193,6 +74812,32 @@ DUK_LOCAL const duk_uint8_t duk__token_lbp[] = {
  *  Misc helpers
  */
 
+#if defined(DUK_USE_COMPILER_STATS)
+/* Update native stack and heap high water marks.  Called at recursion,
+ * token and function template points, so leaf helpers below them (lexer,
+ * property writes) are not included in the stack figure.
+ */
+DUK_LOCAL DUK_NOINLINE void duk__comp_stats_sample(duk_compiler_ctx *comp_ctx) {
+	duk_uintptr_t p;
+	duk_size_t used;
+#if defined(DUK_USE_GET_FREE_HEAP_SIZE)
+	duk_size_t heap_free;
+#endif
+
+	p = (duk_uintptr_t) (void *) &used;
+	used = (duk_size_t) (p < comp_ctx->stats_stack_base ? comp_ctx->stats_stack_base - p : p - comp_ctx->stats_stack_base);
+	if (used > comp_ctx->stats_stack_max) {
+		comp_ctx->stats_stack_max = used;
+	}
+#if defined(DUK_USE_GET_FREE_HEAP_SIZE)
+	heap_free = (duk_size_t) DUK_USE_GET_FREE_HEAP_SIZE(comp_ctx->thr);
+	if (heap_free < comp_ctx->stats_heap_min) {
+		comp_ctx->stats_heap_min = heap_free;
+	}
+#endif
+}
+#endif  /* DUK_USE_COMPILER_STATS */
+
 DUK_LOCAL void duk__comp_recursion_increase(duk_compiler_ctx *comp_ctx) {
 	DUK_ASSERT(comp_ctx != NULL);
 	DUK_ASSERT(comp_ctx->recursion_depth >= 0);
@@ -68201,6 +74846,9 @@ DUK_LOCAL void duk__comp_recursion_increase(duk_compiler_ctx *comp_ctx) {
 		DUK_WO_NORETURN(return;);
 	}
 	comp_ctx->recursion_depth++;
+#if defined(DUK_USE_COMPILER_STATS)
+	duk__comp_stats_sample(comp_ctx);
+#endif
 }
 
 DUK_LOCAL void duk__comp_recursion_decrease(duk_compiler_ctx *comp_ctx) {
@@ -68236,6 +74884,10 @@ DUK_LOCAL void duk__advance_helper(duk_compiler_ctx *comp_ctx, duk_small_int_t e
 	DUK_ASSERT_DISABLE(comp_ctx->curr_token.t >= 0);  /* unsigned */
 	DUK_ASSERT(comp_ctx->curr_token.t <= DUK_TOK_MAXVAL);  /* MAXVAL is inclusive */
 
+#if defined(DUK_USE_COMPILER_STATS)
+	duk__comp_stats_sample(comp_ctx);
+#endif
+
 	/*
 	 *  Use current token to decide whether a RegExp can follow.
 	 *
@@ -68443,48 +75095,15 @@ DUK_LOCAL duk_int_t duk__cleanup_varmap(duk_compiler_ctx *comp_ctx) {
 	return ret;
 }
 
-/* Convert duk_compiler_func into a function template, leaving the result
- * on top of stack.
+/* Init function template flags.  Only depends on state known after pass 1
+ * and register allocation, so it is shared with lazy templates.
  */
-/* XXX: awkward and bloated asm -- use faster internal accesses */
-DUK_LOCAL void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
+DUK_LOCAL void duk__init_template_flags(duk_compiler_ctx *comp_ctx, duk_hobject *h_res) {
 	duk_compiler_func *func = &comp_ctx->curr_func;
-	duk_hthread *thr = comp_ctx->thr;
-	duk_hcompfunc *h_res;
-	duk_hbuffer_fixed *h_data;
-	duk_size_t consts_count;
-	duk_size_t funcs_count;
-	duk_size_t code_count;
-	duk_size_t code_size;
-	duk_size_t data_size;
-	duk_size_t i;
-	duk_tval *p_const;
-	duk_hobject **p_func;
-	duk_instr_t *p_instr;
-	duk_compiler_instr *q_instr;
-	duk_tval *tv;
-	duk_bool_t keep_varmap;
-	duk_bool_t keep_formals;
-#if !defined(DUK_USE_DEBUGGER_SUPPORT)
-	duk_size_t formals_length;
-#endif
-
-	DUK_DDD(DUK_DDDPRINT("converting duk_compiler_func to function/template"));
-
-	/*
-	 *  Push result object and init its flags
-	 */
-
-	/* Valstack should suffice here, required on function valstack init */
-
-	h_res = duk_push_hcompfunc(thr);
-	DUK_ASSERT(h_res != NULL);
-	DUK_ASSERT(DUK_HOBJECT_GET_PROTOTYPE(thr->heap, (duk_hobject *) h_res) == thr->builtins[DUK_BIDX_FUNCTION_PROTOTYPE]);
-	DUK_HOBJECT_SET_PROTOTYPE_UPDREF(thr, (duk_hobject *) h_res, NULL);  /* Function templates are "bare objects". */
 
 	if (func->is_function) {
 		DUK_DDD(DUK_DDDPRINT("function -> set NEWENV"));
-		DUK_HOBJECT_SET_NEWENV((duk_hobject *) h_res);
+		DUK_HOBJECT_SET_NEWENV(h_res);
 
 		if (!func->is_arguments_shadowed) {
 			/* arguments object would be accessible; note that shadowing
@@ -68495,18 +75114,18 @@ DUK_LOCAL void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
 			if (func->id_access_arguments || func->may_direct_eval) {
 				DUK_DDD(DUK_DDDPRINT("function may access 'arguments' object directly or "
 				                     "indirectly -> set CREATEARGS"));
-				DUK_HOBJECT_SET_CREATEARGS((duk_hobject *) h_res);
+				DUK_HOBJECT_SET_CREATEARGS(h_res);
 			}
 		}
 	} else if (func->is_eval && func->is_strict) {
 		DUK_DDD(DUK_DDDPRINT("strict eval code -> set NEWENV"));
-		DUK_HOBJECT_SET_NEWENV((duk_hobject *) h_res);
+		DUK_HOBJECT_SET_NEWENV(h_res);
 	} else {
 		/* non-strict eval: env is caller's env or global env (direct vs. indirect call)
 		 * global code: env is is global env
 		 */
 		DUK_DDD(DUK_DDDPRINT("non-strict eval code or global code -> no NEWENV"));
-		DUK_ASSERT(!DUK_HOBJECT_HAS_NEWENV((duk_hobject *) h_res));
+		DUK_ASSERT(!DUK_HOBJECT_HAS_NEWENV(h_res));
 	}
 
 #if defined(DUK_USE_FUNC_NAME_PROPERTY)
@@ -68516,24 +75135,94 @@ DUK_LOCAL void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
 		 * test-bug-getset-func-name.js.
 		 */
 		DUK_DDD(DUK_DDDPRINT("function expression with a name -> set NAMEBINDING"));
-		DUK_HOBJECT_SET_NAMEBINDING((duk_hobject *) h_res);
+		DUK_HOBJECT_SET_NAMEBINDING(h_res);
 	}
 #endif
 
 	if (func->is_strict) {
 		DUK_DDD(DUK_DDDPRINT("function is strict -> set STRICT"));
-		DUK_HOBJECT_SET_STRICT((duk_hobject *) h_res);
+		DUK_HOBJECT_SET_STRICT(h_res);
 	}
 
 	if (func->is_notail) {
 		DUK_DDD(DUK_DDDPRINT("function is notail -> set NOTAIL"));
-		DUK_HOBJECT_SET_NOTAIL((duk_hobject *) h_res);
+		DUK_HOBJECT_SET_NOTAIL(h_res);
 	}
 
 	if (func->is_constructable) {
 		DUK_DDD(DUK_DDDPRINT("function is constructable -> set CONSTRUCTABLE"));
-		DUK_HOBJECT_SET_CONSTRUCTABLE((duk_hobject *) h_res);
+		DUK_HOBJECT_SET_CONSTRUCTABLE(h_res);
+	}
+}
+
+/* Convert duk_compiler_func into a function template, leaving the result
+ * on top of stack.
+ */
+/* XXX: awkward and bloated asm -- use faster internal accesses */
+DUK_LOCAL void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
+	duk_compiler_func *func = &comp_ctx->curr_func;
+	duk_hthread *thr = comp_ctx->thr;
+	duk_hcompfunc *h_res;
+	duk_hbuffer_fixed *h_data;
+	duk_size_t consts_count;
+	duk_size_t funcs_count;
+	duk_size_t code_count;
+	duk_size_t code_size;
+	duk_size_t data_size;
+	duk_size_t i;
+	duk_tval *p_const;
+	duk_hobject **p_func;
+	duk_instr_t *p_instr;
+	duk_compiler_instr *q_instr;
+#if defined(DUK_USE_COMPILER_LOWMEM)
+	duk_instr_t *q_instr_packed;
+#endif
+	duk_tval *tv;
+	duk_bool_t keep_varmap;
+	duk_bool_t keep_formals;
+#if !defined(DUK_USE_DEBUGGER_SUPPORT)
+	duk_size_t formals_length;
+#endif
+
+	DUK_DDD(DUK_DDDPRINT("converting duk_compiler_func to function/template"));
+
+#if defined(DUK_USE_COMPILER_LOWMEM)
+	/*
+	 *  Squeeze the intermediate code buffer before the 'data' buffer is
+	 *  allocated so that the two don't coexist at full size: pack line
+	 *  numbers into _Pc2line first, then drop the line fields in place
+	 *  and shrink the buffer.  For a large function this is the peak of
+	 *  the whole compilation.
+	 */
+
+	code_count = DUK_BW_GET_SIZE(thr, &func->bw_code) / sizeof(duk_compiler_instr);
+	code_size = code_count * sizeof(duk_instr_t);
+	q_instr = (duk_compiler_instr *) (void *) DUK_BW_GET_BASEPTR(thr, &func->bw_code);
+#if defined(DUK_USE_PC2LINE)
+	DUK_ASSERT(code_count <= DUK_COMPILER_MAX_BYTECODE_LENGTH);
+	duk_hobject_pc2line_pack(thr, q_instr, (duk_uint_fast32_t) code_count);  /* -> [ ... pc2line ] */
+#endif
+	p_instr = (duk_instr_t *) (void *) q_instr;
+	for (i = 0; i < code_count; i++) {
+		p_instr[i] = q_instr[i].ins;  /* p_instr[i] never overlaps a later q_instr[] */
 	}
+	duk_hbuffer_resize(thr, func->bw_code.buf, code_size);
+	/* bw_code is stale from here on, only used through q_instr_packed. */
+	q_instr_packed = (duk_instr_t *) DUK_HBUFFER_DYNAMIC_GET_DATA_PTR(thr->heap, func->bw_code.buf);
+#endif  /* DUK_USE_COMPILER_LOWMEM */
+
+	/*
+	 *  Push result object and init its flags
+	 */
+
+	/* Valstack should suffice here, required on function valstack init */
+
+	h_res = duk_push_hcompfunc(thr);
+	DUK_ASSERT(h_res != NULL);
+	DUK_ASSERT(DUK_HOBJECT_GET_PROTOTYPE(thr->heap, (duk_hobject *) h_res) == thr->builtins[DUK_BIDX_FUNCTION_PROTOTYPE]);
+	DUK_HOBJECT_SET_PROTOTYPE_UPDREF(thr, (duk_hobject *) h_res, NULL);  /* Function templates are "bare objects". */
+
+	duk__init_template_flags(comp_ctx, (duk_hobject *) h_res);
 
 	/*
 	 *  Build function fixed size 'data' buffer, which contains bytecode,
@@ -68546,8 +75235,10 @@ DUK_LOCAL void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
 
 	consts_count = duk_hobject_get_length(thr, func->h_consts);
 	funcs_count = duk_hobject_get_length(thr, func->h_funcs) / 3;
+#if !defined(DUK_USE_COMPILER_LOWMEM)
 	code_count = DUK_BW_GET_SIZE(thr, &func->bw_code) / sizeof(duk_compiler_instr);
 	code_size = code_count * sizeof(duk_instr_t);
+#endif
 
 	data_size = consts_count * sizeof(duk_tval) +
 	            funcs_count * sizeof(duk_hobject *) +
@@ -68599,12 +75290,17 @@ DUK_LOCAL void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
 	p_instr = (duk_instr_t *) p_func;
 	DUK_HCOMPFUNC_SET_BYTECODE(thr->heap, h_res, p_instr);
 
+#if defined(DUK_USE_COMPILER_LOWMEM)
+	duk_memcpy_unsafe((void *) p_instr, (const void *) q_instr_packed, code_size);
+	duk_hbuffer_resize(thr, func->bw_code.buf, 0);
+#else
 	/* copy bytecode instructions one at a time */
 	q_instr = (duk_compiler_instr *) (void *) DUK_BW_GET_BASEPTR(thr, &func->bw_code);
 	for (i = 0; i < code_count; i++) {
 		p_instr[i] = q_instr[i].ins;
 	}
 	/* Note: 'q_instr' is still used below */
+#endif
 
 	DUK_ASSERT((duk_uint8_t *) (p_instr + code_count) == DUK_HBUFFER_FIXED_GET_DATA_PTR(thr->heap, h_data) + data_size);
 
@@ -68624,6 +75320,10 @@ DUK_LOCAL void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
 	h_res->nregs = (duk_uint16_t) func->temp_max;
 	h_res->nargs = (duk_uint16_t) duk_hobject_get_length(thr, func->h_argnames);
 	DUK_ASSERT(h_res->nregs >= h_res->nargs);  /* pass2 allocation handles this */
+#if defined(DUK_USE_STRING_APPEND_INPLACE)
+	DUK_ASSERT(func->temp_first >= 0 && func->temp_first <= func->temp_max);
+	h_res->temp_first = (duk_uint16_t) func->temp_first;
+#endif
 #if defined(DUK_USE_DEBUGGER_SUPPORT)
 	h_res->start_line = (duk_uint32_t) func->min_line;
 	h_res->end_line = (duk_uint32_t) func->max_line;
@@ -68779,8 +75479,15 @@ DUK_LOCAL void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
 		 *  Size-optimized pc->line mapping.
 		 */
 
+#if defined(DUK_USE_COMPILER_LOWMEM)
+		duk_pull(thr, -2);  /* [ ... pc2line res ] -> [ ... res pc2line ] */
+#else
 		DUK_ASSERT(code_count <= DUK_COMPILER_MAX_BYTECODE_LENGTH);
 		duk_hobject_pc2line_pack(thr, q_instr, (duk_uint_fast32_t) code_count);  /* -> pushes fixed buffer */
+#endif
+#if defined(DUK_USE_COMPILER_STATS)
+		duk__comp_stats_sample(comp_ctx);
+#endif
 		duk_xdef_prop_stridx_short(thr, -2, DUK_STRIDX_INT_PC2LINE, DUK_PROPDESC_FLAGS_NONE);
 
 		/* XXX: if assertions enabled, walk through all valid PCs
@@ -68804,6 +75511,10 @@ DUK_LOCAL void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
 	DUK_DD(DUK_DDPRINT("converted function: %!ixT",
 	                   (duk_tval *) duk_get_tval(thr, -1)));
 
+#if defined(DUK_USE_COMPILER_STATS)
+	comp_ctx->stats_funcs++;
+#endif
+
 	/*
 	 *  Compact the function template.
 	 */
@@ -68840,6 +75551,95 @@ DUK_LOCAL void duk__convert_to_func_template(duk_compiler_ctx *comp_ctx) {
 #endif
 }
 
+#if defined(DUK_USE_COMPILER_LAZY)
+/* Convert a pre-parsed duk_compiler_func into a lazy function template,
+ * leaving the result on top of stack.  The template has no bytecode; its
+ * 'data' holds a single constant, a bare info array:
+ *
+ *   [0] source string, replaced by the compiled template on first call
+ *   [1] byte offset of the first token after 'function' (or the method name)
+ *   [2] line number of that token
+ *   [3] DUK__FUNC_FLAG_xxx flags for compiling the function
+ *
+ * Constants are shared by closures created from the template, so the
+ * function gets compiled only once, see duk_js_compile_lazy().  Template
+ * flags and nargs match what the compiled template will have.
+ */
+DUK_LOCAL void duk__convert_to_lazy_template(duk_compiler_ctx *comp_ctx, const duk_lexer_point *lazy_pt, duk_small_uint_t lazy_flags) {
+	duk_compiler_func *func = &comp_ctx->curr_func;
+	duk_hthread *thr = comp_ctx->thr;
+	duk_hcompfunc *h_res;
+	duk_hbuffer_fixed *h_data;
+	duk_tval *tv;
+
+	if (func->in_lazy) {
+		/* Outer function gets recompiled anyway, nothing refers to
+		 * this one.
+		 */
+		duk_push_undefined(thr);
+		return;
+	}
+
+	DUK_DDD(DUK_DDDPRINT("converting duk_compiler_func to lazy template, offset=%ld, line=%ld, flags=0x%02lx",
+	                     (long) lazy_pt->offset, (long) lazy_pt->line, (unsigned long) lazy_flags));
+	DUK_ASSERT(comp_ctx->h_source != NULL);
+
+	h_res = duk_push_hcompfunc(thr);
+	DUK_ASSERT(h_res != NULL);
+	DUK_HOBJECT_SET_PROTOTYPE_UPDREF(thr, (duk_hobject *) h_res, NULL);  /* Function templates are "bare objects". */
+	duk__init_template_flags(comp_ctx, (duk_hobject *) h_res);
+
+	duk_push_bare_array(thr);
+	duk_push_hstring(thr, comp_ctx->h_source);
+	duk_put_prop_index(thr, -2, 0);
+	duk_push_size_t(thr, lazy_pt->offset);
+	duk_put_prop_index(thr, -2, 1);
+	duk_push_int(thr, lazy_pt->line);
+	duk_put_prop_index(thr, -2, 2);
+	duk_push_uint(thr, (duk_uint_t) lazy_flags);
+	duk_put_prop_index(thr, -2, 3);
+
+	duk_push_fixed_buffer_nozero(thr, sizeof(duk_tval));
+	h_data = (duk_hbuffer_fixed *) (void *) duk_known_hbuffer(thr, -1);
+	tv = (duk_tval *) (void *) DUK_HBUFFER_FIXED_GET_DATA_PTR(thr->heap, h_data);
+	DUK_TVAL_SET_OBJECT(tv, duk_known_hobject(thr, -2));
+	DUK_TVAL_INCREF(thr, tv);
+
+	DUK_HCOMPFUNC_SET_DATA(thr->heap, h_res, (duk_hbuffer *) h_data);
+	DUK_HEAPHDR_INCREF(thr, h_data);
+	DUK_HCOMPFUNC_SET_FUNCS(thr->heap, h_res, (duk_hobject **) (void *) (tv + 1));
+	DUK_HCOMPFUNC_SET_BYTECODE(thr->heap, h_res, (duk_instr_t *) (void *) (tv + 1));
+	DUK_ASSERT(DUK_HCOMPFUNC_IS_LAZY(thr->heap, h_res));
+
+	duk_pop_2(thr);
+
+	h_res->nargs = (duk_uint16_t) duk_hobject_get_length(thr, func->h_argnames);
+	h_res->nregs = h_res->nargs;
+#if defined(DUK_USE_STRING_APPEND_INPLACE)
+	h_res->temp_first = 0;
+#endif
+#if defined(DUK_USE_DEBUGGER_SUPPORT)
+	h_res->start_line = (duk_uint32_t) lazy_pt->line;
+	h_res->end_line = (duk_uint32_t) comp_ctx->curr_token.start_line;
+#endif
+
+#if defined(DUK_USE_FUNC_NAME_PROPERTY)
+	if (func->h_name) {
+		duk_push_hstring(thr, func->h_name);
+		duk_xdef_prop_stridx_short(thr, -2, DUK_STRIDX_NAME, DUK_PROPDESC_FLAGS_NONE);
+	}
+#endif
+#if defined(DUK_USE_FUNC_FILENAME_PROPERTY)
+	if (comp_ctx->h_filename) {
+		duk_push_hstring(thr, comp_ctx->h_filename);
+		duk_xdef_prop_stridx_short(thr, -2, DUK_STRIDX_FILE_NAME, DUK_PROPDESC_FLAGS_NONE);
+	}
+#endif
+
+	duk_compact_m1(thr);
+}
+#endif  /* DUK_USE_COMPILER_LAZY */
+
 /*
  *  Code emission helpers
  *
@@ -71225,6 +78025,13 @@ DUK_LOCAL void duk__expr_nud(duk_compiler_ctx *comp_ctx, duk_ivalue *res) {
 		prev_allow_in = comp_ctx->curr_func.allow_in;
 		comp_ctx->curr_func.allow_in = 1; /* reset 'allow_in' for parenthesized expression */
 
+#if defined(DUK_USE_COMPILER_LAZY)
+		/* A parenthesized function expression is almost always
+		 * called immediately, e.g. (function () { ... })().
+		 */
+		comp_ctx->lazy_eager_next = (comp_ctx->curr_token.t == DUK_TOK_FUNCTION);
+#endif
+
 		duk__expr(comp_ctx, res, DUK__BP_FOR_EXPR /*rbp_flags*/);  /* Expression, terminates at a ')' */
 
 		duk__advance_expect(comp_ctx, DUK_TOK_RPAREN);  /* No RegExp after parenthesized expression. */
@@ -75042,6 +81849,38 @@ DUK_LOCAL void duk__init_varmap_and_prologue_for_pass2(duk_compiler_ctx *comp_ct
  *  token (EOF or closing brace).
  */
 
+/* Check function name validity once strictness is known.  This only
+ * applies to function declarations and expressions, not setter/getter
+ * name.
+ */
+DUK_LOCAL void duk__check_func_name(duk_compiler_ctx *comp_ctx) {
+	duk_compiler_func *func = &comp_ctx->curr_func;
+
+	if (func->is_function && !func->is_setget && func->h_name != NULL) {
+		if (func->is_strict) {
+			if (duk__hstring_is_eval_or_arguments(comp_ctx, func->h_name)) {
+				DUK_DDD(DUK_DDDPRINT("func name is 'eval' or 'arguments' in strict mode"));
+				goto error_funcname;
+			}
+			if (DUK_HSTRING_HAS_STRICT_RESERVED_WORD(func->h_name)) {
+				DUK_DDD(DUK_DDDPRINT("func name is a reserved word in strict mode"));
+				goto error_funcname;
+			}
+		} else {
+			if (DUK_HSTRING_HAS_RESERVED_WORD(func->h_name) &&
+			    !DUK_HSTRING_HAS_STRICT_RESERVED_WORD(func->h_name)) {
+				DUK_DDD(DUK_DDDPRINT("func name is a reserved word in non-strict mode"));
+				goto error_funcname;
+			}
+		}
+	}
+	return;
+
+ error_funcname:
+	DUK_ERROR_SYNTAX(comp_ctx->thr, DUK_STR_INVALID_FUNC_NAME);
+	DUK_WO_NORETURN(return;);
+}
+
 DUK_LOCAL void duk__parse_func_body(duk_compiler_ctx *comp_ctx, duk_bool_t expect_eof, duk_bool_t implicit_return_value, duk_bool_t regexp_after, duk_small_int_t expect_token) {
 	duk_compiler_func *func;
 	duk_hthread *thr;
@@ -75139,6 +81978,58 @@ DUK_LOCAL void duk__parse_func_body(duk_compiler_ctx *comp_ctx, duk_bool_t expec
 	                 regexp_after); /* regexp after */
 	DUK_DDD(DUK_DDDPRINT("end 1st pass"));
 
+#if defined(DUK_USE_COMPILER_LAZY)
+	/*
+	 *  Deferred function: pass 1 has checked the syntax, perform the
+	 *  checks which need the final strictness (argument and function
+	 *  names) and leave code generation to duk_js_compile_lazy().
+	 *  Register allocation also detects a shadowed 'arguments' for
+	 *  the template flags.
+	 *
+	 *  The lexer is rewound for the checks so that errors are reported
+	 *  at the same position as in pass 2, and then skips to the closing
+	 *  brace like duk__parse_func_like_fnum() does on its second pass.
+	 */
+
+	if (func->is_lazy) {
+		DUK_ASSERT(!expect_eof);
+		DUK_ASSERT(comp_ctx->lex.input[comp_ctx->prev_token.start_offset] == (duk_uint8_t) DUK_ASC_RCURLY);
+
+		if (!func->in_lazy && func->fnum_next == 0 &&
+		    comp_ctx->prev_token.start_offset - lex_pt.offset < DUK__LAZY_MIN_BODY_BYTES) {
+			DUK_DDD(DUK_DDDPRINT("small leaf function, compile right away"));
+			func->is_lazy = 0;
+		} else {
+			duk_lexer_point end_pt;
+
+			DUK_DDD(DUK_DDDPRINT("deferred function, skip 2nd pass"));
+			end_pt.offset = comp_ctx->prev_token.start_offset;
+			end_pt.line = comp_ctx->prev_token.start_line;
+
+			DUK_LEXER_SETPOINT(&comp_ctx->lex, &lex_pt);
+			comp_ctx->curr_token.t = 0;  /* this is needed for regexp mode */
+			comp_ctx->curr_token.start_line = 0;  /* needed for line number tracking (becomes prev_token.start_line) */
+			duk__advance(comp_ctx);
+
+			duk__reset_func_for_pass2(comp_ctx);
+			duk__init_varmap_and_prologue_for_pass2(comp_ctx, NULL);
+			duk__check_func_name(comp_ctx);
+
+			DUK_LEXER_SETPOINT(&comp_ctx->lex, &end_pt);
+			comp_ctx->curr_token.t = 0;  /* this is needed for regexp mode */
+			comp_ctx->curr_token.start_line = 0;  /* needed for line number tracking (becomes prev_token.start_line) */
+			duk__advance(comp_ctx);
+			if (regexp_after) {
+				comp_ctx->curr_func.allow_regexp_in_adv = 1;
+			}
+			duk__advance_expect(comp_ctx, DUK_TOK_RCURLY);
+
+			DUK__RECURSION_DECREASE(comp_ctx, thr);
+			return;
+		}
+	}
+#endif
+
 	/*
 	 *  Second (and possibly third) pass.
 	 *
@@ -75204,30 +82095,11 @@ DUK_LOCAL void duk__parse_func_body(duk_compiler_ctx *comp_ctx, duk_bool_t expec
 
 		/*
 		 *  Check function name validity now that we know strictness.
-		 *  This only applies to function declarations and expressions,
-		 *  not setter/getter name.
 		 *
 		 *  See: test-dev-strict-mode-boundary.js
 		 */
 
-		if (func->is_function && !func->is_setget && func->h_name != NULL) {
-			if (func->is_strict) {
-				if (duk__hstring_is_eval_or_arguments(comp_ctx, func->h_name)) {
-					DUK_DDD(DUK_DDDPRINT("func name is 'eval' or 'arguments' in strict mode"));
-					goto error_funcname;
-				}
-				if (DUK_HSTRING_HAS_STRICT_RESERVED_WORD(func->h_name)) {
-					DUK_DDD(DUK_DDDPRINT("func name is a reserved word in strict mode"));
-					goto error_funcname;
-				}
-			} else {
-				if (DUK_HSTRING_HAS_RESERVED_WORD(func->h_name) &&
-				    !DUK_HSTRING_HAS_STRICT_RESERVED_WORD(func->h_name)) {
-					DUK_DDD(DUK_DDDPRINT("func name is a reserved word in non-strict mode"));
-					goto error_funcname;
-				}
-			}
-		}
+		duk__check_func_name(comp_ctx);
 
 		/*
 		 *  Second pass parsing.
@@ -75298,10 +82170,6 @@ DUK_LOCAL void duk__parse_func_body(duk_compiler_ctx *comp_ctx, duk_bool_t expec
 
 	DUK__RECURSION_DECREASE(comp_ctx, thr);
 	return;
-
- error_funcname:
-	DUK_ERROR_SYNTAX(thr, DUK_STR_INVALID_FUNC_NAME);
-	DUK_WO_NORETURN(return;);
 }
 
 /*
@@ -75374,6 +82242,10 @@ DUK_LOCAL void duk__parse_func_like_raw(duk_compiler_ctx *comp_ctx, duk_small_ui
 	duk_hthread *thr = comp_ctx->thr;
 	duk_token *tok;
 	duk_bool_t no_advance;
+#if defined(DUK_USE_COMPILER_LAZY)
+	duk_lexer_point lazy_pt;
+	duk_small_uint_t lazy_flags;
+#endif
 
 	DUK_ASSERT(comp_ctx->curr_func.num_formals == 0);
 	DUK_ASSERT(comp_ctx->curr_func.is_function == 1);
@@ -75407,6 +82279,18 @@ DUK_LOCAL void duk__parse_func_like_raw(duk_compiler_ctx *comp_ctx, duk_small_ui
 		tok = &comp_ctx->curr_token;
 	}
 
+#if defined(DUK_USE_COMPILER_LAZY)
+	/* A deferred function is later compiled starting from this token,
+	 * with the strictness inherited from the outer function.
+	 */
+	lazy_pt.offset = tok->start_offset;
+	lazy_pt.line = tok->start_line;
+	lazy_flags = flags & DUK__LAZY_FUNC_FLAGS;
+	if (comp_ctx->curr_func.is_strict) {
+		lazy_flags |= DUK__FUNC_FLAG_STRICT;
+	}
+#endif
+
 	if (flags & DUK__FUNC_FLAG_GETSET) {
 		/* PropertyName -> IdentifierName | StringLiteral | NumericLiteral */
 		if (tok->t_nores == DUK_TOK_IDENTIFIER || tok->t == DUK_TOK_STRING) {
@@ -75476,6 +82360,12 @@ DUK_LOCAL void duk__parse_func_like_raw(duk_compiler_ctx *comp_ctx, duk_small_ui
 	 *  to the parent function table.
 	 */
 
+#if defined(DUK_USE_COMPILER_LAZY)
+	if (comp_ctx->curr_func.is_lazy) {
+		duk__convert_to_lazy_template(comp_ctx, &lazy_pt, lazy_flags);  /* -> [ ... func ] */
+		return;
+	}
+#endif
 	duk__convert_to_func_template(comp_ctx);  /* -> [ ... func ] */
 }
 
@@ -75495,9 +82385,18 @@ DUK_LOCAL void duk__parse_func_like_raw(duk_compiler_ctx *comp_ctx, duk_small_ui
  */
 DUK_LOCAL duk_int_t duk__parse_func_like_fnum(duk_compiler_ctx *comp_ctx, duk_small_uint_t flags) {
 	duk_hthread *thr = comp_ctx->thr;
-	duk_compiler_func old_func;
+	duk_compiler_func *old_func;
+#if !defined(DUK_USE_COMPILER_LOWMEM)
+	duk_compiler_func old_func_alloc;
+#endif
 	duk_idx_t entry_top;
 	duk_int_t fnum;
+#if defined(DUK_USE_COMPILER_LAZY)
+	duk_bool_t eager;
+
+	eager = comp_ctx->lazy_eager_next;
+	comp_ctx->lazy_eager_next = 0;
+#endif
 
 	/*
 	 *  On second pass, skip the function.
@@ -75543,14 +82442,23 @@ DUK_LOCAL duk_int_t duk__parse_func_like_fnum(duk_compiler_ctx *comp_ctx, duk_sm
 	DUK_DDD(DUK_DDDPRINT("before func: entry_top=%ld, curr_tok.start_offset=%ld",
 	                     (long) entry_top, (long) comp_ctx->curr_token.start_offset));
 
-	duk_memcpy(&old_func, &comp_ctx->curr_func, sizeof(duk_compiler_func));
+#if defined(DUK_USE_COMPILER_LOWMEM)
+	/* The outer function's state is saved once per nesting level, keep
+	 * it in a value stack buffer (at entry_top) instead of the native
+	 * stack.  The buffer is fixed so the pointer remains valid.
+	 */
+	old_func = (duk_compiler_func *) duk_push_fixed_buffer_nozero(thr, sizeof(duk_compiler_func));
+#else
+	old_func = &old_func_alloc;
+#endif
+	duk_memcpy((void *) old_func, (void *) &comp_ctx->curr_func, sizeof(duk_compiler_func));
 
 	duk_memzero(&comp_ctx->curr_func, sizeof(duk_compiler_func));
 	duk__init_func_valstack_slots(comp_ctx);
 	DUK_ASSERT(comp_ctx->curr_func.num_formals == 0);
 
 	/* inherit initial strictness from parent */
-	comp_ctx->curr_func.is_strict = old_func.is_strict;
+	comp_ctx->curr_func.is_strict = old_func->is_strict;
 
 	/* XXX: It might be better to just store the flags into the curr_func
 	 * struct and use them as is without this flag interpretation step
@@ -75567,6 +82475,16 @@ DUK_LOCAL duk_int_t duk__parse_func_like_fnum(duk_compiler_ctx *comp_ctx, duk_sm
 	comp_ctx->curr_func.is_constructable = !(flags & (DUK__FUNC_FLAG_GETSET |
 	                                                  DUK__FUNC_FLAG_METDEF));  /* not constructable: objlit getset, objlit method def */
 
+#if defined(DUK_USE_COMPILER_LAZY)
+	/* Defer compilation when the source can be retained, unless the
+	 * function is likely to be called right away.  Inside a deferred
+	 * function everything is pre-parsed only.
+	 */
+	comp_ctx->curr_func.in_lazy = old_func->is_lazy;
+	comp_ctx->curr_func.is_lazy = (old_func->is_lazy ||
+	                               (comp_ctx->h_source != NULL && !eager));
+#endif
+
 	/*
 	 *  Parse inner function
 	 */
@@ -75582,8 +82500,8 @@ DUK_LOCAL duk_int_t duk__parse_func_like_fnum(duk_compiler_ctx *comp_ctx, duk_sm
 	DUK_ASSERT(comp_ctx->lex.input[comp_ctx->prev_token.start_offset] == (duk_uint8_t) DUK_ASC_RCURLY);
 
 	/* XXX: append primitive */
-	DUK_ASSERT(duk_get_length(thr, old_func.funcs_idx) == (duk_size_t) (old_func.fnum_next * 3));
-	fnum = old_func.fnum_next++;
+	DUK_ASSERT(duk_get_length(thr, old_func->funcs_idx) == (duk_size_t) (old_func->fnum_next * 3));
+	fnum = old_func->fnum_next++;
 
 	if (fnum > DUK__MAX_FUNCS) {
 		DUK_ERROR_RANGE(comp_ctx->thr, DUK_STR_FUNC_LIMIT);
@@ -75591,28 +82509,31 @@ DUK_LOCAL duk_int_t duk__parse_func_like_fnum(duk_compiler_ctx *comp_ctx, duk_sm
 	}
 
 	/* array writes autoincrement length */
-	(void) duk_put_prop_index(thr, old_func.funcs_idx, (duk_uarridx_t) (fnum * 3));
+	(void) duk_put_prop_index(thr, old_func->funcs_idx, (duk_uarridx_t) (fnum * 3));
 	duk_push_size_t(thr, comp_ctx->prev_token.start_offset);
-	(void) duk_put_prop_index(thr, old_func.funcs_idx, (duk_uarridx_t) (fnum * 3 + 1));
+	(void) duk_put_prop_index(thr, old_func->funcs_idx, (duk_uarridx_t) (fnum * 3 + 1));
 	duk_push_int(thr, comp_ctx->prev_token.start_line);
-	(void) duk_put_prop_index(thr, old_func.funcs_idx, (duk_uarridx_t) (fnum * 3 + 2));
+	(void) duk_put_prop_index(thr, old_func->funcs_idx, (duk_uarridx_t) (fnum * 3 + 2));
 
 	/*
 	 *  Cleanup: restore original function, restore valstack state.
 	 *
 	 *  Function declaration handling needs the function name to be pushed
-	 *  on the value stack.
+	 *  on the value stack.  The original function is restored before the
+	 *  value stack is unwound because old_func may live there.
 	 */
 
 	if (flags & DUK__FUNC_FLAG_PUSHNAME_PASS1) {
 		DUK_ASSERT(comp_ctx->curr_func.h_name != NULL);
 		duk_push_hstring(thr, comp_ctx->curr_func.h_name);
+	}
+	duk_memcpy((void *) &comp_ctx->curr_func, (void *) old_func, sizeof(duk_compiler_func));
+	if (flags & DUK__FUNC_FLAG_PUSHNAME_PASS1) {
 		duk_replace(thr, entry_top);
 		duk_set_top(thr, entry_top + 1);
 	} else {
 		duk_set_top(thr, entry_top);
 	}
-	duk_memcpy((void *) &comp_ctx->curr_func, (void *) &old_func, sizeof(duk_compiler_func));
 
 	return fnum;
 }
@@ -75710,6 +82631,13 @@ DUK_LOCAL duk_ret_t duk__js_compile_raw(duk_hthread *thr, void *udata) {
 
 	lex_pt->offset = 0;
 	lex_pt->line = 1;
+#if defined(DUK_USE_COMPILER_LAZY)
+	if (comp_stk->lazy_pt != NULL) {
+		/* Deferred inner function, start from its first token. */
+		DUK_ASSERT(is_funcexpr);
+		duk_memcpy((void *) lex_pt, (const void *) comp_stk->lazy_pt, sizeof(duk_lexer_point));
+	}
+#endif
 	DUK_LEXER_SETPOINT(&comp_ctx->lex, lex_pt);    /* fills window */
 	comp_ctx->curr_token.start_line = 0;  /* needed for line number tracking (becomes prev_token.start_line) */
 
@@ -75745,12 +82673,36 @@ DUK_LOCAL duk_ret_t duk__js_compile_raw(duk_hthread *thr, void *udata) {
 		func->is_function = 1;
 		DUK_ASSERT(func->is_eval == 0);
 		DUK_ASSERT(func->is_global == 0);
-		func->is_namebinding = 1;
-		func->is_constructable = 1;
+#if defined(DUK_USE_COMPILER_LAZY)
+		if (comp_stk->lazy_pt != NULL) {
+			/* Same interpretation as duk__parse_func_like_fnum(); the
+			 * lexer is at the token following 'function' (or at the
+			 * method name which must end up in prev_token).
+			 */
+			duk_small_uint_t lazy_flags = comp_stk->lazy_flags;
+
+			func->is_setget = ((lazy_flags & DUK__FUNC_FLAG_GETSET) != 0);
+			func->is_namebinding = !(lazy_flags & (DUK__FUNC_FLAG_GETSET |
+			                                       DUK__FUNC_FLAG_METDEF |
+			                                       DUK__FUNC_FLAG_DECL));
+			func->is_constructable = !(lazy_flags & (DUK__FUNC_FLAG_GETSET |
+			                                         DUK__FUNC_FLAG_METDEF));
 
-		duk__advance(comp_ctx);  /* init 'curr_token' */
-		duk__advance_expect(comp_ctx, DUK_TOK_FUNCTION);
-		(void) duk__parse_func_like_raw(comp_ctx, 0 /*flags*/);
+			duk__advance(comp_ctx);  /* init 'curr_token' */
+			if (lazy_flags & DUK__FUNC_FLAG_USE_PREVTOKEN) {
+				duk__advance(comp_ctx);
+			}
+			(void) duk__parse_func_like_raw(comp_ctx, lazy_flags);
+		} else
+#endif
+		{
+			func->is_namebinding = 1;
+			func->is_constructable = 1;
+
+			duk__advance(comp_ctx);  /* init 'curr_token' */
+			duk__advance_expect(comp_ctx, DUK_TOK_FUNCTION);
+			(void) duk__parse_func_like_raw(comp_ctx, 0 /*flags*/);
+		}
 	} else {
 		DUK_ASSERT(func->is_function == 0);
 		DUK_ASSERT(is_eval == 0 || is_eval == 1);
@@ -75764,13 +82716,16 @@ DUK_LOCAL duk_ret_t duk__js_compile_raw(duk_hthread *thr, void *udata) {
 		                     1,             /* implicit_return_value */
 		                     1,             /* regexp_after (does not matter) */
 		                     -1);           /* expect_token */
-	}
 
-	/*
-	 *  Convert duk_compiler_func to a function template
-	 */
+		/*
+		 *  Convert duk_compiler_func to a function template; for a
+		 *  function expression duk__parse_func_like_raw() has already
+		 *  done so (and with DUK_USE_COMPILER_LOWMEM consumed the code
+		 *  buffer while doing it).
+		 */
 
-	duk__convert_to_func_template(comp_ctx);
+		duk__convert_to_func_template(comp_ctx);
+	}
 
 	/*
 	 *  Wrapping duk_safe_call() will mangle the stack, just return stack top
@@ -75781,29 +82736,125 @@ DUK_LOCAL duk_ret_t duk__js_compile_raw(duk_hthread *thr, void *udata) {
 	return 1;
 }
 
-DUK_INTERNAL void duk_js_compile(duk_hthread *thr, const duk_uint8_t *src_buffer, duk_size_t src_length, duk_small_uint_t flags) {
-	duk__compiler_stkstate comp_stk;
+#if defined(DUK_USE_COMPILER_STATS)
+DUK_LOCAL void duk__comp_stats_update(duk_hthread *thr, duk_compiler_ctx *comp_ctx, duk_double_t t_start) {
+	duk_heap *heap;
+	duk_double_t t;
+
+	heap = thr->heap;
+	t = duk_time_get_monotonic_time(thr) - t_start;
+
+	heap->comp_count++;
+	heap->comp_last_funcs = comp_ctx->stats_funcs;
+	heap->comp_last_source = comp_ctx->lex.input_length;
+	heap->comp_last_stack = comp_ctx->stats_stack_max;
+	if (comp_ctx->stats_stack_max > heap->comp_max_stack) {
+		heap->comp_max_stack = comp_ctx->stats_stack_max;
+	}
+#if defined(DUK_USE_GET_FREE_HEAP_SIZE)
+	heap->comp_last_heap = comp_ctx->stats_heap_base - comp_ctx->stats_heap_min;
+	if (heap->comp_last_heap > heap->comp_max_heap) {
+		heap->comp_max_heap = heap->comp_last_heap;
+	}
+#endif
+	heap->comp_last_time = t;
+	heap->comp_total_time += t;
+
+	DUK_D(DUK_DPRINT("compiled %ld bytes into %ld functions in %lf ms, peak native stack %ld",
+	                 (long) heap->comp_last_source, (long) heap->comp_last_funcs,
+	                 (double) t, (long) heap->comp_last_stack));
+}
+#endif  /* DUK_USE_COMPILER_STATS */
+
+/* Compile with the source at stack top - 1 if it is a string: with
+ * DUK_USE_COMPILER_LAZY inner functions are then compiled on demand from
+ * that string.  'lazy_pt' is non-NULL when compiling such a function.
+ */
+DUK_LOCAL void duk__js_compile(duk_hthread *thr, const duk_uint8_t *src_buffer, duk_size_t src_length, duk_small_uint_t flags, const duk_lexer_point *lazy_pt, duk_small_uint_t lazy_flags) {
+	duk__compiler_stkstate *comp_stk;
+#if !defined(DUK_USE_COMPILER_LOWMEM)
+	duk__compiler_stkstate comp_stk_alloc;
+#endif
 	duk_compiler_ctx *prev_ctx;
 	duk_ret_t safe_rc;
+#if defined(DUK_USE_COMPILER_LAZY)
+	duk_hstring *h_source;
+#endif
+#if defined(DUK_USE_COMPILER_STATS)
+	duk_double_t t_start;
+#endif
 
 	DUK_ASSERT(thr != NULL);
 	DUK_ASSERT(src_buffer != NULL);
+#if !defined(DUK_USE_COMPILER_LAZY)
+	DUK_ASSERT(lazy_pt == NULL);
+	DUK_UNREF(lazy_pt);
+	DUK_UNREF(lazy_flags);
+#endif
+
+#if defined(DUK_USE_COMPILER_LAZY)
+	/* Deferring inner functions needs the source to remain available,
+	 * which is only the case when it is a heap string.  Callers leave it
+	 * below the filename; when compiling from an external buffer the
+	 * value there is unrelated.
+	 */
+	h_source = duk_get_hstring(thr, -2);
+	if (h_source != NULL &&
+	    ((const duk_uint8_t *) DUK_HSTRING_GET_DATA(h_source) != src_buffer ||
+	     (duk_size_t) DUK_HSTRING_GET_BYTELEN(h_source) != src_length)) {
+		h_source = NULL;
+	}
+#endif
+
+#if defined(DUK_USE_COMPILER_STATS)
+	t_start = duk_time_get_monotonic_time(thr);
+#endif
 
 	/* preinitialize lexer state partially */
-	duk_memzero(&comp_stk, sizeof(comp_stk));
-	comp_stk.flags = flags;
-	DUK_LEXER_INITCTX(&comp_stk.comp_ctx_alloc.lex);
-	comp_stk.comp_ctx_alloc.lex.input = src_buffer;
-	comp_stk.comp_ctx_alloc.lex.input_length = src_length;
-	comp_stk.comp_ctx_alloc.lex.flags = flags;  /* Forward flags directly for now. */
+#if defined(DUK_USE_COMPILER_LOWMEM)
+	/* Compiler state, including the lexer window, is a few kilobytes;
+	 * keep it in a zeroed buffer below the safe call argument instead of
+	 * the native stack.
+	 */
+	duk_require_stack(thr, 1);
+	comp_stk = (duk__compiler_stkstate *) duk_push_fixed_buffer(thr, sizeof(duk__compiler_stkstate));
+	duk_insert(thr, -2);
+#else
+	comp_stk = &comp_stk_alloc;
+	duk_memzero(comp_stk, sizeof(*comp_stk));
+#endif
+	comp_stk->flags = flags;
+#if defined(DUK_USE_COMPILER_LAZY)
+	comp_stk->lazy_pt = lazy_pt;
+	comp_stk->lazy_flags = lazy_flags;
+	comp_stk->comp_ctx_alloc.h_source = h_source;
+#endif
+	DUK_LEXER_INITCTX(&comp_stk->comp_ctx_alloc.lex);
+	comp_stk->comp_ctx_alloc.lex.input = src_buffer;
+	comp_stk->comp_ctx_alloc.lex.input_length = src_length;
+	comp_stk->comp_ctx_alloc.lex.flags = flags;  /* Forward flags directly for now. */
+#if defined(DUK_USE_COMPILER_STATS)
+	comp_stk->comp_ctx_alloc.stats_stack_base = (duk_uintptr_t) (void *) &prev_ctx;
+#if defined(DUK_USE_GET_FREE_HEAP_SIZE)
+	comp_stk->comp_ctx_alloc.stats_heap_base = (duk_size_t) DUK_USE_GET_FREE_HEAP_SIZE(thr);
+	comp_stk->comp_ctx_alloc.stats_heap_min = comp_stk->comp_ctx_alloc.stats_heap_base;
+#endif
+#endif
 
-	/* [ ... filename ] */
+	/* [ ... filename ] (or [ ... stkstate filename ] with DUK_USE_COMPILER_LOWMEM) */
 
 	prev_ctx = thr->compile_ctx;
-	thr->compile_ctx = &comp_stk.comp_ctx_alloc;  /* for duk_error_augment.c */
-	safe_rc = duk_safe_call(thr, duk__js_compile_raw, (void *) &comp_stk /*udata*/, 1 /*nargs*/, 1 /*nrets*/);
+	thr->compile_ctx = &comp_stk->comp_ctx_alloc;  /* for duk_error_augment.c */
+	safe_rc = duk_safe_call(thr, duk__js_compile_raw, (void *) comp_stk /*udata*/, 1 /*nargs*/, 1 /*nrets*/);
 	thr->compile_ctx = prev_ctx;  /* must restore reliably before returning */
 
+#if defined(DUK_USE_COMPILER_STATS)
+	duk__comp_stats_update(thr, &comp_stk->comp_ctx_alloc, t_start);
+#endif
+#if defined(DUK_USE_COMPILER_LOWMEM)
+	duk_remove(thr, -2);  /* stkstate, comp_stk no longer valid */
+#endif
+
 	if (safe_rc != DUK_EXEC_SUCCESS) {
 		DUK_D(DUK_DPRINT("compilation failed: %!T", duk_get_tval(thr, -1)));
 		(void) duk_throw(thr);
@@ -75813,6 +82864,153 @@ DUK_INTERNAL void duk_js_compile(duk_hthread *thr, const duk_uint8_t *src_buffer
 	/* [ ... template ] */
 }
 
+DUK_INTERNAL void duk_js_compile(duk_hthread *thr, const duk_uint8_t *src_buffer, duk_size_t src_length, duk_small_uint_t flags) {
+	duk__js_compile(thr, src_buffer, src_length, flags, NULL /*lazy_pt*/, 0 /*lazy_flags*/);
+}
+
+#if defined(DUK_USE_COMPILER_LAZY)
+/* Compile a lazy function on its first call and patch the bytecode into
+ * it.  The compiled template is stored into the shared info array (see
+ * duk__convert_to_lazy_template()) so that other closures of the same
+ * function only need to be patched.
+ */
+DUK_INTERNAL void duk_js_compile_lazy(duk_hthread *thr, duk_hcompfunc *func) {
+	duk_hcompfunc *h_templ;
+	duk_hbuffer_fixed *h_olddata;
+	duk_hbuffer_fixed *h_data;
+	duk_hstring *h_source;
+	duk_tval *tv;
+	duk_tval *tv_end;
+	duk_hobject **funcs;
+	duk_hobject **funcs_end;
+	duk_lexer_point lazy_pt;
+	duk_small_uint_t lazy_flags;
+	duk_small_uint_t comp_flags;
+
+	DUK_ASSERT(thr != NULL);
+	DUK_ASSERT(func != NULL);
+	DUK_ASSERT(DUK_HCOMPFUNC_IS_LAZY(thr->heap, func));
+	DUK_ASSERT(DUK_HCOMPFUNC_GET_CONSTS_COUNT(thr->heap, func) == 1);
+
+	duk_require_stack(thr, 4);
+	duk_push_hobject(thr, (duk_hobject *) func);
+	duk_push_tval(thr, DUK_HCOMPFUNC_GET_CONSTS_BASE(thr->heap, func));
+	(void) duk_get_prop_index(thr, -1, 0);
+
+	/* [ ... func info source/template ] */
+
+	if (duk_is_string(thr, -1)) {
+		h_source = duk_known_hstring(thr, -1);
+		(void) duk_get_prop_index(thr, -2, 1);
+		lazy_pt.offset = (duk_size_t) duk_to_uint(thr, -1);
+		(void) duk_get_prop_index(thr, -3, 2);
+		lazy_pt.line = duk_to_int(thr, -1);
+		(void) duk_get_prop_index(thr, -4, 3);
+		lazy_flags = (duk_small_uint_t) duk_to_uint(thr, -1);
+		duk_pop_3(thr);
+
+		DUK_DD(DUK_DDPRINT("lazy compile: offset=%ld, line=%ld, flags=0x%02lx",
+		                   (long) lazy_pt.offset, (long) lazy_pt.line, (unsigned long) lazy_flags));
+
+		comp_flags = DUK_COMPILE_FUNCEXPR;
+		if (lazy_flags & DUK__FUNC_FLAG_STRICT) {
+			comp_flags |= DUK_COMPILE_STRICT;
+		}
+		(void) duk_xget_owndataprop_stridx_short(thr, -3, DUK_STRIDX_FILE_NAME);
+
+		/* [ ... func info source filename ] */
+
+		duk__js_compile(thr,
+		                (const duk_uint8_t *) DUK_HSTRING_GET_DATA(h_source),
+		                (duk_size_t) DUK_HSTRING_GET_BYTELEN(h_source),
+		                comp_flags,
+		                &lazy_pt,
+		                lazy_flags & DUK__LAZY_FUNC_FLAGS);
+
+		/* [ ... func info source template ] */
+
+		duk_dup_top(thr);
+		duk_put_prop_index(thr, -4, 0);
+		duk_remove_m2(thr);
+	}
+
+	/* [ ... func info template ] */
+
+	h_templ = (duk_hcompfunc *) duk_known_hobject(thr, -1);
+	DUK_ASSERT(DUK_HOBJECT_IS_COMPFUNC((duk_hobject *) h_templ));
+	DUK_ASSERT(!DUK_HCOMPFUNC_IS_LAZY(thr->heap, h_templ));
+
+	if (DUK_HCOMPFUNC_IS_LAZY(thr->heap, func)) {  /* side effects may have patched it already */
+		DUK_ASSERT((DUK_HEAPHDR_GET_FLAGS((duk_heaphdr *) func) &
+		            (DUK_HOBJECT_FLAG_NEWENV | DUK_HOBJECT_FLAG_CREATEARGS | DUK_HOBJECT_FLAG_NAMEBINDING |
+		             DUK_HOBJECT_FLAG_STRICT | DUK_HOBJECT_FLAG_NOTAIL | DUK_HOBJECT_FLAG_CONSTRUCTABLE)) ==
+		           (DUK_HEAPHDR_GET_FLAGS((duk_heaphdr *) h_templ) &
+		            (DUK_HOBJECT_FLAG_NEWENV | DUK_HOBJECT_FLAG_CREATEARGS | DUK_HOBJECT_FLAG_NAMEBINDING |
+		             DUK_HOBJECT_FLAG_STRICT | DUK_HOBJECT_FLAG_NOTAIL | DUK_HOBJECT_FLAG_CONSTRUCTABLE)));
+		DUK_ASSERT(func->nargs == h_templ->nargs);
+
+		/* Same as duk_js_push_closure(): each function referencing
+		 * 'data' holds references to everything inside it.  The info
+		 * array is reachable from the value stack so releasing the
+		 * old references has no side effects.
+		 */
+		h_olddata = DUK_HCOMPFUNC_GET_DATA(thr->heap, func);
+		h_data = DUK_HCOMPFUNC_GET_DATA(thr->heap, h_templ);
+
+		DUK_HCOMPFUNC_SET_DATA(thr->heap, func, (duk_hbuffer *) h_data);
+		DUK_HCOMPFUNC_SET_FUNCS(thr->heap, func, DUK_HCOMPFUNC_GET_FUNCS(thr->heap, h_templ));
+		DUK_HCOMPFUNC_SET_BYTECODE(thr->heap, func, DUK_HCOMPFUNC_GET_BYTECODE(thr->heap, h_templ));
+		DUK_HBUFFER_INCREF(thr, h_data);
+
+		tv = DUK_HCOMPFUNC_GET_CONSTS_BASE(thr->heap, func);
+		tv_end = DUK_HCOMPFUNC_GET_CONSTS_END(thr->heap, func);
+		while (tv < tv_end) {
+			DUK_TVAL_INCREF(thr, tv);
+			tv++;
+		}
+		funcs = DUK_HCOMPFUNC_GET_FUNCS_BASE(thr->heap, func);
+		funcs_end = DUK_HCOMPFUNC_GET_FUNCS_END(thr->heap, func);
+		while (funcs < funcs_end) {
+			DUK_HEAPHDR_INCREF(thr, (duk_heaphdr *) *funcs);
+			funcs++;
+		}
+
+		DUK_HOBJECT_DECREF_NORZ(thr, duk_known_hobject(thr, -2));  /* info */
+		DUK_HBUFFER_DECREF_NORZ(thr, h_olddata);
+		DUK_UNREF(h_olddata);  /* without refcounts */
+
+		func->nregs = h_templ->nregs;
+#if defined(DUK_USE_STRING_APPEND_INPLACE)
+		func->temp_first = h_templ->temp_first;
+#endif
+#if defined(DUK_USE_DEBUGGER_SUPPORT)
+		func->start_line = h_templ->start_line;
+		func->end_line = h_templ->end_line;
+#endif
+
+		if (duk_xget_owndataprop_stridx_short(thr, -1, DUK_STRIDX_INT_VARMAP)) {
+			duk_xdef_prop_stridx_short(thr, -4, DUK_STRIDX_INT_VARMAP, DUK_PROPDESC_FLAGS_C);
+		} else {
+			duk_pop_unsafe(thr);
+		}
+		if (duk_xget_owndataprop_stridx_short(thr, -1, DUK_STRIDX_INT_FORMALS)) {
+			duk_xdef_prop_stridx_short(thr, -4, DUK_STRIDX_INT_FORMALS, DUK_PROPDESC_FLAGS_C);
+		} else {
+			duk_pop_unsafe(thr);
+		}
+#if defined(DUK_USE_PC2LINE)
+		if (duk_xget_owndataprop_stridx_short(thr, -1, DUK_STRIDX_INT_PC2LINE)) {
+			duk_xdef_prop_stridx_short(thr, -4, DUK_STRIDX_INT_PC2LINE, DUK_PROPDESC_FLAGS_C);
+		} else {
+			duk_pop_unsafe(thr);
+		}
+#endif
+	}
+
+	duk_pop_3(thr);
+}
+#endif  /* DUK_USE_COMPILER_LAZY */
+
 /* automatic undefs */
 #undef DUK__ALLOCTEMP
 #undef DUK__ALLOCTEMPS
@@ -75861,6 +83059,7 @@ DUK_INTERNAL void duk_js_compile(duk_hthread *thr, const duk_uint8_t *src_buffer
 #undef DUK__FUNC_FLAG_GETSET
 #undef DUK__FUNC_FLAG_METDEF
 #undef DUK__FUNC_FLAG_PUSHNAME_PASS1
+#undef DUK__FUNC_FLAG_STRICT
 #undef DUK__FUNC_FLAG_USE_PREVTOKEN
 #undef DUK__GETCONST_MAX_CONSTS_CHECK
 #undef DUK__GETTEMP
@@ -75874,6 +83073,8 @@ DUK_INTERNAL void duk_js_compile(duk_hthread *thr, const duk_uint8_t *src_buffer
 #undef DUK__IVAL_FLAG_ALLOW_CONST
 #undef DUK__IVAL_FLAG_REQUIRE_SHORT
 #undef DUK__IVAL_FLAG_REQUIRE_TEMP
+#undef DUK__LAZY_FUNC_FLAGS
+#undef DUK__LAZY_MIN_BODY_BYTES
 #undef DUK__MAX_ARRAY_INIT_VALUES
 #undef DUK__MAX_CONSTS
 #undef DUK__MAX_FUNCS
@@ -75974,6 +83175,80 @@ DUK_LOCAL DUK_EXEC_ALWAYS_INLINE_PERF duk_double_t duk__compute_exp(duk_double_t
 }
 #endif
 
+#if defined(DUK_USE_STRING_APPEND_INPLACE)
+/* String append in place for ADD with string operands.  The left operand
+ * string may be grown in place if every reference to it is overwritten by
+ * this instruction:
+ *
+ *   - 's += x' with 'x' side effect free compiles to ADD s, s, x: the
+ *     target register holds the only reference.
+ *
+ *   - Otherwise the left operand is in a temporary register, e.g. 's += a + b'
+ *     compiles to LDREG t, s; ADD u, a, b; ADD s, t, u.  A temporary holds
+ *     an intermediate value consumed by exactly one instruction, so it's
+ *     dead after the ADD and its reference can be moved to the target.
+ *     The only other allowed reference is the target register itself.
+ */
+DUK_LOCAL DUK_NOINLINE duk_bool_t duk__vm_string_append(duk_hthread *thr, duk_tval *tv_x, duk_tval *tv_y, duk_small_uint_fast_t idx_z) {
+	duk_hcompfunc *fun;
+	duk_tval *tv_z;
+	duk_hstring *h;
+	duk_hstring *h_res;
+	duk_tval tv_tmp;
+	duk_bool_t shared;
+
+	DUK_ASSERT(DUK_TVAL_IS_STRING(tv_x));
+	DUK_ASSERT(DUK_TVAL_IS_STRING(tv_y));
+
+	tv_z = thr->valstack_bottom + idx_z;
+	h = DUK_TVAL_GET_STRING(tv_x);
+	shared = 0;
+	if (tv_x != tv_z) {
+		DUK_ASSERT(thr->callstack_curr != NULL);
+		fun = (duk_hcompfunc *) DUK_ACT_GET_FUNC(thr->callstack_curr);
+		DUK_ASSERT(fun != NULL && DUK_HOBJECT_IS_COMPFUNC((duk_hobject *) fun));
+		if (fun->temp_first == 0 ||
+		    tv_x < thr->valstack_bottom + fun->temp_first ||
+		    tv_x >= thr->valstack_top) {
+			return 0;  /* constant or variable */
+		}
+		if (DUK_TVAL_IS_STRING(tv_z) && DUK_TVAL_GET_STRING(tv_z) == h) {
+			/* Temporary copy of the target, drop its reference
+			 * for the duration of the append.
+			 */
+			if (DUK_HEAPHDR_GET_REFCOUNT((duk_heaphdr *) h) != 2) {
+				return 0;
+			}
+			DUK_HSTRING_DECREF_NORZ(thr, h);
+			shared = 1;
+		}
+	}
+
+	h_res = duk_heap_strtable_append(thr, h, DUK_TVAL_GET_STRING(tv_y));
+	if (h_res == NULL) {
+		if (shared) {
+			DUK_HSTRING_INCREF(thr, h);
+		}
+		return 0;
+	}
+
+	/* 'h' may have been moved or freed: overwrite the old tvals
+	 * without a DECREF, the reference now belongs to 'h_res'.
+	 */
+	if (tv_x != tv_z) {
+		DUK_TVAL_SET_UNDEFINED(tv_x);
+	}
+	if (tv_x == tv_z || shared) {
+		DUK_TVAL_SET_STRING(tv_z, h_res);
+	} else {
+		DUK_TVAL_SET_TVAL(&tv_tmp, tv_z);
+		DUK_TVAL_SET_STRING(tv_z, h_res);
+		DUK_TVAL_DECREF(thr, &tv_tmp);  /* side effects */
+	}
+	return 1;
+}
+#endif  /* DUK_USE_STRING_APPEND_INPLACE */
+
 DUK_LOCAL DUK_EXEC_ALWAYS_INLINE_PERF void duk__vm_arith_add(duk_hthread *thr, duk_tval *tv_x, duk_tval *tv_y, duk_small_uint_fast_t idx_z) {
 	/*
 	 *  Addition operator is different from other arithmetic
@@ -76046,6 +83321,14 @@ DUK_LOCAL DUK_EXEC_ALWAYS_INLINE_PERF void duk__vm_arith_add(duk_hthread *thr, d
 		return;
 	}
 
+#if defined(DUK_USE_STRING_APPEND_INPLACE)
+	if (DUK_TVAL_IS_STRING(tv_x) && DUK_TVAL_IS_STRING(tv_y)) {
+		if (duk__vm_string_append(thr, tv_x, tv_y, idx_z)) {
+			return;
+		}
+	}
+#endif
+
 	/*
 	 *  Slow path: potentially requires function calls for coercion
 	 */
@@ -77917,6 +85200,18 @@ DUK_LOCAL DUK_EXEC_NOINLINE_PERF DUK_COLD duk_small_uint_t duk__executor_interru
 	}
 #endif  /* DUK_USE_EXEC_TIMEOUT_CHECK */
 
+#if defined(DUK_USE_PROFILER_SAMPLING)
+	/*
+	 *  Sampling profiler: record the current activation chain and
+	 *  schedule the next sample 'prof_interval' opcodes from now.
+	 */
+
+	if (thr->heap->prof_enabled) {
+		duk_heap_profiler_sample(thr);
+		ctr = (duk_int_t) thr->heap->prof_interval;
+	}
+#endif  /* DUK_USE_PROFILER_SAMPLING */
+
 #if defined(DUK_USE_DEBUGGER_SUPPORT)
 	if (!thr->heap->dbg_processing &&
 	    (thr->heap->dbg_read_cb != NULL || thr->heap->dbg_detaching)) {
@@ -80079,18 +87374,29 @@ DUK_LOCAL DUK_NOINLINE DUK_HOT void duk__js_execute_bytecode_inner(duk_hthread *
 		 * Occurs relatively often in object oriented code.
 		 */
 
+#if defined(DUK_USE_PROPERTY_IC)
+#define DUK__GETPROP_RAW(barg,carg) \
+		duk_hobject_getprop_ic(thr, (barg), (carg), curr_pc)
+#define DUK__PUTPROP_RAW(aarg,barg,carg) \
+		duk_hobject_putprop_ic(thr, (aarg), (barg), (carg), DUK__STRICT(), curr_pc)
+#else
+#define DUK__GETPROP_RAW(barg,carg) \
+		(void) duk_hobject_getprop(thr, (barg), (carg))
+#define DUK__PUTPROP_RAW(aarg,barg,carg) \
+		(void) duk_hobject_putprop(thr, (aarg), (barg), (carg), DUK__STRICT())
+#endif
 #define DUK__GETPROP_BODY(barg,carg) { \
 		/* A -> target reg \
 		 * B -> object reg/const (may be const e.g. in "'foo'[1]") \
 		 * C -> key reg/const \
 		 */ \
-		(void) duk_hobject_getprop(thr, (barg), (carg)); \
+		DUK__GETPROP_RAW((barg), (carg)); \
 		DUK__REPLACE_TOP_A_BREAK(); \
 	}
 #define DUK__GETPROPC_BODY(barg,carg) { \
 		/* Same as GETPROP but callability check for property-based calls. */ \
 		duk_tval *tv__targ; \
-		(void) duk_hobject_getprop(thr, (barg), (carg)); \
+		DUK__GETPROP_RAW((barg), (carg)); \
 		DUK_GC_TORTURE(thr->heap); \
 		tv__targ = DUK_GET_TVAL_NEGIDX(thr, -1); \
 		if (DUK_UNLIKELY(!duk_is_callable_tval(thr, tv__targ))) { \
@@ -80110,7 +87416,7 @@ DUK_LOCAL DUK_NOINLINE DUK_HOT void duk__js_execute_bytecode_inner(duk_hthread *
 		 * Note: intentional difference to register arrangement \
 		 * of e.g. GETPROP; 'A' must contain a register-only value. \
 		 */ \
-		(void) duk_hobject_putprop(thr, (aarg), (barg), (carg), DUK__STRICT()); \
+		DUK__PUTPROP_RAW((aarg), (barg), (carg)); \
 		break; \
 	}
 #define DUK__DELPROP_BODY(barg,carg) { \
@@ -81117,6 +88423,7 @@ DUK_LOCAL DUK_NOINLINE DUK_HOT void duk__js_execute_bytecode_inner(duk_hthread *
 #undef DUK__FUN
 #undef DUK__GETPROPC_BODY
 #undef DUK__GETPROP_BODY
+#undef DUK__GETPROP_RAW
 #undef DUK__GE_BODY
 #undef DUK__GT_BODY
 #undef DUK__INSTOF_BODY
@@ -81135,6 +88442,7 @@ DUK_LOCAL DUK_NOINLINE DUK_HOT void duk__js_execute_bytecode_inner(duk_hthread *
 #undef DUK__MASK_C
 #undef DUK__NEQ_BODY
 #undef DUK__PUTPROP_BODY
+#undef DUK__PUTPROP_RAW
 #undef DUK__RCBIT_B
 #undef DUK__RCBIT_C
 #undef DUK__REG
@@ -82808,6 +90116,9 @@ void duk_js_push_closure(duk_hthread *thr,
 
 	fun_clos->nregs = fun_temp->nregs;
 	fun_clos->nargs = fun_temp->nargs;
+#if defined(DUK_USE_STRING_APPEND_INPLACE)
+	fun_clos->temp_first = fun_temp->temp_first;
+#endif
 #if defined(DUK_USE_DEBUGGER_SUPPORT)
 	fun_clos->start_line = fun_temp->start_line;
 	fun_clos->end_line = fun_temp->end_line;
@@ -82827,13 +90138,16 @@ void duk_js_push_closure(duk_hthread *thr,
 #endif
 
 	/* Copy duk_hobject flags as is from the template using a mask.
-	 * Leave out duk_heaphdr owned flags just in case (e.g. if there's
-	 * some GC flag or similar).  Some flags can then be adjusted
-	 * separately if necessary.
+	 * Leave out duk_heaphdr owned flags: during incremental marking the
+	 * template may be grey (REACHABLE and TEMPROOT) and the closure must
+	 * keep its own GC flags.  Some flags can then be adjusted separately
+	 * if necessary.
 	 */
 
-	/* DUK_HEAPHDR_SET_FLAGS() masks changes to non-duk_heaphdr flags only. */
-	DUK_HEAPHDR_SET_FLAGS((duk_heaphdr *) fun_clos, DUK_HEAPHDR_GET_FLAGS_RAW((duk_heaphdr *) fun_temp));
+	/* DUK_HEAPHDR_SET_FLAGS() only preserves the heap type. */
+	DUK_HEAPHDR_SET_FLAGS((duk_heaphdr *) fun_clos,
+	                      (DUK_HEAPHDR_GET_FLAGS((duk_heaphdr *) fun_temp) & ~DUK_HEAPHDR_FLAGS_HEAP_MASK) |
+	                      (DUK_HEAPHDR_GET_FLAGS((duk_heaphdr *) fun_clos) & DUK_HEAPHDR_FLAGS_HEAP_MASK));
 	DUK_DD(DUK_DDPRINT("fun_temp heaphdr flags: 0x%08lx, fun_clos heaphdr flags: 0x%08lx",
 	                   (unsigned long) DUK_HEAPHDR_GET_FLAGS_RAW((duk_heaphdr *) fun_temp),
 	                   (unsigned long) DUK_HEAPHDR_GET_FLAGS_RAW((duk_heaphdr *) fun_clos)));
@@ -87436,11 +94750,6 @@ DUK_LOCAL int duk__bi_is_even(duk__bigint *x) {
 	return (x->n == 0) || ((x->v[0] & 0x01) == 0);
 }
 
-DUK_LOCAL int duk__bi_is_zero(duk__bigint *x) {
-	DUK_ASSERT(duk__bi_is_valid(x));
-	return (x->n == 0);  /* this is the case for normalized numbers */
-}
-
 /* Bigint is 2^52.  Used to detect normalized IEEE double mantissa values
  * which are at the lowest edge (next floating point value downwards has
  * a different exponent).  The lowest mantissa has the form:
@@ -87695,10 +95004,11 @@ DUK_LOCAL void duk__dragon4_prepare(duk__numconv_stringify_ctx *nc_ctx) {
 			duk__bi_set_small(&nc_ctx->s, 2);                      /* s <- 2 */
 		}
 	} else {
-		/* When doing string-to-number, lowest_mantissa is always 0 so
-		 * the exponent check, while incorrect, won't matter.
+		/* 'e' is the exponent of the integer 'f', so the minimum is
+		 * DUK__IEEE_DOUBLE_EXP_MIN - 52.  When doing string-to-number,
+		 * lowest_mantissa is always 0 so the check doesn't matter.
 		 */
-		if (nc_ctx->e > DUK__IEEE_DOUBLE_EXP_MIN /*not minimum exponent*/ &&
+		if (nc_ctx->e > DUK__IEEE_DOUBLE_EXP_MIN - 52 /*not minimum exponent*/ &&
 		    lowest_mantissa /* lowest mantissa for this exponent*/) {
 			/* r <- (* f b 2)                                [if b==2 -> (* f 4)]
 			 * s <- (* (expt b (- 1 e)) 2) == b^(1-e) * 2    [if b==2 -> b^(2-e)]
@@ -88430,6 +95740,263 @@ DUK_LOCAL void duk__dragon4_ctx_to_double(duk__numconv_stringify_ctx *nc_ctx, du
 	*x = DUK_DBLUNION_GET_DOUBLE(&u);
 }
 
+/*
+ *  Grisu3 fast path for shortest radix 10 output, based on:
+ *
+ *    Florian Loitsch: "Printing Floating-Point Numbers Quickly and
+ *    Accurately with Integers"
+ *
+ *  Only needs 64-bit integer arithmetic and a table of cached powers of
+ *  ten (~870 bytes).  Grisu3 detects the ~0.5% of inputs for which it
+ *  can't guarantee the shortest and closest digits and reports failure;
+ *  the caller then falls back to Dragon4.  When it succeeds the digits
+ *  are identical to Dragon4 free-format output.
+ */
+
+#if defined(DUK_USE_NUMCONV_STRINGIFY_FASTPATH) && defined(DUK_USE_64BIT_OPS)
+#define DUK__GRISU3
+
+/* Normalized 64-bit significands and binary exponents of 10^k for
+ * k = -348, -340, ..., 340, rounded to nearest.
+ */
+#define DUK__GRISU_CACHED_K_MIN   (-348)
+#define DUK__GRISU_CACHED_K_STEP  8
+
+DUK_LOCAL const duk_uint64_t duk__grisu_cached_f[] = {
+	DUK_U64_CONSTANT(0xfa8fd5a0081c0288), DUK_U64_CONSTANT(0xbaaee17fa23ebf76), DUK_U64_CONSTANT(0x8b16fb203055ac76),
+	DUK_U64_CONSTANT(0xcf42894a5dce35ea), DUK_U64_CONSTANT(0x9a6bb0aa55653b2d), DUK_U64_CONSTANT(0xe61acf033d1a45df),
+	DUK_U64_CONSTANT(0xab70fe17c79ac6ca), DUK_U64_CONSTANT(0xff77b1fcbebcdc4f), DUK_U64_CONSTANT(0xbe5691ef416bd60c),
+	DUK_U64_CONSTANT(0x8dd01fad907ffc3c), DUK_U64_CONSTANT(0xd3515c2831559a83), DUK_U64_CONSTANT(0x9d71ac8fada6c9b5),
+	DUK_U64_CONSTANT(0xea9c227723ee8bcb), DUK_U64_CONSTANT(0xaecc49914078536d), DUK_U64_CONSTANT(0x823c12795db6ce57),
+	DUK_U64_CONSTANT(0xc21094364dfb5637), DUK_U64_CONSTANT(0x9096ea6f3848984f), DUK_U64_CONSTANT(0xd77485cb25823ac7),
+	DUK_U64_CONSTANT(0xa086cfcd97bf97f4), DUK_U64_CONSTANT(0xef340a98172aace5), DUK_U64_CONSTANT(0xb23867fb2a35b28e),
+	DUK_U64_CONSTANT(0x84c8d4dfd2c63f3b), DUK_U64_CONSTANT(0xc5dd44271ad3cdba), DUK_U64_CONSTANT(0x936b9fcebb25c996),
+	DUK_U64_CONSTANT(0xdbac6c247d62a584), DUK_U64_CONSTANT(0xa3ab66580d5fdaf6), DUK_U64_CONSTANT(0xf3e2f893dec3f126),
+	DUK_U64_CONSTANT(0xb5b5ada8aaff80b8), DUK_U64_CONSTANT(0x87625f056c7c4a8b), DUK_U64_CONSTANT(0xc9bcff6034c13053),
+	DUK_U64_CONSTANT(0x964e858c91ba2655), DUK_U64_CONSTANT(0xdff9772470297ebd), DUK_U64_CONSTANT(0xa6dfbd9fb8e5b88f),
+	DUK_U64_CONSTANT(0xf8a95fcf88747d94), DUK_U64_CONSTANT(0xb94470938fa89bcf), DUK_U64_CONSTANT(0x8a08f0f8bf0f156b),
+	DUK_U64_CONSTANT(0xcdb02555653131b6), DUK_U64_CONSTANT(0x993fe2c6d07b7fac), DUK_U64_CONSTANT(0xe45c10c42a2b3b06),
+	DUK_U64_CONSTANT(0xaa242499697392d3), DUK_U64_CONSTANT(0xfd87b5f28300ca0e), DUK_U64_CONSTANT(0xbce5086492111aeb),
+	DUK_U64_CONSTANT(0x8cbccc096f5088cc), DUK_U64_CONSTANT(0xd1b71758e219652c), DUK_U64_CONSTANT(0x9c40000000000000),
+	DUK_U64_CONSTANT(0xe8d4a51000000000), DUK_U64_CONSTANT(0xad78ebc5ac620000), DUK_U64_CONSTANT(0x813f3978f8940984),
+	DUK_U64_CONSTANT(0xc097ce7bc90715b3), DUK_U64_CONSTANT(0x8f7e32ce7bea5c70), DUK_U64_CONSTANT(0xd5d238a4abe98068),
+	DUK_U64_CONSTANT(0x9f4f2726179a2245), DUK_U64_CONSTANT(0xed63a231d4c4fb27), DUK_U64_CONSTANT(0xb0de65388cc8ada8),
+	DUK_U64_CONSTANT(0x83c7088e1aab65db), DUK_U64_CONSTANT(0xc45d1df942711d9a), DUK_U64_CONSTANT(0x924d692ca61be758),
+	DUK_U64_CONSTANT(0xda01ee641a708dea), DUK_U64_CONSTANT(0xa26da3999aef774a), DUK_U64_CONSTANT(0xf209787bb47d6b85),
+	DUK_U64_CONSTANT(0xb454e4a179dd1877), DUK_U64_CONSTANT(0x865b86925b9bc5c2), DUK_U64_CONSTANT(0xc83553c5c8965d3d),
+	DUK_U64_CONSTANT(0x952ab45cfa97a0b3), DUK_U64_CONSTANT(0xde469fbd99a05fe3), DUK_U64_CONSTANT(0xa59bc234db398c25),
+	DUK_U64_CONSTANT(0xf6c69a72a3989f5c), DUK_U64_CONSTANT(0xb7dcbf5354e9bece), DUK_U64_CONSTANT(0x88fcf317f22241e2),
+	DUK_U64_CONSTANT(0xcc20ce9bd35c78a5), DUK_U64_CONSTANT(0x98165af37b2153df), DUK_U64_CONSTANT(0xe2a0b5dc971f303a),
+	DUK_U64_CONSTANT(0xa8d9d1535ce3b396), DUK_U64_CONSTANT(0xfb9b7cd9a4a7443c), DUK_U64_CONSTANT(0xbb764c4ca7a44410),
+	DUK_U64_CONSTANT(0x8bab8eefb6409c1a), DUK_U64_CONSTANT(0xd01fef10a657842c), DUK_U64_CONSTANT(0x9b10a4e5e9913129),
+	DUK_U64_CONSTANT(0xe7109bfba19c0c9d), DUK_U64_CONSTANT(0xac2820d9623bf429), DUK_U64_CONSTANT(0x80444b5e7aa7cf85),
+	DUK_U64_CONSTANT(0xbf21e44003acdd2d), DUK_U64_CONSTANT(0x8e679c2f5e44ff8f), DUK_U64_CONSTANT(0xd433179d9c8cb841),
+	DUK_U64_CONSTANT(0x9e19db92b4e31ba9), DUK_U64_CONSTANT(0xeb96bf6ebadf77d9), DUK_U64_CONSTANT(0xaf87023b9bf0ee6b)
+};
+
+DUK_LOCAL const duk_int16_t duk__grisu_cached_e[] = {
+	-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+	-901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+	-582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+	-263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+	56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+	375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+	694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+	1013, 1039, 1066
+};
+
+/* Upper 64 bits of the 128-bit product x * y, rounded. */
+DUK_LOCAL duk_uint64_t duk__grisu_mul(duk_uint64_t x, duk_uint64_t y) {
+	duk_uint64_t a = x >> 32;
+	duk_uint64_t b = x & 0xffffffffUL;
+	duk_uint64_t c = y >> 32;
+	duk_uint64_t d = y & 0xffffffffUL;
+	duk_uint64_t ad = a * d;
+	duk_uint64_t bc = b * c;
+	duk_uint64_t t;
+
+	t = ((b * d) >> 32) + (ad & 0xffffffffUL) + (bc & 0xffffffffUL);
+	t += DUK_U64_CONSTANT(1) << 31;  /* round */
+	return a * c + (ad >> 32) + (bc >> 32) + (t >> 32);
+}
+
+/* Normalize so that the highest bit is set; returns the updated exponent. */
+DUK_LOCAL duk_small_int_t duk__grisu_normalize(duk_uint64_t *f, duk_small_int_t e) {
+	duk_uint64_t t = *f;
+
+	DUK_ASSERT(t != 0);
+	while ((t & DUK_U64_CONSTANT(0xffc0000000000000)) == 0) {
+		t <<= 10;
+		e -= 10;
+	}
+	while ((t & DUK_U64_CONSTANT(0x8000000000000000)) == 0) {
+		t <<= 1;
+		e--;
+	}
+	*f = t;
+	return e;
+}
+
+/* Move the last digit towards 'w' while that stays within the unsafe
+ * interval, then check the result is certainly closest and within the
+ * safe interval.  Distances are scaled by 2^-e, 'unit' is the error
+ * bound.  Returns 0 if the result can't be guaranteed.
+ */
+DUK_LOCAL duk_bool_t duk__grisu3_round_weed(duk__numconv_stringify_ctx *nc_ctx,
+                                            duk_uint64_t dist_too_high_w,
+                                            duk_uint64_t unsafe_interval,
+                                            duk_uint64_t rest,
+                                            duk_uint64_t ten_kappa,
+                                            duk_uint64_t unit) {
+	duk_uint64_t small_dist = dist_too_high_w - unit;  /* distance to w + unit */
+	duk_uint64_t big_dist = dist_too_high_w + unit;    /* distance to w - unit */
+	duk_uint8_t *last = nc_ctx->digits + nc_ctx->count - 1;
+
+	DUK_ASSERT(rest <= unsafe_interval);
+	while (rest < small_dist &&
+	       unsafe_interval - rest >= ten_kappa &&
+	       (rest + ten_kappa < small_dist ||
+	        small_dist - rest >= rest + ten_kappa - small_dist)) {
+		DUK_ASSERT(*last > 0);
+		(*last)--;
+		rest += ten_kappa;
+	}
+
+	/* If the candidate could still move closer to w - unit, the
+	 * closest result is ambiguous.
+	 */
+	if (rest < big_dist &&
+	    unsafe_interval - rest >= ten_kappa &&
+	    (rest + ten_kappa < big_dist ||
+	     big_dist - rest > rest + ten_kappa - big_dist)) {
+		return 0;
+	}
+
+	return (2 * unit <= rest) && (rest <= unsafe_interval - 4 * unit);
+}
+
+/* Generate shortest digits for positive, finite, non-zero 'x' into
+ * nc_ctx->digits, setting nc_ctx->count and nc_ctx->k like
+ * duk__dragon4_generate().  Returns 0 on failure.
+ */
+DUK_LOCAL duk_bool_t duk__grisu3(duk__numconv_stringify_ctx *nc_ctx, duk_double_t x) {
+	duk_double_union u;
+	duk_uint64_t bits;
+	duk_uint64_t f, f_plus, f_minus;
+	duk_uint64_t c_f;
+	duk_uint64_t w, too_low, too_high;
+	duk_uint64_t unsafe_interval;
+	duk_uint64_t one_mask;
+	duk_uint64_t fractionals;
+	duk_uint64_t rest;
+	duk_uint64_t unit;
+	duk_uint32_t integrals;
+	duk_uint32_t divisor;
+	duk_small_int_t biased_e, e, e_plus, e_minus;
+	duk_small_int_t idx;
+	duk_small_int_t shift;
+	duk_small_int_t kappa;
+	duk_small_int_t count;
+	duk_bool_t ok;
+
+	DUK_DBLUNION_SET_DOUBLE(&u, x);
+	bits = DUK_DBLUNION_GET_UINT64(&u);
+	f = bits & DUK_U64_CONSTANT(0x000fffffffffffff);
+	biased_e = (duk_small_int_t) ((bits >> 52) & 0x07ffU);
+	DUK_ASSERT(biased_e != 0x07ff);  /* finite */
+	if (biased_e == 0) {
+		/* denormal */
+		e = DUK__IEEE_DOUBLE_EXP_MIN - 52;
+	} else {
+		f |= DUK_U64_CONSTANT(0x0010000000000000);
+		e = biased_e - DUK__IEEE_DOUBLE_EXP_BIAS - 52;
+	}
+	DUK_ASSERT(f != 0);
+
+	/* Boundaries m- and m+ halfway to the neighbours, and w, normalized
+	 * to a common exponent.  The lower gap is half as wide when the
+	 * significand is a power of two (except for the smallest normal).
+	 */
+	f_plus = (f << 1) + 1;
+	e_plus = duk__grisu_normalize(&f_plus, e - 1);
+	if ((bits & DUK_U64_CONSTANT(0x000fffffffffffff)) == 0 && biased_e > 1) {
+		f_minus = (f << 2) - 1;
+		e_minus = e - 2;
+	} else {
+		f_minus = (f << 1) - 1;
+		e_minus = e - 1;
+	}
+	f_minus <<= e_minus - e_plus;
+	f <<= e - e_plus;
+
+	/* Pick a cached power c = 10^-mk so that the scaled values have a
+	 * binary exponent in [-60,-32]: the integral part then fits into
+	 * 32 bits and the fraction part has at least 32 bits.
+	 */
+	idx = (duk_small_int_t) DUK_CEIL((double) (-60 - (e_plus + 64) + 63) * 0.30102999566398114);
+	idx = (-DUK__GRISU_CACHED_K_MIN + idx - 1) / DUK__GRISU_CACHED_K_STEP + 1;
+	DUK_ASSERT(idx >= 0 && idx < (duk_small_int_t) (sizeof(duk__grisu_cached_e) / sizeof(duk_int16_t)));
+	c_f = duk__grisu_cached_f[idx];
+	shift = -(e_plus + duk__grisu_cached_e[idx] + 64);
+	DUK_ASSERT(shift >= 32 && shift <= 60);
+
+	w = duk__grisu_mul(f, c_f);
+	too_low = duk__grisu_mul(f_minus, c_f) - 1;
+	too_high = duk__grisu_mul(f_plus, c_f) + 1;
+	unsafe_interval = too_high - too_low;
+	unit = 1;
+	one_mask = (DUK_U64_CONSTANT(1) << shift) - 1;
+
+	/* Digit generation from 'too_high', stopping as soon as the digits
+	 * are within the unsafe interval.
+	 */
+	integrals = (duk_uint32_t) (too_high >> shift);
+	fractionals = too_high & one_mask;
+	DUK_ASSERT(integrals > 0);
+	divisor = 1000000000UL;
+	kappa = 10;
+	while (divisor > integrals) {
+		divisor /= 10;
+		kappa--;
+	}
+
+	count = 0;
+	for (;;) {
+		if (kappa > 0) {
+			nc_ctx->digits[count++] = (duk_uint8_t) (integrals / divisor);
+			integrals %= divisor;
+			kappa--;
+			rest = (((duk_uint64_t) integrals) << shift) + fractionals;
+			if (rest < unsafe_interval) {
+				nc_ctx->count = count;
+				ok = duk__grisu3_round_weed(nc_ctx, too_high - w, unsafe_interval, rest,
+				                            ((duk_uint64_t) divisor) << shift, unit);
+				break;
+			}
+			divisor /= 10;
+		} else {
+			fractionals *= 10;
+			unit *= 10;
+			unsafe_interval *= 10;
+			nc_ctx->digits[count++] = (duk_uint8_t) (fractionals >> shift);
+			fractionals &= one_mask;
+			kappa--;
+			if (fractionals < unsafe_interval) {
+				nc_ctx->count = count;
+				ok = duk__grisu3_round_weed(nc_ctx, (too_high - w) * unit, unsafe_interval, fractionals,
+				                            one_mask + 1, unit);
+				break;
+			}
+		}
+		DUK_ASSERT(count < DUK__MAX_OUTPUT_DIGITS);
+	}
+
+	/* digits * 10^(mk + kappa) -> 0.digits * 10^k */
+	nc_ctx->k = count - (DUK__GRISU_CACHED_K_MIN + idx * DUK__GRISU_CACHED_K_STEP) + kappa;
+	return ok;
+}
+#endif  /* DUK_USE_NUMCONV_STRINGIFY_FASTPATH && DUK_USE_64BIT_OPS */
+
 /*
  *  Exposed number-to-string API
  *
@@ -88572,6 +96139,16 @@ DUK_LOCAL DUK_NOINLINE void duk__numconv_stringify_raw(duk_hthread *thr, duk_sma
 		goto zero_skip;
 	}
 
+#if defined(DUK__GRISU3)
+	if (radix == 10 && !nc_ctx->is_fixed) {
+		if (duk__grisu3(nc_ctx, x)) {
+			DUK_DDD(DUK_DDDPRINT("grisu3 succeeded: k=%ld, count=%ld", (long) nc_ctx->k, (long) nc_ctx->count));
+			goto digits_done;
+		}
+		DUK_DDD(DUK_DDDPRINT("grisu3 failed, fall back to dragon4"));
+	}
+#endif
+
 	duk__dragon4_double_to_ctx(nc_ctx, x);   /* -> sets 'f' and 'e' */
 	DUK__BI_PRINT("f", &nc_ctx->f);
 	DUK_DDD(DUK_DDDPRINT("e=%ld", (long) nc_ctx->e));
@@ -88603,6 +96180,9 @@ DUK_LOCAL DUK_NOINLINE void duk__numconv_stringify_raw(duk_hthread *thr, duk_sma
 	 */
 
  zero_skip:
+#if defined(DUK__GRISU3)
+ digits_done:
+#endif
 
 	if (flags & DUK_N2S_FLAG_FIXED_FORMAT) {
 		/* Perform fixed-format rounding. */
@@ -88635,6 +96215,288 @@ DUK_INTERNAL void duk_numconv_stringify(duk_hthread *thr, duk_small_int_t radix,
 	duk__numconv_stringify_raw(thr, radix, digits, flags);
 }
 
+/*
+ *  Eisel-Lemire fast path for radix 10 string-to-number conversion,
+ *  based on:
+ *
+ *    Daniel Lemire: "Number Parsing at a Gigabyte per Second"
+ *
+ *  Converts w * 10^q, where 'w' is the (at most 19 digit) decimal
+ *  significand, with a single 64x128-bit multiplication by a truncated
+ *  power of five.  Only integer arithmetic is used so the result doesn't
+ *  depend on FPU precision or soft float rounding.  The power table is
+ *  limited to |q| <= 64 which covers practically all numbers seen in
+ *  JSON data and source code; it also means the result is always a
+ *  finite normal double.  When the truncation error might affect
+ *  rounding the conversion reports failure and the caller falls back
+ *  to Dragon4.
+ */
+
+#if defined(DUK_USE_NUMCONV_PARSE_FASTPATH) && defined(DUK_USE_64BIT_OPS)
+#define DUK__EISEL_LEMIRE
+
+#define DUK__EL_POW5_Q_MIN  (-64)
+#define DUK__EL_POW5_Q_MAX  64
+
+/* 128-bit truncated significands of 5^q for q = -64, -63, ..., 64,
+ * high and low 64 bits.
+ */
+DUK_LOCAL const duk_uint64_t duk__el_pow5[] = {
+	DUK_U64_CONSTANT(0xa87fea27a539e9a5), DUK_U64_CONSTANT(0x3f2398d747b36224),
+	DUK_U64_CONSTANT(0xd29fe4b18e88640e), DUK_U64_CONSTANT(0x8eec7f0d19a03aad),
+	DUK_U64_CONSTANT(0x83a3eeeef9153e89), DUK_U64_CONSTANT(0x1953cf68300424ac),
+	DUK_U64_CONSTANT(0xa48ceaaab75a8e2b), DUK_U64_CONSTANT(0x5fa8c3423c052dd7),
+	DUK_U64_CONSTANT(0xcdb02555653131b6), DUK_U64_CONSTANT(0x3792f412cb06794d),
+	DUK_U64_CONSTANT(0x808e17555f3ebf11), DUK_U64_CONSTANT(0xe2bbd88bbee40bd0),
+	DUK_U64_CONSTANT(0xa0b19d2ab70e6ed6), DUK_U64_CONSTANT(0x5b6aceaeae9d0ec4),
+	DUK_U64_CONSTANT(0xc8de047564d20a8b), DUK_U64_CONSTANT(0xf245825a5a445275),
+	DUK_U64_CONSTANT(0xfb158592be068d2e), DUK_U64_CONSTANT(0xeed6e2f0f0d56712),
+	DUK_U64_CONSTANT(0x9ced737bb6c4183d), DUK_U64_CONSTANT(0x55464dd69685606b),
+	DUK_U64_CONSTANT(0xc428d05aa4751e4c), DUK_U64_CONSTANT(0xaa97e14c3c26b886),
+	DUK_U64_CONSTANT(0xf53304714d9265df), DUK_U64_CONSTANT(0xd53dd99f4b3066a8),
+	DUK_U64_CONSTANT(0x993fe2c6d07b7fab), DUK_U64_CONSTANT(0xe546a8038efe4029),
+	DUK_U64_CONSTANT(0xbf8fdb78849a5f96), DUK_U64_CONSTANT(0xde98520472bdd033),
+	DUK_U64_CONSTANT(0xef73d256a5c0f77c), DUK_U64_CONSTANT(0x963e66858f6d4440),
+	DUK_U64_CONSTANT(0x95a8637627989aad), DUK_U64_CONSTANT(0xdde7001379a44aa8),
+	DUK_U64_CONSTANT(0xbb127c53b17ec159), DUK_U64_CONSTANT(0x5560c018580d5d52),
+	DUK_U64_CONSTANT(0xe9d71b689dde71af), DUK_U64_CONSTANT(0xaab8f01e6e10b4a6),
+	DUK_U64_CONSTANT(0x9226712162ab070d), DUK_U64_CONSTANT(0xcab3961304ca70e8),
+	DUK_U64_CONSTANT(0xb6b00d69bb55c8d1), DUK_U64_CONSTANT(0x3d607b97c5fd0d22),
+	DUK_U64_CONSTANT(0xe45c10c42a2b3b05), DUK_U64_CONSTANT(0x8cb89a7db77c506a),
+	DUK_U64_CONSTANT(0x8eb98a7a9a5b04e3), DUK_U64_CONSTANT(0x77f3608e92adb242),
+	DUK_U64_CONSTANT(0xb267ed1940f1c61c), DUK_U64_CONSTANT(0x55f038b237591ed3),
+	DUK_U64_CONSTANT(0xdf01e85f912e37a3), DUK_U64_CONSTANT(0x6b6c46dec52f6688),
+	DUK_U64_CONSTANT(0x8b61313bbabce2c6), DUK_U64_CONSTANT(0x2323ac4b3b3da015),
+	DUK_U64_CONSTANT(0xae397d8aa96c1b77), DUK_U64_CONSTANT(0xabec975e0a0d081a),
+	DUK_U64_CONSTANT(0xd9c7dced53c72255), DUK_U64_CONSTANT(0x96e7bd358c904a21),
+	DUK_U64_CONSTANT(0x881cea14545c7575), DUK_U64_CONSTANT(0x7e50d64177da2e54),
+	DUK_U64_CONSTANT(0xaa242499697392d2), DUK_U64_CONSTANT(0xdde50bd1d5d0b9e9),
+	DUK_U64_CONSTANT(0xd4ad2dbfc3d07787), DUK_U64_CONSTANT(0x955e4ec64b44e864),
+	DUK_U64_CONSTANT(0x84ec3c97da624ab4), DUK_U64_CONSTANT(0xbd5af13bef0b113e),
+	DUK_U64_CONSTANT(0xa6274bbdd0fadd61), DUK_U64_CONSTANT(0xecb1ad8aeacdd58e),
+	DUK_U64_CONSTANT(0xcfb11ead453994ba), DUK_U64_CONSTANT(0x67de18eda5814af2),
+	DUK_U64_CONSTANT(0x81ceb32c4b43fcf4), DUK_U64_CONSTANT(0x80eacf948770ced7),
+	DUK_U64_CONSTANT(0xa2425ff75e14fc31), DUK_U64_CONSTANT(0xa1258379a94d028d),
+	DUK_U64_CONSTANT(0xcad2f7f5359a3b3e), DUK_U64_CONSTANT(0x096ee45813a04330),
+	DUK_U64_CONSTANT(0xfd87b5f28300ca0d), DUK_U64_CONSTANT(0x8bca9d6e188853fc),
+	DUK_U64_CONSTANT(0x9e74d1b791e07e48), DUK_U64_CONSTANT(0x775ea264cf55347e),
+	DUK_U64_CONSTANT(0xc612062576589dda), DUK_U64_CONSTANT(0x95364afe032a819e),
+	DUK_U64_CONSTANT(0xf79687aed3eec551), DUK_U64_CONSTANT(0x3a83ddbd83f52205),
+	DUK_U64_CONSTANT(0x9abe14cd44753b52), DUK_U64_CONSTANT(0xc4926a9672793543),
+	DUK_U64_CONSTANT(0xc16d9a0095928a27), DUK_U64_CONSTANT(0x75b7053c0f178294),
+	DUK_U64_CONSTANT(0xf1c90080baf72cb1), DUK_U64_CONSTANT(0x5324c68b12dd6339),
+	DUK_U64_CONSTANT(0x971da05074da7bee), DUK_U64_CONSTANT(0xd3f6fc16ebca5e04),
+	DUK_U64_CONSTANT(0xbce5086492111aea), DUK_U64_CONSTANT(0x88f4bb1ca6bcf585),
+	DUK_U64_CONSTANT(0xec1e4a7db69561a5), DUK_U64_CONSTANT(0x2b31e9e3d06c32e6),
+	DUK_U64_CONSTANT(0x9392ee8e921d5d07), DUK_U64_CONSTANT(0x3aff322e62439fd0),
+	DUK_U64_CONSTANT(0xb877aa3236a4b449), DUK_U64_CONSTANT(0x09befeb9fad487c3),
+	DUK_U64_CONSTANT(0xe69594bec44de15b), DUK_U64_CONSTANT(0x4c2ebe687989a9b4),
+	DUK_U64_CONSTANT(0x901d7cf73ab0acd9), DUK_U64_CONSTANT(0x0f9d37014bf60a11),
+	DUK_U64_CONSTANT(0xb424dc35095cd80f), DUK_U64_CONSTANT(0x538484c19ef38c95),
+	DUK_U64_CONSTANT(0xe12e13424bb40e13), DUK_U64_CONSTANT(0x2865a5f206b06fba),
+	DUK_U64_CONSTANT(0x8cbccc096f5088cb), DUK_U64_CONSTANT(0xf93f87b7442e45d4),
+	DUK_U64_CONSTANT(0xafebff0bcb24aafe), DUK_U64_CONSTANT(0xf78f69a51539d749),
+	DUK_U64_CONSTANT(0xdbe6fecebdedd5be), DUK_U64_CONSTANT(0xb573440e5a884d1c),
+	DUK_U64_CONSTANT(0x89705f4136b4a597), DUK_U64_CONSTANT(0x31680a88f8953031),
+	DUK_U64_CONSTANT(0xabcc77118461cefc), DUK_U64_CONSTANT(0xfdc20d2b36ba7c3e),
+	DUK_U64_CONSTANT(0xd6bf94d5e57a42bc), DUK_U64_CONSTANT(0x3d32907604691b4d),
+	DUK_U64_CONSTANT(0x8637bd05af6c69b5), DUK_U64_CONSTANT(0xa63f9a49c2c1b110),
+	DUK_U64_CONSTANT(0xa7c5ac471b478423), DUK_U64_CONSTANT(0x0fcf80dc33721d54),
+	DUK_U64_CONSTANT(0xd1b71758e219652b), DUK_U64_CONSTANT(0xd3c36113404ea4a9),
+	DUK_U64_CONSTANT(0x83126e978d4fdf3b), DUK_U64_CONSTANT(0x645a1cac083126ea),
+	DUK_U64_CONSTANT(0xa3d70a3d70a3d70a), DUK_U64_CONSTANT(0x3d70a3d70a3d70a4),
+	DUK_U64_CONSTANT(0xcccccccccccccccc), DUK_U64_CONSTANT(0xcccccccccccccccd),
+	DUK_U64_CONSTANT(0x8000000000000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xa000000000000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xc800000000000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xfa00000000000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0x9c40000000000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xc350000000000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xf424000000000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0x9896800000000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xbebc200000000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xee6b280000000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0x9502f90000000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xba43b74000000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xe8d4a51000000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0x9184e72a00000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xb5e620f480000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xe35fa931a0000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0x8e1bc9bf04000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xb1a2bc2ec5000000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xde0b6b3a76400000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0x8ac7230489e80000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xad78ebc5ac620000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xd8d726b7177a8000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0x878678326eac9000), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xa968163f0a57b400), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xd3c21bcecceda100), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0x84595161401484a0), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xa56fa5b99019a5c8), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0xcecb8f27f4200f3a), DUK_U64_CONSTANT(0x0000000000000000),
+	DUK_U64_CONSTANT(0x813f3978f8940984), DUK_U64_CONSTANT(0x4000000000000000),
+	DUK_U64_CONSTANT(0xa18f07d736b90be5), DUK_U64_CONSTANT(0x5000000000000000),
+	DUK_U64_CONSTANT(0xc9f2c9cd04674ede), DUK_U64_CONSTANT(0xa400000000000000),
+	DUK_U64_CONSTANT(0xfc6f7c4045812296), DUK_U64_CONSTANT(0x4d00000000000000),
+	DUK_U64_CONSTANT(0x9dc5ada82b70b59d), DUK_U64_CONSTANT(0xf020000000000000),
+	DUK_U64_CONSTANT(0xc5371912364ce305), DUK_U64_CONSTANT(0x6c28000000000000),
+	DUK_U64_CONSTANT(0xf684df56c3e01bc6), DUK_U64_CONSTANT(0xc732000000000000),
+	DUK_U64_CONSTANT(0x9a130b963a6c115c), DUK_U64_CONSTANT(0x3c7f400000000000),
+	DUK_U64_CONSTANT(0xc097ce7bc90715b3), DUK_U64_CONSTANT(0x4b9f100000000000),
+	DUK_U64_CONSTANT(0xf0bdc21abb48db20), DUK_U64_CONSTANT(0x1e86d40000000000),
+	DUK_U64_CONSTANT(0x96769950b50d88f4), DUK_U64_CONSTANT(0x1314448000000000),
+	DUK_U64_CONSTANT(0xbc143fa4e250eb31), DUK_U64_CONSTANT(0x17d955a000000000),
+	DUK_U64_CONSTANT(0xeb194f8e1ae525fd), DUK_U64_CONSTANT(0x5dcfab0800000000),
+	DUK_U64_CONSTANT(0x92efd1b8d0cf37be), DUK_U64_CONSTANT(0x5aa1cae500000000),
+	DUK_U64_CONSTANT(0xb7abc627050305ad), DUK_U64_CONSTANT(0xf14a3d9e40000000),
+	DUK_U64_CONSTANT(0xe596b7b0c643c719), DUK_U64_CONSTANT(0x6d9ccd05d0000000),
+	DUK_U64_CONSTANT(0x8f7e32ce7bea5c6f), DUK_U64_CONSTANT(0xe4820023a2000000),
+	DUK_U64_CONSTANT(0xb35dbf821ae4f38b), DUK_U64_CONSTANT(0xdda2802c8a800000),
+	DUK_U64_CONSTANT(0xe0352f62a19e306e), DUK_U64_CONSTANT(0xd50b2037ad200000),
+	DUK_U64_CONSTANT(0x8c213d9da502de45), DUK_U64_CONSTANT(0x4526f422cc340000),
+	DUK_U64_CONSTANT(0xaf298d050e4395d6), DUK_U64_CONSTANT(0x9670b12b7f410000),
+	DUK_U64_CONSTANT(0xdaf3f04651d47b4c), DUK_U64_CONSTANT(0x3c0cdd765f114000),
+	DUK_U64_CONSTANT(0x88d8762bf324cd0f), DUK_U64_CONSTANT(0xa5880a69fb6ac800),
+	DUK_U64_CONSTANT(0xab0e93b6efee0053), DUK_U64_CONSTANT(0x8eea0d047a457a00),
+	DUK_U64_CONSTANT(0xd5d238a4abe98068), DUK_U64_CONSTANT(0x72a4904598d6d880),
+	DUK_U64_CONSTANT(0x85a36366eb71f041), DUK_U64_CONSTANT(0x47a6da2b7f864750),
+	DUK_U64_CONSTANT(0xa70c3c40a64e6c51), DUK_U64_CONSTANT(0x999090b65f67d924),
+	DUK_U64_CONSTANT(0xd0cf4b50cfe20765), DUK_U64_CONSTANT(0xfff4b4e3f741cf6d),
+	DUK_U64_CONSTANT(0x82818f1281ed449f), DUK_U64_CONSTANT(0xbff8f10e7a8921a4),
+	DUK_U64_CONSTANT(0xa321f2d7226895c7), DUK_U64_CONSTANT(0xaff72d52192b6a0d),
+	DUK_U64_CONSTANT(0xcbea6f8ceb02bb39), DUK_U64_CONSTANT(0x9bf4f8a69f764490),
+	DUK_U64_CONSTANT(0xfee50b7025c36a08), DUK_U64_CONSTANT(0x02f236d04753d5b4),
+	DUK_U64_CONSTANT(0x9f4f2726179a2245), DUK_U64_CONSTANT(0x01d762422c946590),
+	DUK_U64_CONSTANT(0xc722f0ef9d80aad6), DUK_U64_CONSTANT(0x424d3ad2b7b97ef5),
+	DUK_U64_CONSTANT(0xf8ebad2b84e0d58b), DUK_U64_CONSTANT(0xd2e0898765a7deb2),
+	DUK_U64_CONSTANT(0x9b934c3b330c8577), DUK_U64_CONSTANT(0x63cc55f49f88eb2f),
+	DUK_U64_CONSTANT(0xc2781f49ffcfa6d5), DUK_U64_CONSTANT(0x3cbf6b71c76b25fb)
+};
+
+/* Full 128-bit product x * y: returns the low 64 bits, stores the high
+ * 64 bits into 'hi'.
+ */
+DUK_LOCAL duk_uint64_t duk__el_mul(duk_uint64_t x, duk_uint64_t y, duk_uint64_t *hi) {
+	duk_uint64_t a = x >> 32;
+	duk_uint64_t b = x & 0xffffffffUL;
+	duk_uint64_t c = y >> 32;
+	duk_uint64_t d = y & 0xffffffffUL;
+	duk_uint64_t ad = a * d;
+	duk_uint64_t bc = b * c;
+	duk_uint64_t bd = b * d;
+	duk_uint64_t t;
+
+	t = (bd >> 32) + (ad & 0xffffffffUL) + (bc & 0xffffffffUL);
+	*hi = a * c + (ad >> 32) + (bc >> 32) + (t >> 32);
+	return (t << 32) | (bd & 0xffffffffUL);
+}
+
+/* x <- w */
+DUK_LOCAL void duk__bi_set_u64(duk__bigint *x, duk_uint64_t w) {
+	x->v[0] = (duk_uint32_t) w;
+	x->v[1] = (duk_uint32_t) (w >> 32);
+	x->n = 2;
+	duk__bi_normalize(x);
+}
+
+/* Convert w * 10^q into the closest double (ties to even).  Returns 0
+ * if the result can't be determined here, 'out' is then untouched.
+ */
+DUK_INTERNAL duk_bool_t duk_numconv_parse_decimal(duk_uint64_t w, duk_int_t q, duk_double_t *out) {
+	duk_double_union du;
+	duk_uint64_t hi;
+	duk_uint64_t lo;
+	duk_uint64_t hi2;
+	duk_uint64_t mant;
+	duk_int_t power2;
+	duk_small_int_t lz;
+	duk_small_int_t upperbit;
+	duk_small_int_t shift;
+	duk_small_int_t idx;
+
+	if (w == 0) {
+		*out = 0.0;
+		return 1;
+	}
+	if (q == 0 && w <= (DUK_U64_CONSTANT(1) << 53)) {
+		/* Exactly representable integer. */
+		*out = (duk_double_t) (duk_int64_t) w;
+		return 1;
+	}
+	if (q < DUK__EL_POW5_Q_MIN || q > DUK__EL_POW5_Q_MAX) {
+		return 0;
+	}
+
+	lz = 0;
+	while ((w & DUK_U64_CONSTANT(0xff00000000000000)) == 0) {
+		w <<= 8;
+		lz += 8;
+	}
+	while ((w & DUK_U64_CONSTANT(0x8000000000000000)) == 0) {
+		w <<= 1;
+		lz++;
+	}
+
+	/* Product of the normalized significand and 5^q.  The truncated
+	 * 64-bit power is enough unless the bits below the 55 needed for
+	 * rounding are all set; then add the next 64 bits of the power.
+	 */
+	idx = (duk_small_int_t) ((q - DUK__EL_POW5_Q_MIN) * 2);
+	lo = duk__el_mul(w, duk__el_pow5[idx], &hi);
+	if ((hi & 0x1ffU) == 0x1ffU) {
+		(void) duk__el_mul(w, duk__el_pow5[idx + 1], &hi2);
+		lo += hi2;
+		if (lo < hi2) {
+			hi++;
+		}
+		if (lo == DUK_U64_CONSTANT(0xffffffffffffffff) && (q < -27 || q > 55)) {
+			/* Product may still be off by one in the lowest
+			 * bit, can't decide.
+			 */
+			return 0;
+		}
+	}
+
+	/* 53 bits plus a rounding bit; the product has 0 or 1 leading zero. */
+	upperbit = (duk_small_int_t) (hi >> 63);
+	shift = upperbit + 9;
+	mant = hi >> shift;
+
+	/* power2 = floor(q * log2(10)) + 63 + upperbit - lz + bias; the
+	 * log2 approximation is exact well beyond the table range.  Avoid
+	 * shifting negative values to the right.
+	 */
+	if (q >= 0) {
+		power2 = (217706 * q) >> 16;
+	} else {
+		power2 = -((217706 * -q + 65535) >> 16);
+	}
+	power2 += 63 + upperbit - lz + 1023;
+
+	/* Exactly halfway between two doubles: can only happen for small q
+	 * where the product is exact; round to even instead of up.
+	 */
+	if (lo <= 1 && q >= -4 && q <= 23 && (mant & 3U) == 1U &&
+	    (mant << shift) == hi) {
+		mant &= ~DUK_U64_CONSTANT(1);
+	}
+
+	mant += mant & 1U;
+	mant >>= 1;
+	if (mant >= (DUK_U64_CONSTANT(1) << 53)) {
+		/* Rounded up to the next power of two. */
+		mant = DUK_U64_CONSTANT(1) << 52;
+		power2++;
+	}
+	DUK_ASSERT(power2 > 0 && power2 < 0x7ff);  /* no denormals or infinities for |q| <= 64 */
+
+	mant &= ~(DUK_U64_CONSTANT(1) << 52);
+	DUK_DBLUNION_SET_UINT64(&du, mant | ((duk_uint64_t) power2 << 52));
+	*out = DUK_DBLUNION_GET_DOUBLE(&du);
+	return 1;
+}
+#endif  /* DUK_USE_NUMCONV_PARSE_FASTPATH && DUK_USE_64BIT_OPS */
+
 /*
  *  Exposed string-to-number API
  *
@@ -88663,6 +96525,9 @@ DUK_LOCAL DUK_NOINLINE void duk__numconv_parse_raw(duk_hthread *thr, duk_small_i
 	const duk__exp_limits *explim;
 	const duk_uint8_t *p;
 	duk_small_int_t ch;
+#if defined(DUK__EISEL_LEMIRE)
+	duk_uint64_t w;  /* radix 10 significand while it fits, 'f' is then unused */
+#endif
 
 	DUK_DDD(DUK_DDDPRINT("parse number: %!T, radix=%ld, flags=0x%08lx",
 	                     (duk_tval *) duk_get_tval(thr, -1),
@@ -88821,6 +96686,9 @@ DUK_LOCAL DUK_NOINLINE void duk__numconv_parse_raw(duk_hthread *thr, duk_small_i
 	 */
 
 	duk__bi_set_small(&nc_ctx->f, 0);
+#if defined(DUK__EISEL_LEMIRE)
+	w = 0;
+#endif
 	dig_prec = 0;
 	dig_lzero = 0;
 	dig_whole = 0;
@@ -88926,8 +96794,8 @@ DUK_LOCAL DUK_NOINLINE void duk__numconv_parse_raw(duk_hthread *thr, duk_small_i
 			if (dig_prec < duk__str2num_digits_for_radix[radix - 2]) {
 				/* significant from precision perspective */
 
-				duk_small_int_t f_zero = duk__bi_is_zero(&nc_ctx->f);
-				if (f_zero && dig == 0) {
+				/* 'f' is zero until the first precision digit. */
+				if (dig_prec == 0 && dig == 0) {
 					/* Leading zero is not counted towards precision digits; not
 					 * in the integer part, nor in the fraction part.
 					 */
@@ -88935,11 +96803,26 @@ DUK_LOCAL DUK_NOINLINE void duk__numconv_parse_raw(duk_hthread *thr, duk_small_i
 						dig_lzero++;
 					}
 				} else {
+#if defined(DUK__EISEL_LEMIRE)
+					if (radix == 10 && dig_prec < 19) {
+						/* 19 decimal digits always fit into 64 bits. */
+						w = w * 10U + (duk_uint64_t) dig;
+					} else {
+						if (radix == 10) {
+							/* 20th digit, continue with a bigint. */
+							DUK_ASSERT(dig_prec == 19);
+							duk__bi_set_u64(&nc_ctx->f, w);
+						}
+						duk__bi_mul_small(&nc_ctx->t1, &nc_ctx->f, (duk_uint32_t) radix);
+						duk__bi_add_small(&nc_ctx->f, &nc_ctx->t1, (duk_uint32_t) dig);
+					}
+#else
 					/* XXX: join these ops (multiply-accumulate), but only if
 					 * code footprint decreases.
 					 */
 					duk__bi_mul_small(&nc_ctx->t1, &nc_ctx->f, (duk_uint32_t) radix);
 					duk__bi_add_small(&nc_ctx->f, &nc_ctx->t1, (duk_uint32_t) dig);
+#endif
 					dig_prec++;
 				}
 			} else {
@@ -89043,6 +96926,18 @@ DUK_LOCAL DUK_NOINLINE void duk__numconv_parse_raw(duk_hthread *thr, duk_small_i
 	                     (long) expt, (long) expt_adj, (long) (expt + expt_adj)));
 	expt += expt_adj;
 
+#if defined(DUK__EISEL_LEMIRE)
+	if (radix == 10 && dig_prec <= 19) {
+		/* All digits are in 'w', 'f' hasn't been set up yet. */
+		DUK_ASSERT(expt_adj <= 0);
+		if (duk_numconv_parse_decimal(w, expt, &res)) {
+			DUK_DDD(DUK_DDDPRINT("eisel-lemire number parse"));
+			goto negcheck_and_ret;
+		}
+		duk__bi_set_u64(&nc_ctx->f, w);
+	}
+#endif
+
 	/* Fast path check. */
 
 	if (nc_ctx->f.n <= 1 &&   /* 32-bit value */
@@ -89184,6 +97079,12 @@ DUK_INTERNAL void duk_numconv_parse(duk_hthread *thr, duk_small_int_t radix, duk
 #undef DUK__BI_PRINT
 #undef DUK__DIGITCHAR
 #undef DUK__DRAGON4_OUTPUT_PREINC
+#undef DUK__EISEL_LEMIRE
+#undef DUK__EL_POW5_Q_MAX
+#undef DUK__EL_POW5_Q_MIN
+#undef DUK__GRISU3
+#undef DUK__GRISU_CACHED_K_MIN
+#undef DUK__GRISU_CACHED_K_STEP
 #undef DUK__IEEE_DOUBLE_EXP_BIAS
 #undef DUK__IEEE_DOUBLE_EXP_MIN
 #undef DUK__MAX_FORMATTED_LENGTH
@@ -90306,6 +98207,327 @@ DUK_LOCAL void duk__create_escaped_source(duk_hthread *thr, int idx_pattern) {
 	/* [ ... escaped_source ] */
 }
 
+#if defined(DUK_USE_REGEXP_PREFILTER)
+/*
+ *  Prefilter analysis.
+ *
+ *  Walk the compiled bytecode to find out which characters a match can
+ *  start with, whether every match starts with a literal ASCII prefix,
+ *  and whether a match is only possible at the start of the input.  The
+ *  matcher uses the result to skip input positions which can't start a
+ *  match without running the backtracking matcher on them.  Anything the
+ *  walk doesn't understand (e.g. a possibly empty match) gives up.
+ */
+
+/* Maximum number of opcodes walked, also bounds the recursion. */
+#define DUK__RE_PF_BUDGET 64
+
+typedef struct {
+	duk_re_compiler_ctx *re_ctx;
+	const duk_uint8_t *p_start;
+	const duk_uint8_t *p_end;
+	duk_int_t budget;
+	duk_uint32_t first[4];      /* bitmap of ASCII characters a match can start with */
+	duk_bool_t first_nonascii;  /* a match can also start with a non-ASCII character */
+} duk__re_pf_ctx;
+
+DUK_LOCAL duk_uint32_t duk__re_pf_get_u32(duk__re_pf_ctx *pf, const duk_uint8_t **pc) {
+	return (duk_uint32_t) duk_unicode_decode_xutf8_checked(pf->re_ctx->thr, pc, pf->p_start, pf->p_end);
+}
+
+DUK_LOCAL duk_int32_t duk__re_pf_get_i32(duk__re_pf_ctx *pf, const duk_uint8_t **pc) {
+	duk_uint32_t t;
+
+	t = duk__re_pf_get_u32(pf, pc);
+	if (t & 1) {
+		return -((duk_int32_t) (t >> 1));
+	} else {
+		return (duk_int32_t) (t >> 1);
+	}
+}
+
+/* Add the ASCII input characters matching a CHAR (n < 0, 'cp' given) or a
+ * RANGES/INVRANGES opcode (n >= 0, ranges read from 'pc').  The matcher
+ * canonicalizes the input character before comparison when ignoring case,
+ * and ASCII characters canonicalize into ASCII characters.
+ */
+DUK_LOCAL void duk__re_pf_add_chars(duk__re_pf_ctx *pf, const duk_uint8_t **pc, duk_codepoint_t cp, duk_int32_t n, duk_bool_t invert) {
+	duk_uint32_t in_set[4];
+	duk_bool_t ignore_case;
+	duk_codepoint_t r1, r2;
+	duk_codepoint_t c;
+	duk_small_uint_t i;
+
+	duk_memzero((void *) in_set, sizeof(in_set));
+	if (n < 0) {
+		if (cp < 0x80L) {
+			in_set[cp >> 5] |= 1UL << (cp & 0x1f);
+		} else {
+			pf->first_nonascii = 1;
+		}
+	} else {
+		while (n-- > 0) {
+			r1 = (duk_codepoint_t) duk__re_pf_get_u32(pf, pc);
+			r2 = (duk_codepoint_t) duk__re_pf_get_u32(pf, pc);
+			if (r2 >= 0x80L) {
+				pf->first_nonascii = 1;
+				r2 = 0x7fL;
+			}
+			for (c = r1; c <= r2; c++) {
+				in_set[c >> 5] |= 1UL << (c & 0x1f);
+			}
+		}
+		if (invert) {
+			pf->first_nonascii = 1;
+		}
+	}
+
+	ignore_case = (pf->re_ctx->re_flags & DUK_RE_FLAG_IGNORE_CASE) != 0;
+	if (ignore_case) {
+		pf->first_nonascii = 1;
+	}
+	for (i = 0; i < 0x80U; i++) {
+		c = ignore_case ? duk_unicode_re_canonicalize_char(pf->re_ctx->thr, (duk_codepoint_t) i) : (duk_codepoint_t) i;
+		DUK_ASSERT(c >= 0 && c < 0x80L);
+		if (((in_set[c >> 5] >> (c & 0x1f)) & 0x01U) != (duk_uint32_t) invert) {
+			pf->first[i >> 5] |= 1UL << (i & 0x1f);
+		}
+	}
+}
+
+/* Add the characters a match starting at 'pc' can begin with.  Returns 0
+ * if they can't be determined.
+ */
+DUK_LOCAL duk_bool_t duk__re_pf_first(duk__re_pf_ctx *pf, const duk_uint8_t *pc) {
+	for (;;) {
+		duk_small_uint_t op;
+		duk_uint32_t qmin;
+		duk_int32_t skip;
+
+		if (--pf->budget < 0 || pc < pf->p_start || pc >= pf->p_end) {
+			return 0;
+		}
+
+		op = *pc++;
+		switch (op) {
+		case DUK_REOP_SAVE: {
+			(void) duk__re_pf_get_u32(pf, &pc);
+			break;
+		}
+		case DUK_REOP_WIPERANGE: {
+			(void) duk__re_pf_get_u32(pf, &pc);
+			(void) duk__re_pf_get_u32(pf, &pc);
+			break;
+		}
+		case DUK_REOP_ASSERT_START:
+		case DUK_REOP_ASSERT_END:
+		case DUK_REOP_ASSERT_WORD_BOUNDARY:
+		case DUK_REOP_ASSERT_NOT_WORD_BOUNDARY: {
+			/* Zero width: the match still begins with what follows. */
+			break;
+		}
+		case DUK_REOP_LOOKPOS:
+		case DUK_REOP_LOOKNEG:
+		case DUK_REOP_JUMP: {
+			skip = duk__re_pf_get_i32(pf, &pc);
+			pc += skip;
+			break;
+		}
+		case DUK_REOP_SPLIT1:
+		case DUK_REOP_SPLIT2: {
+			skip = duk__re_pf_get_i32(pf, &pc);
+			if (!duk__re_pf_first(pf, pc)) {
+				return 0;
+			}
+			pc += skip;
+			break;
+		}
+		case DUK_REOP_SQMINIMAL:
+		case DUK_REOP_SQGREEDY: {
+			qmin = duk__re_pf_get_u32(pf, &pc);
+			(void) duk__re_pf_get_u32(pf, &pc);  /* qmax */
+			if (op == DUK_REOP_SQGREEDY) {
+				(void) duk__re_pf_get_u32(pf, &pc);  /* atomlen */
+			}
+			skip = duk__re_pf_get_i32(pf, &pc);
+			if (!duk__re_pf_first(pf, pc)) {
+				return 0;
+			}
+			if (qmin > 0) {
+				return 1;
+			}
+			pc += skip;
+			break;
+		}
+		case DUK_REOP_CHAR: {
+			duk__re_pf_add_chars(pf, NULL, (duk_codepoint_t) duk__re_pf_get_u32(pf, &pc), -1, 0);
+			return 1;
+		}
+		case DUK_REOP_RANGES:
+		case DUK_REOP_INVRANGES: {
+			duk_uint32_t n;
+
+			n = duk__re_pf_get_u32(pf, &pc);
+			if (n > 0x7fffffffUL) {
+				return 0;
+			}
+			duk__re_pf_add_chars(pf, &pc, 0, (duk_int32_t) n, op == DUK_REOP_INVRANGES);
+			return 1;
+		}
+		default: {
+			/* DUK_REOP_MATCH (possibly empty match), DUK_REOP_PERIOD,
+			 * DUK_REOP_BACKREFERENCE: no useful set.
+			 */
+			return 0;
+		}
+		}
+	}
+}
+
+/* Analyze the bytecode and insert the prefilter info (if any) at the
+ * start of the bytecode buffer.  Inserted in reverse order, the format is:
+ *
+ *   uint   pf_flags (DUK_RE_PF_xxx)
+ *   uint   first[4] (if DUK_RE_PF_FIRST)
+ *   uint   prefix_len
+ *   uint   prefix[prefix_len]
+ */
+DUK_LOCAL void duk__re_prefilter_insert(duk_re_compiler_ctx *re_ctx) {
+	duk__re_pf_ctx pf;
+	const duk_uint8_t *pc;
+	duk_uint8_t prefix[DUK_RE_PF_MAX_PREFIX];
+	duk_small_uint_t prefix_len;
+	duk_small_uint_t pf_flags;
+	duk_small_int_t i;
+	duk_uint32_t c;
+
+	duk_memzero(&pf, sizeof(pf));
+	pf.re_ctx = re_ctx;
+	pf.p_start = DUK_BW_GET_BASEPTR(re_ctx->thr, &re_ctx->bw);
+	pf.p_end = DUK_BW_GET_PTR(re_ctx->thr, &re_ctx->bw);
+	pf.budget = DUK__RE_PF_BUDGET;
+
+	/* Leading '^' and literal prefix, skipping saves. */
+	pf_flags = 0;
+	prefix_len = 0;
+	pc = pf.p_start;
+	while (pc < pf.p_end) {
+		if (*pc == DUK_REOP_SAVE) {
+			pc++;
+			(void) duk__re_pf_get_u32(&pf, &pc);
+		} else if (*pc == DUK_REOP_ASSERT_START && prefix_len == 0 &&
+		           !(re_ctx->re_flags & DUK_RE_FLAG_MULTILINE)) {
+			pf_flags |= DUK_RE_PF_ANCHORED;
+			break;
+		} else if (*pc == DUK_REOP_CHAR && prefix_len < DUK_RE_PF_MAX_PREFIX &&
+		           !(re_ctx->re_flags & DUK_RE_FLAG_IGNORE_CASE)) {
+			pc++;
+			c = duk__re_pf_get_u32(&pf, &pc);
+			if (c >= 0x80UL) {
+				break;
+			}
+			prefix[prefix_len++] = (duk_uint8_t) c;
+		} else {
+			break;
+		}
+	}
+
+	if (pf_flags & DUK_RE_PF_ANCHORED) {
+		/* Only one position to try, nothing else is useful. */
+		;
+	} else if (prefix_len > 0) {
+		pf.first[prefix[0] >> 5] = 1UL << (prefix[0] & 0x1f);
+		pf_flags |= DUK_RE_PF_FIRST;
+	} else if (duk__re_pf_first(&pf, pf.p_start)) {
+		if (!pf.first_nonascii ||
+		    (pf.first[0] & pf.first[1] & pf.first[2] & pf.first[3]) != 0xffffffffUL) {
+			pf_flags |= DUK_RE_PF_FIRST;
+			if (pf.first_nonascii) {
+				pf_flags |= DUK_RE_PF_FIRST_NONASCII;
+			}
+		}
+	}
+
+	DUK_DD(DUK_DDPRINT("regexp prefilter: pf_flags=0x%02lx, first=%08lx %08lx %08lx %08lx, prefix_len=%ld",
+	                   (unsigned long) pf_flags, (unsigned long) pf.first[0], (unsigned long) pf.first[1],
+	                   (unsigned long) pf.first[2], (unsigned long) pf.first[3], (long) prefix_len));
+
+	if (pf_flags == 0) {
+		return;
+	}
+	for (i = (duk_small_int_t) prefix_len - 1; i >= 0; i--) {
+		(void) duk__insert_u32(re_ctx, 0, (duk_uint32_t) prefix[i]);
+	}
+	(void) duk__insert_u32(re_ctx, 0, (duk_uint32_t) prefix_len);
+	if (pf_flags & DUK_RE_PF_FIRST) {
+		for (i = 3; i >= 0; i--) {
+			(void) duk__insert_u32(re_ctx, 0, pf.first[i]);
+		}
+	}
+	(void) duk__insert_u32(re_ctx, 0, (duk_uint32_t) pf_flags);
+	re_ctx->re_flags |= DUK_RE_FLAG_PREFILTER;
+}
+#endif  /* DUK_USE_REGEXP_PREFILTER */
+
+#if defined(DUK_USE_REGEXP_CACHE)
+/*
+ *  RegExp compile cache.
+ *
+ *  A small heap-wide list of recently compiled regexps in LRU order.  The
+ *  pattern and flags strings are interned so pointer comparison suffices.
+ *  Each entry holds a reference to its strings.
+ */
+
+/* [ ... pattern flags ] -> [ ... escaped_source bytecode ] on a hit. */
+DUK_LOCAL duk_bool_t duk__regexp_cache_lookup(duk_hthread *thr, duk_hstring *h_pattern, duk_hstring *h_flags) {
+	duk_re_cache_entry *cache;
+	duk_re_cache_entry tmp;
+	duk_small_uint_t i;
+
+	cache = thr->heap->re_cache;
+	for (i = 0; i < DUK_USE_REGEXP_CACHE_SIZE; i++) {
+		if (cache[i].pattern == h_pattern && cache[i].flags == h_flags) {
+			DUK_DD(DUK_DDPRINT("regexp cache hit at index %ld: %!O", (long) i, (duk_heaphdr *) h_pattern));
+			if (i > 0) {
+				tmp = cache[i];
+				duk_memmove((void *) (cache + 1), (const void *) cache, sizeof(duk_re_cache_entry) * i);
+				cache[0] = tmp;
+			}
+			duk_pop_2(thr);  /* cache keeps pattern and flags reachable */
+			duk_push_hstring(thr, cache[0].source);
+			duk_push_hstring(thr, cache[0].bytecode);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Insert as most recently used, dropping the least recently used entry. */
+DUK_LOCAL void duk__regexp_cache_insert(duk_hthread *thr, duk_hstring *h_pattern, duk_hstring *h_flags, duk_hstring *h_source, duk_hstring *h_bytecode) {
+	duk_re_cache_entry *cache;
+	duk_re_cache_entry old;
+
+	cache = thr->heap->re_cache;
+	old = cache[DUK_USE_REGEXP_CACHE_SIZE - 1];
+	duk_memmove((void *) (cache + 1), (const void *) cache, sizeof(duk_re_cache_entry) * (DUK_USE_REGEXP_CACHE_SIZE - 1));
+	cache[0].pattern = h_pattern;
+	cache[0].flags = h_flags;
+	cache[0].source = h_source;
+	cache[0].bytecode = h_bytecode;
+	DUK_HSTRING_INCREF(thr, h_pattern);
+	DUK_HSTRING_INCREF(thr, h_flags);
+	DUK_HSTRING_INCREF(thr, h_source);
+	DUK_HSTRING_INCREF(thr, h_bytecode);
+
+	if (old.pattern != NULL) {
+		DUK_HSTRING_DECREF(thr, old.pattern);  /* side effects: strings freed */
+		DUK_HSTRING_DECREF(thr, old.flags);
+		DUK_HSTRING_DECREF(thr, old.source);
+		DUK_HSTRING_DECREF(thr, old.bytecode);
+	}
+}
+#endif  /* DUK_USE_REGEXP_CACHE */
+
 /*
  *  Exposed regexp compilation primitive.
  *
@@ -90338,6 +98560,13 @@ DUK_INTERNAL void duk_regexp_compile(duk_hthread *thr) {
 	h_pattern = duk_require_hstring_notsymbol(thr, -2);
 	h_flags = duk_require_hstring_notsymbol(thr, -1);
 
+#if defined(DUK_USE_REGEXP_CACHE)
+	if (duk__regexp_cache_lookup(thr, h_pattern, h_flags)) {
+		/* [ ... escaped_source bytecode ] */
+		return;
+	}
+#endif
+
 	/*
 	 *  Create normalized 'source' property (E5 Section 15.10.3).
 	 */
@@ -90405,10 +98634,13 @@ DUK_INTERNAL void duk_regexp_compile(duk_hthread *thr) {
 	}
 
 	/*
-	 *  Emit compiled regexp header: flags, ncaptures
+	 *  Emit compiled regexp header: flags, ncaptures, prefilter info
 	 *  (insertion order inverted on purpose)
 	 */
 
+#if defined(DUK_USE_REGEXP_PREFILTER)
+	duk__re_prefilter_insert(&re_ctx);
+#endif
 	duk__insert_u32(&re_ctx, 0, (re_ctx.captures + 1) * 2);
 	duk__insert_u32(&re_ctx, 0, re_ctx.re_flags);
 
@@ -90419,6 +98651,10 @@ DUK_INTERNAL void duk_regexp_compile(duk_hthread *thr) {
 
 	/* [ ... pattern flags escaped_source bytecode ] */
 
+#if defined(DUK_USE_REGEXP_CACHE)
+	duk__regexp_cache_insert(thr, h_pattern, h_flags, duk_known_hstring(thr, -2), duk_known_hstring(thr, -1));
+#endif
+
 	/*
 	 *  Finalize stack
 	 */
@@ -90482,6 +98718,7 @@ DUK_INTERNAL void duk_regexp_create_instance(duk_hthread *thr) {
 /* automatic undefs */
 #undef DUK__RE_BUFLEN
 #undef DUK__RE_INITIAL_BUFSIZE
+#undef DUK__RE_PF_BUDGET
 /*
  *  Regexp executor.
  *
@@ -91155,6 +99392,92 @@ DUK_LOCAL const duk_uint8_t *duk__match_regexp(duk_re_matcher_ctx *re_ctx, const
 	DUK_WO_NORETURN(return NULL;);
 }
 
+#if defined(DUK_USE_REGEXP_PREFILTER)
+/*
+ *  Prefilter: skip input positions which can't start a match.
+ *
+ *  The compiler may prepend a description of the characters a match can
+ *  start with to the bytecode (see duk__re_prefilter_insert()).  Positions
+ *  which can't start a match are skipped with a cheap byte scan instead of
+ *  a full backtracking attempt.
+ */
+
+typedef struct {
+	duk_small_uint_t flags;
+	duk_uint32_t first[4];
+	duk_uint8_t prefix[DUK_RE_PF_MAX_PREFIX];
+	duk_small_uint_t prefix_len;
+} duk__re_prefilter;
+
+DUK_LOCAL void duk__re_prefilter_read(duk_re_matcher_ctx *re_ctx, const duk_uint8_t **pc, duk__re_prefilter *pf) {
+	duk_uint32_t t;
+	duk_small_uint_t i;
+
+	pf->flags = (duk_small_uint_t) duk__bc_get_u32(re_ctx, pc);
+	if (pf->flags & DUK_RE_PF_FIRST) {
+		for (i = 0; i < 4; i++) {
+			pf->first[i] = duk__bc_get_u32(re_ctx, pc);
+		}
+	}
+	t = duk__bc_get_u32(re_ctx, pc);
+	if (t > DUK_RE_PF_MAX_PREFIX) {
+		DUK_ERROR_INTERNAL(re_ctx->thr);
+		DUK_WO_NORETURN(return;);
+	}
+	pf->prefix_len = (duk_small_uint_t) t;
+	for (i = 0; i < pf->prefix_len; i++) {
+		pf->prefix[i] = (duk_uint8_t) duk__bc_get_u32(re_ctx, pc);
+	}
+}
+
+/* Advance 'sp' to the first position at or after 'sp' which may start a
+ * match, updating '*char_offset' to match.  Returns NULL if there's no such
+ * position.  Steps over characters the same way as duk__utf8_advance().
+ */
+DUK_LOCAL const duk_uint8_t *duk__re_prefilter_skip(duk_re_matcher_ctx *re_ctx, duk__re_prefilter *pf, duk_hstring *h_input, const duk_uint8_t *sp, duk_uint32_t *char_offset) {
+	const duk_uint8_t *p;
+	const duk_uint8_t *p_end;
+	duk_uint8_t t;
+
+	p = sp;
+	p_end = re_ctx->input_end;
+
+	if (pf->prefix_len > 0 && DUK_HSTRING_IS_ASCII(h_input)) {
+		/* Byte offsets are character offsets. */
+		for (;;) {
+			p = (const duk_uint8_t *) DUK_MEMCHR((const void *) p, (int) pf->prefix[0], (size_t) (p_end - p));
+			if (p == NULL || (duk_size_t) (p_end - p) < (duk_size_t) pf->prefix_len) {
+				return NULL;
+			}
+			if (duk_memcmp((const void *) p, (const void *) pf->prefix, (size_t) pf->prefix_len) == 0) {
+				*char_offset += (duk_uint32_t) (p - sp);
+				return p;
+			}
+			p++;
+		}
+	}
+
+	while (p < p_end) {
+		t = *p;
+		if (t < 0x80U) {
+			if ((pf->first[t >> 5] & (1UL << (t & 0x1fU))) &&
+			    (pf->prefix_len <= 1 ||
+			     ((duk_size_t) (p_end - p) >= (duk_size_t) pf->prefix_len &&
+			      duk_memcmp((const void *) p, (const void *) pf->prefix, (size_t) pf->prefix_len) == 0))) {
+				return p;
+			}
+		} else if (pf->flags & DUK_RE_PF_FIRST_NONASCII) {
+			return p;
+		}
+		do {
+			p++;
+		} while (p < p_end && (*p & 0xc0U) == 0x80U);
+		(*char_offset)++;
+	}
+	return NULL;
+}
+#endif  /* DUK_USE_REGEXP_PREFILTER */
+
 /*
  *  Exposed matcher function which provides the semantics of RegExp.prototype.exec().
  *
@@ -91180,6 +99503,9 @@ DUK_LOCAL void duk__regexp_match_helper(duk_hthread *thr, duk_small_int_t force_
 	duk_uint_fast32_t i;
 	double d;
 	duk_uint32_t char_offset;
+#if defined(DUK_USE_REGEXP_PREFILTER)
+	duk__re_prefilter pf;
+#endif
 
 	DUK_ASSERT(thr != NULL);
 
@@ -91214,6 +99540,7 @@ DUK_LOCAL void duk__regexp_match_helper(duk_hthread *thr, duk_small_int_t force_
 	 *
 	 *    uint   flags
 	 *    uint   nsaved (even, 2n+2 where n = num captures)
+	 *    ...    prefilter info (if DUK_RE_FLAG_PREFILTER)
 	 */
 
 	/* [ ... re_obj input bc ] */
@@ -91233,6 +99560,12 @@ DUK_LOCAL void duk__regexp_match_helper(duk_hthread *thr, duk_small_int_t force_
 	pc = re_ctx.bytecode;
 	re_ctx.re_flags = duk__bc_get_u32(&re_ctx, &pc);
 	re_ctx.nsaved = duk__bc_get_u32(&re_ctx, &pc);
+#if defined(DUK_USE_REGEXP_PREFILTER)
+	duk_memzero(&pf, sizeof(pf));
+	if (re_ctx.re_flags & DUK_RE_FLAG_PREFILTER) {
+		duk__re_prefilter_read(&re_ctx, &pc, &pf);
+	}
+#endif
 	re_ctx.bytecode = pc;
 
 	DUK_ASSERT(DUK_RE_FLAG_GLOBAL < 0x10000UL);  /* must fit into duk_small_int_t */
@@ -91317,6 +99650,19 @@ DUK_LOCAL void duk__regexp_match_helper(duk_hthread *thr, duk_small_int_t force_
 	DUK_ASSERT(match == 0);
 
 	for (;;) {
+#if defined(DUK_USE_REGEXP_PREFILTER)
+		if (pf.flags & DUK_RE_PF_FIRST) {
+			/* A match consumes at least one character so the end
+			 * of input never needs to be tried.
+			 */
+			sp = duk__re_prefilter_skip(&re_ctx, &pf, h_input, sp, &char_offset);
+			if (sp == NULL) {
+				DUK_DDD(DUK_DDDPRINT("no match, prefilter rejected rest of input"));
+				break;
+			}
+		}
+#endif
+
 		/* char offset in [0, h_input->clen] (both ends inclusive), checked before entry */
 		DUK_ASSERT_DISABLE(char_offset >= 0);
 		DUK_ASSERT(char_offset <= DUK_HSTRING_GET_CHARLEN(h_input));
@@ -91341,10 +99687,9 @@ DUK_LOCAL void duk__regexp_match_helper(duk_hthread *thr, duk_small_int_t force_
 		 *
 		 *    - If we supported anchored matches, we would break out here
 		 *      unconditionally; however, ECMAScript regexps don't have anchored
-		 *      matches.  It might make sense to implement a fast bail-out if
-		 *      the regexp begins with '^' and sp is not 0: currently we'll just
-		 *      run through the entire input string, trivially failing the match
-		 *      at every non-zero offset.
+		 *      matches.  A regexp beginning with '^' (without the multiline
+		 *      flag) can only match at offset 0, so the prefilter bails out
+		 *      after the first attempt.
 		 */
 
 		if (duk__match_regexp(&re_ctx, re_ctx.bytecode, sp) != NULL) {
@@ -91353,6 +99698,13 @@ DUK_LOCAL void duk__regexp_match_helper(duk_hthread *thr, duk_small_int_t force_
 			break;
 		}
 
+#if defined(DUK_USE_REGEXP_PREFILTER)
+		if (pf.flags & DUK_RE_PF_ANCHORED) {
+			DUK_DDD(DUK_DDDPRINT("no match, anchored regexp failed at first offset"));
+			break;
+		}
+#endif
+
 		/* advance by one character (code point) and one char_offset */
 		char_offset++;
 		if (char_offset > DUK_HSTRING_GET_CHARLEN(h_input)) {
@@ -142,12 +142,24 @@ static void mos_duk_init_done_handler(int ev, void *ev_data, void *userdata) {
   }
 
   LOG(LL_DEBUG, ("Calling main function"));
-  duk_push_string(ctx, source_code);
+  duk_push_lstring(ctx, source_code, size);
   free(source_code); // free before eval to have more resources
-  duk_ret_t rc = duk_module_node_peval_main(ctx, main_file);
+  // consumes the source, so it's freed once compiled
+  duk_ret_t rc = duk_module_node_peval_main_consume(ctx, main_file);
   if (rc != 0) {
     mos_duk_log_error(ctx);
   }
+  duk_pop(ctx); // module or error
+
+#if MOS_DUK_ENABLE_COMPILER_STATS
+  duk_compile_inspect(ctx);
+  duk_get_prop_string(ctx, -1, "maxHeapBytes");
+  duk_get_prop_string(ctx, -2, "maxStackBytes");
+  duk_get_prop_string(ctx, -3, "totalMs");
+  LOG(LL_INFO, ("Compile peak heap: %d, peak native stack: %d bytes (%d ms)",
+                duk_get_int(ctx, -3), duk_get_int(ctx, -2), duk_get_int(ctx, -1)));
+  duk_pop_n(ctx, 4);
+#endif
 }
 
 bool mgos_duk_init(void) {
@@ -15,6 +15,7 @@
 #include "mgos_time.h"
 
 #include "mos_duk_utils.h"
+#include "mos_duk.h"
 
 // taken from https://github.com/nkolban/duktape-esp32/blob/28b4fb194665039ec7a907d346e9c2cd44e387df/main/include/duktape_utils.h
 #define ADD_FUNCTION(FUNCTION_NAME_STRING, FUNCTION_NAME, PARAM_COUNT) \
@@ -143,6 +144,7 @@ static void mos_duk_timer_cb_handler(void* arg) {
     mos_duk_log_error(ctx);
   }
   duk_pop(ctx);
+  mos_duk_gc_note_busy();
 }
 
 static duk_ret_t mos_duk_func__set_interval(duk_context* ctx) {
@@ -355,6 +357,7 @@ static void mos_duk_event_cb_handler(int ev, void *ev_data, void *userdata) {
     mos_duk_log_error(ctx);
   }
   duk_pop(ctx);
+  mos_duk_gc_note_busy();
 }
 
 static duk_ret_t mos_duk_func__event_on(duk_context* ctx) {
@@ -417,6 +420,56 @@ static duk_ret_t mos_duk_func__gpio_read(duk_context* ctx) {
   return 1;
 }
 
+#if MOS_DUK_ENABLE_PROFILER
+// MOS.Profiler.start([interval])
+static duk_ret_t mos_duk_func__profiler_start(duk_context* ctx) {
+  // interval is in executed opcodes, 0 uses the default
+  duk_uint_t interval = duk_get_uint_default(ctx, 0, 0);
+  duk_profiler_start(ctx, interval);
+  return 0;
+}
+
+static duk_ret_t mos_duk_func__profiler_stop(duk_context* ctx) {
+  duk_profiler_stop(ctx);
+  return 0;
+}
+
+// MOS.Profiler.folded(): folded stacks, one "a:1;b:2 count" per line
+static duk_ret_t mos_duk_func__profiler_folded(duk_context* ctx) {
+  duk_profiler_push_folded(ctx);
+  return 1;
+}
+
+// MOS.Profiler.stats(): sample counts and time spent sampling
+static duk_ret_t mos_duk_func__profiler_stats(duk_context* ctx) {
+  duk_profiler_inspect(ctx);
+  return 1;
+}
+#endif
+
+#if MOS_DUK_ENABLE_INSTRUMENTATION
+// MOS.Profiler.instrument(enabled)
+static duk_ret_t mos_duk_func__profiler_instrument(duk_context* ctx) {
+  bool enabled = duk_require_boolean(ctx, 0);
+  duk_profiler_instrument(ctx, enabled);
+  return 0;
+}
+
+// MOS.Profiler.report(): [{name, fileName, lineNumber, calls, time}, ...]
+static duk_ret_t mos_duk_func__profiler_report(duk_context* ctx) {
+  duk_profiler_push_report(ctx);
+  return 1;
+}
+#endif
+
+#if MOS_DUK_ENABLE_PROFILER || MOS_DUK_ENABLE_INSTRUMENTATION
+// MOS.Profiler.reset(): clears samples and call counters
+static duk_ret_t mos_duk_func__profiler_reset(duk_context* ctx) {
+  duk_profiler_reset(ctx);
+  return 0;
+}
+#endif
+
 static duk_ret_t mos_duk_func__sys_heap_size(duk_context* ctx) {
   duk_push_int(ctx, mgos_get_heap_size());
   return 1;
@@ -481,6 +534,48 @@ static duk_ret_t mos_duk_func__sys_restart(duk_context* ctx) {
   return 0;
 }
 
+// MOS.System.gcStep([budgetMs]): true if a GC cycle was completed
+static duk_ret_t mos_duk_func__sys_gc_step(duk_context* ctx) {
+  // without MOS_DUK_ENABLE_INCREMENTAL_GC every step is a full GC
+  double budget = duk_get_number_default(ctx, 0, DUK_USE_MARK_AND_SWEEP_STEP_BUDGET);
+  duk_push_boolean(ctx, duk_gc_step(ctx, budget));
+  return 1;
+}
+
+// MOS.System.gcOnIdle(budgetMs[, compact]): collect while no callbacks run, 0 disables
+static duk_ret_t mos_duk_func__sys_gc_on_idle(duk_context* ctx) {
+  double budget = duk_require_number(ctx, 0);
+  bool compact = duk_get_boolean_default(ctx, 1, false);
+  mgos_duk_gc_on_idle(budget, compact);
+  return 0;
+}
+
+#if MOS_DUK_ENABLE_GC_STATS
+// MOS.System.gcStats(): {cycles, steps, pauses, pauseTotalMs, pauseMaxMs,
+//   idleCollections, allocCollections, histogram}
+static duk_ret_t mos_duk_func__sys_gc_stats(duk_context* ctx) {
+  duk_gc_inspect(ctx);
+  return 1;
+}
+#endif
+
+#if MOS_DUK_ENABLE_PROPERTY_IC
+// MOS.System.icStats(): {size, used, getHits, getMisses, putHits, putMisses}
+static duk_ret_t mos_duk_func__sys_ic_stats(duk_context* ctx) {
+  duk_ic_inspect(ctx);
+  return 1;
+}
+#endif
+
+#if MOS_DUK_ENABLE_COMPILER_STATS
+// MOS.System.compileStats(): {compiles, totalMs, lastMs, lastSourceBytes,
+//   lastFunctions, lastStackBytes, maxStackBytes, lastHeapBytes, maxHeapBytes}
+static duk_ret_t mos_duk_func__sys_compile_stats(duk_context* ctx) {
+  duk_compile_inspect(ctx);
+  return 1;
+}
+#endif
+
 static duk_ret_t mos_duk_func__mos_time_set(duk_context* ctx) {
   duk_int_t top = duk_get_top(ctx);
   if (top > 2 || top < 1) {
@@ -590,6 +685,25 @@ void mos_duk_define_functions(duk_context* ctx) {
   // TODO write NET handlers
   // TODO write OneWire handlers
   // TODO write PWM handlers
+  // MOS Profiler
+  duk_push_object(ctx); // MOS.Profiler
+#if MOS_DUK_ENABLE_PROFILER || MOS_DUK_ENABLE_INSTRUMENTATION
+  ADD_BOOLEAN("enabled", true);
+  ADD_FUNCTION("reset", mos_duk_func__profiler_reset, 0);
+#else
+  ADD_BOOLEAN("enabled", false);
+#endif
+#if MOS_DUK_ENABLE_PROFILER
+  ADD_FUNCTION("start", mos_duk_func__profiler_start, DUK_VARARGS);
+  ADD_FUNCTION("stop", mos_duk_func__profiler_stop, 0);
+  ADD_FUNCTION("folded", mos_duk_func__profiler_folded, 0);
+  ADD_FUNCTION("stats", mos_duk_func__profiler_stats, 0);
+#endif
+#if MOS_DUK_ENABLE_INSTRUMENTATION
+  ADD_FUNCTION("instrument", mos_duk_func__profiler_instrument, 1);
+  ADD_FUNCTION("report", mos_duk_func__profiler_report, 0);
+#endif
+  duk_put_prop_string(ctx, -2, "Profiler");
   // TODO write SPI handlers
   // MOS System
   duk_push_object(ctx); // MOS.System
@@ -604,6 +718,17 @@ void mos_duk_define_functions(duk_context* ctx) {
   ADD_FUNCTION("wdtSetTimeout", mos_duk_func__sys_wdt_set_timeout, 1);
   ADD_FUNCTION("wdt", mos_duk_func__sys_wdt, 1);
   ADD_FUNCTION("restart", mos_duk_func__sys_restart, 0);
+  ADD_FUNCTION("gcStep", mos_duk_func__sys_gc_step, DUK_VARARGS);
+  ADD_FUNCTION("gcOnIdle", mos_duk_func__sys_gc_on_idle, DUK_VARARGS);
+#if MOS_DUK_ENABLE_GC_STATS
+  ADD_FUNCTION("gcStats", mos_duk_func__sys_gc_stats, 0);
+#endif
+#if MOS_DUK_ENABLE_PROPERTY_IC
+  ADD_FUNCTION("icStats", mos_duk_func__sys_ic_stats, 0);
+#endif
+#if MOS_DUK_ENABLE_COMPILER_STATS
+  ADD_FUNCTION("compileStats", mos_duk_func__sys_compile_stats, 0);
+#endif
   // TODO: locks, enable/disable interrupts and sleep
   duk_put_prop_string(ctx, -2, "System");
   // MOS Time
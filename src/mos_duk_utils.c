@@ -2,6 +2,19 @@
 
 #include "common/cs_dbg.h"
 
+#include "mgos_mongoose.h"
+#include "mgos_time.h"
+
+#include "mos_duk.h"
+
+/* Quiet period after the last JS callback before idle GC kicks in. */
+#define MOS_DUK_GC_IDLE_QUIET_MS 20.0
+
+static double s_gc_idle_budget = 0;
+static duk_uint_t s_gc_idle_flags = 0;
+static double s_gc_last_busy = 0;
+static bool s_gc_idle_registered = false;
+
 void mos_duk_log_error(duk_context *ctx) {
 	duk_idx_t errObjIdx = duk_get_top_index(ctx); // err object
 	duk_get_prop_string(ctx, errObjIdx, "name");
@@ -21,4 +34,33 @@ void mos_duk_log_error(duk_context *ctx) {
 			stack != NULL ? stack : "NULL"
   ));
 	duk_pop_n(ctx, 4);
-}
\ No newline at end of file
+}
+
+double mos_duk_get_monotonic_time(void) {
+	return mgos_uptime() * 1000.0;
+}
+
+void mos_duk_gc_note_busy(void) {
+	s_gc_last_busy = mos_duk_get_monotonic_time();
+}
+
+static void mos_duk_gc_idle_poll_cb(void *arg) {
+	duk_context *ctx = mgos_duk_get_global();
+	if (ctx == NULL || s_gc_idle_budget <= 0) {
+		return;
+	}
+	if (mos_duk_get_monotonic_time() - s_gc_last_busy < MOS_DUK_GC_IDLE_QUIET_MS) {
+		return;
+	}
+	duk_gc_idle(ctx, s_gc_idle_budget, s_gc_idle_flags);
+	(void) arg;
+}
+
+void mgos_duk_gc_on_idle(double budget_ms, bool compact) {
+	s_gc_idle_budget = budget_ms;
+	s_gc_idle_flags = compact ? DUK_GC_COMPACT : 0;
+	if (budget_ms > 0 && !s_gc_idle_registered) {
+		mgos_add_poll_cb(mos_duk_gc_idle_poll_cb, NULL);
+		s_gc_idle_registered = true;
+	}
+}
@@ -9,6 +9,12 @@ extern "C" {
 
 void mos_duk_log_error(duk_context *ctx);
 
+/* Monotonic milliseconds, used as Duktape's time source when profiling. */
+double mos_duk_get_monotonic_time(void);
+
+/* Record that a JS callback just ran, idle GC waits for a quiet period. */
+void mos_duk_gc_note_busy(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */